@@ -52,6 +52,10 @@ void split(const Mat& src, Mat* mvbegin);
 
 void flip(const Mat& src, Mat& dst, int flipCode);
 
+void transpose(const Mat& src, Mat& dst);
+
+void rotate(const Mat& src, Mat& dst, int rotateCode);
+
 void bitwise_and(const Mat& src1, const Mat& src2, Mat& dst, const Mat& mask = Mat());
 
 void bitwise_or(const Mat& src1, const Mat& src2, Mat& dst, const Mat& mask = Mat());
@@ -98,6 +98,13 @@ enum BorderTypes
     BORDER_ISOLATED    = 16
 };
 
+enum RotateFlags
+{
+    ROTATE_90_CLOCKWISE        = 0,
+    ROTATE_180                 = 1,
+    ROTATE_90_COUNTERCLOCKWISE = 2
+};
+
 [[noreturn]]
 void error(int _code, const String& _err, const char* _func, const char* _file, int _line);
 
@@ -1,8 +1,422 @@
 #pragma once
 
 #include <cmath>
+#include <cstring>
 #include <float.h>
+#include <limits.h>
 #include <stdlib.h>
+#include <utility>
 #include "openHL/core/hldef.h"
 
+#if defined __SSE2__
+    #include <emmintrin.h>
+#endif
+
 #define HL_SIMD_WIDTH 16
+
+/**
+ * Universal intrinsics.
+ *
+ * The 128-bit register types below are built on the GCC/Clang vector extensions, so the
+ * compiler lowers them to SSE/NEON (or wider, when allowed by -march) without any
+ * platform specific code. Kernels written with them are guarded by HL_SIMD128 and keep
+ * a scalar tail loop for the remaining elements, in the same way as the original
+ * OpenCV universal intrinsics.
+ */
+#if defined __GNUC__ || defined __clang__
+    #define HL_SIMD128 1
+#else
+    #define HL_SIMD128 0
+#endif
+
+#if HL_SIMD128
+
+namespace hl
+{
+
+template <typename _Tp, int n>
+struct v_reg
+{
+    typedef _Tp lane_type;
+    typedef _Tp vector_type __attribute__((vector_size(sizeof(_Tp) * n)));
+
+    enum
+    {
+        nlanes = n
+    };
+
+    v_reg() {}
+
+    explicit v_reg(vector_type v):
+        val(v)
+    {
+    }
+
+    vector_type val;
+};
+
+typedef v_reg<uchar, 16> v_uint8x16;
+typedef v_reg<schar, 16> v_int8x16;
+typedef v_reg<ushort, 8> v_uint16x8;
+typedef v_reg<short, 8>  v_int16x8;
+typedef v_reg<uint, 4>   v_uint32x4;
+typedef v_reg<int, 4>    v_int32x4;
+typedef v_reg<float, 4>  v_float32x4;
+typedef v_reg<double, 2> v_float64x2;
+
+//! unaligned load of HL_SIMD_WIDTH bytes
+template <typename _Tp>
+inline v_reg<_Tp, HL_SIMD_WIDTH / sizeof(_Tp)> v_load(const _Tp* ptr)
+{
+    v_reg<_Tp, HL_SIMD_WIDTH / sizeof(_Tp)> r;
+    memcpy(&r.val, ptr, sizeof(r.val));
+    return r;
+}
+
+//! unaligned store of HL_SIMD_WIDTH bytes
+template <typename _Tp, int n>
+inline void v_store(_Tp* ptr, const v_reg<_Tp, n>& a)
+{
+    memcpy(ptr, &a.val, sizeof(a.val));
+}
+
+//! loads HL_SIMD_WIDTH / sizeof(_Tp2) elements and converts them to _Tp2, e.g. widens uchar to int
+template <typename _Tp2, typename _Tp>
+inline v_reg<_Tp2, HL_SIMD_WIDTH / sizeof(_Tp2)> v_load_convert(const _Tp* ptr)
+{
+    typedef v_reg<_Tp2, HL_SIMD_WIDTH / sizeof(_Tp2)> _Tpvec;
+    typedef _Tp src_type __attribute__((vector_size(sizeof(_Tp) * _Tpvec::nlanes)));
+
+    src_type a;
+    memcpy(&a, ptr, sizeof(a));
+    return _Tpvec(__builtin_convertvector(a, typename _Tpvec::vector_type));
+}
+
+//! broadcasts v to all lanes
+template <typename _Tp>
+inline v_reg<_Tp, HL_SIMD_WIDTH / sizeof(_Tp)> v_setall(_Tp v)
+{
+    typedef v_reg<_Tp, HL_SIMD_WIDTH / sizeof(_Tp)> _Tpvec;
+    return _Tpvec(typename _Tpvec::vector_type{} + v);
+}
+
+inline v_uint8x16 v_setall_u8(uchar v) { return v_setall(v); }
+
+inline v_uint16x8 v_setall_u16(ushort v) { return v_setall(v); }
+
+inline v_int16x8 v_setall_s16(short v) { return v_setall(v); }
+
+inline v_int32x4 v_setall_s32(int v) { return v_setall(v); }
+
+inline v_float32x4 v_setall_f32(float v) { return v_setall(v); }
+
+//! lane-wise modular arithmetic, i.e. without saturation for the 8- and 16-bit types
+template <typename _Tp, int n>
+inline v_reg<_Tp, n> v_add_wrap(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{
+    return v_reg<_Tp, n>(a.val + b.val);
+}
+
+template <typename _Tp, int n>
+inline v_reg<_Tp, n> v_sub_wrap(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{
+    return v_reg<_Tp, n>(a.val - b.val);
+}
+
+template <typename _Tp, int n>
+inline v_reg<_Tp, n> v_mul_wrap(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{
+    return v_reg<_Tp, n>(a.val * b.val);
+}
+
+//! lane-wise division of the floating-point types
+template <typename _Tp, int n>
+inline v_reg<_Tp, n> v_div(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{
+    return v_reg<_Tp, n>(a.val / b.val);
+}
+
+//! shifts the bits of the lanes, arithmetically for the signed types
+template <int imm, typename _Tp, int n>
+inline v_reg<_Tp, n> v_shl(const v_reg<_Tp, n>& a)
+{
+    return v_reg<_Tp, n>(a.val << imm);
+}
+
+template <int imm, typename _Tp, int n>
+inline v_reg<_Tp, n> v_shr(const v_reg<_Tp, n>& a)
+{
+    return v_reg<_Tp, n>(a.val >> imm);
+}
+
+//! converts the lanes to _Tp2 as a C cast does, i.e. truncating the integers and rounding the floats towards zero
+template <typename _Tp2, typename _Tp, int n>
+inline v_reg<_Tp2, n> v_convert(const v_reg<_Tp, n>& a)
+{
+    return v_reg<_Tp2, n>(__builtin_convertvector(a.val, typename v_reg<_Tp2, n>::vector_type));
+}
+
+//! rounds to the nearest integer, the halves to even as hlRound does
+inline v_int32x4 v_round(const v_float32x4& a)
+{
+    // adding and subtracting 1.5 * 2^23 drops the fraction bits; larger values are integers already
+    const v_float32x4::vector_type magic = v_float32x4::vector_type{} + 12582912.f;
+
+    v_float32x4::vector_type r           = (a.val + magic) - magic;
+    v_float32x4::vector_type absa        = a.val < 0 ? -a.val : a.val;
+    return v_convert<int>(v_float32x4(absa < 8388608.f ? r : a.val));
+}
+
+//! rounds the doubles, which must be in the int range, to the nearest integer in the same way
+template <int n>
+inline v_reg<int, n> v_round(const v_reg<double, n>& a)
+{
+    // the sum with 1.5 * 2^52 has no fraction bits left
+    const typename v_reg<double, n>::vector_type magic = typename v_reg<double, n>::vector_type{} + 6755399441055744.;
+
+    return v_convert<int>(v_reg<double, n>((a.val + magic) - magic));
+}
+
+template <typename _Tp2, typename _Tp, size_t... i>
+inline v_reg<_Tp2, sizeof...(i)> v_lut_convert_(const _Tp* tab, const int* idx, std::index_sequence<i...>)
+{
+    typedef v_reg<_Tp2, sizeof...(i)> _Tpvec;
+    return _Tpvec(typename _Tpvec::vector_type{(_Tp2)tab[idx[i]]...});
+}
+
+//! gathers tab[idx[0]], tab[idx[1]], ... converted to _Tp2 into the HL_SIMD_WIDTH / sizeof(_Tp2) lanes
+template <typename _Tp2, typename _Tp>
+inline v_reg<_Tp2, HL_SIMD_WIDTH / sizeof(_Tp2)> v_lut_convert(const _Tp* tab, const int* idx)
+{
+    return v_lut_convert_<_Tp2>(tab, idx, std::make_index_sequence<HL_SIMD_WIDTH / sizeof(_Tp2)>());
+}
+
+template <typename _Tp>
+inline v_reg<_Tp, HL_SIMD_WIDTH / sizeof(_Tp)> v_lut(const _Tp* tab, const int* idx)
+{
+    return v_lut_convert<_Tp>(tab, idx);
+}
+
+template <typename _Tp, int n, size_t... i>
+inline void v_load_deinterleave_(const _Tp* ptr, v_reg<_Tp, n>& a, v_reg<_Tp, n>& b, std::index_sequence<i...>)
+{
+    typename v_reg<_Tp, n>::vector_type lo, hi;
+    memcpy(&lo, ptr, sizeof(lo));
+    memcpy(&hi, ptr + n, sizeof(hi));
+    a.val = __builtin_shufflevector(lo, hi, (int)i * 2 ...);
+    b.val = __builtin_shufflevector(lo, hi, (int)i * 2 + 1 ...);
+}
+
+//! loads 2 * n interleaved elements, a gets the even ones and b the odd ones
+template <typename _Tp, int n>
+inline void v_load_deinterleave(const _Tp* ptr, v_reg<_Tp, n>& a, v_reg<_Tp, n>& b)
+{
+    v_load_deinterleave_(ptr, a, b, std::make_index_sequence<n>());
+}
+
+template <int imm, typename _Tp, int n, size_t... i>
+inline v_reg<_Tp, n> v_rotate_left_(const v_reg<_Tp, n>& a, std::index_sequence<i...>)
+{
+    typename v_reg<_Tp, n>::vector_type z = {};
+    return v_reg<_Tp, n>(__builtin_shufflevector(a.val, z, ((int)i >= imm ? (int)i - imm : n)...));
+}
+
+//! shifts the lanes towards the higher indices, c[i] = a[i - imm], filling the low lanes with zeros
+template <int imm, typename _Tp, int n>
+inline v_reg<_Tp, n> v_rotate_left(const v_reg<_Tp, n>& a)
+{
+    return v_rotate_left_<imm>(a, std::make_index_sequence<n>());
+}
+
+template <int imm, typename _Tp, int n, size_t... i>
+inline v_reg<_Tp, n> v_rotate_right_(const v_reg<_Tp, n>& a, std::index_sequence<i...>)
+{
+    typename v_reg<_Tp, n>::vector_type z = {};
+    return v_reg<_Tp, n>(__builtin_shufflevector(a.val, z, (int)i + imm...));
+}
+
+//! shifts the lanes towards the lower indices, c[i] = a[i + imm], filling the high lanes with zeros
+template <int imm, typename _Tp, int n>
+inline v_reg<_Tp, n> v_rotate_right(const v_reg<_Tp, n>& a)
+{
+    return v_rotate_right_<imm>(a, std::make_index_sequence<n>());
+}
+
+template <typename _Tp, int n, size_t... i>
+inline void v_zip_(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b, v_reg<_Tp, n>& c, v_reg<_Tp, n>& d, std::index_sequence<i...>)
+{
+    c.val = __builtin_shufflevector(a.val, b.val, ((int)i / 2 + ((int)i % 2) * n)...);
+    d.val = __builtin_shufflevector(a.val, b.val, ((int)i / 2 + n / 2 + ((int)i % 2) * n)...);
+}
+
+//! interleaves the low halves of a and b into c = {a[0], b[0], a[1], b[1], ...} and the high halves into d
+template <typename _Tp, int n>
+inline void v_zip(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b, v_reg<_Tp, n>& c, v_reg<_Tp, n>& d)
+{
+    v_zip_(a, b, c, d, std::make_index_sequence<n>());
+}
+
+template <typename _Tp, int n, size_t... i>
+inline v_reg<_Tp, n * 2> v_combine_(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b, std::index_sequence<i...>)
+{
+    return v_reg<_Tp, n * 2>(__builtin_shufflevector(a.val, b.val, (int)i...));
+}
+
+//! the lanes of a followed by the lanes of b
+template <typename _Tp, int n>
+inline v_reg<_Tp, n * 2> v_combine(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{
+    return v_combine_(a, b, std::make_index_sequence<n * 2>());
+}
+
+template <typename _Tp, int n, size_t... i>
+inline v_reg<_Tp, n / 2> v_get_low_(const v_reg<_Tp, n>& a, std::index_sequence<i...>)
+{
+    return v_reg<_Tp, n / 2>(__builtin_shufflevector(a.val, a.val, (int)i...));
+}
+
+//! the lower half of the lanes
+template <typename _Tp, int n>
+inline v_reg<_Tp, n / 2> v_get_low(const v_reg<_Tp, n>& a)
+{
+    return v_get_low_(a, std::make_index_sequence<n / 2>());
+}
+
+template <typename _Tp, int n, size_t... i>
+inline v_reg<_Tp, n / 2> v_get_high_(const v_reg<_Tp, n>& a, std::index_sequence<i...>)
+{
+    return v_reg<_Tp, n / 2>(__builtin_shufflevector(a.val, a.val, (int)(i + n / 2)...));
+}
+
+//! the upper half of the lanes
+template <typename _Tp, int n>
+inline v_reg<_Tp, n / 2> v_get_high(const v_reg<_Tp, n>& a)
+{
+    return v_get_high_(a, std::make_index_sequence<n / 2>());
+}
+
+template <typename _Tp, int n>
+inline v_reg<_Tp, n> v_min(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{
+    return v_reg<_Tp, n>(a.val < b.val ? a.val : b.val);
+}
+
+template <typename _Tp, int n>
+inline v_reg<_Tp, n> v_max(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{
+    return v_reg<_Tp, n>(a.val > b.val ? a.val : b.val);
+}
+
+//! the comparisons set all the bits of the lanes where they hold, and clear the other lanes
+#define HL_INTRIN_DEF_CMP_OP(op)                                                   \
+    template <typename _Tp, int n>                                                 \
+    inline v_reg<_Tp, n> operator op(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b) \
+    {                                                                              \
+        typedef typename v_reg<_Tp, n>::vector_type vector_type;                   \
+        return v_reg<_Tp, n>((vector_type)(a.val op b.val));                       \
+    }
+
+HL_INTRIN_DEF_CMP_OP(==)
+HL_INTRIN_DEF_CMP_OP(!=)
+HL_INTRIN_DEF_CMP_OP(<)
+HL_INTRIN_DEF_CMP_OP(>)
+HL_INTRIN_DEF_CMP_OP(<=)
+HL_INTRIN_DEF_CMP_OP(>=)
+
+#undef HL_INTRIN_DEF_CMP_OP
+
+//! per-lane mask ? a : b, the mask is the result of a comparison
+template <typename _Tp, int n>
+inline v_reg<_Tp, n> v_select(const v_reg<_Tp, n>& mask, const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{
+    typedef decltype(mask.val == mask.val) mask_type;
+    return v_reg<_Tp, n>((mask_type)mask.val ? a.val : b.val);
+}
+
+//! true when all the lanes of a are set, a is the result of a comparison
+template <typename _Tp, int n>
+inline bool v_check_all(const v_reg<_Tp, n>& a)
+{
+#if defined __SSE2__
+    return _mm_movemask_epi8((__m128i)a.val) == 0xffff;
+#else
+    for (int i = 0; i < n; i++)
+        if (a.val[i] == 0)
+            return false;
+    return true;
+#endif
+}
+
+//! the high 16 bits of the 32-bit products, c[i] = (a[i] * b[i]) >> 16
+inline v_int16x8 v_mul_hi(const v_int16x8& a, const v_int16x8& b)
+{
+#if defined __SSE2__
+    return v_int16x8((v_int16x8::vector_type)_mm_mulhi_epi16((__m128i)a.val, (__m128i)b.val));
+#else
+    typedef int wide_type __attribute__((vector_size(sizeof(int) * 8)));
+    wide_type p = __builtin_convertvector(a.val, wide_type) * __builtin_convertvector(b.val, wide_type);
+    return v_int16x8(__builtin_convertvector(p >> 16, v_int16x8::vector_type));
+#endif
+}
+
+//! sums the products of the adjacent pairs of lanes, c[i] = a[2i] * b[2i] + a[2i + 1] * b[2i + 1]
+inline v_int32x4 v_dotprod(const v_int16x8& a, const v_int16x8& b)
+{
+#if defined __SSE2__
+    return v_int32x4((v_int32x4::vector_type)_mm_madd_epi16((__m128i)a.val, (__m128i)b.val));
+#else
+    typedef int wide_type __attribute__((vector_size(sizeof(int) * 8)));
+    wide_type p = __builtin_convertvector(a.val, wide_type) * __builtin_convertvector(b.val, wide_type);
+    return v_int32x4(__builtin_shufflevector(p, p, 0, 2, 4, 6) + __builtin_shufflevector(p, p, 1, 3, 5, 7));
+#endif
+}
+
+//! widens the cn = 2..4 channels of 2 adjacent 8-bit pixels to the pairs {p0[0], p1[0], p0[1], p1[1], ...},
+//! the operand of v_dotprod with the 2 weights of each channel; only the 2 * cn bytes of the pixels are read
+template <int cn>
+inline v_int16x8 v_load_expand_pair(const uchar* ptr)
+{
+    uint lo, hi = 0;
+    memcpy(&lo, ptr, sizeof(lo));
+    memcpy(&hi, ptr + sizeof(lo), cn * 2 - sizeof(lo));
+
+    v_uint8x16 b((v_uint8x16::vector_type)v_uint32x4::vector_type{lo, hi, 0, 0}), p, t;
+    v_zip(b, v_rotate_right<cn>(b), p, t);
+    return v_convert<short>(v_get_low(p));
+}
+
+//! narrows the lanes of a followed by the lanes of b with saturation
+inline v_int16x8 v_pack(const v_int32x4& a, const v_int32x4& b)
+{
+#if defined __SSE2__
+    return v_int16x8((v_int16x8::vector_type)_mm_packs_epi32((__m128i)a.val, (__m128i)b.val));
+#else
+    v_int32x4::vector_type lo = v_min(v_max(a, v_setall_s32(SHRT_MIN)), v_setall_s32(SHRT_MAX)).val;
+    v_int32x4::vector_type hi = v_min(v_max(b, v_setall_s32(SHRT_MIN)), v_setall_s32(SHRT_MAX)).val;
+    return v_int16x8(__builtin_convertvector(__builtin_shufflevector(lo, hi, 0, 1, 2, 3, 4, 5, 6, 7), v_int16x8::vector_type));
+#endif
+}
+
+//! narrows the signed lanes of a followed by the lanes of b to unsigned with saturation
+inline v_uint8x16 v_pack_u(const v_int16x8& a, const v_int16x8& b)
+{
+#if defined __SSE2__
+    return v_uint8x16((v_uint8x16::vector_type)_mm_packus_epi16((__m128i)a.val, (__m128i)b.val));
+#else
+    v_int16x8::vector_type lo = v_min(v_max(a, v_setall_s16(0)), v_setall_s16(UCHAR_MAX)).val;
+    v_int16x8::vector_type hi = v_min(v_max(b, v_setall_s16(0)), v_setall_s16(UCHAR_MAX)).val;
+    return v_uint8x16(__builtin_convertvector(__builtin_shufflevector(lo, hi, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), v_uint8x16::vector_type));
+#endif
+}
+
+//! narrows the signed lanes of a followed by the lanes of b to unsigned 16 bits with saturation
+inline v_uint16x8 v_pack_u(const v_int32x4& a, const v_int32x4& b)
+{
+    v_int32x4::vector_type lo = v_min(v_max(a, v_setall_s32(0)), v_setall_s32(USHRT_MAX)).val;
+    v_int32x4::vector_type hi = v_min(v_max(b, v_setall_s32(0)), v_setall_s32(USHRT_MAX)).val;
+    return v_uint16x8(__builtin_convertvector(__builtin_shufflevector(lo, hi, 0, 1, 2, 3, 4, 5, 6, 7), v_uint16x8::vector_type));
+}
+
+}    // namespace hl
+
+#endif    // HL_SIMD128
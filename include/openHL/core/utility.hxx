@@ -97,6 +97,13 @@ public:
 
 void parallel_for_(const Range& range, const ParallelLoopBody& body, double nstripes = -1.);
 
+//! sets the number of threads used by parallel_for_, a negative value restores the default of one thread per CPU
+void setNumThreads(int nthreads);
+
+int getNumThreads();
+
+int getNumberOfCPUs();
+
 /////////////////////////// Synchronization Primitives ///////////////////////////////
 
 typedef std::recursive_mutex       Mutex;
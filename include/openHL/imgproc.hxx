@@ -17,7 +17,9 @@ enum InterpolationFlags
     INTER_MAX           = 7,
     WARP_FILL_OUTLIERS  = 8,
     WARP_INVERSE_MAP    = 16,
-    WARP_RELATIVE_MAP   = 32
+    WARP_RELATIVE_MAP   = 32,
+    INTER_CUBIC_EXACT   = 64,
+    INTER_AREA_EXACT    = 65
 };
 
 enum InterpolationMasks
@@ -40,6 +42,36 @@ enum ThresholdTypes
     THRESH_TRIANGLE   = 16
 };
 
+enum AdaptiveThresholdTypes
+{
+    ADAPTIVE_THRESH_MEAN_C     = 0,
+    ADAPTIVE_THRESH_GAUSSIAN_C = 1
+};
+
+enum MorphTypes
+{
+    MORPH_ERODE    = 0,
+    MORPH_DILATE   = 1,
+    MORPH_OPEN     = 2,
+    MORPH_CLOSE    = 3,
+    MORPH_GRADIENT = 4,
+    MORPH_TOPHAT   = 5,
+    MORPH_BLACKHAT = 6
+};
+
+enum MorphShapes
+{
+    MORPH_RECT    = 0,
+    MORPH_CROSS   = 1,
+    MORPH_ELLIPSE = 2
+};
+
+enum BilateralFilterModes
+{
+    BILATERAL_EXACT = 0,
+    BILATERAL_GRID  = 1
+};
+
 enum ColorConversionCodes
 {
     COLOR_BGR2GRAY    = 6,
@@ -78,12 +110,44 @@ void boxFilter(const Mat& src, Mat& dst, int ddepth, Size ksize, Point anchor =
 
 void blur(const Mat& src, Mat& dst, Size ksize, Point anchor = Point(-1, -1), int borderType = BORDER_DEFAULT);
 
+void GaussianBlurIIR(const Mat& src, Mat& dst, double sigmaX, double sigmaY = 0, int borderType = BORDER_DEFAULT);
+
+void stackBlur(const Mat& src, Mat& dst, Size ksize, int borderType = BORDER_DEFAULT);
+
+void integral(const Mat& src, Mat& sum, int sdepth = -1);
+
+void integral(const Mat& src, Mat& sum, Mat& sqsum, int sdepth = -1, int sqdepth = -1);
+
+void integral(const Mat& src, Mat& sum, Mat& sqsum, Mat& tilted, int sdepth = -1, int sqdepth = -1);
+
+void bilateralFilter(const Mat& src, Mat& dst, int d, double sigmaColor, double sigmaSpace, int borderType = BORDER_DEFAULT, int mode = BILATERAL_EXACT);
+
+Mat getStructuringElement(int shape, Size ksize, Point anchor = Point(-1, -1));
+
+inline static Scalar morphologyDefaultBorderValue() { return Scalar::all(DBL_MAX); }
+
+void erode(const Mat& src, Mat& dst, const Mat& kernel, Point anchor = Point(-1, -1), int iterations = 1, int borderType = BORDER_CONSTANT, const Scalar& borderValue = morphologyDefaultBorderValue());
+
+void dilate(const Mat& src, Mat& dst, const Mat& kernel, Point anchor = Point(-1, -1), int iterations = 1, int borderType = BORDER_CONSTANT, const Scalar& borderValue = morphologyDefaultBorderValue());
+
+void morphologyEx(const Mat& src, Mat& dst, int op, const Mat& kernel, Point anchor = Point(-1, -1), int iterations = 1, int borderType = BORDER_CONSTANT, const Scalar& borderValue = morphologyDefaultBorderValue());
+
 void resize(const Mat& src, Mat& dst, Size dsize, double fx = 0, double fy = 0, int interpolation = INTER_LINEAR);
 
+void pyrDown(const Mat& src, Mat& dst, const Size& dstsize = Size(), int borderType = BORDER_DEFAULT);
+
+void pyrUp(const Mat& src, Mat& dst, const Size& dstsize = Size(), int borderType = BORDER_DEFAULT);
+
+void buildPyramid(const Mat& src, std::vector<Mat>& dst, int maxlevel, int borderType = BORDER_DEFAULT);
+
 void warpAffine(const Mat& src, Mat& dst, const Mat& M, Size dsize, int flags = INTER_LINEAR, int borderMode = BORDER_CONSTANT, const Scalar& borderValue = Scalar());
 
+void warpPerspective(const Mat& src, Mat& dst, const Mat& M, Size dsize, int flags = INTER_LINEAR, int borderMode = BORDER_CONSTANT, const Scalar& borderValue = Scalar());
+
 void remap(const Mat& src, Mat& dst, const Mat& map1, const Mat& map2, int interpolation, int borderMode = BORDER_CONSTANT, const Scalar& borderValue = Scalar());
 
+void convertMaps(const Mat& map1, const Mat& map2, Mat& dstmap1, Mat& dstmap2, int dstmap1type, bool nninterpolation = false);
+
 Matx23d getRotationMatrix2D_(Point2f center, double angle, double scale);
 
 inline Mat getRotationMatrix2D(Point2f center, double angle, double scale)
@@ -93,10 +157,32 @@ inline Mat getRotationMatrix2D(Point2f center, double angle, double scale)
 
 double threshold(const Mat& src, Mat& dst, double thresh, double maxval, int type);
 
+void adaptiveThreshold(const Mat& src, Mat& dst, double maxValue, int adaptiveMethod, int thresholdType, int blockSize, double C);
+
+std::vector<int> thresholdMulti(const Mat& src, Mat& dst, int nthresh, double maxval = 255);
+
 void calcHist(const Mat* images, int nimages, const int* channels, const Mat& mask, Mat& hist, int dims, const int* histSize, const float** ranges, bool uniform = true, bool accumulate = false);
 
 void equalizeHist(const Mat& src, Mat& dst);
 
+class CLAHE
+{
+public:
+    virtual ~CLAHE() {}
+
+    virtual void apply(const Mat& src, Mat& dst) = 0;
+
+    virtual void   setClipLimit(double clipLimit) = 0;
+    virtual double getClipLimit() const           = 0;
+
+    virtual void setTilesGridSize(Size tileGridSize) = 0;
+    virtual Size getTilesGridSize() const            = 0;
+
+    virtual void collectGarbage() = 0;
+};
+
+Ptr<CLAHE> createCLAHE(double clipLimit = 40.0, Size tileGridSize = Size(8, 8));
+
 void drawHist_T(const Mat& hist, Mat& histImage, uint width, uint height, uchar thresh);
 
 void drawHist(const Mat& hist, Mat& histImage, uint width, uint height);
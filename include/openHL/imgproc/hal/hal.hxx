@@ -17,6 +17,12 @@ void warpAffineBlocklineNN(int* adelta, int* bdelta, short* xy, int X0, int Y0,
 
 void warpAffineBlockline(int* adelta, int* bdelta, short* xy, short* alpha, int X0, int Y0, int bw);
 
+void warpPerspective(int src_type, const uchar* src_data, size_t src_step, int src_width, int src_height, uchar* dst_data, size_t dst_step, int dst_width, int dst_height, const double M[9], int interpolation, int borderType, const double borderValue[4]);
+
+void warpPerspectiveBlocklineNN(const double* M, short* xy, double X0, double Y0, double W0, int bw);
+
+void warpPerspectiveBlockline(const double* M, short* xy, short* alpha, double X0, double Y0, double W0, int bw);
+
 void cvtBGRtoGray(const uchar* src_data, size_t src_step, uchar* dst_data, size_t dst_step, int width, int height, int depth, int scn, bool swapBlue);
 
 }    // namespace hal
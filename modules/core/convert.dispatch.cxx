@@ -27,6 +27,8 @@ void Mat::convertTo(Mat& _dst, int _type, double alpha, double beta) const
     int sdepth = depth(), ddepth = HL_MAT_DEPTH(_type);
     if (sdepth == ddepth && noScale)
     {
+        if (_dst.type() != _type)
+            _dst.release();
         copyTo(_dst);
         return;
     }
@@ -155,11 +155,11 @@ BinaryFunc getCopyMaskFunc(size_t esz)
     return esz <= 32 && copyMaskTab[esz] ? copyMaskTab[esz] : copyMaskGeneric;
 }
 
-/* dst = src */
+/* dst = src, a non-empty dst of another type receives the converted data */
 void Mat::copyTo(Mat& _dst) const
 {
     int dtype = _dst.type();
-    if (dtype != type())
+    if (!_dst.empty() && dtype != type())
     {
         HL_Assert(channels() == HL_MAT_CN(dtype));
         convertTo(_dst, dtype);
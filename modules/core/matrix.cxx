@@ -617,7 +617,7 @@ Mat::~Mat()
 {
     release();
     if (step.p != step.buf)
-        free(step.p);
+        fastFree(step.p);
 }
 
 Mat& Mat::operator=(const Mat& m)
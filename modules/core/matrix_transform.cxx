@@ -119,4 +119,172 @@ void flip(const Mat& _src, Mat& _dst, int flip_mode)
         flipHoriz(dst.ptr(), dst.step, dst.ptr(), dst.step, dst.size(), esz);
 }
 
+typedef void (*TransposeFunc)(const uchar* src, ptrdiff_t sstep, uchar* dst, ptrdiff_t dstep, Size size);
+
+// dst rows i0..i1 get the columns i0..i1 of the src rows j0..j1
+template <typename T>
+static void transposeBlock(const uchar* src, ptrdiff_t sstep, uchar* dst, ptrdiff_t dstep, int i0, int i1, int j0, int j1)
+{
+    for (int i = i0; i < i1; i++)
+    {
+        T* d = (T*)(dst + i * dstep);
+        for (int j = j0; j < j1; j++)
+            d[j] = ((const T*)(src + j * sstep))[i];
+    }
+}
+
+#if HL_SIMD128
+
+// an n x n tile of n-lane registers, transposed by log2(n) rounds of v_zip
+template <typename T>
+static inline void v_transposeTile(const uchar* src, ptrdiff_t sstep, uchar* dst, ptrdiff_t dstep)
+{
+    typedef v_reg<T, HL_SIMD_WIDTH / sizeof(T)> _Tpvec;
+    const int n = _Tpvec::nlanes;
+
+    _Tpvec r[n], t[n];
+    for (int k = 0; k < n; k++)
+        r[k] = v_load((const T*)(src + k * sstep));
+
+    for (int s = 1; s < n; s *= 2)
+    {
+        for (int k = 0; k < n / 2; k++)
+            v_zip(r[k], r[k + n / 2], t[k * 2], t[k * 2 + 1]);
+        for (int k = 0; k < n; k++)
+            r[k] = t[k];
+    }
+
+    for (int k = 0; k < n; k++)
+        v_store((T*)(dst + k * dstep), r[k]);
+}
+
+#endif
+
+/*
+ * Transposes size (of src) in passes over BLOCK src rows, so both the rows read and the rows written
+ * stay in the cache. The steps may be negative, which turns the transposition into a rotation.
+ */
+template <typename T, bool simd>
+static void transpose_(const uchar* src, ptrdiff_t sstep, uchar* dst, ptrdiff_t dstep, Size size)
+{
+    const int BLOCK = 64;
+
+    for (int j0 = 0; j0 < size.height; j0 += BLOCK)
+    {
+        int j1 = std::min(j0 + BLOCK, size.height), i = 0;
+#if HL_SIMD128
+        if constexpr (simd)
+        {
+            const int n = HL_SIMD_WIDTH / sizeof(T);
+            for (; i <= size.width - n; i += n)
+            {
+                int j = j0;
+                for (; j <= j1 - n; j += n)
+                    v_transposeTile<T>(src + j * sstep + i * sizeof(T), sstep, dst + i * dstep + j * sizeof(T), dstep);
+                transposeBlock<T>(src, sstep, dst, dstep, i, i + n, j, j1);
+            }
+        }
+#endif
+        transposeBlock<T>(src, sstep, dst, dstep, i, size.width, j0, j1);
+    }
+}
+
+static TransposeFunc getTransposeFunc(size_t esz)
+{
+    static TransposeFunc transposeTab[] = {
+        0, transpose_<uchar, true>, transpose_<ushort, true>, transpose_<Vec3b, false>, transpose_<int, true>, 0, transpose_<Vec3s, false>, 0, transpose_<int64, true>, 0, 0, 0, transpose_<Vec3i, false>, 0, 0, 0, transpose_<Vec4i, false>, 0, 0, 0, 0, 0, 0, 0, transpose_<Vec6i, false>, 0, 0, 0, 0, 0, 0, 0, transpose_<Vec8i, false>};
+
+    return esz <= 32 ? transposeTab[esz] : 0;
+}
+
+// every stripe is a range of BLOCK src columns, i.e. of dst rows
+class TransposeInvoker: public ParallelLoopBody
+{
+public:
+    enum
+    {
+        BLOCK = 64
+    };
+
+    TransposeInvoker(const uchar* _src, ptrdiff_t _sstep, uchar* _dst, ptrdiff_t _dstep, Size _size, size_t _esz, TransposeFunc _func):
+        ParallelLoopBody(), src(_src), sstep(_sstep), dst(_dst), dstep(_dstep), size(_size), esz(_esz), func(_func)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        int i0 = range.start * BLOCK, i1 = std::min(range.end * BLOCK, size.width);
+        func(src + i0 * esz, sstep, dst + i0 * dstep, dstep, Size(i1 - i0, size.height));
+    }
+
+private:
+    const uchar*  src;
+    ptrdiff_t     sstep;
+    uchar*        dst;
+    ptrdiff_t     dstep;
+    Size          size;
+    size_t        esz;
+    TransposeFunc func;
+
+    TransposeInvoker(const TransposeInvoker&);                     // = delete;
+    const TransposeInvoker& operator=(const TransposeInvoker&);    // = delete;
+};
+
+/*
+ * dst is src transposed, with the rows of src taken bottom up for flipSrc, which rotates it clockwise,
+ * or the rows of dst written bottom up for flipDst, which rotates it counterclockwise.
+ */
+static void transposeImpl(const Mat& _src, Mat& _dst, bool flipSrc, bool flipDst)
+{
+    HL_Assert(_src.dims <= 2);
+
+    Mat src = _src;
+    _dst.create(src.cols, src.rows, src.type());
+    Mat dst = _dst;
+    if (src.empty())
+        return;
+    if (dst.data == src.data)
+    {
+        Mat tmp(src.size(), src.type());
+        src.copyTo(tmp);
+        src = tmp;
+    }
+
+    size_t        esz  = src.elemSize();
+    TransposeFunc func = getTransposeFunc(esz);
+    if (!func)
+        HL_Error(Error::StsUnsupportedFormat, "");
+
+    const uchar* sptr  = flipSrc ? src.ptr(src.rows - 1) : src.ptr();
+    ptrdiff_t    sstep = flipSrc ? -(ptrdiff_t)src.step : (ptrdiff_t)src.step;
+    uchar*       dptr  = flipDst ? dst.ptr(dst.rows - 1) : dst.ptr();
+    ptrdiff_t    dstep = flipDst ? -(ptrdiff_t)dst.step : (ptrdiff_t)dst.step;
+
+    TransposeInvoker invoker(sptr, sstep, dptr, dstep, src.size(), esz, func);
+    parallel_for_(Range(0, (src.cols + TransposeInvoker::BLOCK - 1) / TransposeInvoker::BLOCK), invoker, src.total() / (double)(1 << 16));
+}
+
+void transpose(const Mat& src, Mat& dst)
+{
+    transposeImpl(src, dst, false, false);
+}
+
+void rotate(const Mat& src, Mat& dst, int rotateMode)
+{
+    switch (rotateMode)
+    {
+        case ROTATE_90_CLOCKWISE:
+            transposeImpl(src, dst, true, false);
+            break;
+        case ROTATE_180:
+            flip(src, dst, -1);
+            break;
+        case ROTATE_90_COUNTERCLOCKWISE:
+            transposeImpl(src, dst, false, true);
+            break;
+        default:
+            HL_Error(Error::StsBadArg, "Unknown rotation code");
+    }
+}
+
 }    // namespace hl
\ No newline at end of file
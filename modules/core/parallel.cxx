@@ -1,6 +1,10 @@
 #include "precomp.hxx"
 
 #include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <thread>
+#include <vector>
 
 using namespace hl;
 
@@ -13,6 +17,155 @@ ParallelLoopBody::~ParallelLoopBody() {}
 
 static void parallel_for_impl(const hl::Range& range, const hl::ParallelLoopBody& body, double nstripes);    // forward declaration
 
+//! the number of threads used by parallel_for_, -1 means one thread per CPU
+static std::atomic<int> numThreads(-1);
+
+/*
+ * The whole range is split into nstripes stripes of (almost) equal length. The stripes are the
+ * units of work handed to the threads: every thread takes the next free stripe until none is left.
+ */
+class ProxyLoopBody
+{
+public:
+    ProxyLoopBody(const ParallelLoopBody& _body, const Range& _range, double _nstripes):
+        body(_body), wholeRange(_range)
+    {
+        double len = wholeRange.end - wholeRange.start;
+        nstripes   = hlRound(_nstripes <= 0 ? len : std::min(std::max(_nstripes, 1.), len));
+    }
+
+    void operator()(int stripe) const
+    {
+        long long len = wholeRange.end - wholeRange.start;
+        Range     r;
+        r.start = (int)(wholeRange.start + (stripe * len + nstripes / 2) / nstripes);
+        r.end   = stripe + 1 >= nstripes ? wholeRange.end : (int)(wholeRange.start + ((stripe + 1) * len + nstripes / 2) / nstripes);
+        body(r);
+    }
+
+    const ParallelLoopBody& body;
+    Range                   wholeRange;
+    int                     nstripes;
+
+private:
+    ProxyLoopBody(const ProxyLoopBody&);                     // = delete;
+    const ProxyLoopBody& operator=(const ProxyLoopBody&);    // = delete;
+};
+
+/*
+ * A pool of sleeping worker threads, created on the first use and grown on demand. The thread
+ * calling run() works on the job as well, so a job with n threads wakes n - 1 workers. Only one
+ * job runs at a time: parallel_for_ does not parallelize nested (or concurrent) calls.
+ */
+class ThreadPool
+{
+public:
+    static ThreadPool& instance()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    void run(const ProxyLoopBody& body, int nthreads)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while ((int)workers.size() < nthreads - 1)
+            {
+                int id = (int)workers.size();
+                workers.emplace_back([this, id]() { workerLoop(id); });
+            }
+
+            job        = &body;
+            jobThreads = nthreads;
+            pending    = nthreads - 1;
+            nextStripe = 0;
+            error      = nullptr;
+            generation++;
+        }
+        taskCond.notify_all();
+
+        execute();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCond.wait(lock, [this]() { return pending == 0; });
+        job = nullptr;
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    ThreadPool() {}
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        taskCond.notify_all();
+        for (std::thread& t : workers)
+            t.join();
+    }
+
+    void workerLoop(int id)
+    {
+        unsigned seen = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                taskCond.wait(lock, [this, seen]() { return stop || generation != seen; });
+                if (stop)
+                    return;
+                seen = generation;
+                // the workers beyond the thread count of the job stay asleep
+                if (id >= jobThreads - 1)
+                    continue;
+            }
+
+            execute();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0)
+                doneCond.notify_one();
+        }
+    }
+
+    void execute()
+    {
+        try
+        {
+            for (int i; (i = nextStripe++) < job->nstripes;)
+                (*job)(i);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            // the remaining stripes are dropped
+            nextStripe = job->nstripes;
+        }
+    }
+
+    std::mutex               mutex;
+    std::condition_variable  taskCond;
+    std::condition_variable  doneCond;
+    std::vector<std::thread> workers;
+
+    const ProxyLoopBody* job        = nullptr;
+    int                  jobThreads = 0;
+    int                  pending    = 0;
+    unsigned             generation = 0;
+    bool                 stop       = false;
+    std::atomic<int>     nextStripe = 0;
+    std::exception_ptr   error;
+
+    ThreadPool(const ThreadPool&);                     // = delete;
+    const ThreadPool& operator=(const ThreadPool&);    // = delete;
+};
+
 void parallel_for_(const hl::Range& range, const hl::ParallelLoopBody& body, double nstripes)
 {
     if (range.empty())
@@ -44,84 +197,35 @@ void parallel_for_(const hl::Range& range, const hl::ParallelLoopBody& body, dou
 
 static void parallel_for_impl(const hl::Range& range, const hl::ParallelLoopBody& body, double nstripes)
 {
-    HL_UNUSED(nstripes);
-    //     using namespace cv::parallel;
-    //     if ((numThreads < 0 || numThreads > 1) && range.end - range.start > 1)
-    //     {
-    //         ParallelLoopBodyWrapperContext ctx(body, range, nstripes);
-    //         ProxyLoopBody                  pbody(ctx);
-    //         cv::Range                      stripeRange = pbody.stripeRange();
-    //         if (stripeRange.end - stripeRange.start == 1)
-    //         {
-    //             body(range);
-    //             return;
-    //         }
-
-    //         std::shared_ptr<ParallelForAPI>& api = getCurrentParallelForAPI();
-    //         if (api)
-    //         {
-    //             CV_CheckEQ(stripeRange.start, 0, "");
-    //             api->parallel_for(stripeRange.end, parallel_for_cb, (void*)&pbody);
-    //             ctx.finalize();    // propagate exceptions if exists
-    //             return;
-    //         }
-
-    // #ifdef CV_PARALLEL_FRAMEWORK
-    //     #if defined HAVE_TBB
-
-    //         #if TBB_INTERFACE_VERSION >= 8000
-    //         tbbArena.execute(pbody);
-    //         #else
-    //         pbody();
-    //         #endif
-
-    //     #elif defined HAVE_HPX
-    //         pbody();
-
-    //     #elif defined HAVE_OPENMP
-
-    //         #pragma omp parallel for schedule(dynamic) num_threads(numThreads > 0 ? numThreads : numThreadsMax)
-    //         for (int i = stripeRange.start; i < stripeRange.end; ++i)
-    //             pbody(Range(i, i + 1));
-
-    //     #elif defined HAVE_GCD
-
-    //         dispatch_queue_t concurrent_queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
-    //         dispatch_apply_f(stripeRange.end - stripeRange.start, concurrent_queue, &pbody, block_function);
-
-    //     #elif defined WINRT
-
-    //         Concurrency::parallel_for(stripeRange.start, stripeRange.end, pbody);
-
-    //     #elif defined HAVE_CONCURRENCY
-
-    //         if (!pplScheduler || pplScheduler->Id() == Concurrency::CurrentScheduler::Id())
-    //         {
-    //             Concurrency::parallel_for(stripeRange.start, stripeRange.end, pbody);
-    //         }
-    //         else
-    //         {
-    //             pplScheduler->Attach();
-    //             Concurrency::parallel_for(stripeRange.start, stripeRange.end, pbody);
-    //             Concurrency::CurrentScheduler::Detach();
-    //         }
-
-    //     #elif defined HAVE_PTHREADS_PF
-
-    //         parallel_for_pthreads(pbody.stripeRange(), pbody, pbody.stripeRange().size());
-
-    //     #else
+    int nthreads = getNumThreads();
+    if (nthreads > 1 && range.end - range.start > 1)
+    {
+        ProxyLoopBody pbody(body, range, nstripes);
+        if (pbody.nstripes > 1)
+        {
+            ThreadPool::instance().run(pbody, std::min(nthreads, pbody.nstripes));
+            return;
+        }
+    }
 
-    //         #error You have hacked and compiling with unsupported parallel framework
+    body(range);
+}
 
-    //     #endif
+void setNumThreads(int nthreads)
+{
+    numThreads.store(nthreads, std::memory_order_relaxed);
+}
 
-    //         ctx.finalize();    // propagate exceptions if exists
-    //         return;
-    // #endif                     // CV_PARALLEL_FRAMEWORK
-    //     }
+int getNumThreads()
+{
+    int n = numThreads.load(std::memory_order_relaxed);
+    return n < 0 ? getNumberOfCPUs() : std::max(n, 1);
+}
 
-    body(range);
+int getNumberOfCPUs()
+{
+    static int ncpus = std::max((int)std::thread::hardware_concurrency(), 1);
+    return ncpus;
 }
 
 }    // namespace hl
\ No newline at end of file
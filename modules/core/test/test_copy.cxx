@@ -0,0 +1,56 @@
+#include "test_precomp.hxx"
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+TEST(Core_CopyTo, emptyDstGetsSrcType)
+{
+    for (int type : {HL_8UC1, HL_8UC2, HL_8UC3, HL_16SC4, HL_32FC3, HL_64FC2})
+    {
+        Mat src(7, 5, type);
+        randomFill(src, type);
+
+        Mat dst;
+        src.copyTo(dst);
+        EXPECT_TRUE(equalMats(src, dst)) << "type " << type;
+
+        Mat cloned = src.clone();
+        EXPECT_TRUE(equalMats(src, cloned)) << "type " << type;
+    }
+}
+
+TEST(Core_CopyTo, nonEmptyDstOfOtherDepthIsConverted)
+{
+    Mat src(3, 4, HL_8UC3);
+    randomFill(src, 1);
+
+    Mat dst(1, 1, HL_32FC3);
+    src.copyTo(dst);
+    ASSERT_EQ(HL_32FC3, dst.type());
+    ASSERT_EQ(src.size(), dst.size());
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols * 3; x++)
+            EXPECT_EQ((float)src.ptr<uchar>(y)[x], dst.ptr<float>(y)[x]);
+}
+
+TEST(Core_ConvertTo, sameDepthIntoDstOfOtherType)
+{
+    Mat src(4, 6, HL_32FC4);
+    randomFill(src, 2);
+
+    Mat dst(2, 2, HL_8UC1);
+    src.convertTo(dst, HL_32F);
+    EXPECT_TRUE(equalMats(src, dst));
+
+    Mat empty;
+    src.convertTo(empty, HL_32F);
+    EXPECT_TRUE(equalMats(src, empty));
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
@@ -0,0 +1,105 @@
+#include "test_precomp.hxx"
+
+#include <cstring>
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+//! dst(y, x) = src(map(y, x)), element by element, for any element size
+template <typename Map>
+Mat remapElements(const Mat& src, Size dsize, Map map)
+{
+    Mat    dst(dsize, src.type());
+    size_t esz = src.elemSize();
+    for (int y = 0; y < dsize.height; y++)
+        for (int x = 0; x < dsize.width; x++)
+        {
+            Point p = map(y, x);
+            memcpy(dst.ptr(y) + x * esz, src.ptr(p.y) + p.x * esz, esz);
+        }
+    return dst;
+}
+
+Mat transposeReference(const Mat& src)
+{
+    return remapElements(src, Size(src.rows, src.cols), [](int y, int x) { return Point(y, x); });
+}
+
+Mat rotateReference(const Mat& src, int code)
+{
+    int rows = src.rows, cols = src.cols;
+    switch (code)
+    {
+        case ROTATE_90_CLOCKWISE:
+            return remapElements(src, Size(rows, cols), [&](int y, int x) { return Point(y, rows - 1 - x); });
+        case ROTATE_180:
+            return remapElements(src, src.size(), [&](int y, int x) { return Point(cols - 1 - x, rows - 1 - y); });
+        default:
+            return remapElements(src, Size(rows, cols), [&](int y, int x) { return Point(cols - 1 - y, x); });
+    }
+}
+
+const int types[]  = {HL_8UC1, HL_8UC2, HL_8UC3, HL_16UC1, HL_16SC3, HL_32FC1, HL_32FC2, HL_32SC3, HL_64FC1, HL_32FC4, HL_64FC2, HL_64FC3, HL_64FC4};
+const Size sizes[] = {Size(1, 1), Size(1, 7), Size(9, 1), Size(5, 5), Size(17, 33), Size(70, 45), Size(300, 260)};
+
+TEST(Core_Transpose, matchesReference)
+{
+    for (int type : types)
+        for (Size size : sizes)
+        {
+            Mat src(size, type);
+            randomFill(src, type + size.width);
+
+            Mat dst;
+            transpose(src, dst);
+            EXPECT_TRUE(equalMats(dst, transposeReference(src))) << "type " << type << " " << size.width << "x" << size.height;
+
+            // ROI sources have a step larger than their rows
+            Mat big(size.height + 4, size.width + 6, type);
+            randomFill(big, type);
+            Mat roi = big(Rect(3, 2, size.width, size.height));
+            transpose(roi, dst);
+            EXPECT_TRUE(equalMats(dst, transposeReference(roi))) << "ROI type " << type << " " << size.width << "x" << size.height;
+        }
+}
+
+TEST(Core_Transpose, inPlace)
+{
+    for (int type : types)
+        for (Size size : sizes)
+        {
+            Mat m(size, type);
+            randomFill(m, type * 3 + size.height);
+            Mat expected = transposeReference(m);
+
+            transpose(m, m);
+            EXPECT_TRUE(equalMats(m, expected)) << "type " << type << " " << size.width << "x" << size.height;
+        }
+}
+
+TEST(Core_Rotate, matchesReference)
+{
+    for (int code : {ROTATE_90_CLOCKWISE, ROTATE_180, ROTATE_90_COUNTERCLOCKWISE})
+        for (int type : types)
+            for (Size size : sizes)
+            {
+                Mat src(size, type);
+                randomFill(src, type + code);
+                Mat expected = rotateReference(src, code);
+
+                Mat dst;
+                rotate(src, dst, code);
+                EXPECT_TRUE(equalMats(dst, expected)) << "code " << code << " type " << type << " " << size.width << "x" << size.height;
+
+                rotate(src, src, code);
+                EXPECT_TRUE(equalMats(src, expected)) << "in place code " << code << " type " << type << " " << size.width << "x" << size.height;
+            }
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
@@ -0,0 +1,73 @@
+#include "test_precomp.hxx"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "openHL/core/utility.hxx"
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+class CountInvoker: public ParallelLoopBody
+{
+public:
+    CountInvoker(std::vector<int>& _hits):
+        ParallelLoopBody(), hits(_hits)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        for (int i = range.start; i < range.end; i++)
+            hits[i]++;
+    }
+
+private:
+    std::vector<int>& hits;
+};
+
+TEST(Core_Parallel, everyIndexOnce)
+{
+    int nthreads = getNumThreads();
+    for (int n : {1, 2, 7, 1000})
+        for (double nstripes : {-1., 1., 3., 64.})
+        {
+            std::vector<int> hits(n, 0);
+            CountInvoker     body(hits);
+            parallel_for_(Range(0, n), body, nstripes);
+            for (int i = 0; i < n; i++)
+                ASSERT_EQ(1, hits[i]) << "n " << n << " nstripes " << nstripes;
+        }
+    setNumThreads(nthreads);
+}
+
+TEST(Core_Parallel, setNumThreadsWhileRunning)
+{
+    int               nthreads = getNumThreads();
+    std::atomic<bool> done(false);
+    std::thread       setter([&] {
+        for (int i = 0; !done; i++)
+            setNumThreads(i % 4);
+    });
+
+    for (int k = 0; k < 200; k++)
+    {
+        std::vector<int> hits(257, 0);
+        CountInvoker     body(hits);
+        parallel_for_(Range(0, (int)hits.size()), body, 16);
+        for (int h : hits)
+            ASSERT_EQ(1, h);
+    }
+
+    done = true;
+    setter.join();
+    setNumThreads(nthreads);
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
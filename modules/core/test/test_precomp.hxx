@@ -0,0 +1,37 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include "openHL/core.hxx"
+
+namespace hl
+{
+namespace test
+{
+
+//! fills m with deterministic pseudo-random bytes, the same for every run
+inline void randomFill(Mat& m, unsigned seed)
+{
+    for (int y = 0; y < m.rows; y++)
+    {
+        uchar* p = m.ptr(y);
+        for (size_t x = 0; x < m.cols * m.elemSize(); x++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            p[x] = (uchar)(seed >> 24);
+        }
+    }
+}
+
+//! true if a and b have the same size, type and contents
+inline bool equalMats(const Mat& a, const Mat& b)
+{
+    if (a.size() != b.size() || a.type() != b.type())
+        return false;
+    for (int y = 0; y < a.rows; y++)
+        if (memcmp(a.ptr(y), b.ptr(y), a.cols * a.elemSize()) != 0)
+            return false;
+    return true;
+}
+
+}    // namespace test
+}    // namespace hl
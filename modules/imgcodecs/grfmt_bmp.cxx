@@ -14,6 +14,8 @@ BmpDecoder::BmpDecoder()
     m_offset        = -1;
     m_buf_supported = true;
     m_origin        = ORIGIN_TL;
+    m_src_width     = 0;
+    m_src_height    = 0;
     m_bpp           = 0;
     m_rle_code      = BMP_RGB;
     initMask();
@@ -156,8 +158,10 @@ bool BmpDecoder::readHeader()
     }
     // in 32 bit case alpha channel is used - so require HL_8UC4 type
     m_type   = iscolor ? ((m_bpp == 32 && m_rle_code != BMP_RGB) ? HL_8UC4 : HL_8UC3) : HL_8UC1;
-    m_origin = m_height > 0 ? ORIGIN_BL : ORIGIN_TL;
-    m_height = std::abs(m_height);
+    m_origin     = m_height > 0 ? ORIGIN_BL : ORIGIN_TL;
+    m_height     = std::abs(m_height);
+    m_src_width  = m_width;
+    m_src_height = m_height;
 
     if (!result)
     {
@@ -165,29 +169,53 @@ bool BmpDecoder::readHeader()
         m_width = m_height = -1;
         m_strm.close();
     }
+    else if (m_scale_denom > 1 && m_rle_code != BMP_RLE4 && m_rle_code != BMP_RLE8)
+    {
+        // the rows are stored one after another, so readData averages them as they are read
+        m_width  = std::max(m_width / m_scale_denom, 1);
+        m_height = std::max(m_height / m_scale_denom, 1);
+    }
     return result;
 }
 
+int BmpDecoder::setScale(const int& scale_denom)
+{
+    int temp = BaseImageDecoder::setScale(scale_denom);
+
+    // the RLE images skip over rows and are decoded at full size, the caller resizes them
+    return m_rle_code == BMP_RLE4 || m_rle_code == BMP_RLE8 ? temp : 1;
+}
+
 bool BmpDecoder::readData(Mat& img)
 {
+    int    width             = m_src_width;
+    int    height            = m_src_height;
     uchar* data              = img.ptr();
     int    step              = validateToInt(img.step);
     bool   color             = img.channels() > 1;
     uchar  gray_palette[256] = {0};
     bool   result            = false;
-    int    src_pitch         = ((m_width * (m_bpp != 15 ? m_bpp : 16) + 7) / 8 + 3) & -4;
+    int    src_pitch         = ((width * (m_bpp != 15 ? m_bpp : 16) + 7) / 8 + 3) & -4;
     int    nch               = color ? 3 : 1;
-    int    y, width3 = m_width * nch;
+    int    y, width3 = width * nch;
 
     // FIXIT: use safe pointer arithmetic (avoid 'int'), use size_t, intptr_t, etc
-    HL_Assert(((uint64)m_height * m_width * nch < (HL_BIG_UINT(1) << 30)) && "BMP reader implementation doesn't support large images >= 1Gb");
+    HL_Assert(((uint64)height * width * nch < (HL_BIG_UINT(1) << 30)) && "BMP reader implementation doesn't support large images >= 1Gb");
 
     if (m_offset < 0 || !m_strm.isOpened())
         return false;
 
-    if (m_origin == ORIGIN_BL)
+    // a scaled image is decoded row by row into the decimator, which averages them into img
+    Ptr<RowDecimator> decimator;
+    if (img.size() != Size(width, height))
+    {
+        decimator = makePtr<RowDecimator>(img, width, height, m_scale_denom, m_origin == ORIGIN_BL);
+        data      = decimator->row();
+        step      = 0;
+    }
+    else if (m_origin == ORIGIN_BL)
     {
-        data += (m_height - 1) * (size_t)step;
+        data += (height - 1) * (size_t)step;
         step  = -step;
     }
 
@@ -200,7 +228,7 @@ bool BmpDecoder::readData(Mat& img)
         {
             CvtPaletteToGray(m_palette, gray_palette, 1 << m_bpp);
         }
-        _bgr.allocate(m_width * 3 + 32);
+        _bgr.allocate(width * 3 + 32);
     }
     uchar *src = _src.data(), *bgr = _bgr.data();
 
@@ -212,12 +240,14 @@ bool BmpDecoder::readData(Mat& img)
         {
             /************************* 1 BPP ************************/
             case 1 :
-                for (y = 0; y < m_height; y++, data += step)
+                for (y = 0; y < height; y++, data += step)
                 {
                     m_strm.getBytes(src, src_pitch);
-                    FillColorRow1(color ? data : bgr, src, m_width, m_palette);
+                    FillColorRow1(color ? data : bgr, src, width, m_palette);
                     if (!color)
-                        ihlCvt_BGR2Gray_8u_C3C1R(bgr, 0, data, 0, Size(m_width, 1));
+                        ihlCvt_BGR2Gray_8u_C3C1R(bgr, 0, data, 0, Size(width, 1));
+                    if (decimator)
+                        decimator->push();
                 }
                 result = true;
                 break;
@@ -226,13 +256,15 @@ bool BmpDecoder::readData(Mat& img)
             case 4 :
                 if (m_rle_code == BMP_RGB)
                 {
-                    for (y = 0; y < m_height; y++, data += step)
+                    for (y = 0; y < height; y++, data += step)
                     {
                         m_strm.getBytes(src, src_pitch);
                         if (color)
-                            FillColorRow4(data, src, m_width, m_palette);
+                            FillColorRow4(data, src, width, m_palette);
                         else
-                            FillGrayRow4(data, src, m_width, gray_palette);
+                            FillGrayRow4(data, src, width, gray_palette);
+                        if (decimator)
+                            decimator->push();
                     }
                     result = true;
                 }
@@ -291,11 +323,11 @@ bool BmpDecoder::readData(Mat& img)
                             }
 
                             if (color)
-                                data = FillUniColor(data, line_end, step, width3, y, m_height, x_shift3, m_palette[0]);
+                                data = FillUniColor(data, line_end, step, width3, y, height, x_shift3, m_palette[0]);
                             else
-                                data = FillUniGray(data, line_end, step, width3, y, m_height, x_shift3, gray_palette[0]);
+                                data = FillUniGray(data, line_end, step, width3, y, height, x_shift3, gray_palette[0]);
 
-                            if (y >= m_height)
+                            if (y >= height)
                                 break;
                         }
                     }
@@ -309,13 +341,15 @@ bool BmpDecoder::readData(Mat& img)
             case 8 :
                 if (m_rle_code == BMP_RGB)
                 {
-                    for (y = 0; y < m_height; y++, data += step)
+                    for (y = 0; y < height; y++, data += step)
                     {
                         m_strm.getBytes(src, src_pitch);
                         if (color)
-                            FillColorRow8(data, src, m_width, m_palette);
+                            FillColorRow8(data, src, width, m_palette);
                         else
-                            FillGrayRow8(data, src, m_width, gray_palette);
+                            FillGrayRow8(data, src, width, gray_palette);
+                        if (decimator)
+                            decimator->push();
                     }
                     result = true;
                 }
@@ -339,13 +373,13 @@ bool BmpDecoder::readData(Mat& img)
                                 goto decode_rle8_bad;
 
                             if (color)
-                                data = FillUniColor(data, line_end, step, width3, y, m_height, len, m_palette[code]);
+                                data = FillUniColor(data, line_end, step, width3, y, height, len, m_palette[code]);
                             else
-                                data = FillUniGray(data, line_end, step, width3, y, m_height, len, gray_palette[code]);
+                                data = FillUniGray(data, line_end, step, width3, y, height, len, gray_palette[code]);
 
                             line_end_flag = y - prev_y;
 
-                            if (y >= m_height)
+                            if (y >= height)
                                 break;
                         }
                         else if (code > 2)    // absolute mode
@@ -368,7 +402,7 @@ bool BmpDecoder::readData(Mat& img)
                         else
                         {
                             int x_shift3 = (int)(line_end - data);
-                            int y_shift  = m_height - y;
+                            int y_shift  = height - y;
 
                             if (code || !line_end_flag || x_shift3 < width3)
                             {
@@ -380,20 +414,20 @@ bool BmpDecoder::readData(Mat& img)
 
                                 x_shift3 += (y_shift * width3) & ((code == 0) - 1);
 
-                                if (y >= m_height)
+                                if (y >= height)
                                     break;
 
                                 if (color)
-                                    data = FillUniColor(data, line_end, step, width3, y, m_height, x_shift3, m_palette[0]);
+                                    data = FillUniColor(data, line_end, step, width3, y, height, x_shift3, m_palette[0]);
                                 else
-                                    data = FillUniGray(data, line_end, step, width3, y, m_height, x_shift3, gray_palette[0]);
+                                    data = FillUniGray(data, line_end, step, width3, y, height, x_shift3, gray_palette[0]);
 
-                                if (y >= m_height)
+                                if (y >= height)
                                     break;
                             }
 
                             line_end_flag = 0;
-                            if (y >= m_height)
+                            if (y >= height)
                                 break;
                         }
                     }
@@ -404,37 +438,43 @@ bool BmpDecoder::readData(Mat& img)
                 break;
             /************************* 15 BPP ************************/
             case 15 :
-                for (y = 0; y < m_height; y++, data += step)
+                for (y = 0; y < height; y++, data += step)
                 {
                     m_strm.getBytes(src, src_pitch);
                     if (!color)
-                        ihlCvt_BGR5552Gray_8u_C2C1R(src, 0, data, 0, Size(m_width, 1));
+                        ihlCvt_BGR5552Gray_8u_C2C1R(src, 0, data, 0, Size(width, 1));
                     else
-                        ihlCvt_BGR5552BGR_8u_C2C3R(src, 0, data, 0, Size(m_width, 1));
+                        ihlCvt_BGR5552BGR_8u_C2C3R(src, 0, data, 0, Size(width, 1));
+                    if (decimator)
+                        decimator->push();
                 }
                 result = true;
                 break;
             /************************* 16 BPP ************************/
             case 16 :
-                for (y = 0; y < m_height; y++, data += step)
+                for (y = 0; y < height; y++, data += step)
                 {
                     m_strm.getBytes(src, src_pitch);
                     if (!color)
-                        ihlCvt_BGR5652Gray_8u_C2C1R(src, 0, data, 0, Size(m_width, 1));
+                        ihlCvt_BGR5652Gray_8u_C2C1R(src, 0, data, 0, Size(width, 1));
                     else
-                        ihlCvt_BGR5652BGR_8u_C2C3R(src, 0, data, 0, Size(m_width, 1));
+                        ihlCvt_BGR5652BGR_8u_C2C3R(src, 0, data, 0, Size(width, 1));
+                    if (decimator)
+                        decimator->push();
                 }
                 result = true;
                 break;
             /************************* 24 BPP ************************/
             case 24 :
-                for (y = 0; y < m_height; y++, data += step)
+                for (y = 0; y < height; y++, data += step)
                 {
                     m_strm.getBytes(src, src_pitch);
                     if (!color)
-                        ihlCvt_BGR2Gray_8u_C3C1R(src, 0, data, 0, Size(m_width, 1));
+                        ihlCvt_BGR2Gray_8u_C3C1R(src, 0, data, 0, Size(width, 1));
                     else
-                        memcpy(data, src, m_width * 3);
+                        memcpy(data, src, width * 3);
+                    if (decimator)
+                        decimator->push();
                 }
                 result = true;
                 break;
@@ -442,31 +482,33 @@ bool BmpDecoder::readData(Mat& img)
             case 32 :
             {
                 bool has_bit_mask = (m_rgba_bit_offset[0] >= 0) && (m_rgba_bit_offset[1] >= 0) && (m_rgba_bit_offset[2] >= 0);
-                for (y = 0; y < m_height; y++, data += step)
+                for (y = 0; y < height; y++, data += step)
                 {
                     m_strm.getBytes(src, src_pitch);
 
                     if (!color)
                     {
                         if (has_bit_mask)
-                            maskBGRAtoGray(data, src, m_width);
+                            maskBGRAtoGray(data, src, width);
                         else
-                            ihlCvt_BGRA2Gray_8u_C4C1R(src, 0, data, 0, Size(m_width, 1));
+                            ihlCvt_BGRA2Gray_8u_C4C1R(src, 0, data, 0, Size(width, 1));
                     }
                     else if (img.channels() == 3)
                     {
                         if (has_bit_mask)
-                            maskBGRA(data, src, m_width, false);
+                            maskBGRA(data, src, width, false);
                         else
-                            ihlCvt_BGRA2BGR_8u_C4C3R(src, 0, data, 0, Size(m_width, 1));
+                            ihlCvt_BGRA2BGR_8u_C4C3R(src, 0, data, 0, Size(width, 1));
                     }
                     else if (img.channels() == 4)
                     {
                         if (has_bit_mask)
-                            maskBGRA(data, src, m_width, true);
+                            maskBGRA(data, src, width, true);
                         else
-                            memcpy(data, src, m_width * 4);
+                            memcpy(data, src, width * 4);
                     }
+                    if (decimator)
+                        decimator->push();
                 }
             }
                 result = true;
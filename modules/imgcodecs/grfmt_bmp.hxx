@@ -22,6 +22,7 @@ public:
 
     bool readData(Mat& img) override;
     bool readHeader() override;
+    int  setScale(const int& scale_denom) override;
     void close();
 
     ImageDecoder newDecoder() const override;
@@ -40,6 +41,8 @@ protected:
     RLByteStream   m_strm;
     PaletteEntry   m_palette[256];
     Origin         m_origin;
+    int            m_src_width;     // the size in the file, m_width and m_height are divided by the scale
+    int            m_src_height;    // when readData applies it
     int            m_bpp;
     int            m_offset;
     BmpCompression m_rle_code;
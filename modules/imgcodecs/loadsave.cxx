@@ -194,6 +194,7 @@ static bool imread_(const String& filename, int flags, Mat& mat)
         return false;
     }
 
+    // the decoders that average the rows as they read them return 1, the others leave the scale to us
     if (decoder->setScale(scale_denom) > 1)
     {
         resize(mat, mat, Size(size.width / scale_denom, size.height / scale_denom), 0, 0, INTER_LINEAR_EXACT);
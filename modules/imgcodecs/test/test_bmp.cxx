@@ -0,0 +1,192 @@
+#include "test_precomp.hxx"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+//! the pseudo-random byte sequence of randomFill
+struct ByteSequence
+{
+    unsigned seed;
+    uchar    next() { return (uchar)((seed = seed * 1664525u + 1013904223u) >> 24); }
+};
+
+void putWord(std::vector<uchar>& buf, int v)
+{
+    buf.push_back((uchar)v);
+    buf.push_back((uchar)(v >> 8));
+}
+
+void putDWord(std::vector<uchar>& buf, int v)
+{
+    putWord(buf, v);
+    putWord(buf, v >> 16);
+}
+
+//! a BITMAPINFOHEADER file of random pixels, top-down for a negative height; RLE8 files are made of runs
+//! of up to 8 pixels of one color, so that they compress to something the decoder walks through run by run
+std::vector<uchar> makeBmp(int width, int height, int bpp, bool rle, unsigned seed)
+{
+    ByteSequence       rnd    = {seed};
+    int                rows   = std::abs(height);
+    int                colors = bpp <= 8 ? 1 << bpp : 0;
+    int                pitch  = ((width * bpp + 7) / 8 + 3) & -4;
+    std::vector<uchar> bits;
+
+    if (rle)
+    {
+        for (int y = 0; y < rows; y++)
+        {
+            for (int x = 0; x < width;)
+            {
+                int len = std::min(rnd.next() % 8 + 1, width - x);
+                bits.push_back((uchar)len);
+                bits.push_back(rnd.next());
+                x += len;
+            }
+            putWord(bits, y + 1 < rows ? 0 : 0x100);    // end of line, end of bitmap
+        }
+    }
+    else
+    {
+        for (int i = 0; i < rows * pitch; i++)
+            bits.push_back(rnd.next());
+    }
+
+    std::vector<uchar> buf = {'B', 'M'};
+    int                offset = 14 + 40 + colors * 4;
+    putDWord(buf, offset + (int)bits.size());
+    putDWord(buf, 0);
+    putDWord(buf, offset);
+    putDWord(buf, 40);
+    putDWord(buf, width);
+    putDWord(buf, height);
+    putWord(buf, 1);
+    putWord(buf, bpp);
+    putDWord(buf, rle ? 1 : 0);
+    putDWord(buf, (int)bits.size());
+    putDWord(buf, 2835);
+    putDWord(buf, 2835);
+    putDWord(buf, colors);
+    putDWord(buf, 0);
+    for (int i = 0; i < colors * 4; i++)
+        buf.push_back((i & 3) == 3 ? 0 : rnd.next());
+    buf.insert(buf.end(), bits.begin(), bits.end());
+    return buf;
+}
+
+//! the mean of each scale x scale block of src, rounded half up; the rows and columns past the last
+//! whole block are dropped, and an image smaller than the scale is averaged into one pixel
+Mat boxAverage(const Mat& src, int scale)
+{
+    int bw = std::min(scale, src.cols), bh = std::min(scale, src.rows), cn = src.channels();
+    Mat dst(std::max(src.rows / scale, 1), std::max(src.cols / scale, 1), src.type());
+
+    for (int y = 0; y < dst.rows; y++)
+        for (int x = 0; x < dst.cols; x++)
+            for (int c = 0; c < cn; c++)
+            {
+                int s = 0;
+                for (int i = 0; i < bh; i++)
+                    for (int j = 0; j < bw; j++)
+                        s += src.ptr(y * bh + i)[(x * bw + j) * cn + c];
+                dst.ptr(y)[x * cn + c] = (uchar)((s + bw * bh / 2) / (bw * bh));
+            }
+    return dst;
+}
+
+struct BmpFile
+{
+    std::string path;
+
+    explicit BmpFile(const std::vector<uchar>& data):
+        path((std::filesystem::temp_directory_path() / ("openHL_test_" + std::to_string(counter++) + ".bmp")).string())
+    {
+        std::ofstream(path, std::ios::binary).write((const char*)data.data(), (std::streamsize)data.size());
+    }
+
+    ~BmpFile() { std::remove(path.c_str()); }
+
+    static inline int counter = 0;
+};
+
+const int reducedFlags[][3] = {
+    {IMREAD_REDUCED_GRAYSCALE_2, IMREAD_GRAYSCALE, 2},
+    {IMREAD_REDUCED_COLOR_2,     IMREAD_COLOR,     2},
+    {IMREAD_REDUCED_GRAYSCALE_4, IMREAD_GRAYSCALE, 4},
+    {IMREAD_REDUCED_COLOR_4,     IMREAD_COLOR,     4},
+    {IMREAD_REDUCED_GRAYSCALE_8, IMREAD_GRAYSCALE, 8},
+    {IMREAD_REDUCED_COLOR_8,     IMREAD_COLOR,     8},
+};
+
+TEST(Imgcodecs_Bmp, reducedMatchesBoxAverageOfFullDecode)
+{
+    const int bpps[]     = {1, 8, 24, 32};
+    const int sizes[][2] = {
+        {64, 48},
+        {37, 29},
+        {21, 67},
+        {5,  3 },
+        {1,  9 },
+    };
+
+    unsigned seed = 1;
+    for (int bpp : bpps)
+        for (auto size : sizes)
+            for (int topDown = 0; topDown < 2; topDown++)
+            {
+                BmpFile file(makeBmp(size[0], topDown ? -size[1] : size[1], bpp, false, seed++));
+                for (auto flags : reducedFlags)
+                {
+                    SCOPED_TRACE(testing::Message() << bpp << " bpp " << size[0] << "x" << size[1] << (topDown ? " top-down" : " bottom-up") << " scale " << flags[2] << " flags " << flags[0]);
+                    Mat full    = imread(file.path, flags[1]);
+                    Mat reduced = imread(file.path, flags[0]);
+                    ASSERT_FALSE(full.empty());
+                    ASSERT_EQ(full.size(), Size(size[0], size[1]));
+                    EXPECT_TRUE(equalMats(reduced, boxAverage(full, flags[2])));
+                }
+            }
+}
+
+// RLE images skip over rows, so they are decoded at full size and resized the way imread always did
+TEST(Imgcodecs_Bmp, reducedRleMatchesResizeOfFullDecode)
+{
+    const int sizes[][2] = {
+        {64, 48},
+        {37, 29},
+        {21, 67},
+    };
+
+    unsigned seed = 1;
+    for (auto size : sizes)
+        for (int topDown = 0; topDown < 2; topDown++)
+        {
+            BmpFile file(makeBmp(size[0], topDown ? -size[1] : size[1], 8, true, seed++));
+            for (auto flags : reducedFlags)
+            {
+                SCOPED_TRACE(testing::Message() << size[0] << "x" << size[1] << (topDown ? " top-down" : " bottom-up") << " scale " << flags[2] << " flags " << flags[0]);
+                Mat full    = imread(file.path, flags[1]);
+                Mat reduced = imread(file.path, flags[0]);
+                ASSERT_FALSE(full.empty());
+                ASSERT_EQ(full.size(), Size(size[0], size[1]));
+
+                Mat expected;
+                resize(full, expected, Size(size[0] / flags[2], size[1] / flags[2]), 0, 0, INTER_LINEAR_EXACT);
+                EXPECT_TRUE(equalMats(reduced, expected));
+            }
+        }
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "../../core/test/test_precomp.hxx"
+#include "openHL/imgcodecs.hxx"
+#include "openHL/imgproc.hxx"
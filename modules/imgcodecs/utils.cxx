@@ -348,4 +348,50 @@ uchar* FillGrayRow1(uchar* data, uchar* indices, int len, uchar* palette)
     return data;
 }
 
+RowDecimator::RowDecimator(const Mat& img, int width, int height, int scale, bool bottomUp):
+    m_img(img), m_width(width), m_height(height), m_bottomUp(bottomUp), m_blockWidth(std::min(scale, width)), m_blockHeight(std::min(scale, height)), m_y(0), m_count(0)
+{
+    HL_Assert(img.depth() == HL_8U && img.cols * m_blockWidth <= width && img.rows * m_blockHeight <= height);
+
+    int len = img.cols * m_blockWidth * img.channels();
+    m_row.allocate(width * img.channels() + 32);
+    m_sum.allocate(len);
+    memset(m_sum.data(), 0, len * sizeof(int));
+}
+
+void RowDecimator::push()
+{
+    // the rows and columns past the last whole block are dropped
+    int y = m_bottomUp ? m_height - 1 - m_y : m_y;
+    m_y++;
+    if (y >= m_img.rows * m_blockHeight)
+        return;
+
+    // the rows of a block are summed at full width, and the columns once the block is complete
+    int          cn  = m_img.channels();
+    int          len = m_img.cols * m_blockWidth * cn;
+    const uchar* src = m_row.data();
+    int*         sum = m_sum.data();
+    for (int i = 0; i < len; i++)
+        sum[i] += src[i];
+
+    if (++m_count == m_blockHeight)
+    {
+        int    area = m_blockWidth * m_blockHeight;
+        uchar* dst  = m_img.ptr(y / m_blockHeight);
+        for (int x = 0; x < m_img.cols * cn; x += cn, sum += m_blockWidth * cn)
+        {
+            for (int c = 0; c < cn; c++)
+            {
+                int s = 0;
+                for (int k = c; k < m_blockWidth * cn; k += cn)
+                    s += sum[k];
+                dst[x + c] = (uchar)((s + area / 2) / area);
+            }
+        }
+        memset(m_sum.data(), 0, len * sizeof(int));
+        m_count = 0;
+    }
+}
+
 }    // namespace hl
\ No newline at end of file
@@ -40,4 +40,31 @@ uchar* FillGrayRow4(uchar* data, uchar* indices, int len, uchar* palette);
 uchar* FillColorRow1(uchar* data, uchar* indices, int len, PaletteEntry* palette);
 uchar* FillGrayRow1(uchar* data, uchar* indices, int len, uchar* palette);
 
+// Box-averages the rows of a width x height image into img, scale x scale pixels per pixel of img,
+// as they come out of the decoder. Only a decoded row and its sums over a block of rows are kept.
+class RowDecimator
+{
+public:
+    RowDecimator(const Mat& img, int width, int height, int scale, bool bottomUp);
+
+    // the buffer the next row is decoded into, width * img.channels() bytes
+    uchar* row() { return m_row.data(); }
+
+    // adds the row decoded into row(), the rows come in file order
+    void push();
+
+private:
+    Mat  m_img;
+    int  m_width;
+    int  m_height;
+    bool m_bottomUp;
+    int  m_blockWidth;
+    int  m_blockHeight;
+    int  m_y;
+    int  m_count;
+
+    AutoBuffer<uchar> m_row;
+    AutoBuffer<int>   m_sum;
+};
+
 }    // namespace hl
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "precomp.hxx"
+#include <vector>
+#include "bilateral_filter.simd.hxx"
+
+/****************************************************************************************\
+                                   Bilateral Filtering
+\****************************************************************************************/
+
+namespace hl
+{
+
+/*
+ * Returns the weight as a float. The weights below sqrt(FLT_MIN) are flushed to zero, so that
+ * the product of the space and the color weights is never a denormal, which would slow the
+ * inner loops down by an order of magnitude; they are far below the float precision of the
+ * sums anyway.
+ */
+static inline float bilateralWeight(double w)
+{
+    return w < std::sqrt((double)FLT_MIN) ? 0.f : (float)w;
+}
+
+static void bilateralFilter_8u(const Mat& src, Mat& dst, int d, double sigma_color, double sigma_space, int borderType)
+{
+    int cn = src.channels();
+    int i, j, maxk, radius;
+
+    HL_Assert((src.type() == HL_8UC1 || src.type() == HL_8UC3) && src.data != dst.data);
+
+    if (sigma_color <= 0)
+        sigma_color = 1;
+    if (sigma_space <= 0)
+        sigma_space = 1;
+
+    double gauss_color_coeff = -0.5 / (sigma_color * sigma_color);
+    double gauss_space_coeff = -0.5 / (sigma_space * sigma_space);
+
+    if (d <= 0)
+        radius = hlRound(sigma_space * 1.5);
+    else
+        radius = d / 2;
+    radius = MAX(radius, 1);
+    d      = radius * 2 + 1;
+
+    // the border is read virtually, row by row
+    BorderRowAccessor acc(src, borderType, radius, radius);
+
+    std::vector<float> _color_weight(cn * 256);
+    std::vector<float> _space_weight(d * d);
+    std::vector<int>   _space_row(d * d);
+    std::vector<int>   _space_ofs(d * d);
+    float*             color_weight = &_color_weight[0];
+    float*             space_weight = &_space_weight[0];
+    int*               space_row    = &_space_row[0];
+    int*               space_ofs    = &_space_ofs[0];
+
+    // initialize color-related bilateral filter coefficients
+    for (i = 0; i < 256 * cn; i++)
+        color_weight[i] = bilateralWeight(std::exp(i * i * gauss_color_coeff));
+
+    // initialize space-related bilateral filter coefficients
+    for (i = -radius, maxk = 0; i <= radius; i++)
+    {
+        for (j = -radius; j <= radius; j++)
+        {
+            double r = std::sqrt((double)i * i + (double)j * j);
+            if (r > radius)
+                continue;
+            space_weight[maxk] = bilateralWeight(std::exp(r * r * gauss_space_coeff));
+            space_row[maxk]    = i + radius;
+            space_ofs[maxk++]  = j * cn;
+        }
+    }
+
+    cpu_baseline::bilateralFilterInvoker_8u(acc, dst, cn, radius, maxk, space_row, space_ofs, space_weight, color_weight);
+}
+
+static void bilateralFilter_32f(const Mat& src, Mat& dst, int d, double sigma_color, double sigma_space, int borderType)
+{
+    int cn = src.channels();
+    int i, maxk, radius;
+
+    HL_Assert((src.type() == HL_32FC1 || src.type() == HL_32FC3) && src.data != dst.data);
+
+    if (sigma_color <= 0)
+        sigma_color = 1;
+    if (sigma_space <= 0)
+        sigma_space = 1;
+
+    double gauss_color_coeff = -0.5 / (sigma_color * sigma_color);
+    double gauss_space_coeff = -0.5 / (sigma_space * sigma_space);
+
+    if (d <= 0)
+        radius = hlRound(sigma_space * 1.5);
+    else
+        radius = d / 2;
+    radius = MAX(radius, 1);
+    d      = radius * 2 + 1;
+    // compute the min/max range for the input image (even if multichannel)
+
+    double minValSrc = -1, maxValSrc = 1;
+    minMaxIdx(src.reshape(1), &minValSrc, &maxValSrc);
+    if ((borderType & ~BORDER_ISOLATED) == BORDER_CONSTANT)
+    {
+        // the constant border is 0
+        minValSrc = std::min(minValSrc, 0.);
+        maxValSrc = std::max(maxValSrc, 0.);
+    }
+    if (std::abs(minValSrc - maxValSrc) < FLT_EPSILON)
+    {
+        src.copyTo(dst);
+        return;
+    }
+
+    // the border is read virtually, row by row
+    BorderRowAccessor acc(src, borderType, radius, radius);
+
+    // allocate lookup tables
+    const int kExpNumBinsPerChannel = 1 << 12;
+    const int kExpNumBins           = kExpNumBinsPerChannel * cn;
+    std::vector<float> _expLUT(kExpNumBins + 2);
+    float*             expLUT = &_expLUT[0];
+
+    // the lookup table is built for the whole range of the L1 color distance, the larger
+    // distances to the values of the parent of a ROI are clamped to its last entry by the invoker
+    float scale_index = kExpNumBins / (float)((maxValSrc - minValSrc) * cn);
+    float lastExpVal  = 1.f;
+    for (i = 0; i < kExpNumBins + 2; i++)
+    {
+        if (lastExpVal > 0.f)
+        {
+            double val = i / scale_index;
+            expLUT[i]  = bilateralWeight(std::exp(val * val * gauss_color_coeff));
+            lastExpVal = expLUT[i];
+        }
+        else
+            expLUT[i] = 0.f;
+    }
+
+    // initialize space-related bilateral filter coefficients
+    std::vector<float> _space_weight(d * d);
+    std::vector<int>   _space_row(d * d);
+    std::vector<int>   _space_ofs(d * d);
+    float*             space_weight = &_space_weight[0];
+    int*               space_row    = &_space_row[0];
+    int*               space_ofs    = &_space_ofs[0];
+
+    for (i = -radius, maxk = 0; i <= radius; i++)
+    {
+        for (int j = -radius; j <= radius; j++)
+        {
+            double r = std::sqrt((double)i * i + (double)j * j);
+            if (r > radius)
+                continue;
+            space_weight[maxk] = bilateralWeight(std::exp(r * r * gauss_space_coeff));
+            space_row[maxk]    = i + radius;
+            space_ofs[maxk++]  = j * cn;
+        }
+    }
+
+    cpu_baseline::bilateralFilterInvoker_32f(acc, dst, cn, radius, maxk, space_row, space_ofs, space_weight, expLUT, scale_index, (float)kExpNumBins);
+}
+
+void bilateralFilter(const Mat& _src, Mat& _dst, int d, double sigmaColor, double sigmaSpace, int borderType, int mode)
+{
+    HL_Assert(!_src.empty());
+    HL_Assert(mode == BILATERAL_EXACT || mode == BILATERAL_GRID);
+
+    Mat src = _src;
+    if (src.data == _dst.data)
+    {
+        src = Mat(_src.size(), _src.type());
+        _src.copyTo(src);
+    }
+    _dst.create(src.size(), src.type());
+    Mat dst = _dst;
+
+    if (src.depth() != HL_8U && src.depth() != HL_32F)
+        HL_Error(HL_StsUnsupportedFormat, "Bilateral filtering is only implemented for 8u and 32f images");
+    if (src.channels() != 1 && src.channels() != 3)
+        HL_Error(HL_StsUnsupportedFormat, "Bilateral filtering is only implemented for 1- and 3-channel images");
+
+    // the grid reaches 2 * sigmaSpace pixels around every pixel whatever d is, and is only
+    // used when it is smaller than the image; otherwise the exact filter runs
+    if (mode == BILATERAL_GRID && sigmaColor > 0 && sigmaSpace > 0 && cpu_baseline::bilateralGrid(src, dst, sigmaColor, sigmaSpace, borderType))
+        return;
+
+    if (src.depth() == HL_8U)
+        bilateralFilter_8u(src, dst, d, sigmaColor, sigmaSpace, borderType);
+    else
+        bilateralFilter_32f(src, dst, d, sigmaColor, sigmaSpace, borderType);
+}
+
+}    // namespace hl
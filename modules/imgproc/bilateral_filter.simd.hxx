@@ -0,0 +1,665 @@
+#include "precomp.hxx"
+#include <vector>
+#include "openHL/core/hal/intrin.hxx"
+
+namespace hl
+{
+namespace cpu_baseline
+{
+
+// forward declarations
+void bilateralFilterInvoker_8u(const BorderRowAccessor& src, Mat& dst, int cn, int radius, int maxk, const int* space_row, const int* space_ofs, const float* space_weight, const float* color_weight);
+void bilateralFilterInvoker_32f(const BorderRowAccessor& src, Mat& dst, int cn, int radius, int maxk, const int* space_row, const int* space_ofs, const float* space_weight, const float* expLUT, float scale_index, float max_alpha);
+bool bilateralGrid(const Mat& src, Mat& dst, double sigmaColor, double sigmaSpace, int borderType);
+
+/****************************************************************************************\
+                                   Bilateral Filtering
+\****************************************************************************************/
+
+namespace
+{
+
+#if HL_SIMD128
+//! the offsets of the first channel of 4 consecutive 3-channel pixels
+const static int pixelOfs3[] = {0, 3, 6, 9};
+
+template <typename _Tpvec>
+inline _Tpvec absDiff(const _Tpvec& a, const _Tpvec& b)
+{
+    _Tpvec d = v_sub_wrap(a, b);
+    return v_max(d, v_sub_wrap(b, a));
+}
+#endif
+
+/*
+ * The 2 * radius + 1 rows around the current row, each extended by radius border elements on
+ * both sides. The rows are kept in a ring indexed by the row number, so that moving the window
+ * down by one row assembles only the new bottom row instead of a padded copy of the image.
+ */
+class BilateralWindow
+{
+public:
+    BilateralWindow(const BorderRowAccessor& _src, int _radius):
+        src(_src), radius(_radius), d(_radius * 2 + 1), rowSize((_src.size.width + _radius * 2) * _src.elemSize), top(0), bottom(-1), buf((size_t)d * rowSize), rows(d)
+    {
+    }
+
+    //! moves the window to the row y and returns the pointers to the column 0 of its rows
+    const uchar* const* moveTo(int y)
+    {
+        for (int t = 0; t < d; t++)
+        {
+            int    sy   = y - radius + t;
+            uchar* slot = buf.data() + (size_t)((sy % d + d) % d) * rowSize;
+            if (sy < top || sy > bottom)
+                src.extendRow(sy, slot);
+            rows[t] = slot + radius * src.elemSize;
+        }
+        top    = y - radius;
+        bottom = y + radius;
+        return rows.data();
+    }
+
+private:
+    const BorderRowAccessor& src;
+    int                      radius;
+    int                      d;
+    int                      rowSize;
+    int                      top;
+    int                      bottom;
+    AutoBuffer<uchar>        buf;
+    AutoBuffer<const uchar*> rows;
+};
+
+/*
+ * The exact filter. Every row is accumulated kernel point by kernel point into the per-row
+ * sums, so that the inner loops run over contiguous pixels; only the range weight lookup
+ * is a gather. The inner loops process 4 pixels per register, the channels of the 3-channel
+ * pixels are gathered into planes, and the scalar tail does the same float operations.
+ */
+class BilateralFilter_8u_Invoker: public ParallelLoopBody
+{
+public:
+    BilateralFilter_8u_Invoker(Mat& _dest, const BorderRowAccessor& _src, int _radius, int _maxk, const int* _space_row, const int* _space_ofs, const float* _space_weight, const float* _color_weight):
+        ParallelLoopBody(), src(&_src), dest(&_dest), radius(_radius), maxk(_maxk), space_row(_space_row), space_ofs(_space_ofs), space_weight(_space_weight), color_weight(_color_weight)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        int i, j, k, cn = dest->channels(), width = dest->cols;
+
+        AutoBuffer<float> buf(width * (cn + 1));
+        float*            wsum = buf.data();
+        float*            sum  = wsum + width;
+        BilateralWindow   window(*src, radius);
+
+        for (i = range.start; i < range.end; i++)
+        {
+            const uchar* const* rows = window.moveTo(i);
+            const uchar*        sptr = rows[radius];
+            uchar*              dptr = dest->ptr(i);
+
+            memset(buf.data(), 0, width * (cn + 1) * sizeof(float));
+
+            if (cn == 1)
+            {
+                for (k = 0; k < maxk; k++)
+                {
+                    const uchar* ksptr = rows[space_row[k]] + space_ofs[k];
+                    float        w     = space_weight[k];
+                    j                  = 0;
+#if HL_SIMD128
+                    const v_float32x4 vw = v_setall_f32(w);
+                    for (; j <= width - v_float32x4::nlanes; j += v_float32x4::nlanes)
+                    {
+                        v_int32x4 val = v_load_convert<int>(ksptr + j);
+                        v_int32x4 ad  = absDiff(val, v_load_convert<int>(sptr + j));
+                        int       idx[4];
+                        v_store(idx, ad);
+                        v_float32x4 ww = v_mul_wrap(vw, v_lut(color_weight, idx));
+                        v_store(sum + j, v_add_wrap(v_load(sum + j), v_mul_wrap(v_convert<float>(val), ww)));
+                        v_store(wsum + j, v_add_wrap(v_load(wsum + j), ww));
+                    }
+#endif
+                    for (; j < width; j++)
+                    {
+                        int   val  = ksptr[j];
+                        float ww   = w * color_weight[std::abs(val - sptr[j])];
+                        sum[j]    += val * ww;
+                        wsum[j]   += ww;
+                    }
+                }
+                for (j = 0; j < width; j++)
+                    dptr[j] = (uchar)hlRound(sum[j] / wsum[j]);
+            }
+            else
+            {
+                HL_Assert(cn == 3);
+                float* sum_g = sum + width;
+                float* sum_r = sum_g + width;
+                for (k = 0; k < maxk; k++)
+                {
+                    const uchar* ksptr = rows[space_row[k]] + space_ofs[k];
+                    float        w     = space_weight[k];
+                    j                  = 0;
+#if HL_SIMD128
+                    const v_float32x4 vw = v_setall_f32(w);
+                    for (; j <= width - v_float32x4::nlanes; j += v_float32x4::nlanes)
+                    {
+                        const uchar* p0 = sptr + j * 3;
+                        const uchar* p  = ksptr + j * 3;
+                        v_int32x4    b  = v_lut_convert<int>(p, pixelOfs3), g = v_lut_convert<int>(p + 1, pixelOfs3), r = v_lut_convert<int>(p + 2, pixelOfs3);
+                        v_int32x4    ad = v_add_wrap(v_add_wrap(absDiff(b, v_lut_convert<int>(p0, pixelOfs3)), absDiff(g, v_lut_convert<int>(p0 + 1, pixelOfs3))), absDiff(r, v_lut_convert<int>(p0 + 2, pixelOfs3)));
+                        int          idx[4];
+                        v_store(idx, ad);
+                        v_float32x4 ww = v_mul_wrap(vw, v_lut(color_weight, idx));
+                        v_store(sum + j, v_add_wrap(v_load(sum + j), v_mul_wrap(v_convert<float>(b), ww)));
+                        v_store(sum_g + j, v_add_wrap(v_load(sum_g + j), v_mul_wrap(v_convert<float>(g), ww)));
+                        v_store(sum_r + j, v_add_wrap(v_load(sum_r + j), v_mul_wrap(v_convert<float>(r), ww)));
+                        v_store(wsum + j, v_add_wrap(v_load(wsum + j), ww));
+                    }
+#endif
+                    for (; j < width; j++)
+                    {
+                        const uchar* p0  = sptr + j * 3;
+                        const uchar* p   = ksptr + j * 3;
+                        int          b   = p[0], g = p[1], r = p[2];
+                        float        ww  = w * color_weight[std::abs(b - p0[0]) + std::abs(g - p0[1]) + std::abs(r - p0[2])];
+                        sum[j]          += b * ww;
+                        sum_g[j]        += g * ww;
+                        sum_r[j]        += r * ww;
+                        wsum[j]         += ww;
+                    }
+                }
+                for (j = 0; j < width; j++)
+                {
+                    float iw        = 1.f / wsum[j];
+                    dptr[j * 3]     = (uchar)hlRound(sum[j] * iw);
+                    dptr[j * 3 + 1] = (uchar)hlRound(sum_g[j] * iw);
+                    dptr[j * 3 + 2] = (uchar)hlRound(sum_r[j] * iw);
+                }
+            }
+        }
+    }
+
+private:
+    const BorderRowAccessor* src;
+    Mat*                     dest;
+    int                      radius;
+    int                      maxk;
+    const int*               space_row;
+    const int*               space_ofs;
+    const float*             space_weight;
+    const float*             color_weight;
+
+    BilateralFilter_8u_Invoker(const BilateralFilter_8u_Invoker&);                     // = delete;
+    const BilateralFilter_8u_Invoker& operator=(const BilateralFilter_8u_Invoker&);    // = delete;
+};
+
+class BilateralFilter_32f_Invoker: public ParallelLoopBody
+{
+public:
+    BilateralFilter_32f_Invoker(int _cn, int _radius, int _maxk, const int* _space_row, const int* _space_ofs, const BorderRowAccessor& _src, Mat& _dest, float _scale_index, float _max_alpha, const float* _space_weight, const float* _expLUT):
+        ParallelLoopBody(), cn(_cn), radius(_radius), maxk(_maxk), space_row(_space_row), space_ofs(_space_ofs), src(&_src), dest(&_dest), scale_index(_scale_index), max_alpha(_max_alpha), space_weight(_space_weight), expLUT(_expLUT)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        int i, j, k, width = dest->cols;
+
+        AutoBuffer<float> buf(width * (cn + 1));
+        float*            wsum = buf.data();
+        float*            sum  = wsum + width;
+        BilateralWindow   window(*src, radius);
+
+        for (i = range.start; i < range.end; i++)
+        {
+            const uchar* const* rows = window.moveTo(i);
+            const float*        sptr = (const float*)rows[radius];
+            float*              dptr = dest->ptr<float>(i);
+
+            memset(buf.data(), 0, width * (cn + 1) * sizeof(float));
+
+            if (cn == 1)
+            {
+                for (k = 0; k < maxk; k++)
+                {
+                    const float* ksptr = (const float*)rows[space_row[k]] + space_ofs[k];
+                    float        w     = space_weight[k];
+                    j                  = 0;
+#if HL_SIMD128
+                    const v_float32x4 vw = v_setall_f32(w), vscale = v_setall_f32(scale_index);
+                    for (; j <= width - v_float32x4::nlanes; j += v_float32x4::nlanes)
+                    {
+                        v_float32x4 val = v_load(ksptr + j);
+                        v_float32x4 ww  = v_mul_wrap(vw, lutWeight(v_mul_wrap(absDiff(val, v_load(sptr + j)), vscale)));
+                        v_store(sum + j, v_add_wrap(v_load(sum + j), v_mul_wrap(val, ww)));
+                        v_store(wsum + j, v_add_wrap(v_load(wsum + j), ww));
+                    }
+#endif
+                    for (; j < width; j++)
+                    {
+                        float val    = ksptr[j];
+                        float alpha  = clampAlpha(std::abs(val - sptr[j]) * scale_index);
+                        int   idx    = (int)alpha;
+                        alpha       -= idx;
+                        float ww     = w * (expLUT[idx] + alpha * (expLUT[idx + 1] - expLUT[idx]));
+                        sum[j]      += val * ww;
+                        wsum[j]     += ww;
+                    }
+                }
+                for (j = 0; j < width; j++)
+                    dptr[j] = sum[j] / wsum[j];
+            }
+            else
+            {
+                HL_Assert(cn == 3);
+                float* sum_g = sum + width;
+                float* sum_r = sum_g + width;
+                for (k = 0; k < maxk; k++)
+                {
+                    const float* ksptr = (const float*)rows[space_row[k]] + space_ofs[k];
+                    float        w     = space_weight[k];
+                    j                  = 0;
+#if HL_SIMD128
+                    const v_float32x4 vw = v_setall_f32(w), vscale = v_setall_f32(scale_index);
+                    for (; j <= width - v_float32x4::nlanes; j += v_float32x4::nlanes)
+                    {
+                        const float* p0 = sptr + j * 3;
+                        const float* p  = ksptr + j * 3;
+                        v_float32x4  b  = v_lut(p, pixelOfs3), g = v_lut(p + 1, pixelOfs3), r = v_lut(p + 2, pixelOfs3);
+                        v_float32x4  ad = v_add_wrap(v_add_wrap(absDiff(b, v_lut(p0, pixelOfs3)), absDiff(g, v_lut(p0 + 1, pixelOfs3))), absDiff(r, v_lut(p0 + 2, pixelOfs3)));
+                        v_float32x4  ww = v_mul_wrap(vw, lutWeight(v_mul_wrap(ad, vscale)));
+                        v_store(sum + j, v_add_wrap(v_load(sum + j), v_mul_wrap(b, ww)));
+                        v_store(sum_g + j, v_add_wrap(v_load(sum_g + j), v_mul_wrap(g, ww)));
+                        v_store(sum_r + j, v_add_wrap(v_load(sum_r + j), v_mul_wrap(r, ww)));
+                        v_store(wsum + j, v_add_wrap(v_load(wsum + j), ww));
+                    }
+#endif
+                    for (; j < width; j++)
+                    {
+                        const float* p0     = sptr + j * 3;
+                        const float* p      = ksptr + j * 3;
+                        float        b      = p[0], g = p[1], r = p[2];
+                        float        alpha  = clampAlpha((std::abs(b - p0[0]) + std::abs(g - p0[1]) + std::abs(r - p0[2])) * scale_index);
+                        int          idx    = (int)alpha;
+                        alpha              -= idx;
+                        float        ww     = w * (expLUT[idx] + alpha * (expLUT[idx + 1] - expLUT[idx]));
+                        sum[j]             += b * ww;
+                        sum_g[j]           += g * ww;
+                        sum_r[j]           += r * ww;
+                        wsum[j]            += ww;
+                    }
+                }
+                for (j = 0; j < width; j++)
+                {
+                    float iw        = 1.f / wsum[j];
+                    dptr[j * 3]     = sum[j] * iw;
+                    dptr[j * 3 + 1] = sum_g[j] * iw;
+                    dptr[j * 3 + 2] = sum_r[j] * iw;
+                }
+            }
+        }
+    }
+
+private:
+    /*
+     * The table covers the color distances within the range of the image; the distances to
+     * the border values outside of it (BORDER_CONSTANT, the parent of a ROI) and the NaNs
+     * are mapped to its last entry.
+     */
+    inline float clampAlpha(float alpha) const { return alpha < max_alpha ? alpha : max_alpha; }
+
+#if HL_SIMD128
+    inline v_float32x4 lutWeight(const v_float32x4& _alpha) const
+    {
+        v_float32x4 alpha = v_min(_alpha, v_setall_f32(max_alpha));
+        v_int32x4   vidx  = v_convert<int>(alpha);
+        int         idx[4];
+        v_store(idx, vidx);
+        v_float32x4 w0 = v_lut(expLUT, idx), w1 = v_lut(expLUT + 1, idx);
+        return v_add_wrap(w0, v_mul_wrap(v_sub_wrap(alpha, v_convert<float>(vidx)), v_sub_wrap(w1, w0)));
+    }
+#endif
+
+    int                      cn;
+    int                      radius;
+    int                      maxk;
+    const int*               space_row;
+    const int*               space_ofs;
+    const BorderRowAccessor* src;
+    Mat*                     dest;
+    float                    scale_index;
+    float                    max_alpha;
+    const float*             space_weight;
+    const float*             expLUT;
+
+    BilateralFilter_32f_Invoker(const BilateralFilter_32f_Invoker&);                     // = delete;
+    const BilateralFilter_32f_Invoker& operator=(const BilateralFilter_32f_Invoker&);    // = delete;
+};
+
+/*
+ * Bilateral grid (Paris & Durand, Chen et al.). The pixels are splatted into a coarse 3D grid
+ * of (x, y, value) cells, sigmaSpace pixels by sigmaSpace pixels by sigmaColor levels, which
+ * accumulates the channel sums and the pixel count. The grid is blurred with a [1 4 6 4 1]/16
+ * kernel along each of its axes, i.e. a Gaussian of one cell, and the result is sliced back
+ * with trilinear interpolation. The cost does not depend on the kernel size. For 3-channel
+ * images the value axis is the sum of the channels, the L1 color distance used by the exact
+ * filter.
+ */
+const static int BILATERAL_GRID_PAD = 2;
+
+struct BilateralGridLayout
+{
+    int    cn;
+    int    nc;    //!< channel sums and the weight
+    int    gw;
+    int    gh;
+    int    gd;
+    int    border;
+    double ss;
+    double sr;
+    double gmin;
+
+    size_t cellStep() const { return nc; }
+
+    //! clamps a position along the value axis to the levels of the image range, NaNs included
+    float clampLevel(double z) const { return z >= 0 ? (float)std::min(z, (double)(gd - BILATERAL_GRID_PAD * 2 - 1)) : 0.f; }
+
+    size_t xStep() const { return (size_t)gd * nc; }
+
+    size_t yStep() const { return (size_t)gw * gd * nc; }
+};
+
+class BilateralGridBlur_Invoker: public ParallelLoopBody
+{
+public:
+    BilateralGridBlur_Invoker(const BilateralGridLayout& _g, const float* _src, float* _dst, int _axis):
+        ParallelLoopBody(), g(_g), src(_src), dst(_dst), axis(_axis)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        const float scale = 1.f / 16;
+        int         lineLen = (int)g.xStep(), nc = g.nc;
+
+        for (int y = range.start; y < range.end; y++)
+        {
+            for (int x = 0; x < g.gw; x++)
+            {
+                size_t       ofs = y * g.yStep() + x * g.xStep();
+                const float* S   = src + ofs;
+                float*       D   = dst + ofs;
+
+                if (axis == 2)
+                {
+                    memset(D, 0, BILATERAL_GRID_PAD * nc * sizeof(float));
+                    memset(D + (g.gd - BILATERAL_GRID_PAD) * nc, 0, BILATERAL_GRID_PAD * nc * sizeof(float));
+                    for (int i = BILATERAL_GRID_PAD * nc; i < (g.gd - BILATERAL_GRID_PAD) * nc; i++)
+                        D[i] = (S[i - 2 * nc] + S[i + 2 * nc] + 4 * (S[i - nc] + S[i + nc]) + 6 * S[i]) * scale;
+                    continue;
+                }
+
+                int    p = axis == 0 ? x : y, n = axis == 0 ? g.gw : g.gh;
+                size_t s = axis == 0 ? g.xStep() : g.yStep();
+                if (p < BILATERAL_GRID_PAD || p >= n - BILATERAL_GRID_PAD)
+                {
+                    memset(D, 0, lineLen * sizeof(float));
+                    continue;
+                }
+
+                const float *S0 = S - 2 * s, *S1 = S - s, *S3 = S + s, *S4 = S + 2 * s;
+                for (int i = 0; i < lineLen; i++)
+                    D[i] = (S0[i] + S4[i] + 4 * (S1[i] + S3[i]) + 6 * S[i]) * scale;
+            }
+        }
+    }
+
+private:
+    const BilateralGridLayout& g;
+    const float*               src;
+    float*                     dst;
+    int                        axis;
+
+    BilateralGridBlur_Invoker(const BilateralGridBlur_Invoker&);                     // = delete;
+    const BilateralGridBlur_Invoker& operator=(const BilateralGridBlur_Invoker&);    // = delete;
+};
+
+template <typename T>
+class BilateralGridSlice_Invoker: public ParallelLoopBody
+{
+public:
+    BilateralGridSlice_Invoker(const BilateralGridLayout& _g, const float* _grid, const Mat& _src, Mat& _dst, const int* _xofs, const float* _xalpha):
+        ParallelLoopBody(), g(_g), grid(_grid), src(_src), dst(_dst), xofs(_xofs), xalpha(_xalpha)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        int    cn = g.cn, nc = g.nc;
+        size_t xs = g.xStep(), ys = g.yStep();
+        float  acc[4];
+
+        for (int y = range.start; y < range.end; y++)
+        {
+            float        fy = (float)((y + g.border) / g.ss) + BILATERAL_GRID_PAD;
+            int          y0 = hlFloor(fy);
+            float        ay = fy - y0;
+            const T*     sp = src.ptr<T>(y);
+            T*           dp = dst.ptr<T>(y);
+            const float* G0 = grid + y0 * ys;
+
+            for (int x = 0; x < dst.cols; x++, sp += cn, dp += cn)
+            {
+                float guide = 0;
+                for (int c = 0; c < cn; c++)
+                    guide += (float)sp[c];
+
+                float fz = g.clampLevel((guide - g.gmin) / g.sr) + BILATERAL_GRID_PAD;
+                int   z0 = hlFloor(fz);
+                float az = fz - z0, ax = xalpha[x];
+
+                const float* C   = G0 + xofs[x] * xs + z0 * nc;
+                float        w00 = (1 - ay) * (1 - ax), w01 = (1 - ay) * ax, w10 = ay * (1 - ax), w11 = ay * ax;
+
+                for (int c = 0; c < nc; c++)
+                {
+                    const float* p = C + c;
+                    float        v0 = w00 * p[0] + w01 * p[xs] + w10 * p[ys] + w11 * p[ys + xs];
+                    float        v1 = w00 * p[nc] + w01 * p[xs + nc] + w10 * p[ys + nc] + w11 * p[ys + xs + nc];
+                    acc[c]          = v0 + az * (v1 - v0);
+                }
+
+                float iw = 1.f / acc[cn];
+                for (int c = 0; c < cn; c++)
+                    dp[c] = saturate_cast<T>(acc[c] * iw);
+            }
+        }
+    }
+
+private:
+    const BilateralGridLayout& g;
+    const float*               grid;
+    const Mat&                 src;
+    Mat&                       dst;
+    const int*                 xofs;
+    const float*               xalpha;
+
+    BilateralGridSlice_Invoker(const BilateralGridSlice_Invoker&);                     // = delete;
+    const BilateralGridSlice_Invoker& operator=(const BilateralGridSlice_Invoker&);    // = delete;
+};
+
+/*
+ * Splats the rows of the extended image into the grid. Every grid row only receives a band of
+ * consecutive image rows, so the grid rows are split between the threads and each one writes its
+ * own rows, without a private copy of the grid.
+ */
+template <typename T>
+class BilateralGridSplat_Invoker: public ParallelLoopBody
+{
+public:
+    BilateralGridSplat_Invoker(const BilateralGridLayout& _g, float* _grid, const BorderRowAccessor& _acc, const int* _vstart, const int* _gx):
+        ParallelLoopBody(), g(_g), grid(_grid), acc(_acc), vstart(_vstart), gx(_gx)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        int            cn = g.cn, nc = g.nc, ewidth = acc.size.width + g.border * 2;
+        std::vector<T> _row(ewidth * cn);
+        T*             row = &_row[0];
+
+        for (int gy = range.start; gy < range.end; gy++)
+        {
+            float* grow = grid + gy * g.yStep();
+
+            // the border pixels are taken from the virtually extended image (or the parent of the
+            // ROI); the values outside of the range of the image go to the first or the last cell
+            for (int v = vstart[gy]; v < vstart[gy + 1]; v++)
+            {
+                acc.extendRow(v - g.border, (uchar*)row);
+
+                const T* sp = row;
+                for (int u = 0; u < ewidth; u++, sp += cn)
+                {
+                    float val[4] = {0, 0, 0, 0}, guide = 0;
+                    for (int c = 0; c < cn; c++)
+                        guide += val[c] = (float)sp[c];
+
+                    float  fz   = g.clampLevel((guide - g.gmin) / g.sr);
+                    int    gz   = hlRound(fz) + BILATERAL_GRID_PAD;
+                    float* cell = grow + gx[u] * g.xStep() + gz * nc;
+                    for (int c = 0; c < cn; c++)
+                        cell[c] += val[c];
+                    cell[cn] += 1.f;
+                }
+            }
+        }
+    }
+
+private:
+    const BilateralGridLayout& g;
+    float*                     grid;
+    const BorderRowAccessor&   acc;
+    const int*                 vstart;
+    const int*                 gx;
+
+    BilateralGridSplat_Invoker(const BilateralGridSplat_Invoker&);                     // = delete;
+    const BilateralGridSplat_Invoker& operator=(const BilateralGridSplat_Invoker&);    // = delete;
+};
+
+template <typename T>
+static void bilateralGrid_(const Mat& src, Mat& dst, const BilateralGridLayout& g, int borderType)
+{
+    int    border = g.border;
+    size_t total  = g.yStep() * g.gh;
+
+    std::vector<float> _grid(total * 2, 0.f);
+    float*             grid = &_grid[0];
+    float*             temp = grid + total;
+
+    // splat; vstart[gy] is the first row of the extended image that goes to the grid row gy
+    BorderRowAccessor acc(src, borderType, border, border);
+    int               ewidth = src.cols + border * 2, eheight = src.rows + border * 2;
+    std::vector<int>  gx(ewidth), vstart(g.gh + 1);
+    for (int u = 0; u < ewidth; u++)
+        gx[u] = hlRound(u / g.ss) + BILATERAL_GRID_PAD;
+    for (int gy = 0, v = 0; gy <= g.gh; gy++)
+    {
+        while (v < eheight && hlRound(v / g.ss) + BILATERAL_GRID_PAD < gy)
+            v++;
+        vstart[gy] = v;
+    }
+
+    {
+        BilateralGridSplat_Invoker<T> body(g, grid, acc, &vstart[0], &gx[0]);
+        parallel_for_(Range(0, g.gh), body, (double)ewidth * eheight / (1 << 16));
+    }
+
+    // blur along x, y and the value axis
+    {
+        BilateralGridBlur_Invoker bx(g, grid, temp, 0);
+        parallel_for_(Range(0, g.gh), bx, total / (double)(1 << 16));
+        BilateralGridBlur_Invoker by(g, temp, grid, 1);
+        parallel_for_(Range(0, g.gh), by, total / (double)(1 << 16));
+        BilateralGridBlur_Invoker bz(g, grid, temp, 2);
+        parallel_for_(Range(0, g.gh), bz, total / (double)(1 << 16));
+    }
+
+    // slice
+    std::vector<int>   xofs(src.cols);
+    std::vector<float> xalpha(src.cols);
+    for (int x = 0; x < src.cols; x++)
+    {
+        float fx  = (float)((x + border) / g.ss) + BILATERAL_GRID_PAD;
+        xofs[x]   = hlFloor(fx);
+        xalpha[x] = fx - xofs[x];
+    }
+
+    BilateralGridSlice_Invoker<T> body(g, temp, src, dst, &xofs[0], &xalpha[0]);
+    parallel_for_(Range(0, src.rows), body, dst.total() / (double)(1 << 16));
+}
+
+}    // namespace
+
+void bilateralFilterInvoker_8u(const BorderRowAccessor& src, Mat& dst, int /*cn*/, int radius, int maxk, const int* space_row, const int* space_ofs, const float* space_weight, const float* color_weight)
+{
+    BilateralFilter_8u_Invoker body(dst, src, radius, maxk, space_row, space_ofs, space_weight, color_weight);
+    parallel_for_(Range(0, dst.rows), body, dst.total() / (double)(1 << 16));
+}
+
+void bilateralFilterInvoker_32f(const BorderRowAccessor& src, Mat& dst, int cn, int radius, int maxk, const int* space_row, const int* space_ofs, const float* space_weight, const float* expLUT, float scale_index, float max_alpha)
+{
+    BilateralFilter_32f_Invoker body(cn, radius, maxk, space_row, space_ofs, src, dst, scale_index, max_alpha, space_weight, expLUT);
+    parallel_for_(Range(0, dst.rows), body, dst.total() / (double)(1 << 16));
+}
+
+bool bilateralGrid(const Mat& src, Mat& dst, double sigmaColor, double sigmaSpace, int borderType)
+{
+    BilateralGridLayout g;
+    g.cn     = src.channels();
+    g.nc     = g.cn + 1;
+    g.ss     = sigmaSpace;
+    g.sr     = sigmaColor;
+    g.border = hlCeil(sigmaSpace * 2);
+
+    double gmax;
+    if (src.depth() == HL_8U)
+    {
+        g.gmin = 0;
+        gmax   = 255. * g.cn;
+    }
+    else
+    {
+        minMaxIdx(src.reshape(1), &g.gmin, &gmax);
+        // the constant border is 0, which must be inside the grid too; the other borders repeat
+        // the image, and the parent pixels of a ROI outside its range go to the end cells
+        if ((borderType & ~BORDER_ISOLATED) == BORDER_CONSTANT)
+        {
+            g.gmin = std::min(g.gmin, 0.);
+            gmax   = std::max(gmax, 0.);
+        }
+        g.gmin *= g.cn;
+        gmax   *= g.cn;
+    }
+
+    g.gw = hlRound((src.cols + g.border * 2 - 1) / g.ss) + 2 + BILATERAL_GRID_PAD * 2;
+    g.gh = hlRound((src.rows + g.border * 2 - 1) / g.ss) + 2 + BILATERAL_GRID_PAD * 2;
+    g.gd = hlRound((gmax - g.gmin) / g.sr) + 2 + BILATERAL_GRID_PAD * 2;
+
+    // the grid only pays off when it is coarser than the image
+    if ((double)g.gw * g.gh * g.gd * g.nc > 4. * src.total() * g.cn)
+        return false;
+
+    if (src.depth() == HL_8U)
+        bilateralGrid_<uchar>(src, dst, g, borderType);
+    else
+        bilateralGrid_<float>(src, dst, g, borderType);
+    return true;
+}
+
+}    // namespace cpu_baseline
+}    // namespace hl
@@ -1,4 +1,5 @@
 #include "precomp.hxx"
+#include "openHL/core/hal/intrin.hxx"
 
 namespace hl
 {
@@ -16,6 +17,16 @@ Ptr<FilterEngine>     createBoxFilter(int srcType, int dstType, Size ksize, Poin
 
 namespace
 {
+#if HL_SIMD128
+//! hlRound(s * scale) of 4 column sums: the products are those of the scalar loops, rounded the same way
+inline static v_int32x4 v_scale_round(const v_int32x4& s, const v_float64x2& scale)
+{
+    v_float64x2 lo = v_mul_wrap(v_convert<double>(v_get_low(s)), scale);
+    v_float64x2 hi = v_mul_wrap(v_convert<double>(v_get_high(s)), scale);
+    return v_combine(v_round(lo), v_round(hi));
+}
+#endif
+
 template <typename T, typename ST>
 struct RowSum: public BaseRowFilter
 {
@@ -83,29 +94,20 @@ struct RowSum: public BaseRowFilter
         }
         else if (cn == 4)
         {
-            ST s0 = 0, s1 = 0, s2 = 0, s3 = 0;
-            for (i = 0; i < ksz_cn; i += 4)
+            // the window deltas of all the channels are computed first, without a loop-carried
+            // dependency, then summed up with one register holding the running sum of each channel
+            for (k = 0; k < 4; k++)
             {
-                s0 += (ST)S[i];
-                s1 += (ST)S[i + 1];
-                s2 += (ST)S[i + 2];
-                s3 += (ST)S[i + 3];
-            }
-            D[0] = s0;
-            D[1] = s1;
-            D[2] = s2;
-            D[3] = s3;
-            for (i = 0; i < width; i += 4)
-            {
-                s0       += (ST)S[i + ksz_cn] - (ST)S[i];
-                s1       += (ST)S[i + ksz_cn + 1] - (ST)S[i + 1];
-                s2       += (ST)S[i + ksz_cn + 2] - (ST)S[i + 2];
-                s3       += (ST)S[i + ksz_cn + 3] - (ST)S[i + 3];
-                D[i + 4]  = s0;
-                D[i + 5]  = s1;
-                D[i + 6]  = s2;
-                D[i + 7]  = s3;
+                ST s = 0;
+                for (i = k; i < ksz_cn; i += 4)
+                    s += (ST)S[i];
+                D[k] = s;
             }
+
+            ST* Dd = D + 4;
+            for (i = 0; i < width; i++)
+                Dd[i] = (ST)((ST)S[i + ksz_cn] - (ST)S[i]);
+            prefixSum4(D, width);
         }
         else
             for (k = 0; k < cn; k++, S++, D++)
@@ -121,6 +123,25 @@ struct RowSum: public BaseRowFilter
                 }
             }
     }
+
+    static void prefixSum4(ST* D, int width)
+    {
+        int i = 4;
+#if HL_SIMD128
+        typedef v_reg<ST, HL_SIMD_WIDTH / sizeof(ST)> ST_vec;
+        if constexpr (ST_vec::nlanes == 4)
+        {
+            ST_vec s = v_load(D);
+            for (; i < width + 4; i += 4)
+            {
+                s = v_add_wrap(s, v_load(D + i));
+                v_store(D + i, s);
+            }
+        }
+#endif
+        for (; i < width + 4; i++)
+            D[i] = (ST)(D[i] + D[i - 4]);
+    }
 };
 
 template <typename ST, typename T>
@@ -275,6 +296,21 @@ struct ColumnSum<int, uchar>: public BaseColumnFilter
             if (haveScale)
             {
                 int i = 0;
+#if HL_SIMD128
+                const v_float64x2 vscale = v_setall(_scale);
+                for (; i <= width - v_uint8x16::nlanes; i += v_uint8x16::nlanes)
+                {
+                    v_int32x4 r[4];
+                    for (int k = 0; k < 4; k++)
+                    {
+                        const int j  = i + k * v_int32x4::nlanes;
+                        v_int32x4 s0 = v_add_wrap(v_load(SUM + j), v_load(Sp + j));
+                        r[k]         = v_scale_round(s0, vscale);
+                        v_store(SUM + j, v_sub_wrap(s0, v_load(Sm + j)));
+                    }
+                    v_store(D + i, v_pack_u(v_pack(r[0], r[1]), v_pack(r[2], r[3])));
+                }
+#endif
                 for (; i < width; i++)
                 {
                     int s0 = SUM[i] + Sp[i];
@@ -373,6 +409,21 @@ struct ColumnSum<ushort, uchar>: public BaseColumnFilter
             if (haveScale)
             {
                 int i = 0;
+#if HL_SIMD128
+                const v_int32x4 vds = v_setall_s32(ds), vdd = v_setall_s32(dd);
+                for (; i <= width - v_uint8x16::nlanes; i += v_uint8x16::nlanes)
+                {
+                    v_int32x4 r[4];
+                    for (int k = 0; k < 4; k++)
+                    {
+                        const int j  = i + k * v_int32x4::nlanes;
+                        v_int32x4 s0 = v_add_wrap(v_load_convert<int>(SUM + j), v_load_convert<int>(Sp + j));
+                        r[k]         = v_shr<SHIFT>(v_mul_wrap(v_add_wrap(s0, vdd), vds));
+                        v_store(SUM + j, v_convert<ushort>(v_sub_wrap(s0, v_load_convert<int>(Sm + j))));
+                    }
+                    v_store(D + i, v_pack_u(v_pack(r[0], r[1]), v_pack(r[2], r[3])));
+                }
+#endif
                 for (; i < width; i++)
                 {
                     int s0 = SUM[i] + Sp[i];
@@ -454,6 +505,21 @@ struct ColumnSum<int, short>: public BaseColumnFilter
             if (haveScale)
             {
                 i = 0;
+#if HL_SIMD128
+                const v_float64x2 vscale = v_setall(_scale);
+                for (; i <= width - v_int16x8::nlanes; i += v_int16x8::nlanes)
+                {
+                    v_int32x4 r[2];
+                    for (int k = 0; k < 2; k++)
+                    {
+                        const int j  = i + k * v_int32x4::nlanes;
+                        v_int32x4 s0 = v_add_wrap(v_load(SUM + j), v_load(Sp + j));
+                        r[k]         = v_scale_round(s0, vscale);
+                        v_store(SUM + j, v_sub_wrap(s0, v_load(Sm + j)));
+                    }
+                    v_store(D + i, v_pack(r[0], r[1]));
+                }
+#endif
                 for (; i < width; i++)
                 {
                     int s0 = SUM[i] + Sp[i];
@@ -532,6 +598,21 @@ struct ColumnSum<int, ushort>: public BaseColumnFilter
             if (haveScale)
             {
                 int i = 0;
+#if HL_SIMD128
+                const v_float64x2 vscale = v_setall(_scale);
+                for (; i <= width - v_uint16x8::nlanes; i += v_uint16x8::nlanes)
+                {
+                    v_int32x4 r[2];
+                    for (int k = 0; k < 2; k++)
+                    {
+                        const int j  = i + k * v_int32x4::nlanes;
+                        v_int32x4 s0 = v_add_wrap(v_load(SUM + j), v_load(Sp + j));
+                        r[k]         = v_scale_round(s0, vscale);
+                        v_store(SUM + j, v_sub_wrap(s0, v_load(Sm + j)));
+                    }
+                    v_store(D + i, v_pack_u(r[0], r[1]));
+                }
+#endif
                 for (; i < width; i++)
                 {
                     int s0 = SUM[i] + Sp[i];
@@ -0,0 +1,349 @@
+#include "precomp.hxx"
+#include "histogram.hxx"
+
+#include "openHL/core/hal/intrin.hxx"
+
+namespace hl
+{
+
+/*
+ * Computes the clipped and equalized LUT of every tile. The image is divided into tilesX x tilesY
+ * tiles of tileSize; when its size is not a multiple of the grid, the last tiles extend past the
+ * image and the outer pixels are read through the reflected border. The pixels inside the image are
+ * counted by the invoker of equalizeHist.
+ */
+class CLAHE_CalcLut_Invoker: public ParallelLoopBody
+{
+public:
+    CLAHE_CalcLut_Invoker(const Mat& _src, const BorderRowAccessor& _border, Mat& _lut, Size _tileSize, int _tilesX, int _clipLimit, float _lutScale):
+        ParallelLoopBody(), src(_src), border(_border), lut(_lut), tileSize(_tileSize), tilesX(_tilesX), clipLimit(_clipLimit), lutScale(_lutScale)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        const int histSize = 256;
+
+        for (int k = range.start; k < range.end; ++k)
+        {
+            int ty = k / tilesX;
+            int tx = k % tilesX;
+
+            // the part of the tile inside the image
+            int x0  = tx * tileSize.width;
+            int y0  = ty * tileSize.height;
+            int xin = std::max(std::min(tileSize.width, src.cols - x0), 0);
+            int yin = std::max(std::min(tileSize.height, src.rows - y0), 0);
+
+            // calc histogram
+            int tileHist[histSize] = {
+                0,
+            };
+            Mutex tileHistLock;
+
+            if (xin > 0)
+            {
+                if (yin > 0)
+                    EqualizeHistCalcHist_Invoker(src(Rect(x0, y0, xin, yin)), tileHist, &tileHistLock)(Range(0, yin));
+
+                // the rows below the image are rows of the image or of its parent
+                for (int y = y0 + yin; y < y0 + tileSize.height; ++y)
+                    EqualizeHistCalcHist_Invoker(Mat(1, xin, HL_8UC1, (void*)(border.row(y) + x0)), tileHist, &tileHistLock)(Range(0, 1));
+            }
+
+            for (int i = 0; i < tileSize.height; ++i)
+                for (int j = xin; j < tileSize.width; ++j)
+                    tileHist[*border.ptr(y0 + i, x0 + j)]++;
+
+            // clip histogram
+            if (clipLimit > 0)
+            {
+                // how many pixels were clipped
+                int clipped = 0;
+                for (int i = 0; i < histSize; ++i)
+                {
+                    if (tileHist[i] > clipLimit)
+                    {
+                        clipped     += tileHist[i] - clipLimit;
+                        tileHist[i]  = clipLimit;
+                    }
+                }
+
+                // redistribute clipped pixels
+                int redistBatch = clipped / histSize;
+                int residual    = clipped - redistBatch * histSize;
+
+                for (int i = 0; i < histSize; ++i)
+                    tileHist[i] += redistBatch;
+
+                if (residual != 0)
+                {
+                    int residualStep = std::max(histSize / residual, 1);
+                    for (int i = 0; i < histSize && residual > 0; i += residualStep, residual--)
+                        tileHist[i]++;
+                }
+            }
+
+            // calc Lut
+            uchar* tileLut = lut.ptr(k);
+            int    sum     = 0;
+            for (int i = 0; i < histSize; ++i)
+            {
+                sum        += tileHist[i];
+                tileLut[i]  = saturate_cast<uchar>(sum * lutScale);
+            }
+        }
+    }
+
+private:
+    const Mat&               src;
+    const BorderRowAccessor& border;
+    Mat&                     lut;
+    Size                     tileSize;
+    int                      tilesX;
+    int                      clipLimit;
+    float                    lutScale;
+
+    CLAHE_CalcLut_Invoker(const CLAHE_CalcLut_Invoker&);                     // = delete;
+    const CLAHE_CalcLut_Invoker& operator=(const CLAHE_CalcLut_Invoker&);    // = delete;
+};
+
+/*
+ * Every pixel is mapped by the LUTs of the 4 nearest tile centers, weighted bilinearly. The weights
+ * are fixed point with 8 fractional bits. The vertical weights are the same along a row, so the two
+ * rows of tile LUTs around it are blended first, for all the levels at once and with SIMD. The two
+ * LUTs l1, l2 of a pixel are packed as l1 + (l2 << 32) and its weights as xa + ((1 - xa) << 32), with
+ * 1 = WEIGHT_ONE, so the bits 32..63 of their product are l1 * (1 - xa) + l2 * xa: the low product
+ * stays below 2^24 and the rest wraps out, which leaves one lookup and one multiplication per pixel.
+ */
+class CLAHE_Interpolation_Invoker: public ParallelLoopBody
+{
+public:
+    enum
+    {
+        WEIGHT_BITS = 8,
+        WEIGHT_ONE  = 1 << WEIGHT_BITS
+    };
+
+    CLAHE_Interpolation_Invoker(const Mat& _src, Mat& _dst, const Mat& _lut, Size _tileSize, int _tilesX, int _tilesY):
+        ParallelLoopBody(), src(_src), dst(_dst), lut(_lut), tileSize(_tileSize), tilesX(_tilesX), tilesY(_tilesY), xw_p(src.cols), spans(tilesX + 2)
+    {
+        float inv_tw = 1.0f / tileSize.width;
+
+        // the columns between the centers of the tiles tx - 1 and tx form the span tx, where both LUTs are the same
+        for (int tx = 0; tx <= tilesX + 1; ++tx)
+            spans[tx] = src.cols;
+        for (int x = src.cols - 1; x >= 0; --x)
+        {
+            float txf = x * inv_tw - 0.5f;
+            int   tx1 = hlFloor(txf);
+            int   xa  = hlRound((txf - tx1) * (float)WEIGHT_ONE);
+
+            xw_p[x]   = (uint64)xa | ((uint64)(WEIGHT_ONE - xa) << 32);
+
+            spans[std::min(tx1 + 1, tilesX)] = x;
+        }
+        for (int tx = tilesX; tx >= 0; --tx)
+            spans[tx] = std::min(spans[tx], spans[tx + 1]);
+    }
+
+    void operator()(const Range& range) const override
+    {
+        const int n      = tilesX * 256;
+        float     inv_th = 1.0f / tileSize.height;
+
+        AutoBuffer<ushort> _rowLut(n);
+        AutoBuffer<uint64> _spanLut((tilesX + 1) * 256);
+        ushort*            rowLut  = _rowLut.data();
+        uint64*            spanLut = _spanLut.data();
+        const uint64*      xw_     = xw_p.data();
+
+        for (int y = range.start; y < range.end; ++y)
+        {
+            const uchar* srcRow = src.ptr(y);
+            uchar*       dstRow = dst.ptr(y);
+
+            float tyf = y * inv_th - 0.5f;
+
+            int ty1   = hlFloor(tyf);
+            int ty2   = ty1 + 1;
+
+            int ya    = hlRound((tyf - ty1) * (float)WEIGHT_ONE);
+            int ya1   = WEIGHT_ONE - ya;
+
+            ty1       = std::max(ty1, 0);
+            ty2       = std::min(ty2, tilesY - 1);
+
+            // the LUTs of the row of tiles ty1 and ty2 are adjacent
+            const uchar* lutPlane1 = lut.ptr(ty1 * tilesX);
+            const uchar* lutPlane2 = lut.ptr(ty2 * tilesX);
+
+            int i = 0;
+#if HL_SIMD128
+            v_uint16x8 vya  = v_setall_u16((ushort)ya);
+            v_uint16x8 vya1 = v_setall_u16((ushort)ya1);
+            for (; i <= n - v_uint16x8::nlanes; i += v_uint16x8::nlanes)
+            {
+                v_uint16x8 l1 = v_load_convert<ushort>(lutPlane1 + i);
+                v_uint16x8 l2 = v_load_convert<ushort>(lutPlane2 + i);
+                v_store(rowLut + i, v_add_wrap(v_mul_wrap(l1, vya1), v_mul_wrap(l2, vya)));
+            }
+#endif
+            for (; i < n; ++i)
+                rowLut[i] = (ushort)(lutPlane1[i] * ya1 + lutPlane2[i] * ya);
+
+            // the two LUTs of every span in the low and high halves of one word, see xw_p
+            for (int tx = 0; tx <= tilesX; ++tx)
+            {
+                const ushort* lut1    = rowLut + std::max(tx - 1, 0) * 256;
+                const ushort* lut2    = rowLut + std::min(tx, tilesX - 1) * 256;
+                uint64*       pairLut = spanLut + tx * 256;
+
+                for (int v = 0; v < 256; ++v)
+                    pairLut[v] = lut1[v] | ((uint64)lut2[v] << 32);
+            }
+
+            for (int tx = 0; tx <= tilesX; ++tx)
+            {
+                const uint64* pairLut = spanLut + tx * 256;
+
+                for (int x = spans[tx]; x < spans[tx + 1]; ++x)
+                {
+                    uint64 res = pairLut[srcRow[x]] * xw_[x];
+                    dstRow[x]  = (uchar)(((res >> 32) + (1 << (WEIGHT_BITS * 2 - 1))) >> (WEIGHT_BITS * 2));
+                }
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat&       dst;
+    const Mat& lut;
+    Size       tileSize;
+    int        tilesX;
+    int        tilesY;
+
+    std::vector<uint64> xw_p;
+    std::vector<int>    spans;
+
+    CLAHE_Interpolation_Invoker(const CLAHE_Interpolation_Invoker&);                     // = delete;
+    const CLAHE_Interpolation_Invoker& operator=(const CLAHE_Interpolation_Invoker&);    // = delete;
+};
+
+class CLAHE_Impl: public CLAHE
+{
+public:
+    CLAHE_Impl(double clipLimit = 40.0, int tilesX = 8, int tilesY = 8);
+
+    void apply(const Mat& src, Mat& dst) override;
+
+    void   setClipLimit(double clipLimit) override;
+    double getClipLimit() const override;
+
+    void setTilesGridSize(Size tileGridSize) override;
+    Size getTilesGridSize() const override;
+
+    void collectGarbage() override;
+
+private:
+    double clipLimit_;
+    int    tilesX_;
+    int    tilesY_;
+
+    Mat lut_;
+};
+
+CLAHE_Impl::CLAHE_Impl(double clipLimit, int tilesX, int tilesY):
+    clipLimit_(clipLimit), tilesX_(tilesX), tilesY_(tilesY)
+{
+}
+
+void CLAHE_Impl::apply(const Mat& _src, Mat& _dst)
+{
+    HL_Assert(_src.type() == HL_8UC1);
+    HL_Assert(tilesX_ > 0 && tilesY_ > 0);
+
+    const int histSize = 256;
+
+    Mat src = _src;
+    _dst.create(src.size(), src.type());
+    Mat dst = _dst;
+
+    if (src.empty())
+        return;
+
+    // the last tiles are completed by the reflected border when the image is not divisible into tiles
+    Size tileSize;
+    tileSize.width  = (src.cols + tilesX_ - 1) / tilesX_;
+    tileSize.height = (src.rows + tilesY_ - 1) / tilesY_;
+
+    BorderRowAccessor border(src, BORDER_REFLECT_101);
+
+    const int   tileSizeTotal = tileSize.area();
+    const float lutScale      = static_cast<float>(histSize - 1) / tileSizeTotal;
+
+    int clipLimit = 0;
+    if (clipLimit_ > 0.0)
+    {
+        clipLimit = static_cast<int>(clipLimit_ * tileSizeTotal / histSize);
+        clipLimit = std::max(clipLimit, 1);
+    }
+
+    lut_.create(tilesX_ * tilesY_, histSize, HL_8UC1);
+
+    CLAHE_CalcLut_Invoker calcLutBody(src, border, lut_, tileSize, tilesX_, clipLimit, lutScale);
+    parallel_for_(Range(0, tilesX_ * tilesY_), calcLutBody);
+
+    // a single tile maps every pixel through its own LUT, like equalizeHist
+    if (tilesX_ == 1 && tilesY_ == 1)
+    {
+        int lut[histSize];
+        for (int i = 0; i < histSize; ++i)
+            lut[i] = lut_.ptr()[i];
+
+        EqualizeHistLut_Invoker lutBody(src, dst, lut);
+        if (EqualizeHistLut_Invoker::isWorthParallel(src))
+            parallel_for_(Range(0, src.rows), lutBody);
+        else
+            lutBody(Range(0, src.rows));
+        return;
+    }
+
+    // every pixel is read before its own result is written, so src may be dst
+    CLAHE_Interpolation_Invoker interpolationBody(src, dst, lut_, tileSize, tilesX_, tilesY_);
+    parallel_for_(Range(0, src.rows), interpolationBody, src.total() / (double)(1 << 16));
+}
+
+void CLAHE_Impl::setClipLimit(double clipLimit)
+{
+    clipLimit_ = clipLimit;
+}
+
+double CLAHE_Impl::getClipLimit() const
+{
+    return clipLimit_;
+}
+
+void CLAHE_Impl::setTilesGridSize(Size tileGridSize)
+{
+    tilesX_ = tileGridSize.width;
+    tilesY_ = tileGridSize.height;
+}
+
+Size CLAHE_Impl::getTilesGridSize() const
+{
+    return Size(tilesX_, tilesY_);
+}
+
+void CLAHE_Impl::collectGarbage()
+{
+    lut_.release();
+}
+
+}    // namespace hl
+
+hl::Ptr<hl::CLAHE> hl::createCLAHE(double clipLimit, Size tileGridSize)
+{
+    return makePtr<CLAHE_Impl>(clipLimit, tileGridSize.width, tileGridSize.height);
+}
@@ -22,56 +22,40 @@ struct Vec2iEqual
     }
 };
 
-static bool isInnerPoint(const Mat& src, int y, int x)
+// 8邻域(图像范围内)全为前景的点是内部点，即3x3腐蚀后仍不为0的点
+static void innerPoints(const Mat& src, Mat& inner)
 {
-    // 定义方向数组，用于遍历8邻域
-    const int dx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
-    const int dy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
-
-    if (src.at<uchar>(y, x) == 0) return false;    // 如果该点是背景点，则直接返回false
-
-    // 遍历8邻域
-    for (int i = 0; i < 8; ++i)
-    {
-        int ny = y + dy[i];
-        int nx = x + dx[i];
-
-        // 检查邻域像素是否在图像范围内
-        if (nx >= 0 && nx < src.cols && ny >= 0 && ny < src.rows)
-        {
-            // 如果邻域中存在背景点，则该点是边界点
-            if (src.at<uchar>(ny, nx) == 0)
-            {
-                return false;
-            }
-        }
-    }
-
-    // 如果邻域中不存在背景点，则该点是内部点
-    return true;
+    // 图像范围外的点不参与判断, src为ROI时也不读取父图像中ROI外的像素
+    erode(src, inner, Mat(), Point(-1, -1), 1, BORDER_CONSTANT | BORDER_ISOLATED);
 }
 
 void extractContours(const Mat& src, Mat& dst)
 {
+    Mat inner;
+    innerPoints(src, inner);
+
     cvtColor(src, dst, COLOR_GRAY2BGR);
     for (int y = 0; y < src.rows; ++y)
     {
+        const uchar* sptr = src.ptr<uchar>(y);
+        const uchar* iptr = inner.ptr<uchar>(y);
+        Vec3b*       dptr = dst.ptr<Vec3b>(y);
         for (int x = 0; x < src.cols; ++x)
         {
-            if (src.at<uchar>(y, x) != 255) continue;
-            if (isInnerPoint(src, y, x))
+            if (sptr[x] != 255) continue;
+            if (iptr[x])
             {
-                dst.at<Vec3b>(y, x) = Vec3b(0, 0, 0);
+                dptr[x] = Vec3b(0, 0, 0);
             }
             else
             {
-                dst.at<Vec3b>(y, x) = Vec3b(0, 0, 255);
+                dptr[x] = Vec3b(0, 0, 255);
             }
         }
     }
 }
 
-static void nextPoint(const Mat& src, Vec3i& p)
+static void nextPoint(const Mat& src, const Mat& inner, Vec3i& p)
 {
     // 定义方向数组，用于遍历8邻域
     const static int dy[8] = {0, -1, -1, -1, 0, +1, +1, +1};
@@ -87,7 +71,7 @@ static void nextPoint(const Mat& src, Vec3i& p)
         if (nx >= 0 && nx < src.cols && ny >= 0 && ny < src.rows)
         {
             // if (src.at<uchar>(ny, nx) == 255)
-            if (src.at<uchar>(ny, nx) == 255 && !isInnerPoint(src, ny, nx))
+            if (src.at<uchar>(ny, nx) == 255 && !inner.at<uchar>(ny, nx))
             {
                 // 返回下一个边界点
                 p[0] = ny;
@@ -111,6 +95,9 @@ static void nextPoint(const Mat& src, Vec3i& p)
 
 void trackingContours(const Mat& src, Mat& dst)
 {
+    Mat inner;
+    innerPoints(src, inner);
+
     cvtColor(src, dst, COLOR_GRAY2BGR);
 
     std::unordered_set<Vec2i, Vec2iHash, Vec2iEqual> pointset;
@@ -121,7 +108,7 @@ void trackingContours(const Mat& src, Mat& dst)
     {
         for (int x = 0; x < src.cols; ++x)
         {
-            if (src.at<uchar>(y, x) == 255 && !isInnerPoint(src, y, x))
+            if (src.at<uchar>(y, x) == 255 && !inner.at<uchar>(y, x))
             {
                 p = Vec3i(y, x, 5);
 
@@ -131,7 +118,7 @@ void trackingContours(const Mat& src, Mat& dst)
                     if (pointset.contains(Vec2i(p[0], p[1]))) break;
                     pointset.insert(Vec2i(p[0], p[1]));
                     dst.at<Vec3b>(p[0], p[1]) = Vec3b(0, 0, 255);
-                    nextPoint(src, p);
+                    nextPoint(src, inner, p);
                     if (p == Vec3i(-1, -1, -1)) break;
                     if (p[0] == y && p[1] == x) break;
                 }
@@ -9,112 +9,84 @@ inline static uchar getG(short gx, short gy)
     return static_cast<uchar>(g > 255 ? 255 : g);
 }
 
-void prewitt(const Mat& src, Mat& dst)
+/*
+ * 对每个像素调用op(p)计算目标像素值，p(dy, dx)返回(x + dx, y + dy)处的邻域像素，使用最近边缘像素填充防止越界。
+ * 边界由BorderRowAccessor虚拟填充，不需要构造带边界的图像副本：内部像素直接通过行指针读取，
+ * 只有左右两侧的r列经过逐像素插值的慢速路径。
+ */
+template <typename Op>
+static void applyNeighborhood(const Mat& src, Mat& dst, int r, const Op& op)
 {
-    short gx, gy;
-    uchar z1, z2, z3, z4, z6, z7, z8, z9;
+    // src可能就是dst，先保留源图像的数据
+    Mat img = src;
 
     // 初始化目标图像，确保尺寸和类型一致
-    dst = Mat(src.size(), src.type());
+    dst     = Mat(img.size(), img.type());
+
+    BorderRowAccessor        acc(img, BORDER_REPLICATE | BORDER_ISOLATED);
+    AutoBuffer<const uchar*> _rows(2 * r + 1);
+    const uchar**            rows = _rows.data() + r;
+
+    int x0 = std::min(r, img.cols), x1 = std::max(img.cols - r, x0);
 
     // 遍历图像的每个像素
-    for (int y = 0; y < src.rows; ++y)
+    for (int y = 0; y < img.rows; ++y)
     {
-        for (int x = 0; x < src.cols; ++x)
-        {
-            // 获取3x3邻域像素值，使用最近边缘像素填充防止越界
-            z1                  = src.at<uchar>(std::max(y - 1, 0), std::max(x - 1, 0));
-            z2                  = src.at<uchar>(std::max(y - 1, 0), x);
-            z3                  = src.at<uchar>(std::max(y - 1, 0), std::min(x + 1, src.cols - 1));
-            z4                  = src.at<uchar>(y, std::max(x - 1, 0));
-            z6                  = src.at<uchar>(y, std::min(x + 1, src.cols - 1));
-            z7                  = src.at<uchar>(std::min(y + 1, src.rows - 1), std::max(x - 1, 0));
-            z8                  = src.at<uchar>(std::min(y + 1, src.rows - 1), x);
-            z9                  = src.at<uchar>(std::min(y + 1, src.rows - 1), std::min(x + 1, src.cols - 1));
-
-            // 计算水平方向梯度
-            gx                  = z7 + z8 + z9 - z1 - z2 - z3;
-            // 计算垂直方向梯度
-            gy                  = z3 + z6 + z9 - z1 - z4 - z7;
-
-            // 设置目标像素值
-            dst.at<uchar>(y, x) = getG(gx, gy);
-        }
+        for (int i = -r; i <= r; i++)
+            rows[i] = acc.row(y + i);
+
+        uchar* d = dst.ptr<uchar>(y);
+        int    x = 0;
+
+        for (; x < x0; ++x)
+            d[x] = op([&](int dy, int dx) { return (int)*acc.ptr(y + dy, x + dx); });
+        for (; x < x1; ++x)
+            d[x] = op([&](int dy, int dx) { return (int)rows[dy][x + dx]; });
+        for (; x < img.cols; ++x)
+            d[x] = op([&](int dy, int dx) { return (int)*acc.ptr(y + dy, x + dx); });
     }
 }
 
-void sobel(const Mat& src, Mat& dst)
+void prewitt(const Mat& src, Mat& dst)
 {
-    short gx, gy;
-    uchar z1, z2, z3, z4, z6, z7, z8, z9;
-
-    // 初始化目标图像，确保尺寸和类型一致
-    dst = Mat(src.size(), src.type());
+    applyNeighborhood(src, dst, 1, [](const auto& p)
+                      {
+                          // 计算水平方向梯度
+                          short gx = p(1, -1) + p(1, 0) + p(1, 1) - p(-1, -1) - p(-1, 0) - p(-1, 1);
+                          // 计算垂直方向梯度
+                          short gy = p(-1, 1) + p(0, 1) + p(1, 1) - p(-1, -1) - p(0, -1) - p(1, -1);
+
+                          return getG(gx, gy);
+                      });
+}
 
-    // 遍历图像的每个像素
-    for (int y = 0; y < src.rows; ++y)
-    {
-        for (int x = 0; x < src.cols; ++x)
-        {
-            // 获取3x3邻域像素值，使用最近边缘像素填充防止越界
-            z1                  = src.at<uchar>(std::max(y - 1, 0), std::max(x - 1, 0));
-            z2                  = src.at<uchar>(std::max(y - 1, 0), x);
-            z3                  = src.at<uchar>(std::max(y - 1, 0), std::min(x + 1, src.cols - 1));
-            z4                  = src.at<uchar>(y, std::max(x - 1, 0));
-            z6                  = src.at<uchar>(y, std::min(x + 1, src.cols - 1));
-            z7                  = src.at<uchar>(std::min(y + 1, src.rows - 1), std::max(x - 1, 0));
-            z8                  = src.at<uchar>(std::min(y + 1, src.rows - 1), x);
-            z9                  = src.at<uchar>(std::min(y + 1, src.rows - 1), std::min(x + 1, src.cols - 1));
-
-            // 计算水平方向梯度
-            gx                  = z7 + 2 * z8 + z9 - z1 - 2 * z2 - z3;
-            // 计算垂直方向梯度
-            gy                  = z3 + 2 * z6 + z9 - z1 - 2 * z4 - z7;
-
-            // 设置目标像素值
-            dst.at<uchar>(y, x) = getG(gx, gy);
-        }
-    }
+void sobel(const Mat& src, Mat& dst)
+{
+    applyNeighborhood(src, dst, 1, [](const auto& p)
+                      {
+                          // 计算水平方向梯度
+                          short gx = p(1, -1) + 2 * p(1, 0) + p(1, 1) - p(-1, -1) - 2 * p(-1, 0) - p(-1, 1);
+                          // 计算垂直方向梯度
+                          short gy = p(-1, 1) + 2 * p(0, 1) + p(1, 1) - p(-1, -1) - 2 * p(0, -1) - p(1, -1);
+
+                          return getG(gx, gy);
+                      });
 }
 
 void LOG(const Mat& src, Mat& dst)
 {
-    short pixi;
-    uchar z3, z7, z8, z9, z11, z12, z13, z14, z15, z17, z18, z19, z23;
-
-    // 初始化目标图像，确保尺寸和类型一致
-    dst = Mat(src.size(), src.type());
-
-    // 遍历图像的每个像素
-    for (int y = 0; y < src.rows; ++y)
-    {
-        for (int x = 0; x < src.cols; ++x)
-        {
-            // 获取5x5邻域像素值，使用最近边缘像素填充防止越界
-            z3                  = src.at<uchar>(std::max(y - 2, 0), x);
-
-            z7                  = src.at<uchar>(std::max(y - 1, 0), std::max(x - 1, 0));
-            z8                  = src.at<uchar>(std::max(y - 1, 0), x);
-            z9                  = src.at<uchar>(std::max(y - 1, 0), std::min(x + 1, src.cols - 1));
-
-            z11                 = src.at<uchar>(y, std::max(x - 2, 0));
-            z12                 = src.at<uchar>(y, std::max(x - 1, 0));
-            z13                 = src.at<uchar>(y, x);
-            z14                 = src.at<uchar>(y, std::min(x + 1, src.cols - 1));
-            z15                 = src.at<uchar>(y, std::min(x + 2, src.cols - 1));
-
-            z17                 = src.at<uchar>(std::min(y + 1, src.rows - 1), std::max(x - 1, 0));
-            z18                 = src.at<uchar>(std::min(y + 1, src.rows - 1), x);
-            z19                 = src.at<uchar>(std::min(y + 1, src.rows - 1), std::min(x + 1, src.cols - 1));
-
-            z23                 = src.at<uchar>(std::min(y + 2, src.rows - 1), x);
-
-            // 设置目标像素值
-            pixi                = -z3 - z7 - 2 * z8 - z9 - z11 - 2 * z12 + 16 * z13 - 2 * z14 - z15 - z17 - 2 * z18 - z19 - z23;
-            dst.at<uchar>(y, x) = static_cast<uchar>(pixi > 255 ? 255 : pixi < 0 ? 0
-                                                                                 : pixi);
-        }
-    }
+    applyNeighborhood(src, dst, 2, [](const auto& p)
+                      {
+                          // 5x5邻域的拉普拉斯-高斯模板
+                          short pixi = -p(-2, 0)
+                                     - p(-1, -1) - 2 * p(-1, 0) - p(-1, 1)
+                                     - p(0, -2) - 2 * p(0, -1) + 16 * p(0, 0) - 2 * p(0, 1) - p(0, 2)
+                                     - p(1, -1) - 2 * p(1, 0) - p(1, 1)
+                                     - p(2, 0);
+
+                          return static_cast<uchar>(pixi > 255 ? 255 : pixi < 0 ? 0
+                                                                                : pixi);
+                      });
 }
 
-}    // namespace hl
\ No newline at end of file
+}    // namespace hl
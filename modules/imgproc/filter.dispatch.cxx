@@ -141,4 +141,92 @@ void FilterEngine::apply(const Mat& src, Mat& dst, const Size& wsz, const Point&
     cpu_baseline ::FilterEngine__apply(*this, src, dst, wsz, ofs);
 }
 
+/****************************************************************************************\
+                                  Virtual Image Border
+\****************************************************************************************/
+
+BorderRowAccessor::BorderRowAccessor():
+    data(0), step(0), size(0, 0), wholeSize(0, 0), borderType(BORDER_REPLICATE), elemSize(0), cn(0), left(0), right(0)
+{
+}
+
+BorderRowAccessor::BorderRowAccessor(const Mat& src, int _borderType, int _left, int _right, const Scalar& _borderValue)
+{
+    init(src, _borderType, _left, _right, _borderValue);
+}
+
+void BorderRowAccessor::init(const Mat& src, int _borderType, int _left, int _right, const Scalar& _borderValue)
+{
+    HL_Assert(!src.empty() && src.dims <= 2 && _left >= 0 && _right >= 0);
+
+    data       = src.ptr();
+    step       = src.step;
+    size       = src.size();
+    wholeSize  = size;
+    ofs        = Point();
+    borderType = _borderType & ~BORDER_ISOLATED;
+    elemSize   = (int)src.elemSize();
+    cn         = src.channels();
+    left       = _left;
+    right      = _right;
+
+    HL_Assert(borderType != BORDER_TRANSPARENT);
+
+    if (!(_borderType & BORDER_ISOLATED))
+        src.locateROI(wholeSize, ofs);
+
+    // the element of the whole row read by each border column, -1 for the constant border
+    borderTab.resize(left + right);
+    for (int i = 0; i < left; i++)
+        borderTab[i] = borderInterpolate(ofs.x + i - left, wholeSize.width, borderType);
+    for (int i = 0; i < right; i++)
+        borderTab[left + i] = borderInterpolate(ofs.x + size.width + i, wholeSize.width, borderType);
+
+    constBorderRow.clear();
+    if (borderType == BORDER_CONSTANT)
+    {
+        int len = left + size.width + right;
+        constBorderRow.resize(len * elemSize);
+        int srcType1 = HL_MAKETYPE(src.depth(), MIN(src.channels(), 4));
+        scalarToRawData(_borderValue, &constBorderRow[0], srcType1, len * cn);
+    }
+}
+
+void BorderRowAccessor::extendRow(int y, uchar* buf) const
+{
+    const uchar* src = row(y);
+    int          esz = elemSize;
+
+    if (borderType == BORDER_CONSTANT && src == &constBorderRow[left * esz])
+    {
+        memcpy(buf, &constBorderRow[0], constBorderRow.size());
+        return;
+    }
+
+    memcpy(buf + left * esz, src, size.width * esz);
+
+    // the border columns are read from the whole row, which starts ofs.x elements before src
+    const uchar* wrow = src - (ptrdiff_t)ofs.x * esz;
+    for (int i = 0; i < left + right; i++)
+    {
+        const uchar* p = borderTab[i] >= 0 ? wrow + borderTab[i] * esz : &constBorderRow[0];
+        uchar*       d = buf + (i < left ? i : size.width + i) * esz;
+        for (int k = 0; k < esz; k++)
+            d[k] = p[k];
+    }
+}
+
+void BorderRowAccessor::columnTab(int* tab, int x0, int count) const
+{
+    HL_Assert(borderType != BORDER_CONSTANT);
+
+    for (int t = 0; t < count; t++)
+    {
+        int sx = x0 + t + ofs.x;
+        if ((unsigned)sx >= (unsigned)wholeSize.width)
+            sx = borderInterpolate(sx, wholeSize.width, borderType);
+        tab[t] = (sx - ofs.x) * cn;
+    }
+}
+
 }    // namespace hl
\ No newline at end of file
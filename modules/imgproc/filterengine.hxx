@@ -135,4 +135,68 @@ public:
     Ptr<BaseColumnFilter> columnFilter;
 };
 
+/**
+ * Reads an image as if it were padded with a border, without building the padded copy. The rows
+ * outside of the image are mapped to the source rows (or to a constant row) and the columns outside
+ * of it through a border table, in the same way as in FilterEngine. The border of a submatrix is
+ * taken from its parent image, unless BORDER_ISOLATED is set.
+ *
+ * The kernels read the interior of the rows directly and send only the border columns through the
+ * slow ptr() path, or assemble the few rows they need with extendRow().
+ */
+class BorderRowAccessor
+{
+public:
+    //! the default constructor
+    BorderRowAccessor();
+    //! the full constructor. left and right are the widths of the horizontal border built by extendRow().
+    BorderRowAccessor(const Mat& src, int borderType, int left = 0, int right = 0, const Scalar& borderValue = Scalar());
+    //! reinitializes the accessor
+    void init(const Mat& src, int borderType, int left = 0, int right = 0, const Scalar& borderValue = Scalar());
+
+    //! returns the row y of the image, the rows outside of the image are interpolated
+    const uchar* row(int y) const
+    {
+        int sy = y + ofs.y;
+        if ((unsigned)sy >= (unsigned)wholeSize.height)
+        {
+            sy = borderInterpolate(sy, wholeSize.height, borderType);
+            if (sy < 0)
+                return &constBorderRow[left * elemSize];
+        }
+        return data + (ptrdiff_t)(sy - ofs.y) * step;
+    }
+
+    //! returns the element (x, y), both coordinates are interpolated
+    const uchar* ptr(int y, int x) const
+    {
+        int sx = x + ofs.x, sy = y + ofs.y;
+        if ((unsigned)sx >= (unsigned)wholeSize.width)
+            sx = borderInterpolate(sx, wholeSize.width, borderType);
+        if ((unsigned)sy >= (unsigned)wholeSize.height)
+            sy = borderInterpolate(sy, wholeSize.height, borderType);
+        if (sx < 0 || sy < 0)
+            return &constBorderRow[0];
+        return data + (ptrdiff_t)(sy - ofs.y) * step + (ptrdiff_t)(sx - ofs.x) * elemSize;
+    }
+
+    //! copies the row y with left and right border elements to buf, which must hold left + cols + right elements
+    void extendRow(int y, uchar* buf) const;
+    //! fills tab[t] with the offset of the column x0 + t from the row start in channels. Not for BORDER_CONSTANT.
+    void columnTab(int* tab, int x0, int count) const;
+
+    const uchar*       data;
+    size_t             step;
+    Size               size;
+    Size               wholeSize;
+    Point              ofs;
+    int                borderType;
+    int                elemSize;
+    int                cn;
+    int                left;
+    int                right;
+    std::vector<int>   borderTab;
+    std::vector<uchar> constBorderRow;
+};
+
 }    // namespace hl
\ No newline at end of file
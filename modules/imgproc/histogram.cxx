@@ -1,4 +1,5 @@
 #include "precomp.hxx"
+#include "histogram.hxx"
 #include <iostream>
 
 namespace hl
@@ -469,8 +470,9 @@ static void calcHist_8u(std::vector<uchar*>& _ptrs, const std::vector<int>& _del
     if (dims == 1)
     {
         int d0 = deltas[0], step0 = deltas[1];
-        int matH[256] = {
-            0,
+        // 4 interleaved tables, so that runs of equal values do not wait for the previous increment of the same counter
+        int matH[4][256] = {
+            {0},
         };
         const uchar* p0 = (const uchar*)ptrs[0];
 
@@ -480,15 +482,21 @@ static void calcHist_8u(std::vector<uchar*>& _ptrs, const std::vector<int>& _del
             {
                 if (d0 == 1)
                 {
-                    for (x = 0; x <= imsize.width - 4; x += 4)
+                    for (x = 0; x <= imsize.width - 8; x += 8)
                     {
-                        int t0 = p0[x], t1 = p0[x + 1];
-                        matH[t0]++;
-                        matH[t1]++;
-                        t0 = p0[x + 2];
-                        t1 = p0[x + 3];
-                        matH[t0]++;
-                        matH[t1]++;
+                        int t0 = p0[x], t1 = p0[x + 1], t2 = p0[x + 2], t3 = p0[x + 3];
+                        matH[0][t0]++;
+                        matH[1][t1]++;
+                        matH[2][t2]++;
+                        matH[3][t3]++;
+                        t0 = p0[x + 4];
+                        t1 = p0[x + 5];
+                        t2 = p0[x + 6];
+                        t3 = p0[x + 7];
+                        matH[0][t0]++;
+                        matH[1][t1]++;
+                        matH[2][t2]++;
+                        matH[3][t3]++;
                     }
                     p0 += x;
                 }
@@ -496,30 +504,30 @@ static void calcHist_8u(std::vector<uchar*>& _ptrs, const std::vector<int>& _del
                     for (x = 0; x <= imsize.width - 4; x += 4)
                     {
                         int t0 = p0[0], t1 = p0[d0];
-                        matH[t0]++;
-                        matH[t1]++;
+                        matH[0][t0]++;
+                        matH[1][t1]++;
                         p0 += d0 * 2;
                         t0  = p0[0];
                         t1  = p0[d0];
-                        matH[t0]++;
-                        matH[t1]++;
+                        matH[2][t0]++;
+                        matH[3][t1]++;
                         p0 += d0 * 2;
                     }
 
                 for (; x < imsize.width; x++, p0 += d0)
-                    matH[*p0]++;
+                    matH[0][*p0]++;
             }
             else
                 for (x = 0; x < imsize.width; x++, p0 += d0)
                     if (mask[x])
-                        matH[*p0]++;
+                        matH[x & 3][*p0]++;
         }
 
         for (int i = 0; i < 256; i++)
         {
             size_t hidx = tab[i];
             if (hidx < OUT_OF_RANGE)
-                *(int*)(H + hidx) += matH[i];
+                *(int*)(H + hidx) += matH[0][i] + matH[1][i] + matH[2][i] + matH[3][i];
         }
     }
     else if (dims == 2)
@@ -626,6 +634,77 @@ static void calcHist_8u(std::vector<uchar*>& _ptrs, const std::vector<int>& _del
     }
 }
 
+/*
+ * The pixels are split into stripes of rows, or into stripes of pixels when all the planes are
+ * continuous and imsize has been collapsed to a single row. Every stripe is counted into its own
+ * integer histogram, which is added to the shared one under the lock at the end.
+ */
+class CalcHist_Invoker: public ParallelLoopBody
+{
+public:
+    CalcHist_Invoker(const std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas, Size _imsize, Mat& _hist, int _dims, const float** _ranges, const double* _uniranges, bool _uniform, int _depth, Mutex* _histLock):
+        ParallelLoopBody(), ptrs(_ptrs), deltas(_deltas), imsize(_imsize), hist(_hist), dims(_dims), ranges(_ranges), uniranges(_uniranges), uniform(_uniform), depth(_depth), histLock(_histLock)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        std::vector<uchar*> sptrs(ptrs);
+        Size                size = imsize;
+        size_t              esz1 = HL_ELEM_SIZE1(depth);
+
+        if (imsize.height == 1)
+        {
+            size.width = range.end - range.start;
+            for (int i = 0; i < dims; i++)
+                sptrs[i] += (size_t)range.start * deltas[i * 2] * esz1;
+            if (sptrs[dims])
+                sptrs[dims] += range.start;
+        }
+        else
+        {
+            size.height = range.end - range.start;
+            for (int i = 0; i < dims; i++)
+                sptrs[i] += (size_t)range.start * (imsize.width * deltas[i * 2] + deltas[i * 2 + 1]) * esz1;
+            if (sptrs[dims])
+                sptrs[dims] += (size_t)range.start * deltas[dims * 2 + 1];
+        }
+
+        Mat lhist(hist.dims, hist.size.p, HL_32S, Scalar(0));
+
+        if (depth == HL_8U)
+            calcHist_8u(sptrs, deltas, size, lhist, dims, ranges, uniranges, uniform);
+        else if (depth == HL_16U)
+            calcHist_<ushort>(sptrs, deltas, size, lhist, dims, ranges, uniranges, uniform);
+        else
+            calcHist_<float>(sptrs, deltas, size, lhist, dims, ranges, uniranges, uniform);
+
+        const int* L     = lhist.ptr<int>();
+        int*       H     = hist.ptr<int>();
+        size_t     total = hist.total();
+
+        AutoLock lock(*histLock);
+
+        for (size_t i = 0; i < total; i++)
+            H[i] += L[i];
+    }
+
+private:
+    const std::vector<uchar*>& ptrs;
+    const std::vector<int>&    deltas;
+    Size                       imsize;
+    Mat&                       hist;
+    int                        dims;
+    const float**              ranges;
+    const double*              uniranges;
+    bool                       uniform;
+    int                        depth;
+    Mutex*                     histLock;
+
+    CalcHist_Invoker(const CalcHist_Invoker&);                     // = delete;
+    const CalcHist_Invoker& operator=(const CalcHist_Invoker&);    // = delete;
+};
+
 void drawHist_T(const Mat& hist, Mat& histImage, uint width, uint height, uchar thresh)
 {
     Mat hist_norm;
@@ -701,13 +780,16 @@ void hl::calcHist(const Mat* images, int nimages, const int* channels, const Mat
     if (histdata != hist.data)
         accumulate = false;
 
-    Mat ihist   = hist;
-    ihist.flags = (ihist.flags & ~HL_MAT_TYPE_MASK) | HL_32S;
-
+    // the counts are integers, without accumulate they are taken in place and converted at the end
+    Mat ihist;
     if (!accumulate)
-        hist = Scalar(0.);
+    {
+        ihist       = hist;
+        ihist.flags = (ihist.flags & ~HL_MAT_TYPE_MASK) | HL_32S;
+        hist        = Scalar(0.);
+    }
     else
-        hist.convertTo(ihist, HL_32S);
+        ihist = Mat(hist.dims, hist.size.p, HL_32S, Scalar(0));
 
     std::vector<uchar*> ptrs;
     std::vector<int>    deltas;
@@ -720,149 +802,28 @@ void hl::calcHist(const Mat* images, int nimages, const int* channels, const Mat
 
     int depth                = images[0].depth();
 
-    if (depth == HL_8U)
-        calcHist_8u(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform);
-    else if (depth == HL_16U)
-        calcHist_<ushort>(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform);
-    else if (depth == HL_32F)
-        calcHist_<float>(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform);
-    else
+    if (depth != HL_8U && depth != HL_16U && depth != HL_32F)
         HL_Error(HL_StsUnsupportedFormat, "");
 
-    ihist.convertTo(hist, HL_32F);
+    // every stripe clears and merges a whole histogram, so large histograms get fewer stripes
+    double           pixels   = (double)imsize.width * imsize.height;
+    double           nstripes = std::min((double)getNumThreads(), pixels / std::max((double)(1 << 16), 4. * ihist.total()));
+    Mutex            histLock;
+    CalcHist_Invoker body(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform, depth, &histLock);
+    parallel_for_(Range(0, imsize.height == 1 ? imsize.width : imsize.height), body, nstripes);
+
+    // the counts are converted (in place, without accumulate) or added to the previous ones in a single pass
+    float*     H     = hist.ptr<float>();
+    const int* I     = ihist.ptr<int>();
+    size_t     total = hist.total();
+    if (!accumulate)
+        for (size_t i = 0; i < total; i++)
+            H[i] = (float)I[i];
+    else
+        for (size_t i = 0; i < total; i++)
+            H[i] += (float)I[i];
 }
 
-class EqualizeHistCalcHist_Invoker: public hl::ParallelLoopBody
-{
-public:
-    enum
-    {
-        HIST_SZ = 256
-    };
-
-    EqualizeHistCalcHist_Invoker(hl::Mat& src, int* histogram, hl::Mutex* histogramLock):
-        src_(src), globalHistogram_(histogram), histogramLock_(histogramLock)
-    {}
-
-    void operator()(const hl::Range& rowRange) const override
-    {
-        int localHistogram[HIST_SZ] = {
-            0,
-        };
-
-        const size_t sstep = src_.step;
-
-        int width          = src_.cols;
-        int height         = rowRange.end - rowRange.start;
-
-        if (src_.isContinuous())
-        {
-            width  *= height;
-            height  = 1;
-        }
-
-        for (const uchar* ptr = src_.ptr<uchar>(rowRange.start); height--; ptr += sstep)
-        {
-            int x = 0;
-            for (; x <= width - 4; x += 4)
-            {
-                int t0 = ptr[x], t1 = ptr[x + 1];
-                localHistogram[t0]++;
-                localHistogram[t1]++;
-                t0 = ptr[x + 2];
-                t1 = ptr[x + 3];
-                localHistogram[t0]++;
-                localHistogram[t1]++;
-            }
-
-            for (; x < width; ++x)
-                localHistogram[ptr[x]]++;
-        }
-
-        hl::AutoLock lock(*histogramLock_);
-
-        for (int i = 0; i < HIST_SZ; i++)
-            globalHistogram_[i] += localHistogram[i];
-    }
-
-    static bool isWorthParallel(const hl::Mat& src)
-    {
-        return (src.total() >= 640 * 480);
-    }
-
-private:
-    EqualizeHistCalcHist_Invoker& operator=(const EqualizeHistCalcHist_Invoker&);
-
-    hl::Mat&   src_;
-    int*       globalHistogram_;
-    hl::Mutex* histogramLock_;
-};
-
-class EqualizeHistLut_Invoker: public hl::ParallelLoopBody
-{
-public:
-    EqualizeHistLut_Invoker(hl::Mat& src, hl::Mat& dst, int* lut):
-        src_(src),
-        dst_(dst),
-        lut_(lut)
-    {}
-
-    void operator()(const hl::Range& rowRange) const override
-    {
-        const size_t sstep = src_.step;
-        const size_t dstep = dst_.step;
-
-        int  width         = src_.cols;
-        int  height        = rowRange.end - rowRange.start;
-        int* lut           = lut_;
-
-        if (src_.isContinuous() && dst_.isContinuous())
-        {
-            width  *= height;
-            height  = 1;
-        }
-
-        const uchar* sptr = src_.ptr<uchar>(rowRange.start);
-        uchar*       dptr = dst_.ptr<uchar>(rowRange.start);
-
-        for (; height--; sptr += sstep, dptr += dstep)
-        {
-            int x = 0;
-            for (; x <= width - 4; x += 4)
-            {
-                int v0      = sptr[x];
-                int v1      = sptr[x + 1];
-                int x0      = lut[v0];
-                int x1      = lut[v1];
-                dptr[x]     = (uchar)x0;
-                dptr[x + 1] = (uchar)x1;
-
-                v0          = sptr[x + 2];
-                v1          = sptr[x + 3];
-                x0          = lut[v0];
-                x1          = lut[v1];
-                dptr[x + 2] = (uchar)x0;
-                dptr[x + 3] = (uchar)x1;
-            }
-
-            for (; x < width; ++x)
-                dptr[x] = (uchar)lut[sptr[x]];
-        }
-    }
-
-    static bool isWorthParallel(const hl::Mat& src)
-    {
-        return (src.total() >= 640 * 480);
-    }
-
-private:
-    EqualizeHistLut_Invoker& operator=(const EqualizeHistLut_Invoker&);
-
-    hl::Mat& src_;
-    hl::Mat& dst_;
-    int*     lut_;
-};
-
 void hl::equalizeHist(const Mat& _src, Mat& _dst)
 {
     HL_Assert(_src.type() == HL_8UC1);
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "openHL/imgproc.hxx"
+#include "openHL/core/utility.hxx"
+
+namespace hl
+{
+
+/*
+ * Counts the 8-bit pixels of the rows of src into a local histogram, which is added to the shared
+ * one under the lock. The pixels go to 4 interleaved tables, so that runs of equal values do not
+ * wait for the previous increment of the same counter.
+ */
+class EqualizeHistCalcHist_Invoker: public ParallelLoopBody
+{
+public:
+    enum
+    {
+        HIST_SZ = 256
+    };
+
+    EqualizeHistCalcHist_Invoker(const Mat& src, int* histogram, Mutex* histogramLock):
+        src_(src), globalHistogram_(histogram), histogramLock_(histogramLock)
+    {}
+
+    void operator()(const Range& rowRange) const override
+    {
+        int localHistogram[4][HIST_SZ] = {
+            {0},
+        };
+
+        const size_t sstep = src_.step;
+
+        int width          = src_.cols;
+        int height         = rowRange.end - rowRange.start;
+
+        if (src_.isContinuous())
+        {
+            width  *= height;
+            height  = 1;
+        }
+
+        for (const uchar* ptr = src_.ptr<uchar>(rowRange.start); height--; ptr += sstep)
+        {
+            int x = 0;
+            for (; x <= width - 4; x += 4)
+            {
+                int t0 = ptr[x], t1 = ptr[x + 1], t2 = ptr[x + 2], t3 = ptr[x + 3];
+                localHistogram[0][t0]++;
+                localHistogram[1][t1]++;
+                localHistogram[2][t2]++;
+                localHistogram[3][t3]++;
+            }
+
+            for (; x < width; ++x)
+                localHistogram[0][ptr[x]]++;
+        }
+
+        AutoLock lock(*histogramLock_);
+
+        for (int i = 0; i < HIST_SZ; i++)
+            globalHistogram_[i] += localHistogram[0][i] + localHistogram[1][i] + localHistogram[2][i] + localHistogram[3][i];
+    }
+
+    static bool isWorthParallel(const Mat& src)
+    {
+        return (src.total() >= 640 * 480);
+    }
+
+private:
+    EqualizeHistCalcHist_Invoker& operator=(const EqualizeHistCalcHist_Invoker&);
+
+    const Mat& src_;
+    int*       globalHistogram_;
+    Mutex*     histogramLock_;
+};
+
+/*
+ * Maps the 8-bit pixels of the rows of src through lut into dst, which may be src.
+ */
+class EqualizeHistLut_Invoker: public ParallelLoopBody
+{
+public:
+    EqualizeHistLut_Invoker(const Mat& src, Mat& dst, const int* lut):
+        src_(src),
+        dst_(dst),
+        lut_(lut)
+    {}
+
+    void operator()(const Range& rowRange) const override
+    {
+        const size_t sstep = src_.step;
+        const size_t dstep = dst_.step;
+
+        int        width   = src_.cols;
+        int        height  = rowRange.end - rowRange.start;
+        const int* lut     = lut_;
+
+        if (src_.isContinuous() && dst_.isContinuous())
+        {
+            width  *= height;
+            height  = 1;
+        }
+
+        const uchar* sptr = src_.ptr<uchar>(rowRange.start);
+        uchar*       dptr = dst_.ptr<uchar>(rowRange.start);
+
+        for (; height--; sptr += sstep, dptr += dstep)
+        {
+            int x = 0;
+            for (; x <= width - 4; x += 4)
+            {
+                int v0      = sptr[x];
+                int v1      = sptr[x + 1];
+                int x0      = lut[v0];
+                int x1      = lut[v1];
+                dptr[x]     = (uchar)x0;
+                dptr[x + 1] = (uchar)x1;
+
+                v0          = sptr[x + 2];
+                v1          = sptr[x + 3];
+                x0          = lut[v0];
+                x1          = lut[v1];
+                dptr[x + 2] = (uchar)x0;
+                dptr[x + 3] = (uchar)x1;
+            }
+
+            for (; x < width; ++x)
+                dptr[x] = (uchar)lut[sptr[x]];
+        }
+    }
+
+    static bool isWorthParallel(const Mat& src)
+    {
+        return (src.total() >= 640 * 480);
+    }
+
+private:
+    EqualizeHistLut_Invoker& operator=(const EqualizeHistLut_Invoker&);
+
+    const Mat& src_;
+    Mat&       dst_;
+    const int* lut_;
+};
+
+}    // namespace hl
@@ -1,6 +1,7 @@
 #include "precomp.hxx"
 #include "openHL/core/hal/intrin.hxx"
 #include "openHL/core/softfloat.hxx"
+#include <mutex>
 
 using namespace hl;
 
@@ -88,67 +89,78 @@ static void initInterTab1D(int method, float* tab, int tabsz)
         HL_Error(hl::Error::StsBadArg, "Unknown interpolation method");
 }
 
-const static void* initInterTab2D(int method, bool fixpt)
+static void initInterTab2D(int method, float* tab, short* itab, int ksize)
 {
-    static bool inittab[INTER_MAX + 1] = {false};
-    float*      tab                    = 0;
-    short*      itab                   = 0;
-    int         ksize                  = 0;
-    if (method == INTER_LINEAR)
-        tab = BilinearTab_f[0][0], itab = BilinearTab_i[0][0], ksize = 2;
-    else if (method == INTER_CUBIC)
-        tab = BicubicTab_f[0][0], itab = BicubicTab_i[0][0], ksize = 4;
-    else if (method == INTER_LANCZOS4)
-        tab = Lanczos4Tab_f[0][0], itab = Lanczos4Tab_i[0][0], ksize = 8;
-    else
-        HL_Error(hl::Error::StsBadArg, "Unknown/unsupported interpolation type");
+    AutoBuffer<float> _tab(8 * INTER_TAB_SIZE);
+    int               i, j, k1, k2;
+    initInterTab1D(method, _tab.data(), INTER_TAB_SIZE);
+    for (i = 0; i < INTER_TAB_SIZE; i++)
+        for (j = 0; j < INTER_TAB_SIZE; j++, tab += ksize * ksize, itab += ksize * ksize)
+        {
+            int isum = 0;
 
-    if (!inittab[method])
-    {
-        AutoBuffer<float> _tab(8 * INTER_TAB_SIZE);
-        int               i, j, k1, k2;
-        initInterTab1D(method, _tab.data(), INTER_TAB_SIZE);
-        for (i = 0; i < INTER_TAB_SIZE; i++)
-            for (j = 0; j < INTER_TAB_SIZE; j++, tab += ksize * ksize, itab += ksize * ksize)
+            for (k1 = 0; k1 < ksize; k1++)
             {
-                int isum                                = 0;
-                NNDeltaTab_i[i * INTER_TAB_SIZE + j][0] = j < INTER_TAB_SIZE / 2;
-                NNDeltaTab_i[i * INTER_TAB_SIZE + j][1] = i < INTER_TAB_SIZE / 2;
-
-                for (k1 = 0; k1 < ksize; k1++)
+                float vy = _tab[i * ksize + k1];
+                for (k2 = 0; k2 < ksize; k2++)
                 {
-                    float vy = _tab[i * ksize + k1];
-                    for (k2 = 0; k2 < ksize; k2++)
-                    {
-                        float v               = vy * _tab[j * ksize + k2];
-                        tab[k1 * ksize + k2]  = v;
-                        isum += itab[k1 * ksize + k2] = saturate_cast<short>(v * INTER_REMAP_COEF_SCALE);
-                    }
+                    float v               = vy * _tab[j * ksize + k2];
+                    tab[k1 * ksize + k2]  = v;
+                    isum += itab[k1 * ksize + k2] = saturate_cast<short>(v * INTER_REMAP_COEF_SCALE);
                 }
+            }
 
-                if (isum != INTER_REMAP_COEF_SCALE)
-                {
-                    int diff   = isum - INTER_REMAP_COEF_SCALE;
-                    int ksize2 = ksize / 2, Mk1 = ksize2, Mk2 = ksize2, mk1 = ksize2, mk2 = ksize2;
-                    for (k1 = ksize2; k1 < ksize2 + 2; k1++)
-                        for (k2 = ksize2; k2 < ksize2 + 2; k2++)
-                        {
-                            if (itab[k1 * ksize + k2] < itab[mk1 * ksize + mk2])
-                                mk1 = k1, mk2 = k2;
-                            else if (itab[k1 * ksize + k2] > itab[Mk1 * ksize + Mk2])
-                                Mk1 = k1, Mk2 = k2;
-                        }
-                    if (diff < 0)
-                        itab[Mk1 * ksize + Mk2] = (short)(itab[Mk1 * ksize + Mk2] - diff);
-                    else
-                        itab[mk1 * ksize + mk2] = (short)(itab[mk1 * ksize + mk2] - diff);
-                }
+            if (isum != INTER_REMAP_COEF_SCALE)
+            {
+                int diff   = isum - INTER_REMAP_COEF_SCALE;
+                int ksize2 = ksize / 2, Mk1 = ksize2, Mk2 = ksize2, mk1 = ksize2, mk2 = ksize2;
+                for (k1 = ksize2; k1 < ksize2 + 2; k1++)
+                    for (k2 = ksize2; k2 < ksize2 + 2; k2++)
+                    {
+                        if (itab[k1 * ksize + k2] < itab[mk1 * ksize + mk2])
+                            mk1 = k1, mk2 = k2;
+                        else if (itab[k1 * ksize + k2] > itab[Mk1 * ksize + Mk2])
+                            Mk1 = k1, Mk2 = k2;
+                    }
+                if (diff < 0)
+                    itab[Mk1 * ksize + Mk2] = (short)(itab[Mk1 * ksize + Mk2] - diff);
+                else
+                    itab[mk1 * ksize + mk2] = (short)(itab[mk1 * ksize + mk2] - diff);
             }
-        tab             -= INTER_TAB_SIZE2 * ksize * ksize;
-        itab            -= INTER_TAB_SIZE2 * ksize * ksize;
-        inittab[method]  = true;
-    }
-    return fixpt ? (const void*)itab : (const void*)tab;
+        }
+}
+
+/*
+ * The tables of all the methods are built together, once, the first time one of them is
+ * requested, so that the remap and warp calls of several threads never see them half built.
+ */
+static void initInterTabs2D()
+{
+    for (int i = 0; i < INTER_TAB_SIZE; i++)
+        for (int j = 0; j < INTER_TAB_SIZE; j++)
+        {
+            NNDeltaTab_i[i * INTER_TAB_SIZE + j][0] = j < INTER_TAB_SIZE / 2;
+            NNDeltaTab_i[i * INTER_TAB_SIZE + j][1] = i < INTER_TAB_SIZE / 2;
+        }
+
+    initInterTab2D(INTER_LINEAR, BilinearTab_f[0][0], BilinearTab_i[0][0], 2);
+    initInterTab2D(INTER_CUBIC, BicubicTab_f[0][0], BicubicTab_i[0][0], 4);
+    initInterTab2D(INTER_LANCZOS4, Lanczos4Tab_f[0][0], Lanczos4Tab_i[0][0], 8);
+}
+
+const static void* initInterTab2D(int method, bool fixpt)
+{
+    static std::once_flag initFlag;
+    std::call_once(initFlag, initInterTabs2D);
+
+    if (method == INTER_LINEAR)
+        return fixpt ? (const void*)BilinearTab_i[0][0] : (const void*)BilinearTab_f[0][0];
+    else if (method == INTER_CUBIC)
+        return fixpt ? (const void*)BicubicTab_i[0][0] : (const void*)BicubicTab_f[0][0];
+    else if (method == INTER_LANCZOS4)
+        return fixpt ? (const void*)Lanczos4Tab_i[0][0] : (const void*)Lanczos4Tab_f[0][0];
+    else
+        HL_Error(hl::Error::StsBadArg, "Unknown/unsupported interpolation type");
 }
 
 template <typename ST, typename DT>
@@ -293,8 +305,140 @@ struct RemapNoVec
     int operator()(const Mat&, void*, const short*, const ushort*, const void*, int, hl::Point&) const { return 0; }
 };
 
+#if HL_SIMD128
+
+template <typename _Tp>
+static inline _Tp load_unaligned(const uchar* ptr)
+{
+    _Tp v;
+    memcpy(&v, ptr, sizeof(v));
+    return v;
+}
+
+//! the unshifted blend of the channels of one pixel, w are its 4 weights of BilinearTab_i
+template <int cn>
+static inline v_int32x4 remapBilinearPixel_8u(const uchar* S, size_t sstep, const short* w)
+{
+    v_int16x8 w0((v_int16x8::vector_type)v_setall(load_unaligned<uint>((const uchar*)w)).val);
+    v_int16x8 w1((v_int16x8::vector_type)v_setall(load_unaligned<uint>((const uchar*)(w + 2))).val);
+    return v_add_wrap(v_dotprod(v_load_expand_pair<cn>(S), w0), v_dotprod(v_load_expand_pair<cn>(S + sstep), w1));
+}
+
+/*
+ * The 8-bit bilinear kernel for the runs of pixels whose 4 taps are all inside the source. The pixel
+ * pairs of the two source rows are widened to 16 bits next to their weights, so v_dotprod gives the
+ * same integer sums as the scalar loop and the results are bit-exact. The gathers stay scalar.
+ */
+template <bool isRelative>
+struct RemapVec_8u
+{
+    int operator()(const Mat& _src, void* _dst, const short* XY, const ushort* FXY, const void* _wtab, int width, hl::Point& _offset) const
+    {
+        const int    cn    = _src.channels();
+        const uchar* S0    = _src.ptr();
+        size_t       sstep = _src.step;
+        const short* wtab  = (const short*)_wtab;
+        uchar*       D     = (uchar*)_dst;
+        const int    off_y = isRelative ? _offset.y : 0;
+
+        const v_int32x4 delta = v_setall_s32(INTER_REMAP_COEF_SCALE / 2);
+
+        int x = 0;
+        if (cn == 1)
+        {
+            typedef v_reg<ushort, 4> v_uint16x4;
+
+            for (; x <= width - v_int16x8::nlanes; x += v_int16x8::nlanes)
+            {
+                v_int32x4 r[2];
+                for (int k = 0; k < 2; k++)
+                {
+                    const uchar* S[4];
+                    const short* w[4];
+                    for (int i = 0; i < 4; i++)
+                    {
+                        const int j = x + k * 4 + i;
+                        int       sx = XY[j * 2] + (isRelative ? (_offset.x + j) : 0), sy = XY[j * 2 + 1] + off_y;
+                        S[i]         = S0 + sy * sstep + sx;
+                        w[i]         = wtab + FXY[j] * 4;
+                    }
+
+                    v_uint16x4 p0(v_uint16x4::vector_type{load_unaligned<ushort>(S[0]), load_unaligned<ushort>(S[1]), load_unaligned<ushort>(S[2]), load_unaligned<ushort>(S[3])});
+                    v_uint16x4 p1(v_uint16x4::vector_type{load_unaligned<ushort>(S[0] + sstep), load_unaligned<ushort>(S[1] + sstep), load_unaligned<ushort>(S[2] + sstep), load_unaligned<ushort>(S[3] + sstep)});
+                    v_int16x8  w0((v_int16x8::vector_type)v_uint32x4::vector_type{load_unaligned<uint>((const uchar*)w[0]), load_unaligned<uint>((const uchar*)w[1]), load_unaligned<uint>((const uchar*)w[2]), load_unaligned<uint>((const uchar*)w[3])});
+                    v_int16x8  w1((v_int16x8::vector_type)v_uint32x4::vector_type{load_unaligned<uint>((const uchar*)(w[0] + 2)), load_unaligned<uint>((const uchar*)(w[1] + 2)), load_unaligned<uint>((const uchar*)(w[2] + 2)), load_unaligned<uint>((const uchar*)(w[3] + 2))});
+
+                    v_int32x4 s0 = v_dotprod(v_convert<short>(v_reg<uchar, 8>((v_reg<uchar, 8>::vector_type)p0.val)), w0);
+                    v_int32x4 s1 = v_dotprod(v_convert<short>(v_reg<uchar, 8>((v_reg<uchar, 8>::vector_type)p1.val)), w1);
+                    r[k]         = v_shr<INTER_REMAP_COEF_BITS>(v_add_wrap(v_add_wrap(s0, s1), delta));
+                }
+                v_int16x8 r16 = v_pack(r[0], r[1]);
+                v_store(D + x, v_get_low(v_pack_u(r16, r16)));
+            }
+        }
+        else if (cn == 3 || cn == 4)
+        {
+            // a 3-channel pixel is stored with 4 bytes, the extra one is overwritten by the next
+            // pixel, so the last pixel of the run is always left to the scalar loop
+            for (; x <= width - 4 - (cn == 3); x += 4)
+            {
+                v_int32x4 r[4];
+                for (int i = 0; i < 4; i++)
+                {
+                    const int    j  = x + i;
+                    int          sx = XY[j * 2] + (isRelative ? (_offset.x + j) : 0), sy = XY[j * 2 + 1] + off_y;
+                    const uchar* S  = S0 + sy * sstep + sx * cn;
+                    const short* w  = wtab + FXY[j] * 4;
+                    v_int32x4    s  = cn == 3 ? remapBilinearPixel_8u<3>(S, sstep, w) : remapBilinearPixel_8u<4>(S, sstep, w);
+                    r[i]            = v_shr<INTER_REMAP_COEF_BITS>(v_add_wrap(s, delta));
+                }
+                v_uint8x16 d = v_pack_u(v_pack(r[0], r[1]), v_pack(r[2], r[3]));
+                if (cn == 4)
+                    v_store(D + x * 4, d);
+                else
+                {
+                    v_uint32x4::vector_type d32 = (v_uint32x4::vector_type)d.val;
+                    for (int i = 0; i < 4; i++)
+                        memcpy(D + (x + i) * 3, &d32[i], sizeof(uint));
+                }
+            }
+        }
+        return x;
+    }
+};
+
+/*
+ * Skips the blocks of 4 points inside [0, width1) x [0, height1), starting at dx, and returns the
+ * first point of the block that is not.
+ */
+template <bool isRelative>
+static int skipInlierBlocks(const short* XY, int dx, int width, unsigned width1, unsigned height1, int off_x, int off_y)
+{
+    const v_int16x8  selx(v_int16x8::vector_type{1, 0, 1, 0, 1, 0, 1, 0});
+    const v_int16x8  sely(v_int16x8::vector_type{0, 1, 0, 1, 0, 1, 0, 1});
+    const v_uint32x4 vw = v_setall(width1), vh = v_setall(height1);
+    const v_int32x4  vy = v_setall_s32(off_y);
+    v_int32x4        vx(v_int32x4::vector_type{0, 1, 2, 3});
+    vx = v_add_wrap(vx, v_setall_s32(isRelative ? off_x + dx : 0));
+
+    for (; dx <= width - v_int32x4::nlanes; dx += v_int32x4::nlanes)
+    {
+        v_int16x8  xy = v_load(XY + dx * 2);
+        v_uint32x4 sx = v_convert<uint>(v_add_wrap(v_dotprod(xy, selx), isRelative ? vx : v_setall_s32(0)));
+        v_uint32x4 sy = v_convert<uint>(v_add_wrap(v_dotprod(xy, sely), vy));
+        if (!v_check_all(v_min(sx < vw, sy < vh)))
+            break;
+        vx = v_add_wrap(vx, v_setall_s32(v_int32x4::nlanes));
+    }
+    return dx;
+}
+
+#else
+
 template <bool isRelative> using RemapVec_8u = RemapNoVec<isRelative>;
 
+#endif
+
 template <class CastOp, class VecOp, typename AT, bool isRelative>
 static void remapBilinear(const Mat& _src, Mat& _dst, const Mat& _xy, const Mat& _fxy, const void* _wtab, int borderType, const Scalar& _borderValue, const Point& _offset)
 {
@@ -325,6 +469,11 @@ static void remapBilinear(const Mat& _src, Mat& _dst, const Mat& _xy, const Mat&
         const int     off_y      = (isRelative ? (_offset.y + dy) : 0);
         for (int dx = 0; dx <= dsize.width; dx++)
         {
+#if HL_SIMD128
+            // the inliers come in long runs, their ends are looked for a block at a time
+            if (prevInlier)
+                dx = skipInlierBlocks<isRelative>(XY, dx, dsize.width, width1, height1, _offset.x, off_y);
+#endif
             bool curInlier = dx < dsize.width ? (unsigned)XY[dx * 2] + (isRelative ? (_offset.x + dx) : 0) < width1 && (unsigned)XY[dx * 2 + 1] + off_y < height1 : !prevInlier;
             if (curInlier == prevInlier)
                 continue;
@@ -728,6 +877,130 @@ typedef void (*RemapNNFunc)(const Mat& _src, Mat& _dst, const Mat& _xy, int bord
 
 typedef void (*RemapFunc)(const Mat& _src, Mat& _dst, const Mat& _xy, const Mat& _fxy, const void* _wtab, int borderType, const Scalar& _borderValue, const Point& _offset);
 
+// selects the remap kernel for the interpolation and the depth, and the coefficient table the interpolating ones read
+static void getRemapFunc(int interpolation, int depth, bool isRelative, RemapNNFunc& nnfunc, RemapFunc& ifunc, const void*& ctab)
+{
+    static RemapNNFunc nn_tab[2][8] = {
+        {remapNearest<uchar, false>, remapNearest<schar, false>, remapNearest<ushort, false>, remapNearest<short, false>, remapNearest<uint, false>, remapNearest<int, false>, remapNearest<float, false>, remapNearest<double, false>},
+        {remapNearest<uchar, true>, remapNearest<schar, true>, remapNearest<ushort, true>, remapNearest<short, true>, remapNearest<uint, true>, remapNearest<int, true>, remapNearest<float, true>, remapNearest<double, true>}};
+
+    static RemapFunc linear_tab[2][8] = {
+        {remapBilinear<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, RemapVec_8u<false>, short, false>, 0, remapBilinear<Cast<float, ushort>, RemapNoVec<false>, float, false>, remapBilinear<Cast<float, short>, RemapNoVec<false>, float, false>, 0, 0, remapBilinear<Cast<float, float>, RemapNoVec<false>, float, false>, remapBilinear<Cast<double, double>, RemapNoVec<false>, float, false>},
+        {remapBilinear<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, RemapVec_8u<true>, short, true>, 0, remapBilinear<Cast<float, ushort>, RemapNoVec<true>, float, true>, remapBilinear<Cast<float, short>, RemapNoVec<true>, float, true>, 0, 0, remapBilinear<Cast<float, float>, RemapNoVec<true>, float, true>, remapBilinear<Cast<double, double>, RemapNoVec<true>, float, true>}};
+
+    static RemapFunc cubic_tab[2][8] = {
+        {remapBicubic<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, short, INTER_REMAP_COEF_SCALE, false>, 0, remapBicubic<Cast<float, ushort>, float, 1, false>, remapBicubic<Cast<float, short>, float, 1, false>, 0, 0, remapBicubic<Cast<float, float>, float, 1, false>, remapBicubic<Cast<double, double>, float, 1, false>},
+        {remapBicubic<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, short, INTER_REMAP_COEF_SCALE, true>, 0, remapBicubic<Cast<float, ushort>, float, 1, true>, remapBicubic<Cast<float, short>, float, 1, true>, 0, 0, remapBicubic<Cast<float, float>, float, 1, true>, remapBicubic<Cast<double, double>, float, 1, true>}};
+
+    static RemapFunc lanczos4_tab[2][8] = {
+        {remapLanczos4<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, short, INTER_REMAP_COEF_SCALE, false>, 0, remapLanczos4<Cast<float, ushort>, float, 1, false>, remapLanczos4<Cast<float, short>, float, 1, false>, 0, 0, remapLanczos4<Cast<float, float>, float, 1, false>, remapLanczos4<Cast<double, double>, float, 1, false>},
+        {remapLanczos4<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, short, INTER_REMAP_COEF_SCALE, true>, 0, remapLanczos4<Cast<float, ushort>, float, 1, true>, remapLanczos4<Cast<float, short>, float, 1, true>, 0, 0, remapLanczos4<Cast<float, float>, float, 1, true>, remapLanczos4<Cast<double, double>, float, 1, true>}};
+
+    const int relativeOptionIndex = (isRelative ? 1 : 0);
+
+    nnfunc = 0;
+    ifunc  = 0;
+    ctab   = 0;
+    if (interpolation == INTER_NEAREST)
+    {
+        nnfunc = nn_tab[relativeOptionIndex][depth];
+        HL_Assert(nnfunc != 0);
+        return;
+    }
+
+    if (interpolation == INTER_LINEAR)
+        ifunc = linear_tab[relativeOptionIndex][depth];
+    else if (interpolation == INTER_CUBIC)
+        ifunc = cubic_tab[relativeOptionIndex][depth];
+    else if (interpolation == INTER_LANCZOS4)
+        ifunc = lanczos4_tab[relativeOptionIndex][depth];
+    else
+        HL_Error(hl::Error::StsBadArg, "Unknown interpolation method");
+    HL_Assert(ifunc != 0);
+    ctab = initInterTab2D(interpolation, depth == HL_8U);
+}
+
+#if HL_SIMD128
+
+// stores the 4 points fx, fy in the fixed-point form of the scalar loops below
+static inline void v_storeMapPoints(const v_float32x4& fx, const v_float32x4& fy, short* XY, ushort* A)
+{
+    const v_float32x4 scale = v_setall_f32((float)INTER_TAB_SIZE);
+
+    v_int32x4 X  = v_round(v_mul_wrap(fx, scale)), Y = v_round(v_mul_wrap(fy, scale));
+    v_int32x4 XI = v_shr<INTER_BITS>(X), YI = v_shr<INTER_BITS>(Y);
+    v_int32x4 a  = v_add_wrap(v_shl<INTER_BITS>(v_sub_wrap(Y, v_shl<INTER_BITS>(YI))), v_sub_wrap(X, v_shl<INTER_BITS>(XI)));
+
+    v_int32x4 xy0, xy1;
+    v_zip(XI, YI, xy0, xy1);
+    v_store(XY, v_pack(xy0, xy1));
+    v_store((short*)A, v_get_low(v_pack(a, a)));
+}
+
+#endif
+
+/*
+ * Converts a line of float map points to the 16SC2 integer coordinates and the 16UC1 indices of their
+ * INTER_BITS fractions that the interpolating kernels read. The points are the planes sX, sY.
+ */
+static void convertMapLine(const float* sX, const float* sY, short* XY, ushort* A, int width)
+{
+    int x = 0;
+#if HL_SIMD128
+    for (; x <= width - v_float32x4::nlanes; x += v_float32x4::nlanes)
+        v_storeMapPoints(v_load(sX + x), v_load(sY + x), XY + x * 2, A + x);
+#endif
+    for (; x < width; x++)
+    {
+        int ix        = hlRound(sX[x] * static_cast<float>(INTER_TAB_SIZE));
+        int iy        = hlRound(sY[x] * static_cast<float>(INTER_TAB_SIZE));
+        XY[x * 2]     = saturate_cast<short>(ix >> INTER_BITS);
+        XY[x * 2 + 1] = saturate_cast<short>(iy >> INTER_BITS);
+        A[x]          = (ushort)((iy & (INTER_TAB_SIZE - 1)) * INTER_TAB_SIZE + (ix & (INTER_TAB_SIZE - 1)));
+    }
+}
+
+// the same for the interleaved points of a 32FC2 map
+static void convertMapLine(const float* sXY, short* XY, ushort* A, int width)
+{
+    int x = 0;
+#if HL_SIMD128
+    for (; x <= width - v_float32x4::nlanes; x += v_float32x4::nlanes)
+    {
+        v_float32x4 fx, fy;
+        v_load_deinterleave(sXY + x * 2, fx, fy);
+        v_storeMapPoints(fx, fy, XY + x * 2, A + x);
+    }
+#endif
+    for (; x < width; x++)
+    {
+        int ix        = hlRound(sXY[x * 2] * static_cast<float>(INTER_TAB_SIZE));
+        int iy        = hlRound(sXY[x * 2 + 1] * static_cast<float>(INTER_TAB_SIZE));
+        XY[x * 2]     = saturate_cast<short>(ix >> INTER_BITS);
+        XY[x * 2 + 1] = saturate_cast<short>(iy >> INTER_BITS);
+        A[x]          = (ushort)((iy & (INTER_TAB_SIZE - 1)) * INTER_TAB_SIZE + (ix & (INTER_TAB_SIZE - 1)));
+    }
+}
+
+// rounds a line of planar float map points to the 16SC2 coordinates of the nearest neighbor kernels
+static void convertMapLineNN(const float* sX, const float* sY, short* XY, int width)
+{
+    int x = 0;
+#if HL_SIMD128
+    for (; x <= width - v_float32x4::nlanes; x += v_float32x4::nlanes)
+    {
+        v_int32x4 xy0, xy1;
+        v_zip(v_round(v_load(sX + x)), v_round(v_load(sY + x)), xy0, xy1);
+        v_store(XY + x * 2, v_pack(xy0, xy1));
+    }
+#endif
+    for (; x < width; x++)
+    {
+        XY[x * 2]     = saturate_cast<short>(sX[x]);
+        XY[x * 2 + 1] = saturate_cast<short>(sY[x]);
+    }
+}
+
 class RemapInvoker:
     public ParallelLoopBody
 {
@@ -783,70 +1056,35 @@ public:
                     else
                     {
                         for (y1 = 0; y1 < brows; y1++)
-                        {
-                            short*       XY = bufxy.ptr<short>(y1);
-                            const float* sX = m1->ptr<float>(y + y1) + x;
-                            const float* sY = m2->ptr<float>(y + y1) + x;
-                            x1              = 0;
-
-                            for (; x1 < bcols; x1++)
-                            {
-                                XY[x1 * 2]     = saturate_cast<short>(sX[x1]);
-                                XY[x1 * 2 + 1] = saturate_cast<short>(sY[x1]);
-                            }
-                        }
+                            convertMapLineNN(m1->ptr<float>(y + y1) + x, m2->ptr<float>(y + y1) + x, bufxy.ptr<short>(y1), bcols);
                     }
                     nnfunc(*src, dpart, bufxy, borderType, borderValue, Point(x, y));
                     continue;
                 }
 
                 Mat bufa(_bufa, Rect(0, 0, bcols, brows));
-                for (y1 = 0; y1 < brows; y1++)
+                if (m1->type() == HL_16SC2 && (m2->type() == HL_16UC1 || m2->type() == HL_16SC1))
                 {
-                    short*  XY = bufxy.ptr<short>(y1);
-                    ushort* A  = bufa.ptr<ushort>(y1);
-
-                    if (m1->type() == HL_16SC2 && (m2->type() == HL_16UC1 || m2->type() == HL_16SC1))
+                    // the fixed-point maps are read in place, only their indices are clipped to the table
+                    bufxy = (*m1)(Rect(x, y, bcols, brows));
+                    for (y1 = 0; y1 < brows; y1++)
                     {
-                        bufxy            = (*m1)(Rect(x, y, bcols, brows));
-
+                        ushort*       A  = bufa.ptr<ushort>(y1);
                         const ushort* sA = m2->ptr<ushort>(y + y1) + x;
-                        x1               = 0;
 
-                        for (; x1 < bcols; x1++)
+                        for (x1 = 0; x1 < bcols; x1++)
                             A[x1] = (ushort)(sA[x1] & (INTER_TAB_SIZE2 - 1));
                     }
-                    else if (planar_input)
-                    {
-                        const float* sX = m1->ptr<float>(y + y1) + x;
-                        const float* sY = m2->ptr<float>(y + y1) + x;
-
-                        x1              = 0;
-                        for (; x1 < bcols; x1++)
-                        {
-                            int sx         = hlRound(sX[x1] * static_cast<int>(INTER_TAB_SIZE));
-                            int sy         = hlRound(sY[x1] * static_cast<int>(INTER_TAB_SIZE));
-                            int v          = (sy & (INTER_TAB_SIZE - 1)) * INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE - 1));
-                            XY[x1 * 2]     = saturate_cast<short>(sx >> INTER_BITS);
-                            XY[x1 * 2 + 1] = saturate_cast<short>(sy >> INTER_BITS);
-                            A[x1]          = (ushort)v;
-                        }
-                    }
-                    else
-                    {
-                        const float* sXY = m1->ptr<float>(y + y1) + x * 2;
-                        x1               = 0;
-
-                        for (; x1 < bcols; x1++)
-                        {
-                            int sx         = hlRound(sXY[x1 * 2] * static_cast<int>(INTER_TAB_SIZE));
-                            int sy         = hlRound(sXY[x1 * 2 + 1] * static_cast<int>(INTER_TAB_SIZE));
-                            int v          = (sy & (INTER_TAB_SIZE - 1)) * INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE - 1));
-                            XY[x1 * 2]     = saturate_cast<short>(sx >> INTER_BITS);
-                            XY[x1 * 2 + 1] = saturate_cast<short>(sy >> INTER_BITS);
-                            A[x1]          = (ushort)v;
-                        }
-                    }
+                }
+                else if (planar_input)
+                {
+                    for (y1 = 0; y1 < brows; y1++)
+                        convertMapLine(m1->ptr<float>(y + y1) + x, m2->ptr<float>(y + y1) + x, bufxy.ptr<short>(y1), bufa.ptr<ushort>(y1), bcols);
+                }
+                else
+                {
+                    for (y1 = 0; y1 < brows; y1++)
+                        convertMapLine(m1->ptr<float>(y + y1) + x * 2, bufxy.ptr<short>(y1), bufa.ptr<ushort>(y1), bcols);
                 }
                 ifunc(*src, dpart, bufxy, bufa, ctab, borderType, borderValue, Point(x, y));
             }
@@ -869,23 +1107,7 @@ private:
 
 void hl::remap(const Mat& _src, Mat& _dst, const Mat& _map1, const Mat& _map2, int interpolation, int borderType, const Scalar& borderValue)
 {
-    const bool hasRelativeFlag      = ((interpolation & WARP_RELATIVE_MAP) != 0);
-
-    static RemapNNFunc nn_tab[2][8] = {
-        {remapNearest<uchar, false>, remapNearest<schar, false>, remapNearest<ushort, false>, remapNearest<short, false>, remapNearest<int, false>, remapNearest<float, false>, remapNearest<double, false>, 0},
-        {remapNearest<uchar, true>, remapNearest<schar, true>, remapNearest<ushort, true>, remapNearest<short, true>, remapNearest<int, true>, remapNearest<float, true>, remapNearest<double, true>, 0}};
-
-    static RemapFunc linear_tab[2][8] = {
-        {remapBilinear<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, RemapVec_8u<false>, short, false>, 0, remapBilinear<Cast<float, ushort>, RemapNoVec<false>, float, false>, remapBilinear<Cast<float, short>, RemapNoVec<false>, float, false>, 0, remapBilinear<Cast<float, float>, RemapNoVec<false>, float, false>, remapBilinear<Cast<double, double>, RemapNoVec<false>, float, false>, 0},
-        {remapBilinear<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, RemapVec_8u<true>, short, true>, 0, remapBilinear<Cast<float, ushort>, RemapNoVec<true>, float, true>, remapBilinear<Cast<float, short>, RemapNoVec<true>, float, true>, 0, remapBilinear<Cast<float, float>, RemapNoVec<true>, float, true>, remapBilinear<Cast<double, double>, RemapNoVec<true>, float, true>, 0}};
-
-    static RemapFunc cubic_tab[2][8] = {
-        {remapBicubic<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, short, INTER_REMAP_COEF_SCALE, false>, 0, remapBicubic<Cast<float, ushort>, float, 1, false>, remapBicubic<Cast<float, short>, float, 1, false>, 0, remapBicubic<Cast<float, float>, float, 1, false>, remapBicubic<Cast<double, double>, float, 1, false>, 0},
-        {remapBicubic<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, short, INTER_REMAP_COEF_SCALE, true>, 0, remapBicubic<Cast<float, ushort>, float, 1, true>, remapBicubic<Cast<float, short>, float, 1, true>, 0, remapBicubic<Cast<float, float>, float, 1, true>, remapBicubic<Cast<double, double>, float, 1, true>, 0}};
-
-    static RemapFunc lanczos4_tab[2][8] = {
-        {remapLanczos4<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, short, INTER_REMAP_COEF_SCALE, false>, 0, remapLanczos4<Cast<float, ushort>, float, 1, false>, remapLanczos4<Cast<float, short>, float, 1, false>, 0, remapLanczos4<Cast<float, float>, float, 1, false>, remapLanczos4<Cast<double, double>, float, 1, false>, 0},
-        {remapLanczos4<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, short, INTER_REMAP_COEF_SCALE, true>, 0, remapLanczos4<Cast<float, ushort>, float, 1, true>, remapLanczos4<Cast<float, short>, float, 1, true>, 0, remapLanczos4<Cast<float, float>, float, 1, true>, remapLanczos4<Cast<double, double>, float, 1, true>, 0}};
+    const bool hasRelativeFlag = ((interpolation & WARP_RELATIVE_MAP) != 0);
 
     HL_Assert(!_map1.empty());
     HL_Assert(_map2.empty() || (_map2.size() == _map1.size()));
@@ -903,39 +1125,14 @@ void hl::remap(const Mat& _src, Mat& _dst, const Mat& _map1, const Mat& _map2, i
     if (interpolation == INTER_AREA)
         interpolation = INTER_LINEAR;
 
-    int type = src.type(), depth = HL_MAT_DEPTH(type);
+    if (interpolation == INTER_CUBIC || interpolation == INTER_LANCZOS4)
+        HL_Assert(_src.channels() <= 4);
 
-    RemapNNFunc nnfunc            = 0;
-    RemapFunc   ifunc             = 0;
-    const void* ctab              = 0;
-    bool        fixpt             = depth == HL_8U;
-    bool        planar_input      = false;
-
-    const int relativeOptionIndex = (hasRelativeFlag ? 1 : 0);
-    if (interpolation == INTER_NEAREST)
-    {
-        nnfunc = nn_tab[relativeOptionIndex][depth];
-        HL_Assert(nnfunc != 0);
-    }
-    else
-    {
-        if (interpolation == INTER_LINEAR)
-            ifunc = linear_tab[relativeOptionIndex][depth];
-        else if (interpolation == INTER_CUBIC)
-        {
-            ifunc = cubic_tab[relativeOptionIndex][depth];
-            HL_Assert(_src.channels() <= 4);
-        }
-        else if (interpolation == INTER_LANCZOS4)
-        {
-            ifunc = lanczos4_tab[relativeOptionIndex][depth];
-            HL_Assert(_src.channels() <= 4);
-        }
-        else
-            HL_Error(hl::Error::StsBadArg, "Unknown interpolation method");
-        HL_Assert(ifunc != 0);
-        ctab = initInterTab2D(interpolation, fixpt);
-    }
+    RemapNNFunc nnfunc       = 0;
+    RemapFunc   ifunc        = 0;
+    const void* ctab         = 0;
+    bool        planar_input = false;
+    getRemapFunc(interpolation, src.depth(), hasRelativeFlag, nnfunc, ifunc, ctab);
 
     const Mat *m1 = &map1, *m2 = &map2;
 
@@ -954,15 +1151,125 @@ void hl::remap(const Mat& _src, Mat& _dst, const Mat& _map1, const Mat& _map2, i
     parallel_for_(Range(0, dst.rows), invoker, dst.total() / (double)(1 << 16));
 }
 
+void hl::convertMaps(const Mat& _map1, const Mat& _map2, Mat& _dstmap1, Mat& _dstmap2, int dstm1type, bool nninterpolate)
+{
+    Mat        map1 = _map1, map2 = _map2;
+    Size       size = map1.size();
+    const Mat *m1 = &map1, *m2 = &map2;
+    int        m1type = m1->type(), m2type = m2->type();
+
+    HL_Assert((m1type == HL_16SC2 && (nninterpolate || m2type == HL_16UC1 || m2type == HL_16SC1)) || (m2type == HL_16SC2 && (nninterpolate || m1type == HL_16UC1 || m1type == HL_16SC1)) || (m1type == HL_32FC1 && m2type == HL_32FC1) || (m1type == HL_32FC2 && m2->empty()));
+
+    if (m2type == HL_16SC2)
+    {
+        std::swap(m1, m2);
+        std::swap(m1type, m2type);
+        size = m1->size();
+    }
+    HL_Assert(m2->empty() || m2->size() == size);
+
+    if (dstm1type <= 0)
+        dstm1type = m1type == HL_16SC2 ? HL_32FC2 : HL_16SC2;
+    HL_Assert(dstm1type == HL_16SC2 || dstm1type == HL_32FC1 || dstm1type == HL_32FC2);
+
+    _dstmap1.create(size, dstm1type);
+    Mat dstmap1 = _dstmap1, dstmap2;
+
+    // a 32FC1 map always comes with its second plane
+    if (dstm1type == HL_32FC1 || (!nninterpolate && dstm1type == HL_16SC2))
+    {
+        _dstmap2.create(size, dstm1type == HL_16SC2 ? HL_16UC1 : HL_32FC1);
+        dstmap2 = _dstmap2;
+    }
+    else
+        _dstmap2.release();
+
+    // the nearest neighbor coordinates are only rounded or widened
+    if (m1type == dstm1type || (nninterpolate && ((m1type == HL_16SC2 && dstm1type == HL_32FC2) || (m1type == HL_32FC2 && dstm1type == HL_16SC2))))
+    {
+        m1->convertTo(dstmap1, dstmap1.type());
+        if (!dstmap2.empty() && dstmap2.type() == m2->type())
+            m2->copyTo(dstmap2);
+        return;
+    }
+
+    if (m1->isContinuous() && (m2->empty() || m2->isContinuous()) && dstmap1.isContinuous() && (dstmap2.empty() || dstmap2.isContinuous()))
+    {
+        size.width  *= size.height;
+        size.height  = 1;
+    }
+
+    const float scale = 1.f / static_cast<float>(INTER_TAB_SIZE);
+    for (int y = 0; y < size.height; y++)
+    {
+        const float*  src1f = m1->ptr<float>(y);
+        const float*  src2f = m2->empty() ? 0 : m2->ptr<float>(y);
+        const short*  src1  = (const short*)src1f;
+        const ushort* src2  = (const ushort*)src2f;
+
+        float*  dst1f = dstmap1.ptr<float>(y);
+        float*  dst2f = dstmap2.empty() ? 0 : dstmap2.ptr<float>(y);
+        short*  dst1  = (short*)dst1f;
+        ushort* dst2  = (ushort*)dst2f;
+
+        if (m1type == HL_32FC1 && dstm1type == HL_16SC2)
+        {
+            if (nninterpolate)
+                convertMapLineNN(src1f, src2f, dst1, size.width);
+            else
+                convertMapLine(src1f, src2f, dst1, dst2, size.width);
+        }
+        else if (m1type == HL_32FC2 && dstm1type == HL_16SC2)
+            convertMapLine(src1f, dst1, dst2, size.width);
+        else if (m1type == HL_32FC1 && dstm1type == HL_32FC2)
+        {
+            for (int x = 0; x < size.width; x++)
+            {
+                dst1f[x * 2]     = src1f[x];
+                dst1f[x * 2 + 1] = src2f[x];
+            }
+        }
+        else if (m1type == HL_32FC2 && dstm1type == HL_32FC1)
+        {
+            for (int x = 0; x < size.width; x++)
+            {
+                dst1f[x] = src1f[x * 2];
+                dst2f[x] = src1f[x * 2 + 1];
+            }
+        }
+        else if (m1type == HL_16SC2 && dstm1type == HL_32FC1)
+        {
+            for (int x = 0; x < size.width; x++)
+            {
+                int fxy  = src2 ? src2[x] & (INTER_TAB_SIZE2 - 1) : 0;
+                dst1f[x] = src1[x * 2] + (fxy & (INTER_TAB_SIZE - 1)) * scale;
+                dst2f[x] = src1[x * 2 + 1] + (fxy >> INTER_BITS) * scale;
+            }
+        }
+        else if (m1type == HL_16SC2 && dstm1type == HL_32FC2)
+        {
+            for (int x = 0; x < size.width; x++)
+            {
+                int fxy          = src2 ? src2[x] & (INTER_TAB_SIZE2 - 1) : 0;
+                dst1f[x * 2]     = src1[x * 2] + (fxy & (INTER_TAB_SIZE - 1)) * scale;
+                dst1f[x * 2 + 1] = src1[x * 2 + 1] + (fxy >> INTER_BITS) * scale;
+            }
+        }
+        else
+            HL_Error(Error::StsNotImplemented, "Unsupported combination of input/output matrices");
+    }
+}
+
 namespace hl
 {
 
+// The tiles of dst are mapped by the remap kernel selected once in hal::warpAffine, on the tile buffers
 class WarpAffineInvoker:
     public ParallelLoopBody
 {
 public:
-    WarpAffineInvoker(const Mat& _src, Mat& _dst, int _interpolation, int _borderType, const Scalar& _borderValue, int* _adelta, int* _bdelta, const double* _M):
-        ParallelLoopBody(), src(_src), dst(_dst), interpolation(_interpolation), borderType(_borderType), borderValue(_borderValue), adelta(_adelta), bdelta(_bdelta), M(_M)
+    WarpAffineInvoker(const Mat& _src, Mat& _dst, int _interpolation, int _borderType, const Scalar& _borderValue, int* _adelta, int* _bdelta, const double* _M, RemapNNFunc _nnfunc, RemapFunc _ifunc, const void* _ctab):
+        ParallelLoopBody(), src(_src), dst(_dst), interpolation(_interpolation), borderType(_borderType), borderValue(_borderValue), adelta(_adelta), bdelta(_bdelta), M(_M), nnfunc(_nnfunc), ifunc(_ifunc), ctab(_ctab)
     {
     }
 
@@ -1001,12 +1308,12 @@ public:
                         hal::warpAffineBlockline(adelta + x, bdelta + x, xy, A + y1 * bw, X0, Y0, bw);
                 }
 
-                if (interpolation == INTER_NEAREST)
-                    remap(src, dpart, _XY, Mat(), interpolation, borderType, borderValue);
+                if (nnfunc)
+                    nnfunc(src, dpart, _XY, borderType, borderValue, Point(x, y));
                 else
                 {
                     Mat _matA(bh, bw, HL_16U, A);
-                    remap(src, dpart, _XY, _matA, interpolation, borderType, borderValue);
+                    ifunc(src, dpart, _XY, _matA, ctab, borderType, borderValue, Point(x, y));
                 }
             }
         }
@@ -1019,6 +1326,75 @@ private:
     Scalar        borderValue;
     int *         adelta, *bdelta;
     const double* M;
+    RemapNNFunc   nnfunc;
+    RemapFunc     ifunc;
+    const void*   ctab;
+};
+
+// The same tiling as WarpAffineInvoker, the coordinates of every tile line are divided by their W
+class WarpPerspectiveInvoker:
+    public ParallelLoopBody
+{
+public:
+    WarpPerspectiveInvoker(const Mat& _src, Mat& _dst, const double* _M, int _interpolation, int _borderType, const Scalar& _borderValue, RemapNNFunc _nnfunc, RemapFunc _ifunc, const void* _ctab):
+        ParallelLoopBody(), src(_src), dst(_dst), M(_M), interpolation(_interpolation), borderType(_borderType), borderValue(_borderValue), nnfunc(_nnfunc), ifunc(_ifunc), ctab(_ctab)
+    {
+    }
+
+    virtual void operator()(const Range& range) const override
+    {
+        const int            BLOCK_SZ = 64;
+        AutoBuffer<short, 0> __XY(BLOCK_SZ * BLOCK_SZ * 2), __A(BLOCK_SZ * BLOCK_SZ);
+        short *              XY = __XY.data(), *A = __A.data();
+        int                  x, y, y1;
+
+        int bh0 = std::min(BLOCK_SZ / 2, dst.rows);
+        int bw0 = std::min(BLOCK_SZ * BLOCK_SZ / bh0, dst.cols);
+        bh0     = std::min(BLOCK_SZ * BLOCK_SZ / bw0, dst.rows);
+
+        for (y = range.start; y < range.end; y += bh0)
+        {
+            for (x = 0; x < dst.cols; x += bw0)
+            {
+                int bw = std::min(bw0, dst.cols - x);
+                int bh = std::min(bh0, range.end - y);
+
+                Mat _XY(bh, bw, HL_16SC2, XY);
+                Mat dpart(dst, Rect(x, y, bw, bh));
+
+                for (y1 = 0; y1 < bh; y1++)
+                {
+                    short* xy = XY + y1 * bw * 2;
+                    double X0 = M[0] * x + M[1] * (y + y1) + M[2];
+                    double Y0 = M[3] * x + M[4] * (y + y1) + M[5];
+                    double W0 = M[6] * x + M[7] * (y + y1) + M[8];
+
+                    if (interpolation == INTER_NEAREST)
+                        hal::warpPerspectiveBlocklineNN(M, xy, X0, Y0, W0, bw);
+                    else
+                        hal::warpPerspectiveBlockline(M, xy, A + y1 * bw, X0, Y0, W0, bw);
+                }
+
+                if (nnfunc)
+                    nnfunc(src, dpart, _XY, borderType, borderValue, Point(x, y));
+                else
+                {
+                    Mat _matA(bh, bw, HL_16U, A);
+                    ifunc(src, dpart, _XY, _matA, ctab, borderType, borderValue, Point(x, y));
+                }
+            }
+        }
+    }
+
+private:
+    Mat           src;
+    Mat           dst;
+    const double* M;
+    int           interpolation, borderType;
+    Scalar        borderValue;
+    RemapNNFunc   nnfunc;
+    RemapFunc     ifunc;
+    const void*   ctab;
 };
 
 namespace hal
@@ -1026,9 +1402,16 @@ namespace hal
 
 void warpAffine(int src_type, const uchar* src_data, size_t src_step, int src_width, int src_height, uchar* dst_data, size_t dst_step, int dst_width, int dst_height, const double M[6], int interpolation, int borderType, const double borderValue[4])
 {
+    HL_Assert(dst_width < SHRT_MAX && dst_height < SHRT_MAX && src_width < SHRT_MAX && src_height < SHRT_MAX);
+
     Mat src(Size(src_width, src_height), src_type, const_cast<uchar*>(src_data), src_step);
     Mat dst(Size(dst_width, dst_height), src_type, dst_data, dst_step);
 
+    RemapNNFunc nnfunc = 0;
+    RemapFunc   ifunc  = 0;
+    const void* ctab   = 0;
+    getRemapFunc(interpolation, src.depth(), false, nnfunc, ifunc, ctab);
+
     int             x;
     AutoBuffer<int> _abdelta(dst.cols * 2);
     int *           adelta = &_abdelta[0], *bdelta = adelta + dst.cols;
@@ -1042,7 +1425,7 @@ void warpAffine(int src_type, const uchar* src_data, size_t src_step, int src_wi
     }
 
     Range             range(0, dst.rows);
-    WarpAffineInvoker invoker(src, dst, interpolation, borderType, Scalar(borderValue[0], borderValue[1], borderValue[2], borderValue[3]), adelta, bdelta, M);
+    WarpAffineInvoker invoker(src, dst, interpolation, borderType, Scalar(borderValue[0], borderValue[1], borderValue[2], borderValue[3]), adelta, bdelta, M, nnfunc, ifunc, ctab);
     parallel_for_(range, invoker, dst.total() / (double)(1 << 16));
 }
 
@@ -1050,6 +1433,19 @@ void warpAffineBlocklineNN(int* adelta, int* bdelta, short* xy, int X0, int Y0,
 {
     constexpr int AB_BITS = MAX(10, static_cast<int>(INTER_BITS));
     int           x1      = 0;
+#if HL_SIMD128
+    const v_int32x4 vX0 = v_setall_s32(X0), vY0 = v_setall_s32(Y0);
+    for (; x1 <= bw - v_int32x4::nlanes; x1 += v_int32x4::nlanes)
+    {
+        v_int32x4 X = v_shr<AB_BITS>(v_add_wrap(vX0, v_load(adelta + x1)));
+        v_int32x4 Y = v_shr<AB_BITS>(v_add_wrap(vY0, v_load(bdelta + x1)));
+
+        // v_pack saturates the interleaved coordinates
+        v_int32x4 xy0, xy1;
+        v_zip(X, Y, xy0, xy1);
+        v_store(xy + x1 * 2, v_pack(xy0, xy1));
+    }
+#endif
     for (; x1 < bw; x1++)
     {
         const int X    = (X0 + adelta[x1]) >> AB_BITS;
@@ -1063,7 +1459,31 @@ void warpAffineBlockline(int* adelta, int* bdelta, short* xy, short* alpha, int
 {
     const int AB_BITS = MAX(10, (int)INTER_BITS);
 
-    for (int x1 = 0; x1 < bw; x1++)
+    int x1 = 0;
+#if HL_SIMD128
+    const v_int32x4 vX0 = v_setall_s32(X0), vY0 = v_setall_s32(Y0);
+    for (; x1 <= bw - v_int16x8::nlanes; x1 += v_int16x8::nlanes)
+    {
+        v_int32x4 a[2];
+        for (int k = 0; k < 2; k++)
+        {
+            const int i  = x1 + k * v_int32x4::nlanes;
+            v_int32x4 X  = v_shr<AB_BITS - INTER_BITS>(v_add_wrap(vX0, v_load(adelta + i)));
+            v_int32x4 Y  = v_shr<AB_BITS - INTER_BITS>(v_add_wrap(vY0, v_load(bdelta + i)));
+            v_int32x4 XI = v_shr<INTER_BITS>(X), YI = v_shr<INTER_BITS>(Y);
+
+            // the fractions are X & (INTER_TAB_SIZE - 1), as the shifts floor
+            v_int32x4 XF = v_sub_wrap(X, v_shl<INTER_BITS>(XI)), YF = v_sub_wrap(Y, v_shl<INTER_BITS>(YI));
+            a[k]         = v_add_wrap(v_shl<INTER_BITS>(YF), XF);
+
+            v_int32x4 xy0, xy1;
+            v_zip(XI, YI, xy0, xy1);
+            v_store(xy + i * 2, v_pack(xy0, xy1));
+        }
+        v_store(alpha + x1, v_pack(a[0], a[1]));
+    }
+#endif
+    for (; x1 < bw; x1++)
     {
         int X          = (X0 + adelta[x1]) >> (AB_BITS - INTER_BITS);
         int Y          = (Y0 + bdelta[x1]) >> (AB_BITS - INTER_BITS);
@@ -1073,11 +1493,119 @@ void warpAffineBlockline(int* adelta, int* bdelta, short* xy, short* alpha, int
     }
 }
 
+void warpPerspective(int src_type, const uchar* src_data, size_t src_step, int src_width, int src_height, uchar* dst_data, size_t dst_step, int dst_width, int dst_height, const double M[9], int interpolation, int borderType, const double borderValue[4])
+{
+    HL_Assert(dst_width < SHRT_MAX && dst_height < SHRT_MAX && src_width < SHRT_MAX && src_height < SHRT_MAX);
+
+    Mat src(Size(src_width, src_height), src_type, const_cast<uchar*>(src_data), src_step);
+    Mat dst(Size(dst_width, dst_height), src_type, dst_data, dst_step);
+
+    RemapNNFunc nnfunc = 0;
+    RemapFunc   ifunc  = 0;
+    const void* ctab   = 0;
+    getRemapFunc(interpolation, src.depth(), false, nnfunc, ifunc, ctab);
+
+    Range                  range(0, dst.rows);
+    WarpPerspectiveInvoker invoker(src, dst, M, interpolation, borderType, Scalar(borderValue[0], borderValue[1], borderValue[2], borderValue[3]), nnfunc, ifunc, ctab);
+    parallel_for_(range, invoker, dst.total() / (double)(1 << 16));
+}
+
+#if HL_SIMD128
+
+/*
+ * The source coordinates of the points x1, ..., x1 + 3 of a block line, multiplied by scale. The
+ * operations are those of the scalar loops, so the results are the same to the last bit.
+ */
+static inline void warpPerspectivePoints(const double* M, double X0, double Y0, double W0, int x1, double scale, v_int32x4& X, v_int32x4& Y)
+{
+    const v_float64x2 zero = v_setall(0.), imin = v_setall((double)INT_MIN), imax = v_setall((double)INT_MAX);
+
+    v_reg<int, 2> XI[2], YI[2];
+    for (int k = 0; k < 2; k++)
+    {
+        v_float64x2 vx(v_float64x2::vector_type{0, 1} + (double)(x1 + k * 2));
+        v_float64x2 W  = v_add_wrap(v_setall(W0), v_mul_wrap(v_setall(M[6]), vx));
+        W              = v_select(W != zero, v_div(v_setall(scale), W), zero);
+
+        v_float64x2 fX = v_mul_wrap(v_add_wrap(v_setall(X0), v_mul_wrap(v_setall(M[0]), vx)), W);
+        v_float64x2 fY = v_mul_wrap(v_add_wrap(v_setall(Y0), v_mul_wrap(v_setall(M[3]), vx)), W);
+        XI[k]          = v_round(v_max(imin, v_min(imax, fX)));
+        YI[k]          = v_round(v_max(imin, v_min(imax, fY)));
+    }
+    X = v_combine(XI[0], XI[1]);
+    Y = v_combine(YI[0], YI[1]);
+}
+
+#endif
+
+void warpPerspectiveBlocklineNN(const double* M, short* xy, double X0, double Y0, double W0, int bw)
+{
+    int x1 = 0;
+#if HL_SIMD128
+    for (; x1 <= bw - v_int32x4::nlanes; x1 += v_int32x4::nlanes)
+    {
+        v_int32x4 X, Y, xy0, xy1;
+        warpPerspectivePoints(M, X0, Y0, W0, x1, 1., X, Y);
+        v_zip(X, Y, xy0, xy1);
+        v_store(xy + x1 * 2, v_pack(xy0, xy1));
+    }
+#endif
+    for (; x1 < bw; x1++)
+    {
+        double W       = W0 + M[6] * x1;
+        W              = W ? 1. / W : 0;
+        double fX      = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0] * x1) * W));
+        double fY      = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3] * x1) * W));
+        xy[x1 * 2]     = saturate_cast<short>(saturate_cast<int>(fX));
+        xy[x1 * 2 + 1] = saturate_cast<short>(saturate_cast<int>(fY));
+    }
+}
+
+void warpPerspectiveBlockline(const double* M, short* xy, short* alpha, double X0, double Y0, double W0, int bw)
+{
+    int x1 = 0;
+#if HL_SIMD128
+    for (; x1 <= bw - v_int16x8::nlanes; x1 += v_int16x8::nlanes)
+    {
+        v_int32x4 a[2];
+        for (int k = 0; k < 2; k++)
+        {
+            const int i = x1 + k * v_int32x4::nlanes;
+            v_int32x4 X, Y;
+            warpPerspectivePoints(M, X0, Y0, W0, i, (double)INTER_TAB_SIZE, X, Y);
+            v_int32x4 XI = v_shr<INTER_BITS>(X), YI = v_shr<INTER_BITS>(Y);
+
+            v_int32x4 XF = v_sub_wrap(X, v_shl<INTER_BITS>(XI)), YF = v_sub_wrap(Y, v_shl<INTER_BITS>(YI));
+            a[k]         = v_add_wrap(v_shl<INTER_BITS>(YF), XF);
+
+            v_int32x4 xy0, xy1;
+            v_zip(XI, YI, xy0, xy1);
+            v_store(xy + i * 2, v_pack(xy0, xy1));
+        }
+        v_store(alpha + x1, v_pack(a[0], a[1]));
+    }
+#endif
+    for (; x1 < bw; x1++)
+    {
+        double W       = W0 + M[6] * x1;
+        W              = W ? (double)INTER_TAB_SIZE / W : 0;
+        double fX      = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0] * x1) * W));
+        double fY      = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3] * x1) * W));
+        int    X       = saturate_cast<int>(fX);
+        int    Y       = saturate_cast<int>(fY);
+        xy[x1 * 2]     = saturate_cast<short>(X >> INTER_BITS);
+        xy[x1 * 2 + 1] = saturate_cast<short>(Y >> INTER_BITS);
+        alpha[x1]      = (short)((Y & (INTER_TAB_SIZE - 1)) * INTER_TAB_SIZE + (X & (INTER_TAB_SIZE - 1)));
+    }
+}
+
 }    // namespace hal
 }    // namespace hl
 
 void hl::warpAffine(const Mat& _src, Mat& _dst, const Mat& _M0, Size dsize, int flags, int borderType, const Scalar& borderValue)
 {
+    // INTER_CUBIC_EXACT and INTER_AREA_EXACT are resize only, they lie outside of the warp flags
+    HL_Assert((flags & ~(INTER_MAX | WARP_FILL_OUTLIERS | WARP_INVERSE_MAP)) == 0);
     int interpolation = flags & INTER_MAX;
     HL_Assert(_src.channels() <= 4 || (interpolation != INTER_LANCZOS4 && interpolation != INTER_CUBIC));
 
@@ -1114,6 +1642,43 @@ void hl::warpAffine(const Mat& _src, Mat& _dst, const Mat& _M0, Size dsize, int
     hal::warpAffine(src.type(), src.data, src.step, src.cols, src.rows, dst.data, dst.step, dst.cols, dst.rows, M, interpolation, borderType, borderValue.val);
 }
 
+void hl::warpPerspective(const Mat& _src, Mat& _dst, const Mat& _M0, Size dsize, int flags, int borderType, const Scalar& borderValue)
+{
+    // INTER_CUBIC_EXACT and INTER_AREA_EXACT are resize only, they lie outside of the warp flags
+    HL_Assert((flags & ~(INTER_MAX | WARP_FILL_OUTLIERS | WARP_INVERSE_MAP)) == 0);
+    int interpolation = flags & INTER_MAX;
+    HL_Assert(_src.channels() <= 4 || (interpolation != INTER_LANCZOS4 && interpolation != INTER_CUBIC));
+
+    Mat src = _src, M0 = _M0;
+    _dst.create(dsize.empty() ? src.size() : dsize, src.type());
+    Mat dst = _dst;
+    HL_Assert(src.cols > 0 && src.rows > 0);
+    if (dst.data == src.data)
+        src = src.clone();
+
+    double M[9] = {0};
+    Mat    matM(3, 3, HL_64F, M);
+    if (interpolation == INTER_AREA)
+        interpolation = INTER_LINEAR;
+
+    HL_Assert((M0.type() == HL_32F || M0.type() == HL_64F) && M0.rows == 3 && M0.cols == 3);
+    M0.convertTo(matM, matM.type());
+
+    if (!(flags & WARP_INVERSE_MAP))
+    {
+        // the inverse is the adjugate divided by the determinant, a singular M maps everything to 0
+        double A[9] = {M[4] * M[8] - M[5] * M[7], M[2] * M[7] - M[1] * M[8], M[1] * M[5] - M[2] * M[4],
+                       M[5] * M[6] - M[3] * M[8], M[0] * M[8] - M[2] * M[6], M[2] * M[3] - M[0] * M[5],
+                       M[3] * M[7] - M[4] * M[6], M[1] * M[6] - M[0] * M[7], M[0] * M[4] - M[1] * M[3]};
+        double D    = M[0] * A[0] + M[1] * A[3] + M[2] * A[6];
+        D           = D != 0 ? 1. / D : 0;
+        for (int i = 0; i < 9; i++)
+            M[i] = A[i] * D;
+    }
+
+    hal::warpPerspective(src.type(), src.data, src.step, src.cols, src.rows, dst.data, dst.step, dst.cols, dst.rows, M, interpolation, borderType, borderValue.val);
+}
+
 hl::Matx23d hl::getRotationMatrix2D_(Point2f center, double angle, double scale)
 {
     angle        *= HL_PI / 180;
@@ -1,4 +1,7 @@
 #include "precomp.hxx"
+#include "openHL/core/hal/intrin.hxx"
+#include <algorithm>
+#include <type_traits>
 #include <vector>
 
 namespace hl
@@ -6,8 +9,12 @@ namespace hl
 namespace cpu_baseline
 {
 
-static void medianBlur_8u_O1(const Mat& _src, Mat& _dst, int ksize)
+namespace
+{
+
+class MedianBlur_8u_O1_Invoker: public ParallelLoopBody
 {
+public:
     typedef ushort HT;
 
     /**
@@ -26,176 +33,237 @@ static void medianBlur_8u_O1(const Mat& _src, Mat& _dst, int ksize)
         HT fine[16][16];
     } Histogram;
 
+    MedianBlur_8u_O1_Invoker(const Mat& _src, Mat& _dst, int _ksize, int _stripeSize):
+        ParallelLoopBody(), src(_src), dst(_dst), ksize(_ksize), stripeSize(_stripeSize), border(_src, BORDER_REPLICATE | BORDER_ISOLATED)
+    {
+    }
+
+    //! y += x for a row of 16 buckets
+    static inline void histAdd(HT* y, const HT* x)
+    {
+#if HL_SIMD128
+        v_store(y, v_add_wrap(v_load(y), v_load(x)));
+        v_store(y + 8, v_add_wrap(v_load(y + 8), v_load(x + 8)));
+#else
+        for (int ind = 0; ind < 16; ++ind)
+            y[ind] += x[ind];
+#endif
+    }
+
+    //! y -= x for a row of 16 buckets
+    static inline void histSub(HT* y, const HT* x)
+    {
+#if HL_SIMD128
+        v_store(y, v_sub_wrap(v_load(y), v_load(x)));
+        v_store(y + 8, v_sub_wrap(v_load(y + 8), v_load(x + 8)));
+#else
+        for (int ind = 0; ind < 16; ++ind)
+            y[ind] -= x[ind];
+#endif
+    }
+
+    //! y += a - b for a row of 16 buckets
+    static inline void histAddSub(HT* y, const HT* a, const HT* b)
+    {
+#if HL_SIMD128
+        v_store(y, v_add_wrap(v_load(y), v_sub_wrap(v_load(a), v_load(b))));
+        v_store(y + 8, v_add_wrap(v_load(y + 8), v_sub_wrap(v_load(a + 8), v_load(b + 8))));
+#else
+        for (int ind = 0; ind < 16; ++ind)
+            y[ind] = (HT)(y[ind] + a[ind] - b[ind]);
+#endif
+    }
+
+    //! y += k * x for a row of 16 buckets
+    static inline void histMulAdd(HT* y, const HT* x, int k)
+    {
+#if HL_SIMD128
+        v_uint16x8 vk = v_setall_u16((HT)k);
+        v_store(y, v_add_wrap(v_load(y), v_mul_wrap(v_load(x), vk)));
+        v_store(y + 8, v_add_wrap(v_load(y + 8), v_mul_wrap(v_load(x + 8), vk)));
+#else
+        for (int ind = 0; ind < 16; ++ind)
+            y[ind] = (HT)(y[ind] + k * x[ind]);
+#endif
+    }
+
+    void operator()(const Range& range) const override
+    {
 /**
- * HOP is short for Histogram OPeration. This macro makes an operation \a op on
- * histogram \a h for pixel value \a x. It takes care of handling both levels.
+ * COP is short for Column histogram OPeration. This macro makes an operation \a op on
+ * the column histogram \a j of channel \a c for pixel value \a x. It takes care of
+ * handling both levels.
  */
-#define HOP(h, x, op)    \
-    h.coarse[x >> 4] op, \
-        *((HT*)h.fine + x) op
-
 #define COP(c, j, x, op)                      \
     h_coarse[16 * (n * c + j) + (x >> 4)] op, \
         h_fine[16 * (n * (16 * c + (x >> 4)) + j) + (x & 0xF)] op
 
-    int cn = _dst.channels(), m = _dst.rows, r = (ksize - 1) / 2;
-    HL_Assert(cn > 0 && cn <= 4);
-    size_t sstep = _src.step, dstep = _dst.step;
-
-    int STRIPE_SIZE = std::min(_dst.cols, 512 / cn);
+        int    cn = dst.channels(), m = dst.rows, r = (ksize - 1) / 2;
+        size_t sstep = src.step, dstep = dst.step;
 
 #define HL_ALIGNMENT 16
 
-    std::vector<HT> _h_coarse(1 * 16 * (STRIPE_SIZE + 2 * r) * cn + HL_ALIGNMENT);
-    std::vector<HT> _h_fine(16 * 16 * (STRIPE_SIZE + 2 * r) * cn + HL_ALIGNMENT);
-    HT*             h_coarse = alignPtr(&_h_coarse[0], HL_ALIGNMENT);
-    HT*             h_fine   = alignPtr(&_h_fine[0], HL_ALIGNMENT);
-
-    for (int x = 0; x < _dst.cols; x += STRIPE_SIZE)
-    {
-        int          i, j, k, c, n = std::min(_dst.cols - x, STRIPE_SIZE) + r * 2;
-        const uchar* src = _src.ptr() + x * cn;
-        uchar*       dst = _dst.ptr() + (x - r) * cn;
-
-        memset(h_coarse, 0, 16 * n * cn * sizeof(h_coarse[0]));
-        memset(h_fine, 0, 16 * 16 * n * cn * sizeof(h_fine[0]));
+        // the column histograms are private to each stripe range, i.e. to each thread
+        std::vector<HT>  _h_coarse(1 * 16 * (stripeSize + 2 * r) * cn + HL_ALIGNMENT);
+        std::vector<HT>  _h_fine(16 * 16 * (stripeSize + 2 * r) * cn + HL_ALIGNMENT);
+        std::vector<int> _xofs(stripeSize + 2 * r);
+        HT*              h_coarse = alignPtr(&_h_coarse[0], HL_ALIGNMENT);
+        HT*              h_fine   = alignPtr(&_h_fine[0], HL_ALIGNMENT);
+        int*             xofs     = &_xofs[0];
 
-        // First row initialization
-        for (c = 0; c < cn; c++)
+        for (int x = range.start * stripeSize; x < std::min(range.end * stripeSize, dst.cols); x += stripeSize)
         {
-            for (j = 0; j < n; j++)
-                COP(c, j, src[cn * j + c], += (HT)(r + 2));
+            int          i, j, k, c, n = std::min(dst.cols - x, stripeSize) + r * 2;
+            const uchar* src0  = src.ptr();
+            uchar*       dst0  = dst.ptr() + (x - r) * cn;
 
-            for (i = 1; i < r; i++)
-            {
-                const uchar* p = src + sstep * std::min(i, m - 1);
-                for (j = 0; j < n; j++)
-                    COP(c, j, p[cn * j + c], ++);
-            }
-        }
+            // the horizontal border is read through the offset table instead of a padded copy
+            border.columnTab(xofs, x - r, n);
 
-        for (i = 0; i < m; i++)
-        {
-            const uchar* p0 = src + sstep * std::max(0, i - r - 1);
-            const uchar* p1 = src + sstep * std::min(m - 1, i + r);
+            memset(h_coarse, 0, 16 * n * cn * sizeof(h_coarse[0]));
+            memset(h_fine, 0, 16 * 16 * n * cn * sizeof(h_fine[0]));
 
+            // First row initialization
             for (c = 0; c < cn; c++)
             {
-                Histogram HL_DECL_ALIGNED(HL_ALIGNMENT) H;
-                HT        HL_DECL_ALIGNED(HL_ALIGNMENT) luc[16];
-
-                memset(&H, 0, sizeof(H));
-                memset(luc, 0, sizeof(luc));
-
-                // Update column histograms for the entire row.
                 for (j = 0; j < n; j++)
-                {
-                    COP(c, j, p0[j * cn + c], --);
-                    COP(c, j, p1[j * cn + c], ++);
-                }
+                    COP(c, j, src0[xofs[j] + c], += (HT)(r + 2));
 
-                // First column initialization
-                for (k = 0; k < 16; ++k)
+                for (i = 1; i < r; i++)
                 {
-                    for (int ind = 0; ind < 16; ++ind)
-                        H.fine[k][ind] = (HT)(H.fine[k][ind] + (2 * r + 1) * h_fine[16 * n * (16 * c + k) + ind]);
+                    const uchar* p = src0 + sstep * std::min(i, m - 1);
+                    for (j = 0; j < n; j++)
+                        COP(c, j, p[xofs[j] + c], ++);
                 }
+            }
 
-                HT* px = h_coarse + 16 * n * c;
-                for (j = 0; j < 2 * r; ++j, px += 16)
-                {
-                    for (int ind = 0; ind < 16; ++ind)
-                        H.coarse[ind] += px[ind];
-                }
+            for (i = 0; i < m; i++)
+            {
+                const uchar* p0 = src0 + sstep * std::max(0, i - r - 1);
+                const uchar* p1 = src0 + sstep * std::min(m - 1, i + r);
 
-                for (j = r; j < n - r; j++)
+                for (c = 0; c < cn; c++)
                 {
-                    int t = 2 * r * r + 2 * r, b, sum = 0;
-                    HT* segment;
-                    px = h_coarse + 16 * (n * c + std::min(j + r, n - 1));
-                    for (int ind = 0; ind < 16; ++ind)
-                        H.coarse[ind] += px[ind];
+                    Histogram HL_DECL_ALIGNED(HL_ALIGNMENT) H;
+                    HT        HL_DECL_ALIGNED(HL_ALIGNMENT) luc[16];
 
-                    // Find median at coarse level
-                    for (k = 0; k < 16; ++k)
+                    memset(&H, 0, sizeof(H));
+                    memset(luc, 0, sizeof(luc));
+
+                    // Update column histograms for the entire row.
+                    for (j = 0; j < n; j++)
                     {
-                        sum += H.coarse[k];
-                        if (sum > t)
-                        {
-                            sum -= H.coarse[k];
-                            break;
-                        }
+                        COP(c, j, p0[xofs[j] + c], --);
+                        COP(c, j, p1[xofs[j] + c], ++);
                     }
-                    HL_Assert(k < 16);
 
-                    /* Update corresponding histogram segment */
-                    if (luc[k] <= j - r)
+                    // First column initialization
+                    for (k = 0; k < 16; ++k)
+                        histMulAdd(H.fine[k], &h_fine[16 * n * (16 * c + k)], 2 * r + 1);
+
+                    HT* px = h_coarse + 16 * n * c;
+                    for (j = 0; j < 2 * r; ++j, px += 16)
+                        histAdd(H.coarse, px);
+
+                    for (j = r; j < n - r; j++)
                     {
-                        memset(&H.fine[k], 0, 16 * sizeof(HT));
-                        px = h_fine + 16 * (n * (16 * c + k) + j - r);
-                        for (luc[k] = HT(j - r); luc[k] < MIN(j + r + 1, n); ++luc[k], px += 16)
+                        int t = 2 * r * r + 2 * r, b, sum = 0;
+                        HT* segment;
+                        px = h_coarse + 16 * (n * c + std::min(j + r, n - 1));
+                        histAdd(H.coarse, px);
+
+                        // Find median at coarse level
+                        for (k = 0; k < 16; ++k)
                         {
-                            for (int ind = 0; ind < 16; ++ind)
-                                H.fine[k][ind] += px[ind];
+                            sum += H.coarse[k];
+                            if (sum > t)
+                            {
+                                sum -= H.coarse[k];
+                                break;
+                            }
                         }
+                        HL_Assert(k < 16);
 
-                        if (luc[k] < j + r + 1)
+                        /* Update corresponding histogram segment */
+                        if (luc[k] <= j - r)
                         {
-                            px = h_fine + 16 * (n * (16 * c + k) + (n - 1));
-                            for (int ind = 0; ind < 16; ++ind)
-                                H.fine[k][ind] = (HT)(H.fine[k][ind] + (j + r + 1 - n) * px[ind]);
-                            luc[k] = (HT)(j + r + 1);
+                            memset(&H.fine[k], 0, 16 * sizeof(HT));
+                            px = h_fine + 16 * (n * (16 * c + k) + j - r);
+                            for (luc[k] = HT(j - r); luc[k] < MIN(j + r + 1, n); ++luc[k], px += 16)
+                                histAdd(H.fine[k], px);
+
+                            if (luc[k] < j + r + 1)
+                            {
+                                px = h_fine + 16 * (n * (16 * c + k) + (n - 1));
+                                histMulAdd(H.fine[k], px, j + r + 1 - n);
+                                luc[k] = (HT)(j + r + 1);
+                            }
                         }
-                    }
-                    else
-                    {
-                        px = h_fine + 16 * n * (16 * c + k);
-                        for (; luc[k] < j + r + 1; ++luc[k])
+                        else
                         {
-                            for (int ind = 0; ind < 16; ++ind)
-                                H.fine[k][ind] += px[16 * MIN(luc[k], n - 1) + ind] - px[16 * MAX(luc[k] - 2 * r - 1, 0) + ind];
+                            px = h_fine + 16 * n * (16 * c + k);
+                            for (; luc[k] < j + r + 1; ++luc[k])
+                                histAddSub(H.fine[k], px + 16 * MIN(luc[k], n - 1), px + 16 * MAX(luc[k] - 2 * r - 1, 0));
                         }
-                    }
 
-                    px = h_coarse + 16 * (n * c + MAX(j - r, 0));
-                    for (int ind = 0; ind < 16; ++ind)
-                        H.coarse[ind] -= px[ind];
+                        px = h_coarse + 16 * (n * c + MAX(j - r, 0));
+                        histSub(H.coarse, px);
 
-                    /* Find median in segment */
-                    segment = H.fine[k];
-                    for (b = 0; b < 16; b++)
-                    {
-                        sum += segment[b];
-                        if (sum > t)
+                        /* Find median in segment */
+                        segment = H.fine[k];
+                        for (b = 0; b < 16; b++)
                         {
-                            dst[dstep * i + cn * j + c] = (uchar)(16 * k + b);
-                            break;
+                            sum += segment[b];
+                            if (sum > t)
+                            {
+                                dst0[dstep * i + cn * j + c] = (uchar)(16 * k + b);
+                                break;
+                            }
                         }
+                        HL_Assert(b < 16);
                     }
-                    HL_Assert(b < 16);
                 }
             }
         }
-    }
 
-#undef HOP
 #undef COP
-}
+    }
 
-static void medianBlur_8u_Om(const Mat& _src, Mat& _dst, int m)
+private:
+    const Mat&        src;
+    Mat&              dst;
+    int               ksize;
+    int               stripeSize;
+    BorderRowAccessor border;
+
+    MedianBlur_8u_O1_Invoker(const MedianBlur_8u_O1_Invoker&);                     // = delete;
+    const MedianBlur_8u_O1_Invoker& operator=(const MedianBlur_8u_O1_Invoker&);    // = delete;
+};
+
+class MedianBlur_8u_Om_Invoker: public ParallelLoopBody
 {
+public:
+    MedianBlur_8u_Om_Invoker(const Mat& _src, Mat& _dst, int _m):
+        ParallelLoopBody(), src(_src), dst(_dst), m(_m)
+    {
+        xtab.resize(dst.cols + m - 1);
+        BorderRowAccessor(src, BORDER_REPLICATE | BORDER_ISOLATED).columnTab(&xtab[0], -(m / 2), dst.cols + m - 1);
+    }
+
+    void operator()(const Range& range) const override
+    {
 #define N 16
-    int          zone0[4][N];
-    int          zone1[4][N * N];
-    int          x, y;
-    int          n2       = m * m / 2;
-    Size         size     = _dst.size();
-    const uchar* src      = _src.ptr();
-    uchar*       dst      = _dst.ptr();
-    int          src_step = (int)_src.step, dst_step = (int)_dst.step;
-    int          cn      = _src.channels();
-    const uchar* src_max = src + size.height * src_step;
-    HL_Assert(cn > 0 && cn <= 4);
+        int          zone0[4][N];
+        int          zone1[4][N * N];
+        int          x, y;
+        int          n2         = m * m / 2;
+        Size         size       = dst.size();
+        const uchar* src_data   = src.ptr();
+        uchar*       dst_data   = dst.ptr() + range.start * dst.channels();
+        int          src_step   = (int)src.step, dst_step = (int)dst.step;
+        int          cn         = src.channels();
+        const uchar* src_max    = src_data + size.height * src_step;
+        HL_Assert(cn > 0 && cn <= 4);
 
 #define UPDATE_ACC01(pix, cn, op) \
     {                             \
@@ -204,123 +272,161 @@ static void medianBlur_8u_Om(const Mat& _src, Mat& _dst, int m)
         zone0[cn][p >> 4] op;     \
     }
 
-    //HL_Assert( size.height >= nx && size.width >= nx );
-    for (x = 0; x < size.width; x++, src += cn, dst += cn)
-    {
-        uchar*       dst_cur    = dst;
-        const uchar* src_top    = src;
-        const uchar* src_bottom = src;
-        int          k, c;
-        int          src_step1 = src_step, dst_step1 = dst_step;
-
-        if (x % 2 != 0)
+        for (x = range.start; x < range.end; x++, dst_data += cn)
         {
-            src_bottom = src_top += src_step * (size.height - 1);
-            dst_cur              += dst_step * (size.height - 1);
-            src_step1             = -src_step1;
-            dst_step1             = -dst_step1;
-        }
+            // the m window columns of x, with the horizontal border replicated virtually
+            const int*   xofs       = &xtab[x];
+            uchar*       dst_cur    = dst_data;
+            const uchar* src_top    = src_data;
+            const uchar* src_bottom = src_data;
+            int          k, c;
+            int          src_step1 = src_step, dst_step1 = dst_step;
+
+            if (x % 2 != 0)
+            {
+                src_bottom = src_top += src_step * (size.height - 1);
+                dst_cur              += dst_step * (size.height - 1);
+                src_step1             = -src_step1;
+                dst_step1             = -dst_step1;
+            }
 
-        // init accumulator
-        memset(zone0, 0, sizeof(zone0[0]) * cn);
-        memset(zone1, 0, sizeof(zone1[0]) * cn);
+            // init accumulator
+            memset(zone0, 0, sizeof(zone0[0]) * cn);
+            memset(zone1, 0, sizeof(zone1[0]) * cn);
 
-        for (y = 0; y <= m / 2; y++)
-        {
-            for (c = 0; c < cn; c++)
+            for (y = 0; y <= m / 2; y++)
             {
-                if (y > 0)
+                for (c = 0; c < cn; c++)
                 {
-                    for (k = 0; k < m * cn; k += cn)
-                        UPDATE_ACC01(src_bottom[k + c], c, ++);
-                }
-                else
-                {
-                    for (k = 0; k < m * cn; k += cn)
-                        UPDATE_ACC01(src_bottom[k + c], c, += m / 2 + 1);
+                    if (y > 0)
+                    {
+                        for (k = 0; k < m; k++)
+                            UPDATE_ACC01(src_bottom[xofs[k] + c], c, ++);
+                    }
+                    else
+                    {
+                        for (k = 0; k < m; k++)
+                            UPDATE_ACC01(src_bottom[xofs[k] + c], c, += m / 2 + 1);
+                    }
                 }
-            }
 
-            if ((src_step1 > 0 && y < size.height - 1) || (src_step1 < 0 && size.height - y - 1 > 0))
-                src_bottom += src_step1;
-        }
+                if ((src_step1 > 0 && y < size.height - 1) || (src_step1 < 0 && size.height - y - 1 > 0))
+                    src_bottom += src_step1;
+            }
 
-        for (y = 0; y < size.height; y++, dst_cur += dst_step1)
-        {
-            // find median
-            for (c = 0; c < cn; c++)
+            for (y = 0; y < size.height; y++, dst_cur += dst_step1)
             {
-                int s = 0;
-                for (k = 0;; k++)
+                // find median
+                for (c = 0; c < cn; c++)
                 {
-                    int t = s + zone0[c][k];
-                    if (t > n2) break;
-                    s = t;
-                }
+                    int s = 0;
+                    for (k = 0;; k++)
+                    {
+                        int t = s + zone0[c][k];
+                        if (t > n2) break;
+                        s = t;
+                    }
 
-                for (k *= N;; k++)
-                {
-                    s += zone1[c][k];
-                    if (s > n2) break;
-                }
+                    for (k *= N;; k++)
+                    {
+                        s += zone1[c][k];
+                        if (s > n2) break;
+                    }
 
-                dst_cur[c] = (uchar)k;
-            }
+                    dst_cur[c] = (uchar)k;
+                }
 
-            if (y + 1 == size.height)
-                break;
+                if (y + 1 == size.height)
+                    break;
 
-            if (cn == 1)
-            {
-                for (k = 0; k < m; k++)
+                if (cn == 1)
                 {
-                    int p = src_top[k];
-                    int q = src_bottom[k];
-                    zone1[0][p]--;
-                    zone0[0][p >> 4]--;
-                    zone1[0][q]++;
-                    zone0[0][q >> 4]++;
+                    for (k = 0; k < m; k++)
+                    {
+                        int p = src_top[xofs[k]];
+                        int q = src_bottom[xofs[k]];
+                        zone1[0][p]--;
+                        zone0[0][p >> 4]--;
+                        zone1[0][q]++;
+                        zone0[0][q >> 4]++;
+                    }
                 }
-            }
-            else if (cn == 3)
-            {
-                for (k = 0; k < m * 3; k += 3)
+                else if (cn == 3)
                 {
-                    UPDATE_ACC01(src_top[k], 0, --);
-                    UPDATE_ACC01(src_top[k + 1], 1, --);
-                    UPDATE_ACC01(src_top[k + 2], 2, --);
+                    for (k = 0; k < m; k++)
+                    {
+                        const uchar* pt = src_top + xofs[k];
+                        const uchar* pb = src_bottom + xofs[k];
+
+                        UPDATE_ACC01(pt[0], 0, --);
+                        UPDATE_ACC01(pt[1], 1, --);
+                        UPDATE_ACC01(pt[2], 2, --);
 
-                    UPDATE_ACC01(src_bottom[k], 0, ++);
-                    UPDATE_ACC01(src_bottom[k + 1], 1, ++);
-                    UPDATE_ACC01(src_bottom[k + 2], 2, ++);
+                        UPDATE_ACC01(pb[0], 0, ++);
+                        UPDATE_ACC01(pb[1], 1, ++);
+                        UPDATE_ACC01(pb[2], 2, ++);
+                    }
                 }
-            }
-            else
-            {
-                HL_Assert(cn == 4);
-                for (k = 0; k < m * 4; k += 4)
+                else
                 {
-                    UPDATE_ACC01(src_top[k], 0, --);
-                    UPDATE_ACC01(src_top[k + 1], 1, --);
-                    UPDATE_ACC01(src_top[k + 2], 2, --);
-                    UPDATE_ACC01(src_top[k + 3], 3, --);
-
-                    UPDATE_ACC01(src_bottom[k], 0, ++);
-                    UPDATE_ACC01(src_bottom[k + 1], 1, ++);
-                    UPDATE_ACC01(src_bottom[k + 2], 2, ++);
-                    UPDATE_ACC01(src_bottom[k + 3], 3, ++);
+                    HL_Assert(cn == 4);
+                    for (k = 0; k < m; k++)
+                    {
+                        const uchar* pt = src_top + xofs[k];
+                        const uchar* pb = src_bottom + xofs[k];
+
+                        UPDATE_ACC01(pt[0], 0, --);
+                        UPDATE_ACC01(pt[1], 1, --);
+                        UPDATE_ACC01(pt[2], 2, --);
+                        UPDATE_ACC01(pt[3], 3, --);
+
+                        UPDATE_ACC01(pb[0], 0, ++);
+                        UPDATE_ACC01(pb[1], 1, ++);
+                        UPDATE_ACC01(pb[2], 2, ++);
+                        UPDATE_ACC01(pb[3], 3, ++);
+                    }
                 }
-            }
 
-            if ((src_step1 > 0 && src_bottom + src_step1 < src_max) || (src_step1 < 0 && src_bottom + src_step1 >= src))
-                src_bottom += src_step1;
+                if ((src_step1 > 0 && src_bottom + src_step1 < src_max) || (src_step1 < 0 && src_bottom + src_step1 >= src_data))
+                    src_bottom += src_step1;
 
-            if (y >= m / 2)
-                src_top += src_step1;
+                if (y >= m / 2)
+                    src_top += src_step1;
+            }
         }
-    }
 #undef N
-#undef UPDATE_ACC
+#undef UPDATE_ACC01
+    }
+
+private:
+    const Mat&       src;
+    Mat&             dst;
+    int              m;
+    std::vector<int> xtab;
+
+    MedianBlur_8u_Om_Invoker(const MedianBlur_8u_Om_Invoker&);                     // = delete;
+    const MedianBlur_8u_Om_Invoker& operator=(const MedianBlur_8u_Om_Invoker&);    // = delete;
+};
+}    // namespace
+
+static void medianBlur_8u_O1(const Mat& _src, Mat& _dst, int ksize)
+{
+    int cn = _dst.channels();
+    HL_Assert(cn > 0 && cn <= 4);
+
+    // 512/cn wide stripes keep the column histograms of a stripe in L2; they are independent
+    // of each other, so the stripes are distributed among the threads
+    int stripeSize = std::min(_dst.cols, 512 / cn);
+    int nstripes   = (_dst.cols + stripeSize - 1) / stripeSize;
+
+    parallel_for_(Range(0, nstripes), MedianBlur_8u_O1_Invoker(_src, _dst, ksize, stripeSize), nstripes);
+}
+
+static void medianBlur_8u_Om(const Mat& _src, Mat& _dst, int m)
+{
+    HL_Assert(_src.channels() > 0 && _src.channels() <= 4);
+
+    parallel_for_(Range(0, _dst.cols), MedianBlur_8u_Om_Invoker(_src, _dst, m), _dst.total() / (double)(1 << 16));
 }
 
 namespace
@@ -330,6 +436,11 @@ struct MinMax8u
     typedef uchar value_type;
     typedef int   arg_type;
 
+    enum
+    {
+        SIZE = 1
+    };
+
     arg_type load(const uchar* ptr) { return *ptr; }
 
     void store(uchar* ptr, arg_type val) { *ptr = (uchar)val; }
@@ -347,6 +458,11 @@ struct MinMax16u
     typedef ushort value_type;
     typedef int    arg_type;
 
+    enum
+    {
+        SIZE = 1
+    };
+
     arg_type load(const ushort* ptr) { return *ptr; }
 
     void store(ushort* ptr, arg_type val) { *ptr = (ushort)val; }
@@ -364,6 +480,11 @@ struct MinMax16s
     typedef short value_type;
     typedef int   arg_type;
 
+    enum
+    {
+        SIZE = 1
+    };
+
     arg_type load(const short* ptr) { return *ptr; }
 
     void store(short* ptr, arg_type val) { *ptr = (short)val; }
@@ -381,32 +502,110 @@ struct MinMax32f
     typedef float value_type;
     typedef float arg_type;
 
+    enum
+    {
+        SIZE = 1
+    };
+
     arg_type load(const float* ptr) { return *ptr; }
 
     void store(float* ptr, arg_type val) { *ptr = val; }
 
+    // compared in the operand order of v_min/v_max, so NaN and -0 come out the same as in MinMaxVec32f
     void operator()(arg_type& a, arg_type& b) const
     {
         arg_type t = a;
-        a          = std::min(a, b);
-        b          = std::max(b, t);
+        a          = a < b ? a : b;
+        b          = b > t ? b : t;
     }
 };
 
+#if HL_SIMD128
+/**
+ * Vector counterpart of the MinMax* operations above: the compare-exchange is done on a
+ * whole register of consecutive elements, so the sorting networks below process 16 (8u),
+ * 8 (16u/16s) or 4 (32f) pixels per step instead of one.
+ */
+template <typename T>
+struct MinMaxVec
+{
+    typedef T                                    value_type;
+    typedef v_reg<T, HL_SIMD_WIDTH / sizeof(T)> arg_type;
+
+    enum
+    {
+        SIZE = arg_type::nlanes
+    };
+
+    arg_type load(const T* ptr) { return v_load(ptr); }
+
+    void store(T* ptr, const arg_type& val) { v_store(ptr, val); }
+
+    void operator()(arg_type& a, arg_type& b) const
+    {
+        arg_type t = a;
+        a          = v_min(a, b);
+        b          = v_max(b, t);
+    }
+};
+
+/**
+ * A float register holds only 4 pixels, so the 32f networks work on two of them at a time
+ * and step by 8 pixels like the 16u/16s ones.
+ */
+template <>
+struct MinMaxVec<float>
+{
+    typedef float value_type;
+
+    struct arg_type
+    {
+        v_float32x4 lo, hi;
+    };
+
+    enum
+    {
+        SIZE = v_float32x4::nlanes * 2
+    };
+
+    arg_type load(const float* ptr) { return {v_load(ptr), v_load(ptr + v_float32x4::nlanes)}; }
+
+    void store(float* ptr, const arg_type& val)
+    {
+        v_store(ptr, val.lo);
+        v_store(ptr + v_float32x4::nlanes, val.hi);
+    }
+
+    void operator()(arg_type& a, arg_type& b) const
+    {
+        arg_type t = a;
+        a.lo       = v_min(a.lo, b.lo);
+        a.hi       = v_min(a.hi, b.hi);
+        b.lo       = v_max(b.lo, t.lo);
+        b.hi       = v_max(b.hi, t.hi);
+    }
+};
+
+typedef MinMaxVec<uchar>  MinMaxVec8u;
+typedef MinMaxVec<ushort> MinMaxVec16u;
+typedef MinMaxVec<short>  MinMaxVec16s;
+typedef MinMaxVec<float>  MinMaxVec32f;
+#else
 typedef MinMax8u  MinMaxVec8u;
 typedef MinMax16u MinMaxVec16u;
 typedef MinMax16s MinMaxVec16s;
 typedef MinMax32f MinMaxVec32f;
+#endif
 
 template <class Op, class VecOp>
-static void medianBlur_SortNet(const Mat& _src, Mat& _dst, int m)
+static void medianBlur_SortNet(const Mat& _src, Mat& _dst, int m, const Range& range)
 {
     typedef typename Op::value_type  T;
     typedef typename Op::arg_type    WT;
     typedef typename VecOp::arg_type VT;
 
     const T* src   = _src.ptr<T>();
-    T*       dst   = _dst.ptr<T>();
+    T*       dst   = _dst.ptr<T>(range.start);
     int      sstep = (int)(_src.step / sizeof(T));
     int      dstep = (int)(_dst.step / sizeof(T));
     Size     size  = _dst.size();
@@ -416,6 +615,7 @@ static void medianBlur_SortNet(const Mat& _src, Mat& _dst, int m)
 
     if (m == 3)
     {
+        // single row/column images are processed as a whole, see MedianBlur_SortNet_Invoker
         if (size.width == 1 || size.height == 1)
         {
             int len     = size.width + size.height - 1;
@@ -439,7 +639,7 @@ static void medianBlur_SortNet(const Mat& _src, Mat& _dst, int m)
         }
 
         size.width *= cn;
-        for (i = 0; i < size.height; i++, dst += dstep)
+        for (i = range.start; i < range.end; i++, dst += dstep)
         {
             const T* row0  = src + std::max(i - 1, 0) * sstep;
             const T* row1  = src + i * sstep;
@@ -481,7 +681,7 @@ static void medianBlur_SortNet(const Mat& _src, Mat& _dst, int m)
                 if (limit == size.width)
                     break;
 
-                for (int nlanes = 1; j <= size.width - nlanes - cn; j += nlanes)
+                for (const int nlanes = VecOp::SIZE; j <= size.width - nlanes - cn; j += nlanes)
                 {
                     VT p0 = vop.load(row0 + j - cn), p1 = vop.load(row0 + j), p2 = vop.load(row0 + j + cn);
                     VT p3 = vop.load(row1 + j - cn), p4 = vop.load(row1 + j), p5 = vop.load(row1 + j + cn);
@@ -515,6 +715,7 @@ static void medianBlur_SortNet(const Mat& _src, Mat& _dst, int m)
     }
     else if (m == 5)
     {
+        // single row/column images are processed as a whole, see MedianBlur_SortNet_Invoker
         if (size.width == 1 || size.height == 1)
         {
             int len     = size.width + size.height - 1;
@@ -545,7 +746,7 @@ static void medianBlur_SortNet(const Mat& _src, Mat& _dst, int m)
         }
 
         size.width *= cn;
-        for (i = 0; i < size.height; i++, dst += dstep)
+        for (i = range.start; i < range.end; i++, dst += dstep)
         {
             const T* row[5];
             row[0]    = src + std::max(i - 2, 0) * sstep;
@@ -693,7 +894,7 @@ static void medianBlur_SortNet(const Mat& _src, Mat& _dst, int m)
                 if (limit == size.width)
                     break;
 
-                for (int nlanes = 1; j <= size.width - nlanes - cn * 2; j += nlanes)
+                for (const int nlanes = VecOp::SIZE; j <= size.width - nlanes - cn * 2; j += nlanes)
                 {
                     VT p0 = vop.load(row[0] + j - cn * 2), p5 = vop.load(row[1] + j - cn * 2), p10 = vop.load(row[2] + j - cn * 2), p15 = vop.load(row[3] + j - cn * 2), p20 = vop.load(row[4] + j - cn * 2);
                     VT p1 = vop.load(row[0] + j - cn * 1), p6 = vop.load(row[1] + j - cn * 1), p11 = vop.load(row[2] + j - cn * 1), p16 = vop.load(row[3] + j - cn * 1), p21 = vop.load(row[4] + j - cn * 1);
@@ -822,6 +1023,403 @@ static void medianBlur_SortNet(const Mat& _src, Mat& _dst, int m)
         }
     }
 }
+
+template <class Op, class VecOp>
+class MedianBlur_SortNet_Invoker: public ParallelLoopBody
+{
+public:
+    MedianBlur_SortNet_Invoker(const Mat& _src, Mat& _dst, int _m):
+        ParallelLoopBody(), src(_src), dst(_dst), m(_m)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        medianBlur_SortNet<Op, VecOp>(src, dst, m, range);
+    }
+
+    static void run(const Mat& src, Mat& dst, int m)
+    {
+        MedianBlur_SortNet_Invoker body(src, dst, m);
+        Range                      range(0, dst.rows);
+
+        if (dst.rows == 1 || dst.cols == 1)
+            body(range);
+        else
+            parallel_for_(range, body, dst.total() / (double)(1 << 16));
+    }
+
+private:
+    const Mat& src;
+    Mat&       dst;
+    int        m;
+
+    MedianBlur_SortNet_Invoker(const MedianBlur_SortNet_Invoker&);                     // = delete;
+    const MedianBlur_SortNet_Invoker& operator=(const MedianBlur_SortNet_Invoker&);    // = delete;
+};
+
+//! maps a float to an int with the same order, and puts the NaNs at the ends of the range
+static inline int floatOrderKey(float v)
+{
+    Hl32suf u;
+    u.f = v;
+    return u.i ^ ((u.i >> 31) & 0x7fffffff);
+}
+
+/**
+ * Multi-level histogram of 16-bit keys used by the large kernel median of the 16U, 16S
+ * and 32F images. Each level refines the previous one by 4 bits (16, 256, 4096 and 65536
+ * buckets), so an update touches 4 counters and a median query scans at most 4 * 16
+ * buckets, instead of walking a flat 65536 bucket histogram.
+ */
+class MultiLevelHistogram16
+{
+public:
+    MultiLevelHistogram16():
+        buf(16 + 256 + 4096 + 65536)
+    {
+        h0 = &buf[0];
+        h1 = h0 + 16;
+        h2 = h1 + 256;
+        h3 = h2 + 4096;
+    }
+
+    void clear() { memset(&buf[0], 0, buf.size() * sizeof(buf[0])); }
+
+    inline void add(int v)
+    {
+        h0[v >> 12]++;
+        h1[v >> 8]++;
+        h2[v >> 4]++;
+        h3[v]++;
+    }
+
+    inline void remove(int v)
+    {
+        h0[v >> 12]--;
+        h1[v >> 8]--;
+        h2[v >> 4]--;
+        h3[v]--;
+    }
+
+    //! returns the smallest key k such that more than n2 of the inserted keys are <= k
+    inline int find(int n2) const
+    {
+        int s = 0, k = findBucket(h0, 0, s, n2);
+        k     = findBucket(h1, k << 4, s, n2);
+        k     = findBucket(h2, k << 4, s, n2);
+        return findBucket(h3, k << 4, s, n2);
+    }
+
+private:
+    static inline int findBucket(const int* h, int k, int& s, int n2)
+    {
+        for (;; k++)
+        {
+            int t = s + h[k];
+            if (t > n2)
+                return k;
+            s = t;
+        }
+    }
+
+    std::vector<int> buf;
+    int*             h0;
+    int*             h1;
+    int*             h2;
+    int*             h3;
+
+    MultiLevelHistogram16(const MultiLevelHistogram16&);                     // = delete;
+    const MultiLevelHistogram16& operator=(const MultiLevelHistogram16&);    // = delete;
+};
+
+/**
+ * Large kernel median for 16U, 16S and 32F images.
+ *
+ * The image is split into tiles that are processed in parallel. Every tile is gathered
+ * together with its halo (replicating the image border) as 16-bit keys: 16U values are
+ * used as is, 16S values are offset by 32768, and 32F values are replaced by their rank
+ * among the distinct values of the tile, which is why a tile with its halo never holds
+ * more than 65536 pixels. The window then walks the tile in a serpentine order, so that
+ * every step only removes and inserts one row or column of the window in the histogram.
+ * The 16-bit values are their own keys, so only the 32F tiles are bounded by the key count;
+ * the 32F kernels that do not leave room for a tile of MIN_TILE_SIZE pixels go through
+ * MedianBlur_Sort32f_Invoker instead.
+ */
+template <typename T>
+class MedianBlur_LargeKernel_Invoker: public ParallelLoopBody
+{
+public:
+    enum
+    {
+        MAX_TILE_SIZE  = 256,
+        MIN_TILE_SIZE  = 16,
+        WIDE_TILE_SIZE = 64
+    };
+
+    //! the tile size for the kernel, 0 if the 32F keys of a tile with its halo would not fit in 16 bits
+    static int tileSizeFor(int ksize)
+    {
+        int size = MAX_TILE_SIZE - (ksize - 1);
+        if (std::is_same<T, float>::value)
+            return size >= MIN_TILE_SIZE ? size : 0;
+
+        // the halo of a wide kernel is gathered and the window is filled once per tile, so the tiles
+        // are kept large enough for the m * m fill to stay small next to the m steps of every pixel
+        return std::max(size, (int)WIDE_TILE_SIZE);
+    }
+
+    MedianBlur_LargeKernel_Invoker(const Mat& _src, Mat& _dst, int _ksize):
+        ParallelLoopBody(), src(_src), dst(_dst), ksize(_ksize), border(_src, BORDER_REPLICATE | BORDER_ISOLATED)
+    {
+        tileSize = tileSizeFor(ksize);
+        HL_DbgAssert(tileSize > 0);
+        tilesX = (dst.cols + tileSize - 1) / tileSize;
+        tilesY = (dst.rows + tileSize - 1) / tileSize;
+    }
+
+    int tilesCount() const { return tilesX * tilesY; }
+
+    void operator()(const Range& range) const override
+    {
+        int m = ksize, r = ksize / 2, n2 = m * m / 2, cn = src.channels();
+        int maxExt = tileSize + m - 1;
+
+        MultiLevelHistogram16 hist;
+        std::vector<ushort>   _keys(maxExt * maxExt);
+        std::vector<T>        _vals(maxExt * maxExt);
+        std::vector<int>      _xofs(maxExt);
+        ushort*               keys = &_keys[0];
+        T*                    vals = &_vals[0];
+        int*                  xofs = &_xofs[0];
+
+        for (int tile = range.start; tile < range.end; tile++)
+        {
+            int x0 = (tile % tilesX) * tileSize, y0 = (tile / tilesX) * tileSize;
+            int tw = std::min(tileSize, dst.cols - x0), th = std::min(tileSize, dst.rows - y0);
+            int bw = tw + m - 1, bh = th + m - 1;
+
+            border.columnTab(xofs, x0 - r, bw);
+
+            for (int c = 0; c < cn; c++)
+            {
+                // gather the tile with its halo
+                for (int i = 0; i < bh; i++)
+                {
+                    const T* sp = (const T*)border.row(y0 - r + i) + c;
+                    T*       vp = vals + i * bw;
+                    for (int j = 0; j < bw; j++)
+                        vp[j] = sp[xofs[j]];
+                }
+
+                int       area = bw * bh;
+                const T*  lut  = toKeys(vals, keys, area);
+                ushort*   K    = keys;
+
+                hist.clear();
+                for (int i = 0; i < m; i++)
+                    for (int j = 0; j < m; j++)
+                        hist.add(K[i * bw + j]);
+
+                for (int y = 0; y < th; y++)
+                {
+                    T*   D       = dst.ptr<T>(y0 + y) + x0 * cn + c;
+                    bool forward = y % 2 == 0;
+                    int  x       = forward ? 0 : tw - 1;
+
+                    for (int xi = 0;; xi++)
+                    {
+                        D[x * cn] = fromKey(lut, hist.find(n2));
+                        if (xi == tw - 1)
+                            break;
+
+                        const ushort* col = K + y * bw + x;
+                        if (forward)
+                        {
+                            for (int i = 0; i < m; i++)
+                            {
+                                hist.remove(col[i * bw]);
+                                hist.add(col[i * bw + m]);
+                            }
+                            x++;
+                        }
+                        else
+                        {
+                            for (int i = 0; i < m; i++)
+                            {
+                                hist.remove(col[i * bw + m - 1]);
+                                hist.add(col[i * bw - 1]);
+                            }
+                            x--;
+                        }
+                    }
+
+                    if (y + 1 < th)
+                    {
+                        const ushort* top    = K + y * bw + x;
+                        const ushort* bottom = top + m * bw;
+                        for (int j = 0; j < m; j++)
+                        {
+                            hist.remove(top[j]);
+                            hist.add(bottom[j]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    //! converts the gathered values to keys; returns the key -> value table if one is needed
+    static const T* toKeys(T* vals, ushort* keys, int area);
+
+    static inline T fromKey(const T* lut, int k);
+
+    const Mat&        src;
+    Mat&              dst;
+    int               ksize;
+    int               tileSize;
+    int               tilesX;
+    int               tilesY;
+    BorderRowAccessor border;
+
+    MedianBlur_LargeKernel_Invoker(const MedianBlur_LargeKernel_Invoker&);                     // = delete;
+    const MedianBlur_LargeKernel_Invoker& operator=(const MedianBlur_LargeKernel_Invoker&);    // = delete;
+};
+
+template <>
+const ushort* MedianBlur_LargeKernel_Invoker<ushort>::toKeys(ushort* vals, ushort* keys, int area)
+{
+    memcpy(keys, vals, area * sizeof(keys[0]));
+    return 0;
+}
+
+template <>
+inline ushort MedianBlur_LargeKernel_Invoker<ushort>::fromKey(const ushort*, int k)
+{
+    return (ushort)k;
+}
+
+template <>
+const short* MedianBlur_LargeKernel_Invoker<short>::toKeys(short* vals, ushort* keys, int area)
+{
+    for (int i = 0; i < area; i++)
+        keys[i] = (ushort)(vals[i] + 32768);
+    return 0;
+}
+
+template <>
+inline short MedianBlur_LargeKernel_Invoker<short>::fromKey(const short*, int k)
+{
+    return (short)(k - 32768);
+}
+
+template <>
+const float* MedianBlur_LargeKernel_Invoker<float>::toKeys(float* vals, ushort* keys, int area)
+{
+    // the keys are the ranks among the distinct values; the gathered values are reused
+    // for the sorted table, so the ranks are computed from a sorted copy of the indices.
+    // The values are ordered through their total order keys, which keeps NaNs well defined
+    AutoBuffer<int> _idx(area), _order(area);
+    int*            idx   = _idx.data();
+    int*            order = _order.data();
+    for (int i = 0; i < area; i++)
+    {
+        idx[i]   = i;
+        order[i] = floatOrderKey(vals[i]);
+    }
+    std::sort(idx, idx + area, [order](int a, int b) { return order[a] < order[b]; });
+
+    AutoBuffer<float> _sorted(area);
+    float*            sorted = _sorted.data();
+    int               nvals  = 0;
+    for (int i = 0; i < area; i++)
+    {
+        if (nvals == 0 || order[idx[i - 1]] != order[idx[i]])
+            sorted[nvals++] = vals[idx[i]];
+        keys[idx[i]] = (ushort)(nvals - 1);
+    }
+
+    memcpy(vals, sorted, nvals * sizeof(vals[0]));
+    return vals;
+}
+
+template <>
+inline float MedianBlur_LargeKernel_Invoker<float>::fromKey(const float* lut, int k)
+{
+    return lut[k];
+}
+
+/**
+ * Median of the 32F kernels too large for the tiled histogram, found with nth_element in every
+ * window. The elements are compared through their total order keys.
+ */
+class MedianBlur_Sort32f_Invoker: public ParallelLoopBody
+{
+public:
+    MedianBlur_Sort32f_Invoker(const Mat& _src, Mat& _dst, int _ksize):
+        ParallelLoopBody(), src(_src), dst(_dst), ksize(_ksize), border(_src, BORDER_REPLICATE | BORDER_ISOLATED)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        int m = ksize, r = ksize / 2, n2 = m * m / 2, cn = src.channels();
+
+        std::vector<int> _xofs(dst.cols + m - 1);
+        std::vector<int> _keys(m * m);
+        int*             xofs = &_xofs[0];
+        int*             keys = &_keys[0];
+
+        border.columnTab(xofs, -r, dst.cols + m - 1);
+
+        for (int y = range.start; y < range.end; y++)
+        {
+            float* D = dst.ptr<float>(y);
+            for (int x = 0; x < dst.cols; x++)
+                for (int c = 0; c < cn; c++)
+                {
+                    for (int i = 0; i < m; i++)
+                    {
+                        const float* sp = (const float*)border.row(y - r + i) + c;
+                        for (int j = 0; j < m; j++)
+                            keys[i * m + j] = floatOrderKey(sp[xofs[x + j]]);
+                    }
+                    std::nth_element(keys, keys + n2, keys + m * m);
+
+                    Hl32suf u;
+                    u.i           = keys[n2] ^ ((keys[n2] >> 31) & 0x7fffffff);
+                    D[x * cn + c] = u.f;
+                }
+        }
+    }
+
+private:
+    const Mat&        src;
+    Mat&              dst;
+    int               ksize;
+    BorderRowAccessor border;
+
+    MedianBlur_Sort32f_Invoker(const MedianBlur_Sort32f_Invoker&);                     // = delete;
+    const MedianBlur_Sort32f_Invoker& operator=(const MedianBlur_Sort32f_Invoker&);    // = delete;
+};
+
+template <typename T>
+static void medianBlur_LargeKernel(const Mat& src, Mat& dst, int ksize)
+{
+    if constexpr (std::is_same<T, float>::value)
+    {
+        if (MedianBlur_LargeKernel_Invoker<T>::tileSizeFor(ksize) == 0)
+        {
+            MedianBlur_Sort32f_Invoker body(src, dst, ksize);
+            parallel_for_(Range(0, dst.rows), body, dst.total() / (double)(1 << 16));
+            return;
+        }
+    }
+
+    MedianBlur_LargeKernel_Invoker<T> body(src, dst, ksize);
+    parallel_for_(Range(0, body.tilesCount()), body, body.tilesCount());
+}
 }    // namespace
 
 void medianBlur(const Mat& src0, Mat& dst, int ksize)
@@ -837,13 +1435,13 @@ void medianBlur(const Mat& src0, Mat& dst, int ksize)
             src0.copyTo(src);
 
         if (src.depth() == HL_8U)
-            medianBlur_SortNet<MinMax8u, MinMaxVec8u>(src, dst, ksize);
+            MedianBlur_SortNet_Invoker<MinMax8u, MinMaxVec8u>::run(src, dst, ksize);
         else if (src.depth() == HL_16U)
-            medianBlur_SortNet<MinMax16u, MinMaxVec16u>(src, dst, ksize);
+            MedianBlur_SortNet_Invoker<MinMax16u, MinMaxVec16u>::run(src, dst, ksize);
         else if (src.depth() == HL_16S)
-            medianBlur_SortNet<MinMax16s, MinMaxVec16s>(src, dst, ksize);
+            MedianBlur_SortNet_Invoker<MinMax16s, MinMaxVec16s>::run(src, dst, ksize);
         else if (src.depth() == HL_32F)
-            medianBlur_SortNet<MinMax32f, MinMaxVec32f>(src, dst, ksize);
+            MedianBlur_SortNet_Invoker<MinMax32f, MinMaxVec32f>::run(src, dst, ksize);
         else
             HL_Error(HL_StsUnsupportedFormat, "");
 
@@ -851,11 +1449,27 @@ void medianBlur(const Mat& src0, Mat& dst, int ksize)
     }
     else
     {
-        // TODO AVX guard (external call)
-        hl::copyMakeBorder(src0, src, 0, 0, ksize / 2, ksize / 2, BORDER_REPLICATE | BORDER_ISOLATED);
+        // the horizontal border is replicated virtually by the kernels, no padded copy is needed
+        if (dst.data != src0.data)
+            src = src0;
+        else
+            src0.copyTo(src);
+
+        if (src.depth() != HL_8U)
+        {
+            if (src.depth() == HL_16U)
+                medianBlur_LargeKernel<ushort>(src, dst, ksize);
+            else if (src.depth() == HL_16S)
+                medianBlur_LargeKernel<short>(src, dst, ksize);
+            else if (src.depth() == HL_32F)
+                medianBlur_LargeKernel<float>(src, dst, ksize);
+            else
+                HL_Error(HL_StsUnsupportedFormat, "");
+            return;
+        }
 
         int cn = src0.channels();
-        HL_Assert(src.depth() == HL_8U && (cn == 1 || cn == 3 || cn == 4));
+        HL_Assert(cn == 1 || cn == 3 || cn == 4);
 
         double img_size_mp = (double)(src0.total()) / (1 << 20);
         if (ksize <= 3 + (img_size_mp < 1 ? 12 : img_size_mp < 4 ? 6
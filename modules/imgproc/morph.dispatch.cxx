@@ -0,0 +1,281 @@
+#include "precomp.hxx"
+#include <vector>
+#include "morph.simd.hxx"
+
+/****************************************************************************************\
+                     Basic Morphological Operations: Erosion & Dilation
+\****************************************************************************************/
+
+namespace hl
+{
+
+Mat getStructuringElement(int shape, Size ksize, Point anchor)
+{
+    int    i, j;
+    int    r = 0, c = 0;
+    double inv_r2 = 0;
+
+    HL_Assert(shape == MORPH_RECT || shape == MORPH_CROSS || shape == MORPH_ELLIPSE);
+
+    if (anchor.x < 0)
+        anchor.x = ksize.width / 2;
+    if (anchor.y < 0)
+        anchor.y = ksize.height / 2;
+    HL_Assert(0 <= anchor.x && anchor.x < ksize.width && 0 <= anchor.y && anchor.y < ksize.height);
+
+    if (ksize == Size(1, 1))
+        shape = MORPH_RECT;
+
+    if (shape == MORPH_ELLIPSE)
+    {
+        r      = ksize.height / 2;
+        c      = ksize.width / 2;
+        inv_r2 = r ? 1. / ((double)r * r) : 0;
+    }
+
+    Mat elem(ksize, HL_8U);
+
+    for (i = 0; i < ksize.height; i++)
+    {
+        uchar* ptr = elem.ptr<uchar>(i);
+        int    j1 = 0, j2 = 0;
+
+        if (shape == MORPH_RECT || (shape == MORPH_CROSS && i == anchor.y))
+            j2 = ksize.width;
+        else if (shape == MORPH_CROSS)
+            j1 = anchor.x, j2 = j1 + 1;
+        else
+        {
+            int dy = i - r;
+            if (std::abs(dy) <= r)
+            {
+                int dx = saturate_cast<int>(c * std::sqrt((r * r - dy * dy) * inv_r2));
+                j1     = std::max(c - dx, 0);
+                j2     = std::min(c + dx + 1, ksize.width);
+            }
+        }
+
+        for (j = 0; j < j1; j++)
+            ptr[j] = 0;
+        for (; j < j2; j++)
+            ptr[j] = 1;
+        for (; j < ksize.width; j++)
+            ptr[j] = 0;
+    }
+
+    return elem;
+}
+
+namespace
+{
+
+//! returns true if the only non-zero elements of the kernel are the row and the column of the anchor
+static bool isCrossKernel(const Mat& kernel, Point anchor)
+{
+    for (int i = 0; i < kernel.rows; i++)
+    {
+        const uchar* krow = kernel.ptr<uchar>(i);
+        for (int j = 0; j < kernel.cols; j++)
+            if ((krow[j] != 0) != (i == anchor.y || j == anchor.x))
+                return false;
+    }
+    return true;
+}
+
+class MorphologyRunner: public ParallelLoopBody
+{
+public:
+    MorphologyRunner(const Mat& _src, Mat& _dst, int _nStripes, int _op, const Mat& _kernel, Point _anchor, const Size& _wholeSize, const Point& _ofs, int _borderType, const Scalar& _borderValue):
+        ParallelLoopBody(), src(_src), dst(_dst), nStripes(_nStripes), op(_op), kernel(_kernel), anchor(_anchor), wholeSize(_wholeSize), ofs(_ofs), borderType(_borderType), borderValue(_borderValue)
+    {
+        // a cross is the union of its row and its column, both of which are separable
+        crossKernel = (kernel.cols > 3 || kernel.rows > 3) && isCrossKernel(kernel, anchor);
+    }
+
+    void operator()(const Range& range) const override
+    {
+        int   row0      = std::min(hlRound(range.start * src.rows / (double)nStripes), src.rows);
+        int   row1      = std::min(hlRound(range.end * src.rows / (double)nStripes), src.rows);
+
+        Mat   srcStripe = src.rowRange(row0, row1);
+        Mat   dstStripe = dst.rowRange(row0, row1);
+        Point stripeOfs = ofs + Point(0, row0);
+
+        if (!crossKernel)
+        {
+            Ptr<FilterEngine> f = cpu_baseline::createMorphologyFilter(op, src.type(), kernel, anchor, borderType, borderType, borderValue);
+            f->apply(srcStripe, dstStripe, wholeSize, stripeOfs);
+            return;
+        }
+
+        Mat hkernel(1, kernel.cols, HL_8U, Scalar::all(1));
+        Mat vkernel(kernel.rows, 1, HL_8U, Scalar::all(1));
+        Mat vstripe(dstStripe.size(), dstStripe.type());
+
+        Ptr<FilterEngine> hf = cpu_baseline::createMorphologyFilter(op, src.type(), hkernel, Point(anchor.x, 0), borderType, borderType, borderValue);
+        Ptr<FilterEngine> vf = cpu_baseline::createMorphologyFilter(op, src.type(), vkernel, Point(0, anchor.y), borderType, borderType, borderValue);
+        hf->apply(srcStripe, dstStripe, wholeSize, stripeOfs);
+        vf->apply(srcStripe, vstripe, wholeSize, stripeOfs);
+
+        if (op == MORPH_ERODE)
+            min(dstStripe, vstripe, dstStripe);
+        else
+            max(dstStripe, vstripe, dstStripe);
+    }
+
+private:
+    const Mat& src;
+    Mat&       dst;
+    int        nStripes;
+    int        op;
+    Mat        kernel;
+    Point      anchor;
+    Size       wholeSize;
+    Point      ofs;
+    int        borderType;
+    Scalar     borderValue;
+    bool       crossKernel;
+
+    MorphologyRunner(const MorphologyRunner&);                     // = delete;
+    const MorphologyRunner& operator=(const MorphologyRunner&);    // = delete;
+};
+
+}    // namespace
+
+static void morphOp(int op, const Mat& _src, Mat& _dst, const Mat& _kernel, Point anchor, int iterations, int borderType, const Scalar& borderValue)
+{
+    HL_Assert(!_src.empty());
+    HL_Assert(op == MORPH_ERODE || op == MORPH_DILATE);
+
+    Mat  kernel = _kernel;
+    Size ksize  = !kernel.empty() ? kernel.size() : Size(3, 3);
+    if (anchor.x < 0)
+        anchor.x = ksize.width / 2;
+    if (anchor.y < 0)
+        anchor.y = ksize.height / 2;
+    HL_Assert(0 <= anchor.x && anchor.x < ksize.width && 0 <= anchor.y && anchor.y < ksize.height);
+
+    int nz = 0;
+    if (kernel.empty())
+        nz = 9;
+    else
+    {
+        HL_Assert(kernel.type() == HL_8U);
+        for (int i = 0; i < kernel.rows; i++)
+        {
+            const uchar* krow = kernel.ptr<uchar>(i);
+            for (int j = 0; j < kernel.cols; j++)
+                nz += krow[j] != 0;
+        }
+    }
+
+    if (iterations == 0 || nz == 0 || ksize.area() == 1)
+    {
+        _src.copyTo(_dst);
+        return;
+    }
+
+    // the repeated erosion/dilation with a rectangle is the erosion/dilation with a larger one
+    if (nz == ksize.area())
+    {
+        if (iterations > 1)
+        {
+            anchor     = Point(anchor.x * iterations, anchor.y * iterations);
+            ksize      = Size(ksize.width + (iterations - 1) * (ksize.width - 1), ksize.height + (iterations - 1) * (ksize.height - 1));
+            iterations = 1;
+        }
+        kernel = getStructuringElement(MORPH_RECT, ksize, anchor);
+    }
+
+    Mat src = _src;
+    if (src.data == _dst.data)
+    {
+        src = Mat(_src.size(), _src.type());
+        _src.copyTo(src);
+    }
+    _dst.create(src.size(), src.type());
+    Mat dst = _dst;
+
+    Point ofs;
+    Size  wsz(src.cols, src.rows);
+    if (!(borderType & BORDER_ISOLATED))
+        src.locateROI(wsz, ofs);
+    borderType   = (borderType & ~BORDER_ISOLATED);
+
+    int nStripes = std::max(std::min(src.rows / std::max(ksize.height, 16), 64), 1);
+
+    for (int i = 0; i < iterations; i++)
+    {
+        if (i > 0)
+        {
+            // the stripes of the next pass read the rows around them, so dst can't be its source
+            if (i == 1)
+                src = Mat(dst.size(), dst.type());
+            dst.copyTo(src);
+            wsz = src.size();
+            ofs = Point();
+        }
+
+        MorphologyRunner body(src, dst, nStripes, op, kernel, anchor, wsz, ofs, borderType, borderValue);
+        parallel_for_(Range(0, nStripes), body, nStripes);
+    }
+}
+
+void erode(const Mat& src, Mat& dst, const Mat& kernel, Point anchor, int iterations, int borderType, const Scalar& borderValue)
+{
+    morphOp(MORPH_ERODE, src, dst, kernel, anchor, iterations, borderType, borderValue);
+}
+
+void dilate(const Mat& src, Mat& dst, const Mat& kernel, Point anchor, int iterations, int borderType, const Scalar& borderValue)
+{
+    morphOp(MORPH_DILATE, src, dst, kernel, anchor, iterations, borderType, borderValue);
+}
+
+void morphologyEx(const Mat& _src, Mat& _dst, int op, const Mat& kernel, Point anchor, int iterations, int borderType, const Scalar& borderValue)
+{
+    HL_Assert(!_src.empty());
+
+    Mat src = _src, temp;
+    if (src.data == _dst.data && (op == MORPH_GRADIENT || op == MORPH_TOPHAT || op == MORPH_BLACKHAT))
+    {
+        src = Mat(_src.size(), _src.type());
+        _src.copyTo(src);
+    }
+
+    switch (op)
+    {
+        case MORPH_ERODE :
+            erode(src, _dst, kernel, anchor, iterations, borderType, borderValue);
+            break;
+        case MORPH_DILATE :
+            dilate(src, _dst, kernel, anchor, iterations, borderType, borderValue);
+            break;
+        case MORPH_OPEN :
+            erode(src, _dst, kernel, anchor, iterations, borderType, borderValue);
+            dilate(_dst, _dst, kernel, anchor, iterations, borderType, borderValue);
+            break;
+        case MORPH_CLOSE :
+            dilate(src, _dst, kernel, anchor, iterations, borderType, borderValue);
+            erode(_dst, _dst, kernel, anchor, iterations, borderType, borderValue);
+            break;
+        case MORPH_GRADIENT :
+            erode(src, temp, kernel, anchor, iterations, borderType, borderValue);
+            dilate(src, _dst, kernel, anchor, iterations, borderType, borderValue);
+            subtract(_dst, temp, _dst);
+            break;
+        case MORPH_TOPHAT :
+            erode(src, temp, kernel, anchor, iterations, borderType, borderValue);
+            dilate(temp, temp, kernel, anchor, iterations, borderType, borderValue);
+            subtract(src, temp, _dst);
+            break;
+        case MORPH_BLACKHAT :
+            dilate(src, temp, kernel, anchor, iterations, borderType, borderValue);
+            erode(temp, temp, kernel, anchor, iterations, borderType, borderValue);
+            subtract(temp, src, _dst);
+            break;
+        default :
+            HL_Error(HL_StsBadArg, "unknown morphological operation");
+    }
+}
+
+}    // namespace hl
@@ -0,0 +1,460 @@
+#include "precomp.hxx"
+#include "openHL/core/hal/intrin.hxx"
+#include <limits>
+#include <vector>
+
+namespace hl
+{
+namespace cpu_baseline
+{
+
+// forward declarations
+Ptr<BaseRowFilter>    getMorphologyRowFilter(int op, int type, int ksize, int anchor);
+Ptr<BaseColumnFilter> getMorphologyColumnFilter(int op, int type, int ksize, int anchor);
+Ptr<BaseFilter>       getMorphologyFilter(int op, int type, const Mat& kernel, Point anchor);
+Ptr<FilterEngine>     createMorphologyFilter(int op, int type, const Mat& kernel, Point anchor, int rowBorderType, int columnBorderType, const Scalar& borderValue);
+
+/****************************************************************************************\
+                     Basic Morphological Operations: Erosion & Dilation
+\****************************************************************************************/
+
+namespace
+{
+
+template <typename T>
+struct MinOp
+{
+    typedef T rtype;
+
+    inline T operator()(T a, T b) const { return a < b ? a : b; }
+
+#if HL_SIMD128
+    typedef v_reg<T, HL_SIMD_WIDTH / sizeof(T)> vtype;
+
+    inline vtype operator()(const vtype& a, const vtype& b) const { return v_min(a, b); }
+#endif
+};
+
+template <typename T>
+struct MaxOp
+{
+    typedef T rtype;
+
+    inline T operator()(T a, T b) const { return a > b ? a : b; }
+
+#if HL_SIMD128
+    typedef v_reg<T, HL_SIMD_WIDTH / sizeof(T)> vtype;
+
+    inline vtype operator()(const vtype& a, const vtype& b) const { return v_max(a, b); }
+#endif
+};
+
+//! dst[i] = op(a[i], b[i]) for i < n, dst may be the same as a or b
+template <class Op>
+static inline void morphRow(const typename Op::rtype* a, const typename Op::rtype* b, typename Op::rtype* dst, int n)
+{
+    Op  op;
+    int i = 0;
+#if HL_SIMD128
+    const int nlanes = Op::vtype::nlanes;
+    for (; i <= n - nlanes; i += nlanes)
+        v_store(dst + i, op(v_load(a + i), v_load(b + i)));
+#endif
+    for (; i < n; i++)
+        dst[i] = op(a[i], b[i]);
+}
+
+/*
+ * Short kernels are applied directly, i.e. with ksize - 1 vector min/max per element. Longer
+ * ones use the van Herk/Gil-Werman algorithm: the line is split into blocks of ksize
+ * elements, and every window, which always covers a suffix of one block and a prefix of
+ * the next one, is the min/max of the two precomputed partial results. This costs 3 min/max
+ * per element whatever the kernel size is, but the prefixes and suffixes of a row are
+ * computed by scalar recurrences, so in the row filter it only pays off once the kernel is
+ * about 3 times longer than a vector.
+ */
+template <class Op>
+struct MorphDirectMaxKsize
+{
+#if HL_SIMD128
+    enum
+    {
+        ROW    = 3 * Op::vtype::nlanes,
+        COLUMN = 3
+    };
+#else
+    enum
+    {
+        ROW    = 3,
+        COLUMN = 3
+    };
+#endif
+};
+
+template <class Op>
+struct MorphRowFilter: public BaseRowFilter
+{
+    typedef typename Op::rtype T;
+
+    MorphRowFilter(int _ksize, int _anchor)
+    {
+        ksize  = _ksize;
+        anchor = _anchor;
+    }
+
+    void operator()(const uchar* src, uchar* dst, int width, int cn) override
+    {
+        const T* S      = (const T*)src;
+        T*       D      = (T*)dst;
+        int      _ksize = ksize * cn;
+
+        width *= cn;
+        if (ksize == 1)
+        {
+            memcpy(D, S, width * sizeof(T));
+            return;
+        }
+
+        if (ksize <= MorphDirectMaxKsize<Op>::ROW)
+        {
+            morphRow<Op>(S, S + cn, D, width);
+            for (int k = 2 * cn; k < _ksize; k += cn)
+                morphRow<Op>(D, S + k, D, width);
+            return;
+        }
+
+        // van Herk/Gil-Werman: G holds the block prefixes and H the block suffixes
+        Op  op;
+        int n = width + _ksize - cn;
+        buf.resize(n * 2);
+        T* G = &buf[0];
+        T* H = G + n;
+
+        for (int b = 0; b < n; b += _ksize)
+        {
+            int e = std::min(b + _ksize, n), i;
+            for (i = b; i < b + cn; i++)
+                G[i] = S[i];
+            for (; i < e; i++)
+                G[i] = op(G[i - cn], S[i]);
+
+            if (b < width)
+            {
+                for (i = e - 1; i >= e - cn; i--)
+                    H[i] = S[i];
+                for (; i >= b; i--)
+                    H[i] = op(H[i + cn], S[i]);
+            }
+        }
+
+        morphRow<Op>(H, G + _ksize - cn, D, width);
+    }
+
+    std::vector<T> buf;
+};
+
+template <class Op>
+struct MorphColumnFilter: public BaseColumnFilter
+{
+    typedef typename Op::rtype T;
+
+    MorphColumnFilter(int _ksize, int _anchor)
+    {
+        ksize  = _ksize;
+        anchor = _anchor;
+        y      = 0;
+    }
+
+    void reset() override { y = 0; }
+
+    void operator()(const uchar** _src, uchar* dst, int dststep, int count, int width) override
+    {
+        const T** src = (const T**)_src;
+        T*        D   = (T*)dst;
+        dststep      /= sizeof(T);
+
+        if (ksize <= MorphDirectMaxKsize<Op>::COLUMN)
+        {
+            for (; count > 0; count--, D += dststep, src++)
+            {
+                if (ksize == 1)
+                {
+                    memcpy(D, src[0], width * sizeof(T));
+                    continue;
+                }
+                morphRow<Op>(src[0], src[1], D, width);
+                for (int k = 2; k < ksize; k++)
+                    morphRow<Op>(D, src[k], D, width);
+            }
+            return;
+        }
+
+        /*
+         * van Herk/Gil-Werman over the output rows. The blocks are counted from the first
+         * output row, and since the rows are delivered in order, the suffixes of the current
+         * block (H) and the running prefix of the next one (G) are kept between the calls.
+         */
+        if ((int)buf.size() < (ksize + 1) * width)
+            buf.resize((ksize + 1) * width);
+        T* H = &buf[0];
+        T* G = H + ksize * width;
+
+        for (; count > 0; count--, D += dststep, src++, y++)
+        {
+            int t = y % ksize;
+            if (t == 0)
+            {
+                T* Hk = H + (ksize - 1) * width;
+                memcpy(Hk, src[ksize - 1], width * sizeof(T));
+                for (int k = ksize - 2; k >= 0; k--, Hk -= width)
+                    morphRow<Op>(src[k], Hk, Hk - width, width);
+                memcpy(D, H, width * sizeof(T));
+            }
+            else
+            {
+                if (t == 1)
+                    memcpy(G, src[ksize - 1], width * sizeof(T));
+                else
+                    morphRow<Op>(G, src[ksize - 1], G, width);
+                morphRow<Op>(H + t * width, G, D, width);
+            }
+        }
+    }
+
+    int            y;
+    std::vector<T> buf;
+};
+
+template <class Op>
+struct MorphFilter: BaseFilter
+{
+    typedef typename Op::rtype T;
+
+    MorphFilter(const Mat& _kernel, Point _anchor)
+    {
+        anchor = _anchor;
+        ksize  = _kernel.size();
+        HL_Assert(_kernel.type() == HL_8U);
+
+        for (int i = 0; i < ksize.height; i++)
+        {
+            const uchar* krow = _kernel.ptr<uchar>(i);
+            for (int j = 0; j < ksize.width; j++)
+                if (krow[j])
+                    coords.push_back(Point(j, i));
+        }
+
+        HL_Assert(!coords.empty());
+        ptrs.resize(coords.size());
+    }
+
+    void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn) override
+    {
+        const Point* pt = &coords[0];
+        const T**    kp = (const T**)&ptrs[0];
+        int          nz = (int)coords.size();
+        Op           op;
+
+        width *= cn;
+        for (; count > 0; count--, dst += dststep, src++)
+        {
+            T*  D = (T*)dst;
+            int i = 0, k;
+
+            for (k = 0; k < nz; k++)
+                kp[k] = (const T*)src[pt[k].y] + pt[k].x * cn;
+
+#if HL_SIMD128
+            typedef typename Op::vtype VT;
+            for (; i <= width - VT::nlanes; i += VT::nlanes)
+            {
+                VT s = v_load(kp[0] + i);
+                for (k = 1; k < nz; k++)
+                    s = op(s, v_load(kp[k] + i));
+                v_store(D + i, s);
+            }
+#endif
+            for (; i < width; i++)
+            {
+                T s = kp[0][i];
+                for (k = 1; k < nz; k++)
+                    s = op(s, kp[k][i]);
+                D[i] = s;
+            }
+        }
+    }
+
+    std::vector<Point>  coords;
+    std::vector<uchar*> ptrs;
+};
+
+//! returns the border value that does not change the result of the operation
+template <typename T>
+static double morphNeutralValue(int op)
+{
+    if (std::numeric_limits<T>::has_infinity)
+        return op == MORPH_ERODE ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity();
+    return op == MORPH_ERODE ? (double)std::numeric_limits<T>::max() : (double)std::numeric_limits<T>::min();
+}
+
+}    // namespace
+
+Ptr<BaseRowFilter> getMorphologyRowFilter(int op, int type, int ksize, int anchor)
+{
+    int depth = HL_MAT_DEPTH(type);
+    if (anchor < 0)
+        anchor = ksize / 2;
+    HL_Assert(op == MORPH_ERODE || op == MORPH_DILATE);
+
+    if (op == MORPH_ERODE)
+    {
+        if (depth == HL_8U)
+            return makePtr<MorphRowFilter<MinOp<uchar>>>(ksize, anchor);
+        if (depth == HL_16U)
+            return makePtr<MorphRowFilter<MinOp<ushort>>>(ksize, anchor);
+        if (depth == HL_16S)
+            return makePtr<MorphRowFilter<MinOp<short>>>(ksize, anchor);
+        if (depth == HL_32F)
+            return makePtr<MorphRowFilter<MinOp<float>>>(ksize, anchor);
+        if (depth == HL_64F)
+            return makePtr<MorphRowFilter<MinOp<double>>>(ksize, anchor);
+    }
+    else
+    {
+        if (depth == HL_8U)
+            return makePtr<MorphRowFilter<MaxOp<uchar>>>(ksize, anchor);
+        if (depth == HL_16U)
+            return makePtr<MorphRowFilter<MaxOp<ushort>>>(ksize, anchor);
+        if (depth == HL_16S)
+            return makePtr<MorphRowFilter<MaxOp<short>>>(ksize, anchor);
+        if (depth == HL_32F)
+            return makePtr<MorphRowFilter<MaxOp<float>>>(ksize, anchor);
+        if (depth == HL_64F)
+            return makePtr<MorphRowFilter<MaxOp<double>>>(ksize, anchor);
+    }
+
+    HL_Error_(HL_StsNotImplemented, ("Unsupported data type (={})", type));
+}
+
+Ptr<BaseColumnFilter> getMorphologyColumnFilter(int op, int type, int ksize, int anchor)
+{
+    int depth = HL_MAT_DEPTH(type);
+    if (anchor < 0)
+        anchor = ksize / 2;
+    HL_Assert(op == MORPH_ERODE || op == MORPH_DILATE);
+
+    if (op == MORPH_ERODE)
+    {
+        if (depth == HL_8U)
+            return makePtr<MorphColumnFilter<MinOp<uchar>>>(ksize, anchor);
+        if (depth == HL_16U)
+            return makePtr<MorphColumnFilter<MinOp<ushort>>>(ksize, anchor);
+        if (depth == HL_16S)
+            return makePtr<MorphColumnFilter<MinOp<short>>>(ksize, anchor);
+        if (depth == HL_32F)
+            return makePtr<MorphColumnFilter<MinOp<float>>>(ksize, anchor);
+        if (depth == HL_64F)
+            return makePtr<MorphColumnFilter<MinOp<double>>>(ksize, anchor);
+    }
+    else
+    {
+        if (depth == HL_8U)
+            return makePtr<MorphColumnFilter<MaxOp<uchar>>>(ksize, anchor);
+        if (depth == HL_16U)
+            return makePtr<MorphColumnFilter<MaxOp<ushort>>>(ksize, anchor);
+        if (depth == HL_16S)
+            return makePtr<MorphColumnFilter<MaxOp<short>>>(ksize, anchor);
+        if (depth == HL_32F)
+            return makePtr<MorphColumnFilter<MaxOp<float>>>(ksize, anchor);
+        if (depth == HL_64F)
+            return makePtr<MorphColumnFilter<MaxOp<double>>>(ksize, anchor);
+    }
+
+    HL_Error_(HL_StsNotImplemented, ("Unsupported data type (={})", type));
+}
+
+Ptr<BaseFilter> getMorphologyFilter(int op, int type, const Mat& kernel, Point anchor)
+{
+    int depth = HL_MAT_DEPTH(type);
+    HL_Assert(op == MORPH_ERODE || op == MORPH_DILATE);
+
+    if (op == MORPH_ERODE)
+    {
+        if (depth == HL_8U)
+            return makePtr<MorphFilter<MinOp<uchar>>>(kernel, anchor);
+        if (depth == HL_16U)
+            return makePtr<MorphFilter<MinOp<ushort>>>(kernel, anchor);
+        if (depth == HL_16S)
+            return makePtr<MorphFilter<MinOp<short>>>(kernel, anchor);
+        if (depth == HL_32F)
+            return makePtr<MorphFilter<MinOp<float>>>(kernel, anchor);
+        if (depth == HL_64F)
+            return makePtr<MorphFilter<MinOp<double>>>(kernel, anchor);
+    }
+    else
+    {
+        if (depth == HL_8U)
+            return makePtr<MorphFilter<MaxOp<uchar>>>(kernel, anchor);
+        if (depth == HL_16U)
+            return makePtr<MorphFilter<MaxOp<ushort>>>(kernel, anchor);
+        if (depth == HL_16S)
+            return makePtr<MorphFilter<MaxOp<short>>>(kernel, anchor);
+        if (depth == HL_32F)
+            return makePtr<MorphFilter<MaxOp<float>>>(kernel, anchor);
+        if (depth == HL_64F)
+            return makePtr<MorphFilter<MaxOp<double>>>(kernel, anchor);
+    }
+
+    HL_Error_(HL_StsNotImplemented, ("Unsupported data type (={})", type));
+}
+
+Ptr<FilterEngine> createMorphologyFilter(int op, int type, const Mat& kernel, Point anchor, int rowBorderType, int columnBorderType, const Scalar& _borderValue)
+{
+    HL_Assert(kernel.type() == HL_8U && !kernel.empty());
+    Size ksize = kernel.size();
+    if (anchor.x < 0)
+        anchor.x = ksize.width / 2;
+    if (anchor.y < 0)
+        anchor.y = ksize.height / 2;
+
+    bool rectKernel = true;
+    for (int i = 0; i < ksize.height && rectKernel; i++)
+    {
+        const uchar* krow = kernel.ptr<uchar>(i);
+        for (int j = 0; j < ksize.width; j++)
+            if (!krow[j])
+            {
+                rectKernel = false;
+                break;
+            }
+    }
+
+    Ptr<BaseRowFilter>    rowFilter;
+    Ptr<BaseColumnFilter> columnFilter;
+    Ptr<BaseFilter>       filter2D;
+
+    if (rectKernel)
+    {
+        rowFilter    = getMorphologyRowFilter(op, type, ksize.width, anchor.x);
+        columnFilter = getMorphologyColumnFilter(op, type, ksize.height, anchor.y);
+    }
+    else
+        filter2D = getMorphologyFilter(op, type, kernel, anchor);
+
+    Scalar borderValue = _borderValue;
+    if ((rowBorderType == BORDER_CONSTANT || columnBorderType == BORDER_CONSTANT) && borderValue == morphologyDefaultBorderValue())
+    {
+        int depth = HL_MAT_DEPTH(type);
+        HL_Assert(depth == HL_8U || depth == HL_16U || depth == HL_16S || depth == HL_32F || depth == HL_64F);
+        borderValue = Scalar::all(depth == HL_8U    ? morphNeutralValue<uchar>(op)
+                                  : depth == HL_16U ? morphNeutralValue<ushort>(op)
+                                  : depth == HL_16S ? morphNeutralValue<short>(op)
+                                  : depth == HL_32F ? morphNeutralValue<float>(op)
+                                                    : morphNeutralValue<double>(op));
+    }
+
+    return makePtr<FilterEngine>(filter2D, rowFilter, columnFilter, type, type, type, rowBorderType, columnBorderType, borderValue);
+}
+
+}    // namespace cpu_baseline
+}    // namespace hl
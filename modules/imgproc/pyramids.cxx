@@ -0,0 +1,557 @@
+#include "precomp.hxx"
+
+#include "openHL/core/hal/intrin.hxx"
+
+namespace hl
+{
+
+namespace
+{
+
+// the binomial weights 1 4 6 4 1 sum to 16 per pass, the pyrUp ones 1 6 1 and 4 4 to 8
+template <typename T, int shift>
+struct FixPtCast
+{
+    typedef int type1;
+    typedef T   rtype;
+
+    rtype operator()(type1 arg) const { return (T)((arg + (1 << (shift - 1))) >> shift); }
+};
+
+template <typename T, int shift>
+struct FltCast
+{
+    typedef T type1;
+    typedef T rtype;
+
+    rtype operator()(type1 arg) const { return arg * (T)(1. / (1 << shift)); }
+};
+
+inline int borderRow(int p, int len, int borderType)
+{
+    return (unsigned)p < (unsigned)len ? p : borderInterpolate(p, len, borderType);
+}
+
+/*
+ * The vector parts of the row passes return where the scalar loops go on from. The 8-bit image sums
+ * fit in 16 bits, 16 * 255 for pyrDown and 8 * 255 for pyrUp, and so do the horizontal sums of them.
+ */
+template <typename T, typename WT>
+int pyrDownVLineVec(const T* const*, WT*, int)
+{
+    return 0;
+}
+
+template <typename WT, typename T>
+int pyrDownHLineVec(const WT*, T*, int x, int)
+{
+    return x;
+}
+
+template <typename T, typename WT>
+int pyrUpVLineVec(const T* const*, WT*, int, bool)
+{
+    return 0;
+}
+
+template <typename WT, typename T>
+int pyrUpHLineVec(const WT*, T*, int x, int)
+{
+    return x;
+}
+
+#if HL_SIMD128
+int pyrDownVLineVec(const uchar* const* rows, ushort* buf, int width)
+{
+    int x = 0;
+    for (; x <= width - v_uint16x8::nlanes; x += v_uint16x8::nlanes)
+    {
+        v_uint16x8 r0 = v_load_convert<ushort>(rows[0] + x);
+        v_uint16x8 r1 = v_load_convert<ushort>(rows[1] + x);
+        v_uint16x8 r2 = v_load_convert<ushort>(rows[2] + x);
+        v_uint16x8 r3 = v_load_convert<ushort>(rows[3] + x);
+        v_uint16x8 r4 = v_load_convert<ushort>(rows[4] + x);
+
+        v_uint16x8 s  = v_add_wrap(v_add_wrap(r0, r4), v_shl<2>(v_add_wrap(r1, r3)));
+        v_store(buf + x, v_add_wrap(s, v_add_wrap(v_shl<2>(r2), v_shl<1>(r2))));
+    }
+    return x;
+}
+
+// single channel only, the even and odd columns around dst[x] are split by the deinterleaving loads
+int pyrDownHLineVec(const ushort* buf, uchar* dst, int x, int xend)
+{
+    const v_uint16x8 delta = v_setall_u16(128);
+    for (; x <= xend - v_uint16x8::nlanes; x += v_uint16x8::nlanes)
+    {
+        v_uint16x8 e0, o0, e1, o1, e2, o2;
+        v_load_deinterleave(buf + x * 2 - 2, e0, o0);
+        v_load_deinterleave(buf + x * 2, e1, o1);
+        v_load_deinterleave(buf + x * 2 + 2, e2, o2);
+
+        v_uint16x8 s = v_add_wrap(v_add_wrap(e0, e2), v_shl<2>(v_add_wrap(o0, o1)));
+        s            = v_add_wrap(s, v_add_wrap(v_shl<2>(e1), v_shl<1>(e1)));
+        v_store(dst + x, v_convert<uchar>(v_shr<8>(v_add_wrap(s, delta))));
+    }
+    return x;
+}
+
+int pyrUpVLineVec(const uchar* const* rows, ushort* buf, int width, bool odd)
+{
+    int x = 0;
+    for (; x <= width - v_uint16x8::nlanes; x += v_uint16x8::nlanes)
+    {
+        v_uint16x8 r1 = v_load_convert<ushort>(rows[1] + x);
+        v_uint16x8 r2 = v_load_convert<ushort>(rows[2] + x);
+        if (odd)
+        {
+            v_store(buf + x, v_shl<2>(v_add_wrap(r1, r2)));
+        }
+        else
+        {
+            v_uint16x8 r0 = v_load_convert<ushort>(rows[0] + x);
+            v_store(buf + x, v_add_wrap(v_add_wrap(r0, r2), v_add_wrap(v_shl<2>(r1), v_shl<1>(r1))));
+        }
+    }
+    return x;
+}
+
+// single channel only, the even and odd dst columns are interleaved by v_zip
+int pyrUpHLineVec(const ushort* buf, uchar* dst, int x, int xend)
+{
+    const v_uint16x8 delta = v_setall_u16(32);
+    for (; x <= xend - v_uint16x8::nlanes; x += v_uint16x8::nlanes)
+    {
+        v_uint16x8 s0 = v_load(buf + x - 1);
+        v_uint16x8 s1 = v_load(buf + x);
+        v_uint16x8 s2 = v_load(buf + x + 1);
+
+        v_uint16x8 e  = v_add_wrap(v_add_wrap(s0, s2), v_add_wrap(v_shl<2>(s1), v_shl<1>(s1)));
+        v_uint16x8 o  = v_shl<2>(v_add_wrap(s1, s2));
+        e             = v_shr<6>(v_add_wrap(e, delta));
+        o             = v_shr<6>(v_add_wrap(o, delta));
+
+        v_uint16x8 lo, hi;
+        v_zip(e, o, lo, hi);
+        v_store(dst + x * 2, v_convert<uchar>(lo));
+        v_store(dst + x * 2 + v_uint16x8::nlanes, v_convert<uchar>(hi));
+    }
+    return x;
+}
+#endif
+
+// buf = r0 + 4 r1 + 6 r2 + 4 r3 + r4
+template <typename T, typename WT>
+void pyrDownVLine(const T* const* rows, WT* buf, int width)
+{
+    int x = pyrDownVLineVec(rows, buf, width);
+    for (; x < width; ++x)
+        buf[x] = (WT)(rows[0][x] + rows[4][x] + (rows[1][x] + rows[3][x]) * 4 + rows[2][x] * 6);
+}
+
+// dst[x] is the same weighted sum of the columns 2x - 2 ... 2x + 2 of buf
+template <class CastOp, typename WT>
+void pyrDownHLine(const WT* buf, typename CastOp::rtype* dst, int swidth, int dwidth, int cn, int borderType)
+{
+    typedef typename CastOp::type1 AT;
+
+    CastOp castOp;
+
+    // the columns whose taps are all inside the row
+    int xl = std::min(1, dwidth);
+    int xr = std::min(std::max((swidth - 3) / 2 + 1, xl), dwidth);
+
+    for (int x = 0; x < dwidth; ++x)
+    {
+        if (x == xl)
+        {
+            x = xr;
+            if (x == dwidth)
+                break;
+        }
+
+        int tab[5];
+        for (int i = 0; i < 5; ++i)
+            tab[i] = borderRow(x * 2 + i - 2, swidth, borderType) * cn;
+        for (int c = 0; c < cn; ++c)
+        {
+            const WT* s     = buf + c;
+            AT        sum   = (AT)s[tab[0]] + s[tab[4]] + ((AT)s[tab[1]] + s[tab[3]]) * 4 + (AT)s[tab[2]] * 6;
+            dst[x * cn + c] = castOp(sum);
+        }
+    }
+
+    if (cn == 1)
+    {
+        // the vector loads read one column past the last tap
+        int x = pyrDownHLineVec(buf, dst, xl, std::max(std::min(xr, (swidth - 2) / 2), xl));
+        for (; x < xr; ++x)
+        {
+            const WT* s = buf + x * 2;
+            dst[x]      = castOp((AT)s[-2] + s[2] + ((AT)s[-1] + s[1]) * 4 + (AT)s[0] * 6);
+        }
+    }
+    else
+    {
+        for (int x = xl; x < xr; ++x)
+        {
+            const WT* s = buf + x * 2 * cn;
+            for (int c = 0; c < cn; ++c, ++s)
+                dst[x * cn + c] = castOp((AT)s[-2 * cn] + s[2 * cn] + ((AT)s[-cn] + s[cn]) * 4 + (AT)s[0] * 6);
+        }
+    }
+}
+
+// the even rows weight the src rows y - 1, y, y + 1 by 1 6 1, the odd rows y and y + 1 by 4 4
+template <typename T, typename WT>
+void pyrUpVLine(const T* const* rows, WT* buf, int width, bool odd)
+{
+    int x = pyrUpVLineVec(rows, buf, width, odd);
+    if (odd)
+    {
+        for (; x < width; ++x)
+            buf[x] = (WT)((rows[1][x] + rows[2][x]) * 4);
+    }
+    else
+    {
+        for (; x < width; ++x)
+            buf[x] = (WT)(rows[0][x] + rows[1][x] * 6 + rows[2][x]);
+    }
+}
+
+template <class CastOp, typename WT>
+void pyrUpHLine(const WT* buf, typename CastOp::rtype* dst, int swidth, int dwidth, int cn, int borderType)
+{
+    typedef typename CastOp::type1 AT;
+
+    CastOp castOp;
+
+    // the src columns x whose neighbours x - 1 and x + 1 are inside the row, giving dst columns 2x and 2x + 1
+    int xl = std::min(1, swidth);
+    int xr = std::min(std::max(swidth - 1, xl), dwidth / 2);
+
+    for (int dx = 0; dx < dwidth; ++dx)
+    {
+        if (dx == xl * 2)
+        {
+            dx = std::max(xr * 2, dx);
+            if (dx == dwidth)
+                break;
+        }
+
+        int x  = dx >> 1;
+        int x0 = borderRow(x, swidth, borderType) * cn;
+        int x1 = borderRow(x + 1, swidth, borderType) * cn;
+        int xm = borderRow(x - 1, swidth, borderType) * cn;
+        for (int c = 0; c < cn; ++c)
+        {
+            const WT* s      = buf + c;
+            AT        sum    = dx & 1 ? ((AT)s[x0] + s[x1]) * 4 : (AT)s[xm] + s[x1] + (AT)s[x0] * 6;
+            dst[dx * cn + c] = castOp(sum);
+        }
+    }
+
+    if (cn == 1)
+    {
+        int x = pyrUpHLineVec(buf, dst, xl, xr);
+        for (; x < xr; ++x)
+        {
+            const WT* s    = buf + x;
+            dst[x * 2]     = castOp((AT)s[-1] + s[1] + (AT)s[0] * 6);
+            dst[x * 2 + 1] = castOp(((AT)s[0] + s[1]) * 4);
+        }
+    }
+    else
+    {
+        for (int x = xl; x < xr; ++x)
+        {
+            const WT* s = buf + x * cn;
+            for (int c = 0; c < cn; ++c, ++s)
+            {
+                dst[x * 2 * cn + c]      = castOp((AT)s[-cn] + s[cn] + (AT)s[0] * 6);
+                dst[(x * 2 + 1) * cn + c] = castOp(((AT)s[0] + s[cn]) * 4);
+            }
+        }
+    }
+}
+
+/*
+ * Builds the levels dst[0 .. nlevels - 1] of the Gaussian pyramid of src in one pass. The range is
+ * split over the rows of the last level, and each stripe owns the rows of the upper levels that
+ * are above its rows, i.e. range << (nlevels - 1 - k) at dst[k]. A row of a level is computed as
+ * soon as the 5 rows of the previous level it reads are, so the stripe streams through src once,
+ * and the previous level rows are read again while they are in cache. They are kept in a ring of
+ * 5 rows; the ones above and below the stripe, that are owned by the neighbour stripes, are
+ * computed again into a private ring instead of being written.
+ */
+template <class CastOp, typename WT>
+class PyrDownInvoker: public ParallelLoopBody
+{
+public:
+    typedef typename CastOp::rtype T;
+
+    PyrDownInvoker(const Mat& _src, Mat* _dst, int _nlevels, int _borderType):
+        ParallelLoopBody(), src(_src), dst(_dst), nlevels(_nlevels), borderType(_borderType)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        const int cn = src.channels();
+
+        std::vector<Level> levels(nlevels);
+
+        int scratchSize = 0;
+        for (int k = nlevels - 1; k >= 0; --k)
+        {
+            Level& lv   = levels[k];
+            int    rows = dst[k].rows;
+            if (k == nlevels - 1)
+            {
+                lv.ownStart = lv.start = range.start;
+                lv.ownEnd = lv.end = range.end;
+            }
+            else
+            {
+                const Level& next = levels[k + 1];
+
+                bool last         = next.ownEnd == dst[k + 1].rows;
+                lv.ownStart       = std::min(next.ownStart * 2, rows);
+                lv.ownEnd         = last ? rows : std::min(next.ownEnd * 2, rows);
+                lv.start          = std::min(std::max(next.start * 2 - 2, 0), lv.ownStart);
+                lv.end            = std::max(std::min(next.end * 2 + 1, rows), lv.ownEnd);
+            }
+            lv.next      = lv.start;
+            scratchSize += dst[k].cols * cn * 5;
+        }
+
+        AutoBuffer<T>  _scratch(scratchSize);
+        AutoBuffer<WT> _buf(src.cols * cn);
+
+        T* scratch = _scratch.data();
+        for (int k = 0; k < nlevels; ++k)
+        {
+            levels[k].scratch  = scratch;
+            scratch           += dst[k].cols * cn * 5;
+        }
+
+        while (levels[0].next < levels[0].end)
+            computeRow(levels, 0, _buf.data());
+    }
+
+private:
+    struct Level
+    {
+        int ownStart, ownEnd;
+        int start, end;
+        int next;
+
+        T*       scratch;
+        const T* ring[5];
+    };
+
+    void computeRow(std::vector<Level>& levels, int k, WT* buf) const
+    {
+        const Mat& prev  = k == 0 ? src : dst[k - 1];
+        const int  cn    = src.channels();
+        Level&     lv    = levels[k];
+        int        y     = lv.next++;
+
+        const T* rows[5];
+        for (int i = 0; i < 5; ++i)
+        {
+            int sy  = borderRow(y * 2 + i - 2, prev.rows, borderType);
+            rows[i] = k == 0 ? src.ptr<T>(sy) : levels[k - 1].ring[sy % 5];
+        }
+
+        T* row = y >= lv.ownStart && y < lv.ownEnd ? dst[k].ptr<T>(y) : lv.scratch + (y % 5) * dst[k].cols * cn;
+
+        pyrDownVLine(rows, buf, prev.cols * cn);
+        pyrDownHLine<CastOp>(buf, row, prev.cols, dst[k].cols, cn, borderType);
+        lv.ring[y % 5] = row;
+
+        // the next level takes its rows while the ring still holds all the ones they read
+        if (k + 1 < nlevels)
+        {
+            Level& next = levels[k + 1];
+            while (next.next < next.end && std::min(next.next * 2 + 2, dst[k].rows - 1) <= y)
+                computeRow(levels, k + 1, buf);
+        }
+    }
+
+    const Mat& src;
+    Mat*       dst;
+    int        nlevels;
+    int        borderType;
+
+    PyrDownInvoker(const PyrDownInvoker&);                     // = delete;
+    const PyrDownInvoker& operator=(const PyrDownInvoker&);    // = delete;
+};
+
+template <class CastOp, typename WT>
+class PyrUpInvoker: public ParallelLoopBody
+{
+public:
+    typedef typename CastOp::rtype T;
+
+    PyrUpInvoker(const Mat& _src, Mat& _dst, int _borderType):
+        ParallelLoopBody(), src(_src), dst(_dst), borderType(_borderType)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        const int cn = src.channels();
+
+        AutoBuffer<WT> _buf(src.cols * cn);
+        WT*            buf = _buf.data();
+
+        for (int dy = range.start; dy < range.end; ++dy)
+        {
+            int y = dy >> 1;
+
+            const T* rows[3];
+            for (int i = 0; i < 3; ++i)
+                rows[i] = src.ptr<T>(borderRow(y + i - 1, src.rows, borderType));
+
+            pyrUpVLine(rows, buf, src.cols * cn, (dy & 1) != 0);
+            pyrUpHLine<CastOp>(buf, dst.ptr<T>(dy), src.cols, dst.cols, cn, borderType);
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat&       dst;
+    int        borderType;
+
+    PyrUpInvoker(const PyrUpInvoker&);                     // = delete;
+    const PyrUpInvoker& operator=(const PyrUpInvoker&);    // = delete;
+};
+
+typedef void (*PyrDownFunc)(const Mat&, Mat*, int, int);
+typedef void (*PyrUpFunc)(const Mat&, Mat&, int);
+
+template <class CastOp, typename WT>
+void pyrDown_(const Mat& src, Mat* dst, int nlevels, int borderType)
+{
+    PyrDownInvoker<CastOp, WT> invoker(src, dst, nlevels, borderType);
+
+    // the stripes compute the rows around them again at every level but the last
+    double nstripes = src.total() / (double)(1 << 16);
+    if (nlevels > 1)
+        nstripes = std::min((double)getNumThreads(), nstripes);
+    parallel_for_(Range(0, dst[nlevels - 1].rows), invoker, nstripes);
+}
+
+template <class CastOp, typename WT>
+void pyrUp_(const Mat& src, Mat& dst, int borderType)
+{
+    PyrUpInvoker<CastOp, WT> invoker(src, dst, borderType);
+    parallel_for_(Range(0, dst.rows), invoker, dst.total() / (double)(1 << 16));
+}
+
+PyrDownFunc getPyrDownFunc(int depth)
+{
+    static PyrDownFunc tab[] = {
+        pyrDown_<FixPtCast<uchar, 8>, ushort>,
+        0,
+        pyrDown_<FixPtCast<ushort, 8>, int>,
+        pyrDown_<FixPtCast<short, 8>, int>,
+        0,
+        0,
+        pyrDown_<FltCast<float, 8>, float>,
+        pyrDown_<FltCast<double, 8>, double>
+    };
+
+    PyrDownFunc func = tab[depth];
+    if (func == 0)
+        HL_Error(Error::StsUnsupportedFormat, "");
+    return func;
+}
+
+PyrUpFunc getPyrUpFunc(int depth)
+{
+    static PyrUpFunc tab[] = {
+        pyrUp_<FixPtCast<uchar, 6>, ushort>,
+        0,
+        pyrUp_<FixPtCast<ushort, 6>, int>,
+        pyrUp_<FixPtCast<short, 6>, int>,
+        0,
+        0,
+        pyrUp_<FltCast<float, 6>, float>,
+        pyrUp_<FltCast<double, 6>, double>
+    };
+
+    PyrUpFunc func = tab[depth];
+    if (func == 0)
+        HL_Error(Error::StsUnsupportedFormat, "");
+    return func;
+}
+
+// the rows of a stripe only read the rows around it, which rules out BORDER_WRAP
+void checkPyrBorder(int borderType)
+{
+    borderType &= ~BORDER_ISOLATED;
+    HL_Assert(borderType == BORDER_REPLICATE || borderType == BORDER_REFLECT || borderType == BORDER_REFLECT_101);
+}
+
+}    // namespace
+
+void pyrDown(const Mat& _src, Mat& _dst, const Size& _dsz, int borderType)
+{
+    HL_Assert(!_src.empty());
+    checkPyrBorder(borderType);
+    borderType &= ~BORDER_ISOLATED;
+
+    Mat  src   = _src;
+    Size ssize = src.size();
+    Size dsize = _dsz.empty() ? Size((ssize.width + 1) / 2, (ssize.height + 1) / 2) : _dsz;
+    HL_Assert(dsize.width > 0 && dsize.height > 0 && std::abs(dsize.width * 2 - ssize.width) <= 2 && std::abs(dsize.height * 2 - ssize.height) <= 2);
+
+    PyrDownFunc func = getPyrDownFunc(src.depth());
+
+    _dst.create(dsize, src.type());
+    Mat dst = _dst;
+
+    func(src, &dst, 1, borderType);
+}
+
+void pyrUp(const Mat& _src, Mat& _dst, const Size& _dsz, int borderType)
+{
+    HL_Assert(!_src.empty());
+    checkPyrBorder(borderType);
+    borderType &= ~BORDER_ISOLATED;
+
+    Mat  src   = _src;
+    Size ssize = src.size();
+    Size dsize = _dsz.empty() ? Size(ssize.width * 2, ssize.height * 2) : _dsz;
+    HL_Assert(std::abs(dsize.width - ssize.width * 2) == dsize.width % 2 && std::abs(dsize.height - ssize.height * 2) == dsize.height % 2);
+
+    PyrUpFunc func = getPyrUpFunc(src.depth());
+
+    _dst.create(dsize, src.type());
+    Mat dst = _dst;
+
+    func(src, dst, borderType);
+}
+
+void buildPyramid(const Mat& _src, std::vector<Mat>& dst, int maxlevel, int borderType)
+{
+    HL_Assert(!_src.empty() && maxlevel >= 0);
+    checkPyrBorder(borderType);
+    borderType &= ~BORDER_ISOLATED;
+
+    // src may be one of the levels, which are reallocated below
+    Mat         src  = _src;
+    PyrDownFunc func = getPyrDownFunc(src.depth());
+
+    dst.resize(maxlevel + 1);
+    dst[0] = src;
+    for (int i = 1; i <= maxlevel; ++i)
+        dst[i].create(Size((dst[i - 1].cols + 1) / 2, (dst[i - 1].rows + 1) / 2), src.type());
+
+    if (maxlevel > 0)
+        func(src, &dst[1], maxlevel, borderType);
+}
+
+}    // namespace hl
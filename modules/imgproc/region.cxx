@@ -4,19 +4,11 @@
 namespace hl
 {
 
-static bool isHomogeneous(const Mat& src, int x, int y, int width, int height, int threshold)
+static bool isHomogeneous(const Mat& src, const Mat& sum, int x, int y, int width, int height, int threshold)
 {
-    int sum   = 0;
-    int count = 0;
-    for (int i = y; i < y + height; ++i)
-    {
-        for (int j = x; j < x + width; ++j)
-        {
-            sum += src.at<uchar>(i, j);
-            ++count;
-        }
-    }
-    int mean = sum / count;
+    // 区域的像素和由积分图的四个角得到
+    int total = sum.at<int>(y + height, x + width) - sum.at<int>(y, x + width) - sum.at<int>(y + height, x) + sum.at<int>(y, x);
+    int mean  = total / (width * height);
     for (int i = y; i < y + height; ++i)
     {
         for (int j = x; j < x + width; ++j)
@@ -30,9 +22,9 @@ static bool isHomogeneous(const Mat& src, int x, int y, int width, int height, i
     return true;
 }
 
-static void split(const Mat& src, Mat& dst, int x, int y, int width, int height, int threshold)
+static void split(const Mat& src, const Mat& sum, Mat& dst, int x, int y, int width, int height, int threshold)
 {
-    if (isHomogeneous(src, x, y, width, height, threshold))
+    if (isHomogeneous(src, sum, x, y, width, height, threshold))
     {
         for (int i = y + 1; i < y + height - 1; ++i)
         {
@@ -48,10 +40,10 @@ static void split(const Mat& src, Mat& dst, int x, int y, int width, int height,
         int halfHeight = height / 2;
         if (halfWidth > 0 && halfHeight > 0)
         {
-            split(src, dst, x, y, halfWidth, halfHeight, threshold);
-            split(src, dst, x + halfWidth, y, halfWidth, halfHeight, threshold);
-            split(src, dst, x, y + halfHeight, halfWidth, halfHeight, threshold);
-            split(src, dst, x + halfWidth, y + halfHeight, halfWidth, halfHeight, threshold);
+            split(src, sum, dst, x, y, halfWidth, halfHeight, threshold);
+            split(src, sum, dst, x + halfWidth, y, halfWidth, halfHeight, threshold);
+            split(src, sum, dst, x, y + halfHeight, halfWidth, halfHeight, threshold);
+            split(src, sum, dst, x + halfWidth, y + halfHeight, halfWidth, halfHeight, threshold);
         }
     }
 }
@@ -68,8 +60,12 @@ void regionSplitting(const Mat& src, Mat& dst, int threshold)
         }
     }
 
+    // 积分图，每个区域的均值只需常数时间
+    Mat sum;
+    integral(src, sum, HL_32S);
+
     // 开始区域分裂
-    split(src, dst, 0, 0, src.cols, src.rows, threshold);
+    split(src, sum, dst, 0, 0, src.cols, src.rows, threshold);
 }
 
 void regionGrowing(const Mat& src, Mat& dst, int seedX, int seedY, int threshold)
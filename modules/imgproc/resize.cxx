@@ -22,8 +22,8 @@ struct fixedtype<uint32_t, false>
     typedef ufixedpoint64 type;
 };
 
-template <bool needsign>
-struct fixedtype<int16_t, needsign>
+template <>
+struct fixedtype<int16_t, false>
 {
     typedef fixedpoint32 type;
 };
@@ -46,6 +46,26 @@ struct fixedtype<uint8_t, false>
     typedef ufixedpoint16 type;
 };
 
+// the negative lobes of the cubic kernel need a signed type with room for the overshoots
+template <>
+struct fixedtype<uint8_t, true>
+{
+    typedef fixedpoint32 type;
+};
+
+// the weights of a large area are much smaller than one, so the 8-bit images keep 16 fractional bits for them
+template <typename ET>
+struct areafixedtype
+{
+    typedef typename fixedtype<ET, false>::type type;
+};
+
+template <>
+struct areafixedtype<uint8_t>
+{
+    typedef ufixedpoint32 type;
+};
+
 //FT is fixedtype<ET, needsign>::type
 template <typename ET, typename FT, int n, bool mulall>
 static void hlineResize(ET* src, int cn, int* ofst, FT* m, FT* dst, int dst_min, int dst_max, int dst_width)
@@ -248,7 +268,7 @@ struct hline<ET, FT, 4, true, 1>
         for (; i < dst_max; i++, m += 4)
         {
             ET* px   = src + ofst[i];
-            *(dst++) = m[0] * src[0] + m[1] * src[1] + m[2] * src[2] + m[3] * src[3];
+            *(dst++) = m[0] * px[0] + m[1] * px[1] + m[2] * px[2] + m[3] * px[3];
         }
         // Avoid reading a potentially unset ofst, leading to a random memory read.
         if (i >= dst_width)
@@ -278,8 +298,8 @@ struct hline<ET, FT, 4, true, 2>
         for (; i < dst_max; i++, m += 4)
         {
             ET* px   = src + 2 * ofst[i];
-            *(dst++) = m[0] * src[0] + m[1] * src[2] + m[2] * src[4] + m[3] * src[6];
-            *(dst++) = m[0] * src[1] + m[1] * src[3] + m[2] * src[5] + m[3] * src[7];
+            *(dst++) = m[0] * px[0] + m[1] * px[2] + m[2] * px[4] + m[3] * px[6];
+            *(dst++) = m[0] * px[1] + m[1] * px[3] + m[2] * px[5] + m[3] * px[7];
         }
         // Avoid reading a potentially unset ofst, leading to a random memory read.
         if (i >= dst_width)
@@ -312,9 +332,9 @@ struct hline<ET, FT, 4, true, 3>
         for (; i < dst_max; i++, m += 4)
         {
             ET* px   = src + 3 * ofst[i];
-            *(dst++) = m[0] * src[0] + m[1] * src[3] + m[2] * src[6] + m[3] * src[9];
-            *(dst++) = m[0] * src[1] + m[1] * src[4] + m[2] * src[7] + m[3] * src[10];
-            *(dst++) = m[0] * src[2] + m[1] * src[5] + m[2] * src[8] + m[3] * src[11];
+            *(dst++) = m[0] * px[0] + m[1] * px[3] + m[2] * px[6] + m[3] * px[9];
+            *(dst++) = m[0] * px[1] + m[1] * px[4] + m[2] * px[7] + m[3] * px[10];
+            *(dst++) = m[0] * px[2] + m[1] * px[5] + m[2] * px[8] + m[3] * px[11];
         }
         // Avoid reading a potentially unset ofst, leading to a random memory read.
         if (i >= dst_width)
@@ -350,10 +370,10 @@ struct hline<ET, FT, 4, true, 4>
         for (; i < dst_max; i++, m += 4)
         {
             ET* px   = src + 4 * ofst[i];
-            *(dst++) = m[0] * src[0] + m[1] * src[4] + m[2] * src[8] + m[3] * src[12];
-            *(dst++) = m[0] * src[1] + m[1] * src[5] + m[2] * src[9] + m[3] * src[13];
-            *(dst++) = m[0] * src[2] + m[1] * src[6] + m[2] * src[10] + m[3] * src[14];
-            *(dst++) = m[0] * src[3] + m[1] * src[7] + m[2] * src[11] + m[3] * src[15];
+            *(dst++) = m[0] * px[0] + m[1] * px[4] + m[2] * px[8] + m[3] * px[12];
+            *(dst++) = m[0] * px[1] + m[1] * px[5] + m[2] * px[9] + m[3] * px[13];
+            *(dst++) = m[0] * px[2] + m[1] * px[6] + m[2] * px[10] + m[3] * px[14];
+            *(dst++) = m[0] * px[3] + m[1] * px[7] + m[2] * px[11] + m[3] * px[15];
         }
         // Avoid reading a potentially unset ofst, leading to a random memory read.
         if (i >= dst_width)
@@ -374,6 +394,55 @@ struct hline<ET, FT, 4, true, 4>
     }
 };
 
+#if HL_SIMD128
+
+template <typename _Tp>
+static inline _Tp load_unaligned(const uchar* ptr)
+{
+    _Tp v;
+    memcpy(&v, ptr, sizeof(v));
+    return v;
+}
+
+/*
+ * The 8-bit linear lines are kept in ufixedpoint16, with 8 fractional bits. The two coefficients of a
+ * pixel add up to one, so v_dotprod sums the products of a pixel pair exactly and the sums fit the
+ * 16 bits without the saturation of the scalar loops ever taking effect.
+ */
+template <int cn>
+static int hlineResizeLinearVec_8u(const uint8_t* src, const int* ofst, const ufixedpoint16* m, ufixedpoint16* dst, int len)
+{
+    const uchar* a = (const uchar*)m;
+    ushort*      d = (ushort*)dst;
+
+    int i = 0;
+    for (; i * cn + v_int32x4::nlanes <= len * cn; i++)
+    {
+        v_int16x8 w((v_int16x8::vector_type)v_setall(load_unaligned<uint>(a + i * 4)).val);
+        v_store(d + i * cn, v_convert<ushort>(v_dotprod(v_load_expand_pair<cn>(src + cn * ofst[i]), w)));
+    }
+    return i;
+}
+
+template <>
+int hlineResizeLinearVec_8u<1>(const uint8_t* src, const int* ofst, const ufixedpoint16* m, ufixedpoint16* dst, int len)
+{
+    typedef v_reg<ushort, 4> v_uint16x4;
+
+    const short* a = (const short*)m;
+    ushort*      d = (ushort*)dst;
+
+    int i = 0;
+    for (; i <= len - v_int32x4::nlanes; i += v_int32x4::nlanes)
+    {
+        v_uint16x4 p(v_uint16x4::vector_type{load_unaligned<ushort>(src + ofst[i]), load_unaligned<ushort>(src + ofst[i + 1]), load_unaligned<ushort>(src + ofst[i + 2]), load_unaligned<ushort>(src + ofst[i + 3])});
+        v_store(d + i, v_convert<ushort>(v_dotprod(v_convert<short>(v_reg<uchar, 8>((v_reg<uchar, 8>::vector_type)p.val)), v_load(a + i * 2))));
+    }
+    return i;
+}
+
+#endif
+
 template <typename ET, typename FT, int n, bool mulall, int cncnt>
 static void hlineResizeCn(ET* src, int cn, int* ofst, FT* m, FT* dst, int dst_min, int dst_max, int dst_width)
 {
@@ -389,6 +458,12 @@ void hlineResizeCn<uint8_t, ufixedpoint16, 2, true, 1>(uint8_t* src, int, int* o
     {
         *(dst++) = src_0;
     }
+#if HL_SIMD128
+    int n  = hlineResizeLinearVec_8u<1>(src, ofst + i, m, dst, dst_max - i);
+    i     += n;
+    m     += 2 * n;
+    dst   += n;
+#endif
     for (; i < dst_max; i += 1, m += 2)
     {
         uint8_t* px = src + ofst[i];
@@ -424,6 +499,12 @@ void hlineResizeCn<uint8_t, ufixedpoint16, 2, true, 2>(uint8_t* src, int, int* o
         *(dst++) = ((ufixedpoint16*)(srccn.w))[0];
         *(dst++) = ((ufixedpoint16*)(srccn.w))[1];
     }
+#if HL_SIMD128
+    int n  = hlineResizeLinearVec_8u<2>(src, ofst + i, m, dst, dst_max - i);
+    i     += n;
+    m     += 2 * n;
+    dst   += 2 * n;
+#endif
     for (; i < dst_max; i += 1, m += 2)
     {
         uint8_t* px = src + 2 * ofst[i];
@@ -465,6 +546,12 @@ void hlineResizeCn<uint8_t, ufixedpoint16, 2, true, 3>(uint8_t* src, int, int* o
         *(dst++) = ((ufixedpoint16*)(srccn.w))[1];
         *(dst++) = ((ufixedpoint16*)(srccn.w))[2];
     }
+#if HL_SIMD128
+    int n  = hlineResizeLinearVec_8u<3>(src, ofst + i, m, dst, dst_max - i);
+    i     += n;
+    m     += 2 * n;
+    dst   += 3 * n;
+#endif
     for (; i < dst_max; i += 1, m += 2)
     {
         uint8_t* px = src + 3 * ofst[i];
@@ -510,6 +597,12 @@ void hlineResizeCn<uint8_t, ufixedpoint16, 2, true, 4>(uint8_t* src, int, int* o
         *(dst++) = ((ufixedpoint16*)(srccn.w))[2];
         *(dst++) = ((ufixedpoint16*)(srccn.w))[3];
     }
+#if HL_SIMD128
+    int n  = hlineResizeLinearVec_8u<4>(src, ofst + i, m, dst, dst_max - i);
+    i     += n;
+    m     += 2 * n;
+    dst   += 4 * n;
+#endif
     for (; i < dst_max; i += 1, m += 2)
     {
         uint8_t* px = src + 4 * ofst[i];
@@ -562,6 +655,61 @@ void hlineResizeCn<uint16_t, ufixedpoint32, 2, true, 1>(uint16_t* src, int, int*
     }
 }
 
+/*
+ * The 8-bit cubic lines are kept in fixedpoint32, with 16 fractional bits. The products of the
+ * coefficients and the pixels stay below 2^25 and their sums never saturate, so they are computed
+ * on the raw values with plain integer arithmetic.
+ */
+template <int cn>
+static void hlineResizeCubic_8u(uint8_t* src, int* ofst, fixedpoint32* m, fixedpoint32* dst, int dst_min, int dst_max, int dst_width)
+{
+    const int* M = (const int*)m;
+    int*       D = (int*)dst;
+
+    int i = 0;
+    for (; i < dst_min; i++)
+        for (int c = 0; c < cn; c++)
+            *(D++) = src[c] << fixedpoint32::fixedShift;
+    for (; i < dst_max; i++)
+    {
+        const uint8_t* px = src + cn * ofst[i];
+        const int*     w  = M + i * 4;
+        for (int c = 0; c < cn; c++)
+            *(D++) = w[0] * px[c] + w[1] * px[c + cn] + w[2] * px[c + cn * 2] + w[3] * px[c + cn * 3];
+    }
+    // Avoid reading a potentially unset ofst, leading to a random memory read.
+    if (i >= dst_width)
+        return;
+    const uint8_t* src_last = src + cn * ofst[dst_width - 1];
+    for (; i < dst_width; i++)
+        for (int c = 0; c < cn; c++)
+            *(D++) = src_last[c] << fixedpoint32::fixedShift;
+}
+
+template <>
+void hlineResizeCn<uint8_t, fixedpoint32, 4, true, 1>(uint8_t* src, int, int* ofst, fixedpoint32* m, fixedpoint32* dst, int dst_min, int dst_max, int dst_width)
+{
+    hlineResizeCubic_8u<1>(src, ofst, m, dst, dst_min, dst_max, dst_width);
+}
+
+template <>
+void hlineResizeCn<uint8_t, fixedpoint32, 4, true, 2>(uint8_t* src, int, int* ofst, fixedpoint32* m, fixedpoint32* dst, int dst_min, int dst_max, int dst_width)
+{
+    hlineResizeCubic_8u<2>(src, ofst, m, dst, dst_min, dst_max, dst_width);
+}
+
+template <>
+void hlineResizeCn<uint8_t, fixedpoint32, 4, true, 3>(uint8_t* src, int, int* ofst, fixedpoint32* m, fixedpoint32* dst, int dst_min, int dst_max, int dst_width)
+{
+    hlineResizeCubic_8u<3>(src, ofst, m, dst, dst_min, dst_max, dst_width);
+}
+
+template <>
+void hlineResizeCn<uint8_t, fixedpoint32, 4, true, 4>(uint8_t* src, int, int* ofst, fixedpoint32* m, fixedpoint32* dst, int dst_min, int dst_max, int dst_width)
+{
+    hlineResizeCubic_8u<4>(src, ofst, m, dst, dst_min, dst_max, dst_width);
+}
+
 template <typename ET, typename FT>
 void vlineSet(FT* src, ET* dst, int dst_width)
 {
@@ -594,12 +742,55 @@ void vlineResize<uint8_t, ufixedpoint16, 2>(ufixedpoint16* src, size_t src_step,
 {
     int            i    = 0;
     ufixedpoint16* src1 = src + src_step;
+#if HL_SIMD128
+    // the lines are split into their integer and fractional bytes, which v_dotprod multiplies exactly
+    const ushort* S0    = (const ushort*)src;
+    const ushort* S1    = (const ushort*)src1;
+    v_int16x8     w((v_int16x8::vector_type)v_setall(load_unaligned<uint>((const uchar*)m)).val);
+    v_uint16x8    lo    = v_setall_u16(0xFF);
+    v_int32x4     delta = v_setall_s32(1 << 15);
+    v_int16x8     r[2];
+    for (; i <= dst_width - v_uint8x16::nlanes; i += v_uint8x16::nlanes)
+    {
+        for (int k = 0; k < 2; k++)
+        {
+            v_uint16x8 a0 = v_load(S0 + i + k * 8), a1 = v_load(S1 + i + k * 8), h0, h1, l0, l1;
+            v_zip(v_shr<8>(a0), v_shr<8>(a1), h0, h1);
+            v_zip(v_uint16x8(a0.val & lo.val), v_uint16x8(a1.val & lo.val), l0, l1);
+            v_int32x4 t0 = v_add_wrap(v_shl<8>(v_dotprod(v_int16x8((v_int16x8::vector_type)h0.val), w)), v_dotprod(v_int16x8((v_int16x8::vector_type)l0.val), w));
+            v_int32x4 t1 = v_add_wrap(v_shl<8>(v_dotprod(v_int16x8((v_int16x8::vector_type)h1.val), w)), v_dotprod(v_int16x8((v_int16x8::vector_type)l1.val), w));
+            r[k]         = v_pack(v_shr<16>(v_add_wrap(t0, delta)), v_shr<16>(v_add_wrap(t1, delta)));
+        }
+        v_store(dst + i, v_pack_u(r[0], r[1]));
+    }
+    src  += i;
+    src1 += i;
+    dst  += i;
+#endif
     for (; i < dst_width; i++)
     {
         *(dst++) = (uint8_t)(*(src++) * m[0] + *(src1++) * m[1]);
     }
 }
 
+/*
+ * The products of the 8-bit cubic lines and the coefficients stay below 2^42 and their sums never
+ * saturate, so they are computed on the raw values in 64 bits without the checks of fixedpoint64.
+ */
+template <>
+void vlineResize<uint8_t, fixedpoint32, 4>(fixedpoint32* src, size_t src_step, fixedpoint32* m, uint8_t* dst, int dst_width)
+{
+    const int* S0 = (const int*)src;
+    const int *S1 = S0 + src_step, *S2 = S1 + src_step, *S3 = S2 + src_step;
+    const int* M  = (const int*)m;
+    int64_t    m0 = M[0], m1 = M[1], m2 = M[2], m3 = M[3];
+    for (int i = 0; i < dst_width; i++)
+    {
+        int64_t res = S0[i] * m0 + S1[i] * m1 + S2[i] * m2 + S3[i] * m3;
+        dst[i]      = saturate_cast<uint8_t>((res + (INT64_C(1) << (fixedpoint64::fixedShift - 1))) >> fixedpoint64::fixedShift);
+    }
+}
+
 template <typename ET> class interpolationLinear
 {
 public:
@@ -646,6 +837,101 @@ protected:
     int        minofst, maxofst;
 };
 
+/*
+ * The area interpolation of the upscaled images is a linear one with sharper weights: the
+ * destination pixels that lie inside a source pixel copy it, and only the ones overlapping two
+ * source pixels are blended.
+ */
+template <typename ET> class interpolationArea: public interpolationLinear<ET>
+{
+public:
+    interpolationArea(double inv_scale, int srcsize, int dstsize):
+        interpolationLinear<ET>(inv_scale, srcsize, dstsize), inv_scale(inv_scale) {}
+
+    void getCoeffs(int val, int* offset, typename fixedtype<ET, false>::type* coeffs)
+    {
+        typedef typename fixedtype<ET, false>::type fixedpoint;
+        int                                         ival = hlFloor(this->scale * softdouble(val));
+        softdouble                                  fval = softdouble(val + 1) - softdouble(ival + 1) * inv_scale;
+        fval                                             = fval <= softdouble::zero() ? softdouble::zero() : fval - softdouble(hlFloor(fval));
+        if (ival < this->maxsize - 1)
+        {
+            *offset   = ival;
+            coeffs[1] = fval;
+            coeffs[0] = fixedpoint::one() - coeffs[1];
+        }
+        else
+        {
+            *offset       = this->maxsize - 1;
+            this->maxofst = min(this->maxofst, val);
+        }
+    }
+
+protected:
+    softdouble inv_scale;
+};
+
+/*
+ * The bicubic weights are computed in softdouble with A = -0.75, as in interpolateCubic. The taps
+ * outside of the image repeat its border pixel, so their weights are folded into the taps of a
+ * window that is moved inside of the image, and no point needs a special case. The weights are
+ * rounded by their cumulative sums, which keeps their total exactly one.
+ */
+template <typename ET> class interpolationCubic
+{
+public:
+    const static int  len      = 4;
+    const static bool needsign = true;
+
+    interpolationCubic(double inv_scale, int srcsize, int dstsize):
+        scale(softdouble::one() / softdouble(inv_scale)), maxsize(srcsize), dstsize(dstsize) {}
+
+    void getCoeffs(int val, int* offset, typename fixedtype<ET, needsign>::type* coeffs)
+    {
+        typedef typename fixedtype<ET, needsign>::type fixedpoint;
+        softdouble                                     fval = scale * (softdouble(val) + softdouble(0.5)) - softdouble(0.5);
+        int                                            ival = hlFloor(fval);
+        softdouble                                     x    = fval - softdouble(ival);
+
+        const softdouble A(-0.75), one = softdouble::one();
+        softdouble       x1 = x + one, x2 = one - x, w[len], wsum[len];
+
+        w[0]      = ((A * x1 - softdouble(5) * A) * x1 + softdouble(8) * A) * x1 - softdouble(4) * A;
+        w[1]      = ((A + softdouble(2)) * x - (A + softdouble(3))) * x * x + one;
+        w[2]      = ((A + softdouble(2)) * x2 - (A + softdouble(3))) * x2 * x2 + one;
+        w[3]      = one - w[0] - w[1] - w[2];
+
+        int start = max(min(ival - 1, maxsize - len), 0);
+        for (int k = 0; k < len; k++)
+            wsum[k] = softdouble::zero();
+        for (int k = 0; k < len; k++)
+            wsum[min(max(ival - 1 + k, 0), maxsize - 1) - start] += w[k];
+
+        softdouble sum = softdouble::zero();
+        fixedpoint prev;
+        for (int k = 0; k < len - 1; k++)
+        {
+            sum            += wsum[k];
+            fixedpoint cur  = sum;
+            coeffs[k]       = cur - prev;
+            prev            = cur;
+        }
+        coeffs[len - 1] = fixedpoint::one() - prev;
+        *offset         = start;
+    }
+
+    void getMinMax(int& min, int& max)
+    {
+        min = 0;
+        max = dstsize;
+    }
+
+protected:
+    softdouble scale;
+    int        maxsize;
+    int        dstsize;
+};
+
 template <typename ET, typename FT, int interp_y_len>
 class resize_bitExactInvoker:
     public ParallelLoopBody
@@ -709,6 +995,8 @@ public:
 
             vlineResize<ET, FT, interp_y_len>(linebuf.data(), dst_width * cn, curcoeffs, (ET*)(dst + dst_step * dy), dst_width * cn);
         }
+        if (dy == range.end)
+            return;
         fixedpoint* endline = linebuf.data();
         if (last_eval + interp_y_len > src_height)
             endline += dst_width * cn * ((evalbuf_start + src_height - 1 - last_eval) % interp_y_len);
@@ -752,10 +1040,10 @@ void resize_bitExact(const uchar* src, size_t src_step, int src_width, int src_h
     interpolation interp_y(inv_scale_y, src_height, dst_height);
 
     AutoBuffer<uchar> buf(dst_width * sizeof(int) + dst_height * sizeof(int) + dst_width * interp_x.len * sizeof(fixedpoint) + dst_height * interp_y.len * sizeof(fixedpoint));
-    int*              xoffsets = (int*)buf.data();
-    int*              yoffsets = xoffsets + dst_width;
-    fixedpoint*       xcoeffs  = (fixedpoint*)(yoffsets + dst_height);
+    fixedpoint*       xcoeffs  = (fixedpoint*)buf.data();
     fixedpoint*       ycoeffs  = xcoeffs + dst_width * interp_x.len;
+    int*              xoffsets = (int*)(ycoeffs + dst_height * interp_y.len);
+    int*              yoffsets = xoffsets + dst_width;
 
     int min_x, max_x, min_y, max_y;
     for (int dx = 0; dx < dst_width; dx++)
@@ -770,6 +1058,233 @@ void resize_bitExact(const uchar* src, size_t src_step, int src_width, int src_h
     parallel_for_(range, invoker, dst_width * dst_height / (double)(1 << 16));
 }
 
+template <typename FT>
+struct fixedDecimateAlpha
+{
+    int si, di;
+    FT  alpha;
+};
+
+/*
+ * The same table as computeResizeAreaTab, computed in softdouble. The weights of every destination
+ * pixel are rounded by their cumulative sums and the last one completes them to exactly one.
+ */
+template <typename FT>
+static int computeResizeAreaTab_bitExact(int ssize, int dsize, int cn, softdouble scale, fixedDecimateAlpha<FT>* tab)
+{
+    const softdouble eps(1e-3);
+
+    int k = 0;
+    for (int dx = 0; dx < dsize; dx++)
+    {
+        softdouble fsx1      = softdouble(dx) * scale;
+        softdouble fsx2      = fsx1 + scale;
+        softdouble cellWidth = min(scale, softdouble(ssize) - fsx1);
+
+        int sx1 = hlCeil(fsx1), sx2 = hlFloor(fsx2);
+
+        sx2 = min(sx2, ssize - 1);
+        sx1 = min(sx1, sx2);
+
+        int        k0  = k;
+        softdouble sum = softdouble::zero();
+        FT         prev, last;
+
+        if (eps < softdouble(sx1) - fsx1)
+        {
+            HL_Assert(k < ssize * 2);
+            sum          += (softdouble(sx1) - fsx1) / cellWidth;
+            tab[k].di     = dx * cn;
+            tab[k].si     = (sx1 - 1) * cn;
+            last          = prev;
+            prev          = sum;
+            tab[k++].alpha = prev - last;
+        }
+
+        for (int sx = sx1; sx < sx2; sx++)
+        {
+            HL_Assert(k < ssize * 2);
+            sum          += softdouble::one() / cellWidth;
+            tab[k].di     = dx * cn;
+            tab[k].si     = sx * cn;
+            last          = prev;
+            prev          = sum;
+            tab[k++].alpha = prev - last;
+        }
+
+        if (eps < fsx2 - softdouble(sx2))
+        {
+            HL_Assert(k < ssize * 2);
+            sum          += min(min(fsx2 - softdouble(sx2), softdouble::one()), cellWidth) / cellWidth;
+            tab[k].di     = dx * cn;
+            tab[k].si     = sx2 * cn;
+            last          = prev;
+            prev          = sum;
+            tab[k++].alpha = prev - last;
+        }
+
+        if (k > k0)
+            tab[k - 1].alpha = FT::one() - last;
+    }
+    return k;
+}
+
+template <typename ET, typename FT>
+static void hlineResizeArea(const ET* src, int cn, const fixedDecimateAlpha<FT>* xtab, int xtab_size, FT* dst)
+{
+    if (cn == 1)
+        for (int k = 0; k < xtab_size; k++)
+            dst[xtab[k].di] = dst[xtab[k].di] + xtab[k].alpha * src[xtab[k].si];
+    else
+        for (int k = 0; k < xtab_size; k++)
+        {
+            const ET* px    = src + xtab[k].si;
+            FT*       D     = dst + xtab[k].di;
+            FT        alpha = xtab[k].alpha;
+            for (int c = 0; c < cn; c++)
+                D[c] = D[c] + alpha * px[c];
+        }
+}
+
+// the weights of a destination pixel add up to one, so the 8-bit sums never saturate and are computed on the raw values
+template <>
+void hlineResizeArea<uint8_t, ufixedpoint32>(const uint8_t* src, int cn, const fixedDecimateAlpha<ufixedpoint32>* xtab, int xtab_size, ufixedpoint32* dst)
+{
+    uint32_t* D = (uint32_t*)dst;
+    if (cn == 1)
+        for (int k = 0; k < xtab_size; k++)
+            D[xtab[k].di] += *(const uint32_t*)&xtab[k].alpha * src[xtab[k].si];
+    else if (cn == 3)
+        for (int k = 0; k < xtab_size; k++)
+        {
+            const uint8_t* px    = src + xtab[k].si;
+            uint32_t*      d     = D + xtab[k].di;
+            uint32_t       alpha = *(const uint32_t*)&xtab[k].alpha;
+            d[0]                += alpha * px[0];
+            d[1]                += alpha * px[1];
+            d[2]                += alpha * px[2];
+        }
+    else
+        for (int k = 0; k < xtab_size; k++)
+        {
+            const uint8_t* px    = src + xtab[k].si;
+            uint32_t*      d     = D + xtab[k].di;
+            uint32_t       alpha = *(const uint32_t*)&xtab[k].alpha;
+            for (int c = 0; c < cn; c++)
+                d[c] += alpha * px[c];
+        }
+}
+
+/*
+ * The fixed-point counterpart of ResizeArea_Invoker. Every destination row sums its own source rows,
+ * so the order of the operations and the result do not depend on the stripes of parallel_for_.
+ */
+template <typename ET, typename FT>
+class resizeArea_bitExactInvoker:
+    public ParallelLoopBody
+{
+public:
+    typedef FT                     fixedpoint;
+    typedef typename FT::WT        fixedpoint_wide;
+    typedef fixedDecimateAlpha<FT> DecimateAlpha;
+
+    resizeArea_bitExactInvoker(const uchar* _src, size_t _src_step, uchar* _dst, size_t _dst_step, int _dst_width, int _cn, const DecimateAlpha* _xtab, int _xtab_size, const DecimateAlpha* _ytab, const int* _tabofs):
+        ParallelLoopBody(),
+        src(_src),
+        src_step(_src_step),
+        dst(_dst),
+        dst_step(_dst_step),
+        dst_width(_dst_width),
+        cn(_cn),
+        xtab(_xtab),
+        xtab_size(_xtab_size),
+        ytab(_ytab),
+        tabofs(_tabofs) {}
+
+    virtual void operator()(const Range& range) const override
+    {
+        int                         width = dst_width * cn;
+        AutoBuffer<fixedpoint>      _buf(width);
+        AutoBuffer<fixedpoint_wide> _sum(width);
+        fixedpoint*                 buf = _buf.data();
+        fixedpoint_wide*            sum = _sum.data();
+
+        for (int dy = range.start; dy < range.end; dy++)
+        {
+            for (int dx = 0; dx < width; dx++)
+                sum[dx] = fixedpoint_wide();
+
+            for (int j = tabofs[dy]; j < tabofs[dy + 1]; j++)
+            {
+                const ET* S = (const ET*)(src + src_step * ytab[j].si);
+                for (int dx = 0; dx < width; dx++)
+                    buf[dx] = fixedpoint();
+
+                hlineResizeArea<ET, FT>(S, cn, xtab, xtab_size, buf);
+
+                fixedpoint beta = ytab[j].alpha;
+                for (int dx = 0; dx < width; dx++)
+                    sum[dx] = sum[dx] + buf[dx] * beta;
+            }
+
+            ET* D = (ET*)(dst + dst_step * dy);
+            for (int dx = 0; dx < width; dx++)
+                D[dx] = sum[dx];
+        }
+    }
+
+private:
+    const uchar*         src;
+    size_t               src_step;
+    uchar*               dst;
+    size_t               dst_step;
+    int                  dst_width, cn;
+    const DecimateAlpha* xtab;
+    int                  xtab_size;
+    const DecimateAlpha* ytab;
+    const int*           tabofs;
+
+    resizeArea_bitExactInvoker(const resizeArea_bitExactInvoker&);
+    resizeArea_bitExactInvoker& operator=(const resizeArea_bitExactInvoker&);
+};
+
+template <typename ET>
+void resizeArea_bitExact(const uchar* src, size_t src_step, int src_width, int src_height, uchar* dst, size_t dst_step, int dst_width, int dst_height, int cn, double inv_scale_x, double inv_scale_y)
+{
+    // as in the generic resize, the true area interpolation is only used when both axes are downscaled
+    if (inv_scale_x > 1 || inv_scale_y > 1)
+    {
+        resize_bitExact<ET, interpolationArea<ET>>(src, src_step, src_width, src_height, dst, dst_step, dst_width, dst_height, cn, inv_scale_x, inv_scale_y);
+        return;
+    }
+
+    typedef typename areafixedtype<ET>::type fixedpoint;
+    typedef fixedDecimateAlpha<fixedpoint>   DecimateAlpha;
+
+    size_t            tabSize = (src_width + src_height) * 2 * sizeof(DecimateAlpha);
+    AutoBuffer<uchar> buf(tabSize + (dst_height + 1) * sizeof(int));
+    DecimateAlpha*    xtab   = (DecimateAlpha*)buf.data();
+    DecimateAlpha*    ytab   = xtab + src_width * 2;
+    int*              tabofs = (int*)(buf.data() + tabSize);
+
+    int xtab_size = computeResizeAreaTab_bitExact(src_width, dst_width, cn, softdouble::one() / softdouble(inv_scale_x), xtab);
+    int ytab_size = computeResizeAreaTab_bitExact(src_height, dst_height, 1, softdouble::one() / softdouble(inv_scale_y), ytab);
+
+    int k, dy;
+    for (k = 0, dy = 0; k < ytab_size; k++)
+    {
+        if (k == 0 || ytab[k].di != ytab[k - 1].di)
+        {
+            HL_Assert(ytab[k].di == dy);
+            tabofs[dy++] = k;
+        }
+    }
+    tabofs[dy] = ytab_size;
+
+    resizeArea_bitExactInvoker<ET, fixedpoint> invoker(src, src_step, dst, dst_step, dst_width, cn, xtab, xtab_size, ytab, tabofs);
+    parallel_for_(Range(0, dst_height), invoker, dst_width * dst_height / (double)(1 << 16));
+}
+
 typedef void (*be_resize_func)(const uchar* src, size_t src_step, int src_width, int src_height, uchar* dst, size_t dst_step, int dst_width, int dst_height, int cn, double inv_scale_x, double inv_scale_y);
 
 }    // namespace
@@ -1094,6 +1609,246 @@ struct HResizeNoVec
     }
 };
 
+#if HL_SIMD128
+
+//! stores 4 lanes with the rounding and the saturation of saturate_cast<T>
+static inline void v_store_sat(float* dst, const v_float32x4& v)
+{
+    v_store(dst, v);
+}
+
+static inline void v_store_sat(ushort* dst, const v_float32x4& v)
+{
+    v_float32x4 t = v_min(v_max(v, v_setall_f32(0.f)), v_setall_f32((float)USHRT_MAX));
+    v_store(dst, v_convert<ushort>(v_round(t)));
+}
+
+static inline void v_store_sat(short* dst, const v_float32x4& v)
+{
+    v_float32x4 t = v_min(v_max(v, v_setall_f32((float)SHRT_MIN)), v_setall_f32((float)SHRT_MAX));
+    v_store(dst, v_convert<short>(v_round(t)));
+}
+
+/*
+ * The vertical pass blends the ksize buffered rows with the same weights along the whole row. The
+ * lanes are computed in the same order of operations as the scalar loops of VResizeLinear,
+ * VResizeCubic and VResizeLanczos4, so the results do not depend on where the vector loop stops.
+ */
+struct VResizeLinearVec_32s8u
+{
+    int operator()(const int** src, uchar* dst, const short* beta, int width) const
+    {
+        const int *S0 = src[0], *S1 = src[1];
+        v_int16x8  b0 = v_setall_s16(beta[0]), b1 = v_setall_s16(beta[1]);
+        v_int16x8  delta = v_setall_s16(2);
+
+        // the rows are scaled by INTER_RESIZE_COEF_SCALE, so S >> 4 fits 16 bits and
+        // (b * (S >> 4)) >> 16 is the high half of the 16-bit product
+        int x = 0;
+        for (; x <= width - v_uint8x16::nlanes; x += v_uint8x16::nlanes)
+        {
+            v_int16x8 s00 = v_pack(v_shr<4>(v_load(S0 + x)), v_shr<4>(v_load(S0 + x + 4)));
+            v_int16x8 s01 = v_pack(v_shr<4>(v_load(S0 + x + 8)), v_shr<4>(v_load(S0 + x + 12)));
+            v_int16x8 s10 = v_pack(v_shr<4>(v_load(S1 + x)), v_shr<4>(v_load(S1 + x + 4)));
+            v_int16x8 s11 = v_pack(v_shr<4>(v_load(S1 + x + 8)), v_shr<4>(v_load(S1 + x + 12)));
+
+            v_int16x8 t0  = v_shr<2>(v_add_wrap(v_add_wrap(v_mul_hi(b0, s00), v_mul_hi(b1, s10)), delta));
+            v_int16x8 t1  = v_shr<2>(v_add_wrap(v_add_wrap(v_mul_hi(b0, s01), v_mul_hi(b1, s11)), delta));
+            v_store(dst + x, v_pack_u(t0, t1));
+        }
+        return x;
+    }
+};
+
+template <typename T>
+struct VResizeLinearVec_32f_
+{
+    int operator()(const float** src, T* dst, const float* beta, int width) const
+    {
+        const float *S0 = src[0], *S1 = src[1];
+        v_float32x4  b0 = v_setall_f32(beta[0]), b1 = v_setall_f32(beta[1]);
+
+        int x = 0;
+        for (; x <= width - v_float32x4::nlanes; x += v_float32x4::nlanes)
+            v_store_sat(dst + x, v_add_wrap(v_mul_wrap(v_load(S0 + x), b0), v_mul_wrap(v_load(S1 + x), b1)));
+        return x;
+    }
+};
+
+struct VResizeCubicVec_32s8u
+{
+    int operator()(const int** src, uchar* dst, const short* beta, int width) const
+    {
+        const int *S0 = src[0], *S1 = src[1], *S2 = src[2], *S3 = src[3];
+        v_int32x4  b0 = v_setall_s32(beta[0]), b1 = v_setall_s32(beta[1]);
+        v_int32x4  b2 = v_setall_s32(beta[2]), b3 = v_setall_s32(beta[3]);
+        v_int32x4  delta = v_setall_s32(1 << (INTER_RESIZE_COEF_BITS * 2 - 1));
+
+        int x = 0;
+        for (; x <= width - v_uint8x16::nlanes; x += v_uint8x16::nlanes)
+        {
+            v_int32x4 t[4];
+            for (int i = 0; i < 4; i++)
+            {
+                int       xi = x + i * v_int32x4::nlanes;
+                v_int32x4 s  = v_add_wrap(v_mul_wrap(v_load(S0 + xi), b0), v_mul_wrap(v_load(S1 + xi), b1));
+                s            = v_add_wrap(s, v_mul_wrap(v_load(S2 + xi), b2));
+                s            = v_add_wrap(s, v_mul_wrap(v_load(S3 + xi), b3));
+                t[i]         = v_shr<INTER_RESIZE_COEF_BITS * 2>(v_add_wrap(s, delta));
+            }
+            v_store(dst + x, v_pack_u(v_pack(t[0], t[1]), v_pack(t[2], t[3])));
+        }
+        return x;
+    }
+};
+
+template <typename T>
+struct VResizeCubicVec_32f_
+{
+    int operator()(const float** src, T* dst, const float* beta, int width) const
+    {
+        const float *S0 = src[0], *S1 = src[1], *S2 = src[2], *S3 = src[3];
+        v_float32x4  b0 = v_setall_f32(beta[0]), b1 = v_setall_f32(beta[1]);
+        v_float32x4  b2 = v_setall_f32(beta[2]), b3 = v_setall_f32(beta[3]);
+
+        int x = 0;
+        for (; x <= width - v_float32x4::nlanes; x += v_float32x4::nlanes)
+        {
+            v_float32x4 s = v_add_wrap(v_mul_wrap(v_load(S0 + x), b0), v_mul_wrap(v_load(S1 + x), b1));
+            s             = v_add_wrap(s, v_mul_wrap(v_load(S2 + x), b2));
+            s             = v_add_wrap(s, v_mul_wrap(v_load(S3 + x), b3));
+            v_store_sat(dst + x, s);
+        }
+        return x;
+    }
+};
+
+template <typename T>
+struct VResizeLanczos4Vec_32f_
+{
+    int operator()(const float** src, T* dst, const float* beta, int width) const
+    {
+        v_float32x4 b[8];
+        for (int k = 0; k < 8; k++)
+            b[k] = v_setall_f32(beta[k]);
+
+        int x = 0;
+        for (; x <= width - v_float32x4::nlanes; x += v_float32x4::nlanes)
+        {
+            v_float32x4 s = v_mul_wrap(v_load(src[0] + x), b[0]);
+            for (int k = 1; k < 8; k++)
+                s = v_add_wrap(s, v_mul_wrap(v_load(src[k] + x), b[k]));
+            v_store_sat(dst + x, s);
+        }
+        return x;
+    }
+};
+
+typedef VResizeLinearVec_32f_<ushort> VResizeLinearVec_32f16u;
+typedef VResizeLinearVec_32f_<short>  VResizeLinearVec_32f16s;
+typedef VResizeLinearVec_32f_<float>  VResizeLinearVec_32f;
+
+typedef VResizeCubicVec_32f_<ushort> VResizeCubicVec_32f16u;
+typedef VResizeCubicVec_32f_<short>  VResizeCubicVec_32f16s;
+typedef VResizeCubicVec_32f_<float>  VResizeCubicVec_32f;
+
+typedef VResizeLanczos4Vec_32f_<ushort> VResizeLanczos4Vec_32f16u;
+typedef VResizeLanczos4Vec_32f_<short>  VResizeLanczos4Vec_32f16s;
+typedef VResizeLanczos4Vec_32f_<float>  VResizeLanczos4Vec_32f;
+
+/*
+ * The horizontal pass gathers the two source pixels of 4 destination elements at once and blends
+ * them with the deinterleaved alpha pairs, for every row to be computed. Only the elements below
+ * xmax are handled, where both pixels are inside the row.
+ */
+template <typename ST, typename DT, typename AT>
+struct HResizeLinearVec_X4
+{
+    int operator()(const ST** src, DT** dst, int count, const int* xofs, const AT* alpha, int, int, int cn, int, int xmax) const
+    {
+        typedef v_reg<DT, 4> DVT;
+        typedef v_reg<AT, 4> AVT;
+
+        int dx = 0;
+        for (; dx <= xmax - DVT::nlanes; dx += DVT::nlanes)
+        {
+            AVT a0, a1;
+            v_load_deinterleave(alpha + dx * 2, a0, a1);
+            DVT va0 = v_convert<DT>(a0), va1 = v_convert<DT>(a1);
+
+            for (int k = 0; k < count; k++)
+            {
+                const ST* S  = src[k];
+                DVT       s0 = v_lut_convert<DT>(S, xofs + dx);
+                DVT       s1 = v_lut_convert<DT>(S + cn, xofs + dx);
+                v_store(dst[k] + dx, v_add_wrap(v_mul_wrap(s0, va0), v_mul_wrap(s1, va1)));
+            }
+        }
+        return dx;
+    }
+};
+
+/*
+ * For 8u the alpha pairs are stored interleaved as 16-bit values, so when the source pixels are
+ * gathered as (S[sx], S[sx + cn]) pairs v_dotprod computes S[sx] * a0 + S[sx + cn] * a1 for 4
+ * elements. With several channels the two pixels of a pair are adjacent: their 2 * cn bytes are
+ * read at once and zipped with themselves shifted by cn. A 3-channel pixel fills 3 lanes and the
+ * fourth one is rewritten by the next pixel, 2-channel pixels leave 2 such lanes.
+ */
+template <int cn>
+static int hResizeLinear_8u32s(const uchar** src, int** dst, int count, const int* xofs, const short* alpha, int xmax)
+{
+    int dx = 0;
+    for (; dx <= xmax - v_int32x4::nlanes; dx += cn)
+    {
+        v_int16x8 a  = v_load(alpha + dx * 2);
+        int       sx = xofs[dx];
+        for (int k = 0; k < count; k++)
+        {
+            v_store(dst[k] + dx, v_dotprod(v_load_expand_pair<cn>(src[k] + sx), a));
+        }
+    }
+    return dx;
+}
+
+struct HResizeLinearVec_8u32s
+{
+    int operator()(const uchar** src, int** dst, int count, const int* xofs, const short* alpha, int, int, int cn, int, int xmax) const
+    {
+        typedef v_reg<ushort, 4> v_uint16x4;
+
+        if (cn == 2)
+            return hResizeLinear_8u32s<2>(src, dst, count, xofs, alpha, xmax);
+        if (cn == 3)
+            return hResizeLinear_8u32s<3>(src, dst, count, xofs, alpha, xmax);
+        if (cn == 4)
+            return hResizeLinear_8u32s<4>(src, dst, count, xofs, alpha, xmax);
+        if (cn != 1)
+            return 0;
+
+        // the pairs of neighbours are gathered as 16-bit values
+        int dx = 0;
+        for (; dx <= xmax - v_int32x4::nlanes; dx += v_int32x4::nlanes)
+        {
+            v_int16x8  a   = v_load(alpha + dx * 2);
+            const int* ofs = xofs + dx;
+            for (int k = 0; k < count; k++)
+            {
+                const uchar* S = src[k];
+                v_uint16x4   p(v_uint16x4::vector_type{load_unaligned<ushort>(S + ofs[0]), load_unaligned<ushort>(S + ofs[1]), load_unaligned<ushort>(S + ofs[2]), load_unaligned<ushort>(S + ofs[3])});
+                v_store(dst[k] + dx, v_dotprod(v_convert<short>(v_reg<uchar, 8>((v_reg<uchar, 8>::vector_type)p.val)), a));
+            }
+        }
+        return dx;
+    }
+};
+
+typedef HResizeLinearVec_X4<ushort, float, float> HResizeLinearVec_16u32f;
+typedef HResizeLinearVec_X4<short, float, float>  HResizeLinearVec_16s32f;
+typedef HResizeLinearVec_X4<float, float, float>  HResizeLinearVec_32f;
+
+#else
+
 typedef VResizeNoVec VResizeLinearVec_32s8u;
 typedef VResizeNoVec VResizeLinearVec_32f16u;
 typedef VResizeNoVec VResizeLinearVec_32f16s;
@@ -1112,6 +1867,9 @@ typedef HResizeNoVec HResizeLinearVec_8u32s;
 typedef HResizeNoVec HResizeLinearVec_16u32f;
 typedef HResizeNoVec HResizeLinearVec_16s32f;
 typedef HResizeNoVec HResizeLinearVec_32f;
+
+#endif
+
 typedef HResizeNoVec HResizeLinearVec_64f;
 
 template <typename T, typename WT, typename AT, int ONE, class VecOp>
@@ -1883,22 +2641,54 @@ static int computeResizeAreaTab(int ssize, int dsize, int cn, double scale, Deci
     return k;
 }
 
-namespace hal
+/*
+ * The coefficient tables of resize depend only on the geometry of the call, so they are prepared
+ * once by a ResizePlan and kept in a small LRU cache: repeated calls with the same sizes, type and
+ * interpolation, e.g. for the frames of a video, go straight to the invokers without computing or
+ * allocating the tables again. The nearest neighbour and the bit-exact resizes compute their offsets
+ * inside their own invokers and are not planned.
+ */
+class ResizePlan
 {
+public:
+    ResizePlan(int _type, Size _ssize, Size _dsize, size_t _srcStep, double _inv_scale_x, double _inv_scale_y, int _interpolation);
 
-void resize(int src_type, const uchar* src_data, size_t src_step, int src_width, int src_height, uchar* dst_data, size_t dst_step, int dst_width, int dst_height, double inv_scale_x, double inv_scale_y, int interpolation)
-{
-    HL_Assert((dst_width > 0 && dst_height > 0) || (inv_scale_x > 0 && inv_scale_y > 0));
-    if (inv_scale_x < DBL_EPSILON || inv_scale_y < DBL_EPSILON)
+    bool matches(int _type, Size _ssize, Size _dsize, size_t _srcStep, double _inv_scale_x, double _inv_scale_y, int _interpolation) const
     {
-        inv_scale_x = static_cast<double>(dst_width) / src_width;
-        inv_scale_y = static_cast<double>(dst_height) / src_height;
+        // only the fast area offsets depend on the source step, the other plans serve any ROI of the size
+        return type == _type && ssize == _ssize && dsize == _dsize && (!areaFastFunc || srcStep == _srcStep) && inv_scale_x == _inv_scale_x && inv_scale_y == _inv_scale_y && interpolation == _interpolation;
     }
 
-    int  depth = HL_MAT_DEPTH(src_type), cn = HL_MAT_CN(src_type);
-    Size dsize = Size(saturate_cast<int>(src_width * inv_scale_x), saturate_cast<int>(src_height * inv_scale_y));
-    HL_Assert(!dsize.empty());
+    void run(const Mat& src, Mat& dst) const;
+
+private:
+    int    type;
+    Size   ssize, dsize;
+    size_t srcStep;
+    double inv_scale_x, inv_scale_y;
+    int    interpolation;
+
+    // exactly one of the functions is set, with the tables it takes
+    ResizeFunc         func;
+    ResizeAreaFastFunc areaFastFunc;
+    ResizeAreaFunc     areaFunc;
+
+    const int *          xofs, *yofs, *ofs, *tabofs;
+    const void *         alpha, *beta;
+    const DecimateAlpha *xtab, *ytab;
+    int                  xmin, xmax, ksize, iscale_x, iscale_y, xtab_size, ytab_size;
+
+    AutoBuffer<uchar> buffer;
+
+    ResizePlan(const ResizePlan&);                  // = delete;
+    const ResizePlan& operator=(const ResizePlan&);    // = delete;
+};
 
+ResizePlan::ResizePlan(int _type, Size _ssize, Size _dsize, size_t _srcStep, double _inv_scale_x, double _inv_scale_y, int _interpolation):
+    type(_type), ssize(_ssize), dsize(_dsize), srcStep(_srcStep), inv_scale_x(_inv_scale_x), inv_scale_y(_inv_scale_y), interpolation(_interpolation),
+    func(0), areaFastFunc(0), areaFunc(0), xofs(0), yofs(0), ofs(0), tabofs(0), alpha(0), beta(0), xtab(0), ytab(0),
+    xmin(0), xmax(0), ksize(0), iscale_x(0), iscale_y(0), xtab_size(0), ytab_size(0)
+{
     static ResizeFunc linear_tab[] = {
         resizeGeneric_<HResizeLinear<uchar, int, short, INTER_RESIZE_COEF_SCALE, HResizeLinearVec_8u32s>,
                        VResizeLinear<uchar, int, short, FixedPtCast<int, uchar, INTER_RESIZE_COEF_BITS * 2>, VResizeLinearVec_32s8u>>,
@@ -1908,11 +2698,11 @@ void resize(int src_type, const uchar* src_data, size_t src_step, int src_width,
         resizeGeneric_<HResizeLinear<short, float, float, 1, HResizeLinearVec_16s32f>,
                        VResizeLinear<short, float, float, Cast<float, short>, VResizeLinearVec_32f16s>>,
         0,
+        0,
         resizeGeneric_<HResizeLinear<float, float, float, 1, HResizeLinearVec_32f>,
                        VResizeLinear<float, float, float, Cast<float, float>, VResizeLinearVec_32f>>,
         resizeGeneric_<HResizeLinear<double, double, float, 1, HResizeNoVec>,
-                       VResizeLinear<double, double, float, Cast<double, double>, VResizeNoVec>>,
-        0};
+                       VResizeLinear<double, double, float, Cast<double, double>, VResizeNoVec>>};
 
     static ResizeFunc cubic_tab[] = {
         resizeGeneric_<
@@ -1926,13 +2716,13 @@ void resize(int src_type, const uchar* src_data, size_t src_step, int src_width,
             HResizeCubic<short, float, float>,
             VResizeCubic<short, float, float, Cast<float, short>, VResizeCubicVec_32f16s>>,
         0,
+        0,
         resizeGeneric_<
             HResizeCubic<float, float, float>,
             VResizeCubic<float, float, float, Cast<float, float>, VResizeCubicVec_32f>>,
         resizeGeneric_<
             HResizeCubic<double, double, float>,
-            VResizeCubic<double, double, float, Cast<double, double>, VResizeNoVec>>,
-        0};
+            VResizeCubic<double, double, float, Cast<double, double>, VResizeNoVec>>};
 
     static ResizeFunc lanczos4_tab[] = {
         resizeGeneric_<HResizeLanczos4<uchar, int, short>,
@@ -1943,11 +2733,11 @@ void resize(int src_type, const uchar* src_data, size_t src_step, int src_width,
         resizeGeneric_<HResizeLanczos4<short, float, float>,
                        VResizeLanczos4<short, float, float, Cast<float, short>, VResizeLanczos4Vec_32f16s>>,
         0,
+        0,
         resizeGeneric_<HResizeLanczos4<float, float, float>,
                        VResizeLanczos4<float, float, float, Cast<float, float>, VResizeLanczos4Vec_32f>>,
         resizeGeneric_<HResizeLanczos4<double, double, float>,
-                       VResizeLanczos4<double, double, float, Cast<double, double>, VResizeNoVec>>,
-        0};
+                       VResizeLanczos4<double, double, float, Cast<double, double>, VResizeNoVec>>};
 
     static ResizeAreaFastFunc areafast_tab[] = {
         resizeAreaFast_<uchar, int, ResizeAreaFastVec<uchar, ResizeAreaFastVec_SIMD_8u>>,
@@ -1955,136 +2745,103 @@ void resize(int src_type, const uchar* src_data, size_t src_step, int src_width,
         resizeAreaFast_<ushort, float, ResizeAreaFastVec<ushort, ResizeAreaFastVec_SIMD_16u>>,
         resizeAreaFast_<short, float, ResizeAreaFastVec<short, ResizeAreaFastVec_SIMD_16s>>,
         0,
+        0,
         resizeAreaFast_<float, float, ResizeAreaFastVec_SIMD_32f>,
-        resizeAreaFast_<double, double, ResizeAreaFastNoVec<double, double>>,
-        0};
+        resizeAreaFast_<double, double, ResizeAreaFastNoVec<double, double>>};
 
     static ResizeAreaFunc area_tab[] = {
-        resizeArea_<uchar, float>, 0, resizeArea_<ushort, float>, resizeArea_<short, float>, 0, resizeArea_<float, float>, resizeArea_<double, double>, 0};
+        resizeArea_<uchar, float>, 0, resizeArea_<ushort, float>, resizeArea_<short, float>, 0, 0, resizeArea_<float, float>, resizeArea_<double, double>};
 
-    static be_resize_func linear_exact_tab[] = {
-        resize_bitExact<uchar, interpolationLinear<uchar>>,
-        resize_bitExact<schar, interpolationLinear<schar>>,
-        resize_bitExact<ushort, interpolationLinear<ushort>>,
-        resize_bitExact<short, interpolationLinear<short>>,
-        resize_bitExact<int, interpolationLinear<int>>,
-        0,
-        0,
-        0};
+    int depth = HL_MAT_DEPTH(type), cn = HL_MAT_CN(type), interp = interpolation;
 
     double scale_x = 1. / inv_scale_x, scale_y = 1. / inv_scale_y;
 
-    int iscale_x      = saturate_cast<int>(scale_x);
-    int iscale_y      = saturate_cast<int>(scale_y);
+    iscale_x          = saturate_cast<int>(scale_x);
+    iscale_y          = saturate_cast<int>(scale_y);
 
     bool is_area_fast = std::abs(scale_x - iscale_x) < DBL_EPSILON && std::abs(scale_y - iscale_y) < DBL_EPSILON;
 
-    Mat src(Size(src_width, src_height), src_type, const_cast<uchar*>(src_data), src_step);
-    Mat dst(dsize, src_type, dst_data, dst_step);
-
-    if (interpolation == INTER_LINEAR_EXACT)
-    {
-        // in case of inv_scale_x && inv_scale_y is equal to 0.5
-        // INTER_AREA (fast) is equal to bit exact INTER_LINEAR
-        if (is_area_fast && iscale_x == 2 && iscale_y == 2 && cn != 2)    //Area resize implementation for 2-channel images isn't bit-exact
-            interpolation = INTER_AREA;
-        else
-        {
-            be_resize_func func = linear_exact_tab[depth];
-            HL_Assert(func != 0);
-            func(src_data, src_step, src_width, src_height, dst_data, dst_step, dst_width, dst_height, cn, inv_scale_x, inv_scale_y);
-            return;
-        }
-    }
-
-    if (interpolation == INTER_NEAREST)
-    {
-        resizeNN(src, dst, inv_scale_x, inv_scale_y);
-        return;
-    }
-
-    if (interpolation == INTER_NEAREST_EXACT)
-    {
-        resizeNN_bitexact(src, dst, inv_scale_x, inv_scale_y);
-        return;
-    }
-
     int k, sx, sy, dx, dy;
 
-
     {
         // in case of scale_x && scale_y is equal to 2
         // INTER_AREA (fast) also is equal to INTER_LINEAR
-        if (interpolation == INTER_LINEAR && is_area_fast && iscale_x == 2 && iscale_y == 2)
-            interpolation = INTER_AREA;
+        if (interp == INTER_LINEAR && is_area_fast && iscale_x == 2 && iscale_y == 2)
+            interp = INTER_AREA;
 
         // true "area" interpolation is only implemented for the case (scale_x >= 1 && scale_y >= 1).
         // In other cases it is emulated using some variant of bilinear interpolation
-        if (interpolation == INTER_AREA && scale_x >= 1 && scale_y >= 1)
+        if (interp == INTER_AREA && scale_x >= 1 && scale_y >= 1)
         {
             if (is_area_fast)
             {
-                int                area    = iscale_x * iscale_y;
-                size_t             srcstep = src_step / src.elemSize1();
-                AutoBuffer<int>    _ofs(area + dsize.width * cn);
-                int*               ofs  = _ofs.data();
-                int*               xofs = ofs + area;
-                ResizeAreaFastFunc func = areafast_tab[depth];
-                HL_Assert(func != 0);
+                int    area     = iscale_x * iscale_y;
+                size_t srcstep  = srcStep / HL_ELEM_SIZE1(type);
+                buffer.allocate((area + dsize.width * cn) * sizeof(int));
+                int* _ofs       = (int*)buffer.data();
+                int* _xofs      = _ofs + area;
+                areaFastFunc    = areafast_tab[depth];
+                HL_Assert(areaFastFunc != 0);
 
                 for (sy = 0, k = 0; sy < iscale_y; sy++)
                     for (sx = 0; sx < iscale_x; sx++)
-                        ofs[k++] = (int)(sy * srcstep + sx * cn);
+                        _ofs[k++] = (int)(sy * srcstep + sx * cn);
 
                 for (dx = 0; dx < dsize.width; dx++)
                 {
                     int j = dx * cn;
                     sx    = iscale_x * j;
                     for (k = 0; k < cn; k++)
-                        xofs[j + k] = sx + k;
+                        _xofs[j + k] = sx + k;
                 }
 
-                func(src, dst, ofs, xofs, iscale_x, iscale_y);
+                ofs  = _ofs;
+                xofs = _xofs;
                 return;
             }
 
-            ResizeAreaFunc func = area_tab[depth];
-            HL_Assert(func != 0 && cn <= 4);
+            areaFunc = area_tab[depth];
+            HL_Assert(areaFunc != 0 && cn <= 4);
 
-            AutoBuffer<DecimateAlpha> _xytab((src_width + src_height) * 2);
-            DecimateAlpha *           xtab = _xytab.data(), *ytab = xtab + src_width * 2;
+            size_t tabSize = (ssize.width + ssize.height) * 2 * sizeof(DecimateAlpha);
+            buffer.allocate(tabSize + (dsize.height + 1) * sizeof(int));
+            DecimateAlpha* _xtab = (DecimateAlpha*)buffer.data();
+            DecimateAlpha* _ytab = _xtab + ssize.width * 2;
 
-            int xtab_size = computeResizeAreaTab(src_width, dsize.width, cn, scale_x, xtab);
-            int ytab_size = computeResizeAreaTab(src_height, dsize.height, 1, scale_y, ytab);
+            xtab_size            = computeResizeAreaTab(ssize.width, dsize.width, cn, scale_x, _xtab);
+            ytab_size            = computeResizeAreaTab(ssize.height, dsize.height, 1, scale_y, _ytab);
 
-            AutoBuffer<int> _tabofs(dsize.height + 1);
-            int*            tabofs = _tabofs.data();
+            int* _tabofs         = (int*)(buffer.data() + tabSize);
             for (k = 0, dy = 0; k < ytab_size; k++)
             {
-                if (k == 0 || ytab[k].di != ytab[k - 1].di)
+                if (k == 0 || _ytab[k].di != _ytab[k - 1].di)
                 {
-                    HL_Assert(ytab[k].di == dy);
-                    tabofs[dy++] = k;
+                    HL_Assert(_ytab[k].di == dy);
+                    _tabofs[dy++] = k;
                 }
             }
-            tabofs[dy] = ytab_size;
+            _tabofs[dy] = ytab_size;
 
-            func(src, dst, xtab, xtab_size, ytab, ytab_size, tabofs);
+            xtab        = _xtab;
+            ytab        = _ytab;
+            tabofs      = _tabofs;
             return;
         }
     }
 
-    int        xmin = 0, xmax = dsize.width, width = dsize.width * cn;
-    bool       area_mode = interpolation == INTER_AREA;
-    bool       fixpt     = depth == HL_8U;
-    float      fx, fy;
-    ResizeFunc func  = 0;
-    int        ksize = 0, ksize2;
-    if (interpolation == INTER_CUBIC)
+    int   width     = dsize.width * cn;
+    bool  area_mode = interp == INTER_AREA;
+    bool  fixpt     = depth == HL_8U;
+    float fx, fy;
+    int   ksize2;
+
+    xmin            = 0;
+    xmax            = dsize.width;
+    if (interp == INTER_CUBIC)
         ksize = 4, func = cubic_tab[depth];
-    else if (interpolation == INTER_LANCZOS4)
+    else if (interp == INTER_LANCZOS4)
         ksize = 8, func = lanczos4_tab[depth];
-    else if (interpolation == INTER_LINEAR || interpolation == INTER_AREA)
+    else if (interp == INTER_LINEAR || interp == INTER_AREA)
         ksize = 2, func = linear_tab[depth];
     else
         HL_Error(hl::Error::StsBadArg, "Unknown interpolation method");
@@ -2092,14 +2849,14 @@ void resize(int src_type, const uchar* src_data, size_t src_step, int src_width,
 
     HL_Assert(func != 0);
 
-    AutoBuffer<uchar> _buffer((width + dsize.height) * (sizeof(int) + sizeof(float) * ksize));
-    int*              xofs            = (int*)_buffer.data();
-    int*              yofs            = xofs + width;
-    float*            alpha           = (float*)(yofs + dsize.height);
-    short*            ialpha          = (short*)alpha;
-    float*            beta            = alpha + width * ksize;
-    short*            ibeta           = ialpha + width * ksize;
-    float             cbuf[MAX_ESIZE] = {0};
+    buffer.allocate((width + dsize.height) * (sizeof(int) + sizeof(float) * ksize));
+    int*   _xofs           = (int*)buffer.data();
+    int*   _yofs           = _xofs + width;
+    float* _alpha          = (float*)(_yofs + dsize.height);
+    short* ialpha          = (short*)_alpha;
+    float* _beta           = _alpha + width * ksize;
+    short* ibeta           = ialpha + width * ksize;
+    float  cbuf[MAX_ESIZE] = {0};
 
     for (dx = 0; dx < dsize.width; dx++)
     {
@@ -2119,23 +2876,23 @@ void resize(int src_type, const uchar* src_data, size_t src_step, int src_width,
         if (sx < ksize2 - 1)
         {
             xmin = dx + 1;
-            if (sx < 0 && (interpolation != INTER_CUBIC && interpolation != INTER_LANCZOS4))
+            if (sx < 0 && (interp != INTER_CUBIC && interp != INTER_LANCZOS4))
                 fx = 0, sx = 0;
         }
 
-        if (sx + ksize2 >= src_width)
+        if (sx + ksize2 >= ssize.width)
         {
             xmax = std::min(xmax, dx);
-            if (sx >= src_width - 1 && (interpolation != INTER_CUBIC && interpolation != INTER_LANCZOS4))
-                fx = 0, sx = src_width - 1;
+            if (sx >= ssize.width - 1 && (interp != INTER_CUBIC && interp != INTER_LANCZOS4))
+                fx = 0, sx = ssize.width - 1;
         }
 
         for (k = 0, sx *= cn; k < cn; k++)
-            xofs[dx * cn + k] = sx + k;
+            _xofs[dx * cn + k] = sx + k;
 
-        if (interpolation == INTER_CUBIC)
+        if (interp == INTER_CUBIC)
             interpolateCubic(fx, cbuf);
-        else if (interpolation == INTER_LANCZOS4)
+        else if (interp == INTER_LANCZOS4)
             interpolateLanczos4(fx, cbuf);
         else
         {
@@ -2152,9 +2909,9 @@ void resize(int src_type, const uchar* src_data, size_t src_step, int src_width,
         else
         {
             for (k = 0; k < ksize; k++)
-                alpha[dx * cn * ksize + k] = cbuf[k];
+                _alpha[dx * cn * ksize + k] = cbuf[k];
             for (; k < cn * ksize; k++)
-                alpha[dx * cn * ksize + k] = alpha[dx * cn * ksize + k - ksize];
+                _alpha[dx * cn * ksize + k] = _alpha[dx * cn * ksize + k - ksize];
         }
     }
 
@@ -2173,10 +2930,10 @@ void resize(int src_type, const uchar* src_data, size_t src_step, int src_width,
             fy = fy <= 0 ? 0.f : fy - hlFloor(fy);
         }
 
-        yofs[dy] = sy;
-        if (interpolation == INTER_CUBIC)
+        _yofs[dy] = sy;
+        if (interp == INTER_CUBIC)
             interpolateCubic(fy, cbuf);
-        else if (interpolation == INTER_LANCZOS4)
+        else if (interp == INTER_LANCZOS4)
             interpolateLanczos4(fy, cbuf);
         else
         {
@@ -2192,11 +2949,159 @@ void resize(int src_type, const uchar* src_data, size_t src_step, int src_width,
         else
         {
             for (k = 0; k < ksize; k++)
-                beta[dy * ksize + k] = cbuf[k];
+                _beta[dy * ksize + k] = cbuf[k];
+        }
+    }
+
+    xofs  = _xofs;
+    yofs  = _yofs;
+    alpha = fixpt ? (const void*)ialpha : (const void*)_alpha;
+    beta  = fixpt ? (const void*)ibeta : (const void*)_beta;
+}
+
+void ResizePlan::run(const Mat& src, Mat& dst) const
+{
+    if (areaFastFunc)
+        areaFastFunc(src, dst, ofs, xofs, iscale_x, iscale_y);
+    else if (areaFunc)
+        areaFunc(src, dst, xtab, xtab_size, ytab, ytab_size, tabofs);
+    else
+        func(src, dst, xofs, alpha, yofs, beta, xmin, xmax, ksize);
+}
+
+//! the most recently used plans, the first one is the last used
+class ResizePlanCache
+{
+public:
+    Ptr<ResizePlan> get(int type, Size ssize, Size dsize, size_t srcStep, double inv_scale_x, double inv_scale_y, int interpolation)
+    {
+        {
+            AutoLock lock(mutex);
+            for (size_t i = 0; i < plans.size(); i++)
+            {
+                if (plans[i]->matches(type, ssize, dsize, srcStep, inv_scale_x, inv_scale_y, interpolation))
+                {
+                    std::rotate(plans.begin(), plans.begin() + i, plans.begin() + i + 1);
+                    return plans[0];
+                }
+            }
         }
+
+        // the tables are computed outside of the lock, other threads keep resizing meanwhile
+        Ptr<ResizePlan> plan = makePtr<ResizePlan>(type, ssize, dsize, srcStep, inv_scale_x, inv_scale_y, interpolation);
+
+        AutoLock lock(mutex);
+        if (plans.size() >= MAX_PLANS)
+            plans.pop_back();
+        plans.insert(plans.begin(), plan);
+        return plan;
     }
 
-    func(src, dst, xofs, fixpt ? (void*)ialpha : (void*)alpha, yofs, fixpt ? (void*)ibeta : (void*)beta, xmin, xmax, ksize);
+private:
+    enum
+    {
+        MAX_PLANS = 8
+    };
+
+    Mutex                        mutex;
+    std::vector<Ptr<ResizePlan>> plans;
+};
+
+static ResizePlanCache& getResizePlanCache()
+{
+    static ResizePlanCache cache;
+    return cache;
+}
+
+namespace hal
+{
+
+void resize(int src_type, const uchar* src_data, size_t src_step, int src_width, int src_height, uchar* dst_data, size_t dst_step, int dst_width, int dst_height, double inv_scale_x, double inv_scale_y, int interpolation)
+{
+    HL_Assert((dst_width > 0 && dst_height > 0) || (inv_scale_x > 0 && inv_scale_y > 0));
+    if (inv_scale_x < DBL_EPSILON || inv_scale_y < DBL_EPSILON)
+    {
+        inv_scale_x = static_cast<double>(dst_width) / src_width;
+        inv_scale_y = static_cast<double>(dst_height) / src_height;
+    }
+
+    int  depth = HL_MAT_DEPTH(src_type), cn = HL_MAT_CN(src_type);
+    Size dsize = Size(saturate_cast<int>(src_width * inv_scale_x), saturate_cast<int>(src_height * inv_scale_y));
+    HL_Assert(!dsize.empty());
+
+    static be_resize_func linear_exact_tab[] = {
+        resize_bitExact<uchar, interpolationLinear<uchar>>,
+        resize_bitExact<schar, interpolationLinear<schar>>,
+        resize_bitExact<ushort, interpolationLinear<ushort>>,
+        resize_bitExact<short, interpolationLinear<short>>,
+        0,
+        resize_bitExact<int, interpolationLinear<int>>,
+        0,
+        0};
+
+    static be_resize_func cubic_exact_tab[] = {
+        resize_bitExact<uchar, interpolationCubic<uchar>>,
+        resize_bitExact<schar, interpolationCubic<schar>>,
+        resize_bitExact<ushort, interpolationCubic<ushort>>,
+        resize_bitExact<short, interpolationCubic<short>>,
+        0,
+        resize_bitExact<int, interpolationCubic<int>>,
+        0,
+        0};
+
+    static be_resize_func area_exact_tab[] = {
+        resizeArea_bitExact<uchar>,
+        resizeArea_bitExact<schar>,
+        resizeArea_bitExact<ushort>,
+        resizeArea_bitExact<short>,
+        0,
+        resizeArea_bitExact<int>,
+        0,
+        0};
+
+    Mat src(Size(src_width, src_height), src_type, const_cast<uchar*>(src_data), src_step);
+    Mat dst(dsize, src_type, dst_data, dst_step);
+
+    if (interpolation == INTER_CUBIC_EXACT || interpolation == INTER_AREA_EXACT)
+    {
+        be_resize_func func = interpolation == INTER_CUBIC_EXACT ? cubic_exact_tab[depth] : area_exact_tab[depth];
+        HL_Assert(func != 0);
+        func(src_data, src_step, src_width, src_height, dst_data, dst_step, dst_width, dst_height, cn, inv_scale_x, inv_scale_y);
+        return;
+    }
+
+    if (interpolation == INTER_LINEAR_EXACT)
+    {
+        double scale_x = 1. / inv_scale_x, scale_y = 1. / inv_scale_y;
+        int    iscale_x = saturate_cast<int>(scale_x), iscale_y = saturate_cast<int>(scale_y);
+
+        // in case of inv_scale_x && inv_scale_y is equal to 0.5
+        // INTER_AREA (fast) is equal to bit exact INTER_LINEAR
+        if (std::abs(scale_x - iscale_x) < DBL_EPSILON && std::abs(scale_y - iscale_y) < DBL_EPSILON && iscale_x == 2 && iscale_y == 2 && cn != 2)    //Area resize implementation for 2-channel images isn't bit-exact
+            interpolation = INTER_AREA;
+        else
+        {
+            be_resize_func func = linear_exact_tab[depth];
+            HL_Assert(func != 0);
+            func(src_data, src_step, src_width, src_height, dst_data, dst_step, dst_width, dst_height, cn, inv_scale_x, inv_scale_y);
+            return;
+        }
+    }
+
+    if (interpolation == INTER_NEAREST)
+    {
+        resizeNN(src, dst, inv_scale_x, inv_scale_y);
+        return;
+    }
+
+    if (interpolation == INTER_NEAREST_EXACT)
+    {
+        resizeNN_bitexact(src, dst, inv_scale_x, inv_scale_y);
+        return;
+    }
+
+    Ptr<ResizePlan> plan = getResizePlanCache().get(src_type, src.size(), dsize, src_step, inv_scale_x, inv_scale_y, interpolation);
+    plan->run(src, dst);
 }
 
 }    // namespace hal
@@ -2223,8 +3128,16 @@ void hl::resize(const Mat& _src, Mat& _dst, Size dsize, double inv_scale_x, doub
         HL_Assert(inv_scale_y > 0);
     }
 
-    if (interpolation == INTER_LINEAR_EXACT && (_src.depth() == HL_32F || _src.depth() == HL_64F))
-        interpolation = INTER_LINEAR;    // If depth isn't supported fallback to generic resize
+    // If depth isn't supported fallback to generic resize
+    if (_src.depth() == HL_32F || _src.depth() == HL_64F)
+    {
+        if (interpolation == INTER_LINEAR_EXACT)
+            interpolation = INTER_LINEAR;
+        else if (interpolation == INTER_CUBIC_EXACT)
+            interpolation = INTER_CUBIC;
+        else if (interpolation == INTER_AREA_EXACT)
+            interpolation = INTER_AREA;
+    }
 
     Mat src = _src;
     _dst.create(dsize, src.type());
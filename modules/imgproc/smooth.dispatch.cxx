@@ -0,0 +1,34 @@
+#include "precomp.hxx"
+#include <vector>
+#include "smooth.simd.hxx"
+
+namespace hl
+{
+
+void GaussianBlurIIR(const Mat& src, Mat& _dst, double sigmaX, double sigmaY, int borderType)
+{
+    HL_Assert(!src.empty());
+
+    if (sigmaY <= 0)
+        sigmaY = sigmaX;
+    // the recursive approximation is only defined for sigma >= 0.5
+    HL_Assert(sigmaX >= 0.5 && sigmaY >= 0.5);
+
+    _dst.create(src.size(), src.type());
+    Mat dst = _dst;
+
+    cpu_baseline::GaussianBlurIIR(src, dst, sigmaX, sigmaY, borderType);
+}
+
+void stackBlur(const Mat& src, Mat& _dst, Size ksize, int borderType)
+{
+    HL_Assert(!src.empty());
+    HL_Assert(ksize.width > 0 && ksize.width % 2 == 1 && ksize.height > 0 && ksize.height % 2 == 1);
+
+    _dst.create(src.size(), src.type());
+    Mat dst = _dst;
+
+    cpu_baseline::stackBlur(src, dst, ksize, borderType);
+}
+
+}    // namespace hl
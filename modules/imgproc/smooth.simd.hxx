@@ -0,0 +1,551 @@
+#include "precomp.hxx"
+#include <vector>
+
+namespace hl
+{
+namespace cpu_baseline
+{
+
+// forward declarations
+void GaussianBlurIIR(const Mat& src, Mat& dst, double sigmaX, double sigmaY, int borderType);
+void stackBlur(const Mat& src, Mat& dst, Size ksize, int borderType);
+
+/****************************************************************************************\
+                                 Recursive Gaussian Blur
+\****************************************************************************************/
+
+namespace
+{
+
+/*
+ * The 3rd order recursive Gaussian of Young & van Vliet: a causal pass
+ * w[n] = B x[n] + a1 w[n-1] + a2 w[n-2] + a3 w[n-3] followed by the same anti-causal pass.
+ * The ends of a line are replicated: the causal pass starts in its steady state for x[0], and
+ * the anti-causal pass is initialized as proposed by Triggs & Sdika, i.e. with the exact
+ * response of the filter to the causal state and an infinite extension by x[n-1]. M maps
+ * the last three causal outputs (minus x[n-1]) to the anti-causal values past the end.
+ * The other borders, and the replicated border of a ROI inside a larger image, are handled
+ * by extending the lines by getIIRBorderPad() elements, beyond which the response of the
+ * filter is about 1e-4 of the input.
+ */
+struct RecursiveGaussianCoeffs
+{
+    explicit RecursiveGaussianCoeffs(double sigma)
+    {
+        double q;
+        if (sigma >= 2.5)
+            q = 0.98711 * sigma - 0.96330;
+        else
+            q = 3.97156 - 4.14554 * std::sqrt(1 - 0.26891 * sigma);
+
+        double q2 = q * q, q3 = q2 * q;
+        double b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+        double b1 = 2.44413 * q + 2.85619 * q2 + 1.26661 * q3;
+        double b2 = -(1.4281 * q2 + 1.26661 * q3);
+        double b3 = 0.422205 * q3;
+
+        double a[3] = {b1 / b0, b2 / b0, b3 / b0};
+        a1          = (float)a[0];
+        a2          = (float)a[1];
+        a3          = (float)a[2];
+        B           = (float)(1 - (a[0] + a[1] + a[2]));
+
+        /*
+         * The Triggs & Sdika matrix is computed by running the filter on the three unit causal
+         * states: the causal deviations from x[n-1] decay by the homogeneous recursion, and the
+         * anti-causal pass over them, started far enough, gives the initial values.
+         */
+        int                 len = hlCeil(q * 20) + 64;
+        std::vector<double> e(len + 3), y(len + 3);
+        for (int j = 0; j < 3; j++)
+        {
+            // e[0], e[1] and e[2] are the causal outputs n-3, n-2 and n-1
+            std::fill(e.begin(), e.end(), 0.);
+            e[2 - j] = 1;
+            for (int i = 3; i < len + 3; i++)
+                e[i] = a[0] * e[i - 1] + a[1] * e[i - 2] + a[2] * e[i - 3];
+
+            std::fill(y.begin(), y.end(), 0.);
+            for (int i = len + 2 - 3; i >= 3; i--)
+                y[i] = B * e[i] + a[0] * y[i + 1] + a[1] * y[i + 2] + a[2] * y[i + 3];
+
+            for (int i = 0; i < 3; i++)
+                M[i * 3 + j] = (float)y[i + 3];
+        }
+    }
+
+    float B;
+    float a1;
+    float a2;
+    float a3;
+    float M[9];
+};
+
+/*
+ * The lines are processed in blocks of IIR_LANES, stored interleaved (n x IIR_LANES floats),
+ * so that every step of the recursions is one vector operation across the lines. The image
+ * rows and columns are gathered into such blocks, which keeps the working set of a block
+ * in the cache for the anti-causal pass.
+ */
+enum
+{
+    IIR_LANES = 16
+};
+
+static void recursiveGaussianLines(float* buf, int n, const RecursiveGaussianCoeffs& c)
+{
+    float w1[IIR_LANES], w2[IIR_LANES], w3[IIR_LANES], u[IIR_LANES];
+    int   l, i;
+
+    for (l = 0; l < IIR_LANES; l++)
+    {
+        w1[l] = w2[l] = w3[l] = buf[l];
+        u[l]                  = buf[(n - 1) * IIR_LANES + l];
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        float* b = buf + i * IIR_LANES;
+        for (l = 0; l < IIR_LANES; l++)
+        {
+            float w = c.B * b[l] + c.a1 * w1[l] + c.a2 * w2[l] + c.a3 * w3[l];
+            w3[l]   = w2[l];
+            w2[l]   = w1[l];
+            w1[l]   = w;
+            b[l]    = w;
+        }
+    }
+
+    for (l = 0; l < IIR_LANES; l++)
+    {
+        float d0 = w1[l] - u[l], d1 = w2[l] - u[l], d2 = w3[l] - u[l];
+        float y1 = u[l] + c.M[0] * d0 + c.M[1] * d1 + c.M[2] * d2;
+        float y2 = u[l] + c.M[3] * d0 + c.M[4] * d1 + c.M[5] * d2;
+        float y3 = u[l] + c.M[6] * d0 + c.M[7] * d1 + c.M[8] * d2;
+        w1[l]    = y1;
+        w2[l]    = y2;
+        w3[l]    = y3;
+    }
+
+    for (i = n - 1; i >= 0; i--)
+    {
+        float* b = buf + i * IIR_LANES;
+        for (l = 0; l < IIR_LANES; l++)
+        {
+            float y = c.B * b[l] + c.a1 * w1[l] + c.a2 * w2[l] + c.a3 * w3[l];
+            w3[l]   = w2[l];
+            w2[l]   = w1[l];
+            w1[l]   = y;
+            b[l]    = y;
+        }
+    }
+}
+
+//! the number of elements the lines are extended by on each side for the given border
+static int getIIRBorderPad(double sigma, int borderType, bool atImageBorder)
+{
+    if ((borderType & ~BORDER_ISOLATED) == BORDER_REPLICATE && ((borderType & BORDER_ISOLATED) || atImageBorder))
+        return 0;
+    return hlCeil(sigma * 4) + 3;
+}
+
+/*
+ * The horizontal pass, a line per row and channel. The rows of dst are the rows -top ..
+ * src.rows + top - 1 of src, extended by the accessor, so that the vertical pass finds the
+ * border rows in dst.
+ */
+template <typename T>
+class RecursiveGaussianRow_Invoker: public ParallelLoopBody
+{
+public:
+    RecursiveGaussianRow_Invoker(const BorderRowAccessor& _src, Mat& _dst, const RecursiveGaussianCoeffs& _c, int _pad, int _top):
+        ParallelLoopBody(), src(_src), dst(_dst), c(_c), pad(_pad), top(_top)
+    {
+        cn     = dst.channels();
+        nlines = dst.rows * cn;
+        n      = dst.cols + pad * 2;
+    }
+
+    int blocksCount() const { return (nlines + IIR_LANES - 1) / IIR_LANES; }
+
+    void operator()(const Range& range) const override
+    {
+        AutoBuffer<float> _buf(n * IIR_LANES);
+        AutoBuffer<T>     _row(n * cn);
+        float*            buf = _buf.data();
+        T*                row = _row.data();
+
+        for (int blk = range.start; blk < range.end; blk++)
+        {
+            int k0 = blk * IIR_LANES, lanes = std::min((int)IIR_LANES, nlines - k0), i, l, y = -1;
+
+            for (l = 0; l < IIR_LANES; l++)
+            {
+                float* b = buf + l;
+                if (l >= lanes)
+                {
+                    for (i = 0; i < n; i++)
+                        b[i * IIR_LANES] = 0.f;
+                    continue;
+                }
+                if ((k0 + l) / cn != y)
+                {
+                    y = (k0 + l) / cn;
+                    src.extendRow(y - top, (uchar*)row);
+                }
+                const T* S = row + (k0 + l) % cn;
+                for (i = 0; i < n; i++)
+                    b[i * IIR_LANES] = (float)S[i * cn];
+            }
+
+            recursiveGaussianLines(buf, n, c);
+
+            for (l = 0; l < lanes; l++)
+            {
+                float*       D = dst.ptr<float>((k0 + l) / cn) + (k0 + l) % cn;
+                const float* b = buf + pad * IIR_LANES + l;
+                for (i = 0; i < dst.cols; i++)
+                    D[i * cn] = b[i * IIR_LANES];
+            }
+        }
+    }
+
+private:
+    const BorderRowAccessor&       src;
+    Mat&                           dst;
+    const RecursiveGaussianCoeffs& c;
+    int                            pad;
+    int                            top;
+    int                            cn;
+    int                            nlines;
+    int                            n;
+
+    RecursiveGaussianRow_Invoker(const RecursiveGaussianRow_Invoker&);                     // = delete;
+    const RecursiveGaussianRow_Invoker& operator=(const RecursiveGaussianRow_Invoker&);    // = delete;
+};
+
+/*
+ * The vertical pass, a line per element of the rows of src, which holds top border rows
+ * above and below the rows of dst.
+ */
+template <typename T>
+class RecursiveGaussianColumn_Invoker: public ParallelLoopBody
+{
+public:
+    RecursiveGaussianColumn_Invoker(const Mat& _src, Mat& _dst, const RecursiveGaussianCoeffs& _c, int _top):
+        ParallelLoopBody(), src(_src), dst(_dst), c(_c), top(_top)
+    {
+        nlines = dst.cols * dst.channels();
+        n      = src.rows;
+    }
+
+    int blocksCount() const { return (nlines + IIR_LANES - 1) / IIR_LANES; }
+
+    void operator()(const Range& range) const override
+    {
+        AutoBuffer<float> _buf(n * IIR_LANES);
+        float*            buf = _buf.data();
+
+        for (int blk = range.start; blk < range.end; blk++)
+        {
+            int k0 = blk * IIR_LANES, lanes = std::min((int)IIR_LANES, nlines - k0), i, l;
+
+            for (i = 0; i < n; i++)
+            {
+                const float* S = src.ptr<float>(i) + k0;
+                float*       b = buf + i * IIR_LANES;
+                for (l = 0; l < lanes; l++)
+                    b[l] = S[l];
+                for (; l < IIR_LANES; l++)
+                    b[l] = 0.f;
+            }
+
+            recursiveGaussianLines(buf, n, c);
+
+            for (i = 0; i < dst.rows; i++)
+            {
+                T*           D = dst.ptr<T>(i) + k0;
+                const float* b = buf + (i + top) * IIR_LANES;
+                for (l = 0; l < lanes; l++)
+                    D[l] = saturate_cast<T>(b[l]);
+            }
+        }
+    }
+
+private:
+    const Mat&                     src;
+    Mat&                           dst;
+    const RecursiveGaussianCoeffs& c;
+    int                            top;
+    int                            nlines;
+    int                            n;
+
+    RecursiveGaussianColumn_Invoker(const RecursiveGaussianColumn_Invoker&);                     // = delete;
+    const RecursiveGaussianColumn_Invoker& operator=(const RecursiveGaussianColumn_Invoker&);    // = delete;
+};
+
+template <typename T>
+static void GaussianBlurIIR_(const Mat& src, Mat& dst, double sigmaX, double sigmaY, int borderType)
+{
+    Size  wholeSize;
+    Point ofs;
+    src.locateROI(wholeSize, ofs);
+    int pad = getIIRBorderPad(sigmaX, borderType, ofs.x == 0 && ofs.x + src.cols == wholeSize.width);
+    int top = getIIRBorderPad(sigmaY, borderType, ofs.y == 0 && ofs.y + src.rows == wholeSize.height);
+
+    BorderRowAccessor       acc(src, borderType, pad, pad);
+    Mat                     tmp(src.rows + top * 2, src.cols, HL_MAKETYPE(HL_32F, src.channels()));
+    RecursiveGaussianCoeffs cx(sigmaX), cy(sigmaY);
+
+    RecursiveGaussianRow_Invoker<T> rows(acc, tmp, cx, pad, top);
+    parallel_for_(Range(0, rows.blocksCount()), rows, rows.blocksCount());
+
+    RecursiveGaussianColumn_Invoker<T> columns(tmp, dst, cy, top);
+    parallel_for_(Range(0, columns.blocksCount()), columns, columns.blocksCount());
+}
+
+}    // namespace
+
+void GaussianBlurIIR(const Mat& src, Mat& dst, double sigmaX, double sigmaY, int borderType)
+{
+    int depth = src.depth();
+    if (depth == HL_8U)
+        GaussianBlurIIR_<uchar>(src, dst, sigmaX, sigmaY, borderType);
+    else if (depth == HL_16U)
+        GaussianBlurIIR_<ushort>(src, dst, sigmaX, sigmaY, borderType);
+    else if (depth == HL_16S)
+        GaussianBlurIIR_<short>(src, dst, sigmaX, sigmaY, borderType);
+    else if (depth == HL_32F)
+        GaussianBlurIIR_<float>(src, dst, sigmaX, sigmaY, borderType);
+    else
+        HL_Error_(HL_StsNotImplemented, ("Unsupported depth (={})", depth));
+}
+
+/****************************************************************************************\
+                                       Stack Blur
+\****************************************************************************************/
+
+namespace
+{
+
+/*
+ * Stack blur is the convolution with the tent kernel (r + 1 - |i|) / (r + 1)^2, done with
+ * running sums: when the center moves by one, the sum loses the left half of the window
+ * (sumOut) and gains the right half (sumIn), so each pixel costs a few additions whatever
+ * the radius is. The horizontal pass reads the rows extended by the border and also filters
+ * the border rows above and below the image, which the vertical pass then reads as is.
+ */
+template <typename T>
+struct StackBlurTraits
+{
+    typedef int    WT;
+    typedef double DT;
+};
+
+template <>
+struct StackBlurTraits<ushort>
+{
+    typedef double WT;
+    typedef double DT;
+};
+
+template <>
+struct StackBlurTraits<short>
+{
+    typedef double WT;
+    typedef double DT;
+};
+
+template <>
+struct StackBlurTraits<float>
+{
+    typedef float WT;
+    typedef float DT;
+};
+
+template <typename T>
+class StackBlurRow_Invoker: public ParallelLoopBody
+{
+public:
+    typedef typename StackBlurTraits<T>::WT WT;
+
+    //! the rows of dst are the rows -top .. src.rows + top - 1 of src
+    StackBlurRow_Invoker(const BorderRowAccessor& _src, Mat& _dst, int _radius, int _top):
+        ParallelLoopBody(), src(_src), dst(_dst), radius(_radius), top(_top)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        int                             cn = dst.channels(), width = dst.cols, r = radius;
+        typename StackBlurTraits<T>::DT scale = (typename StackBlurTraits<T>::DT)1 / ((r + 1) * (r + 1));
+        AutoBuffer<T>                   _row((width + 2 * r + 1) * cn);
+
+        for (int y = range.start; y < range.end; y++)
+        {
+            const T* S = _row.data() + r * cn;
+            T*       D = dst.ptr<T>(y);
+
+            src.extendRow(y - top, (uchar*)_row.data());
+
+            for (int c = 0; c < cn; c++)
+            {
+                WT sum = 0, sumIn = 0, sumOut = 0;
+                for (int i = -r; i <= 0; i++)
+                {
+                    WT v    = S[i * cn + c];
+                    sum    += v * (r + 1 + i);
+                    sumOut += v;
+                }
+                for (int i = 1; i <= r; i++)
+                {
+                    WT v   = S[i * cn + c];
+                    sum   += v * (r + 1 - i);
+                    sumIn += v;
+                }
+
+                for (int x = 0; x < width; x++)
+                {
+                    D[x * cn + c]  = saturate_cast<T>(sum * scale);
+                    WT vin         = S[(x + r + 1) * cn + c];
+                    WT vc          = S[(x + 1) * cn + c];
+                    sum           += sumIn + vin - sumOut;
+                    sumOut        += vc - S[(x - r) * cn + c];
+                    sumIn         += vin - vc;
+                }
+            }
+        }
+    }
+
+private:
+    const BorderRowAccessor& src;
+    Mat&                     dst;
+    int                      radius;
+    int                      top;
+
+    StackBlurRow_Invoker(const StackBlurRow_Invoker&);                     // = delete;
+    const StackBlurRow_Invoker& operator=(const StackBlurRow_Invoker&);    // = delete;
+};
+
+/*
+ * The vertical pass keeps the running sums of a block of columns and moves them down the
+ * image row by row, so the updates are vector operations across the columns. src holds
+ * radius border rows above and below the rows of dst.
+ */
+template <typename T>
+class StackBlurColumn_Invoker: public ParallelLoopBody
+{
+public:
+    typedef typename StackBlurTraits<T>::WT WT;
+
+    enum
+    {
+        BLOCK_SIZE = 256
+    };
+
+    StackBlurColumn_Invoker(const Mat& _src, Mat& _dst, int _radius):
+        ParallelLoopBody(), src(_src), dst(_dst), radius(_radius)
+    {
+        width = dst.cols * dst.channels();
+    }
+
+    int blocksCount() const { return (width + BLOCK_SIZE - 1) / BLOCK_SIZE; }
+
+    void operator()(const Range& range) const override
+    {
+        int                             height = dst.rows, r = radius, i, x;
+        typename StackBlurTraits<T>::DT scale  = (typename StackBlurTraits<T>::DT)1 / ((r + 1) * (r + 1));
+        WT                              sum[BLOCK_SIZE], sumIn[BLOCK_SIZE], sumOut[BLOCK_SIZE];
+
+        for (int blk = range.start; blk < range.end; blk++)
+        {
+            int x0 = blk * BLOCK_SIZE, bw = std::min((int)BLOCK_SIZE, width - x0);
+
+            for (x = 0; x < bw; x++)
+                sum[x] = sumIn[x] = sumOut[x] = 0;
+
+            for (i = -r; i <= r; i++)
+            {
+                const T* S = src.ptr<T>(i + r) + x0;
+                WT       w = (WT)(r + 1 - std::abs(i));
+                if (i <= 0)
+                    for (x = 0; x < bw; x++)
+                    {
+                        sum[x]    += S[x] * w;
+                        sumOut[x] += S[x];
+                    }
+                else
+                    for (x = 0; x < bw; x++)
+                    {
+                        sum[x]   += S[x] * w;
+                        sumIn[x] += S[x];
+                    }
+            }
+
+            for (i = 0; i < height; i++)
+            {
+                // the sums after the last row are not used, Sin only has to stay inside src
+                T*       D    = dst.ptr<T>(i) + x0;
+                const T* Sin  = src.ptr<T>(std::min(i + r * 2 + 1, src.rows - 1)) + x0;
+                const T* Sc   = src.ptr<T>(i + r + 1) + x0;
+                const T* Sout = src.ptr<T>(i) + x0;
+
+                for (x = 0; x < bw; x++)
+                {
+                    D[x]       = saturate_cast<T>(sum[x] * scale);
+                    sum[x]    += sumIn[x] + Sin[x] - sumOut[x];
+                    sumOut[x] += Sc[x] - Sout[x];
+                    sumIn[x]  += Sin[x] - Sc[x];
+                }
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat&       dst;
+    int        radius;
+    int        width;
+
+    StackBlurColumn_Invoker(const StackBlurColumn_Invoker&);                     // = delete;
+    const StackBlurColumn_Invoker& operator=(const StackBlurColumn_Invoker&);    // = delete;
+};
+
+template <typename T>
+static void stackBlur_(const Mat& src, Mat& dst, Size ksize, int borderType)
+{
+    int               rx = ksize.width / 2, ry = ksize.height / 2;
+    BorderRowAccessor acc(src, borderType, rx, rx + 1);
+    Mat               tmp(src.rows + ry * 2, src.cols, src.type());
+
+    StackBlurRow_Invoker<T> rows(acc, tmp, rx, ry);
+    parallel_for_(Range(0, tmp.rows), rows, tmp.total() / (double)(1 << 16));
+
+    if (ksize.height > 1)
+    {
+        StackBlurColumn_Invoker<T> body(tmp, dst, ry);
+        parallel_for_(Range(0, body.blocksCount()), body, body.blocksCount());
+    }
+    else
+        tmp.copyTo(dst);
+}
+
+}    // namespace
+
+void stackBlur(const Mat& src, Mat& dst, Size ksize, int borderType)
+{
+    int depth = src.depth();
+    if (depth == HL_8U)
+        stackBlur_<uchar>(src, dst, ksize, borderType);
+    else if (depth == HL_16U)
+        stackBlur_<ushort>(src, dst, ksize, borderType);
+    else if (depth == HL_16S)
+        stackBlur_<short>(src, dst, ksize, borderType);
+    else if (depth == HL_32F)
+        stackBlur_<float>(src, dst, ksize, borderType);
+    else
+        HL_Error_(HL_StsNotImplemented, ("Unsupported depth (={})", depth));
+}
+
+}    // namespace cpu_baseline
+}    // namespace hl
@@ -0,0 +1,47 @@
+#include "precomp.hxx"
+#include "sumpixels.simd.hxx"
+
+namespace hl
+{
+
+static void integral_(const Mat& _src, Mat& sum, Mat* sqsum, Mat* tilted, int sdepth, int sqdepth)
+{
+    HL_Assert(!_src.empty());
+
+    // the outputs may share the data of src, which is released by create()
+    Mat src   = _src;
+    int depth = src.depth(), cn = src.channels();
+
+    if (sdepth <= 0)
+        sdepth = depth == HL_8U ? HL_32S : HL_64F;
+    if (sqdepth <= 0)
+        sqdepth = HL_64F;
+    sdepth  = HL_MAT_DEPTH(sdepth);
+    sqdepth = HL_MAT_DEPTH(sqdepth);
+
+    Size isize(src.cols + 1, src.rows + 1);
+    sum.create(isize, HL_MAKETYPE(sdepth, cn));
+    if (sqsum)
+        sqsum->create(isize, HL_MAKETYPE(sqdepth, cn));
+    if (tilted)
+        tilted->create(isize, HL_MAKETYPE(sdepth, cn));
+
+    cpu_baseline::integral(src, sum, sqsum, tilted);
+}
+
+void integral(const Mat& src, Mat& sum, int sdepth)
+{
+    integral_(src, sum, 0, 0, sdepth, -1);
+}
+
+void integral(const Mat& src, Mat& sum, Mat& sqsum, int sdepth, int sqdepth)
+{
+    integral_(src, sum, &sqsum, 0, sdepth, sqdepth);
+}
+
+void integral(const Mat& src, Mat& sum, Mat& sqsum, Mat& tilted, int sdepth, int sqdepth)
+{
+    integral_(src, sum, &sqsum, &tilted, sdepth, sqdepth);
+}
+
+}    // namespace hl
@@ -0,0 +1,387 @@
+#include "precomp.hxx"
+#include "openHL/core/hal/intrin.hxx"
+
+namespace hl
+{
+namespace cpu_baseline
+{
+
+// forward declarations
+void integral(const Mat& src, Mat& sum, Mat* sqsum, Mat* tilted);
+
+/****************************************************************************************\
+                                      Integral Image
+\****************************************************************************************/
+
+namespace
+{
+
+#if HL_SIMD128
+//! inclusive prefix sum of the lanes, in log2(nlanes) shift-and-add steps
+template <int k, typename _Tpvec>
+inline _Tpvec v_prefix_sum(const _Tpvec& v)
+{
+    if constexpr (k < _Tpvec::nlanes)
+        return v_prefix_sum<k * 2>(v_add_wrap(v, v_rotate_left<k>(v)));
+    else
+        return v;
+}
+#endif
+
+/*
+ * Computes a row of the integral image, dst[x] = prev[x] + the sum of the source elements of the
+ * same channel before and at x; dst and prev point at the column 1 of the integral rows. With sqr
+ * set the squares of the elements are summed. The single channel rows are scanned a register at a
+ * time: the prefix sum of the lanes is added to the running sum, whose last lane is broadcast to
+ * the next register.
+ */
+template <typename T, typename ST, bool sqr>
+static void integralRow(const T* src, const ST* prev, ST* dst, int width, int cn)
+{
+    if (cn == 1)
+    {
+        int x = 0;
+        ST  s = 0;
+#if HL_SIMD128
+        typedef v_reg<ST, HL_SIMD_WIDTH / sizeof(ST)> ST_vec;
+        const int                                     nlanes = ST_vec::nlanes;
+
+        ST_vec vs = v_setall((ST)0);
+        for (; x <= width - nlanes; x += nlanes)
+        {
+            ST_vec v = v_load_convert<ST>(src + x);
+            if (sqr)
+                v = v_mul_wrap(v, v);
+            v  = v_add_wrap(v_prefix_sum<1>(v), vs);
+            vs = v_setall((ST)v.val[nlanes - 1]);
+            v_store(dst + x, v_add_wrap(v, v_load(prev + x)));
+        }
+        s = vs.val[0];
+#endif
+        for (; x < width; x++)
+        {
+            ST v    = (ST)src[x];
+            s      += sqr ? v * v : v;
+            dst[x]  = prev[x] + s;
+        }
+        return;
+    }
+
+    for (int c = 0; c < cn; c++)
+    {
+        ST s = 0;
+        for (int x = c; x < width * cn; x += cn)
+        {
+            ST v    = (ST)src[x];
+            s      += sqr ? v * v : v;
+            dst[x]  = prev[x] + s;
+        }
+    }
+}
+
+//! the first source row of the band b, when the rows are split into nbands bands
+static inline int integralBandStart(int b, int rows, int nbands)
+{
+    return (int)((int64)b * rows / nbands);
+}
+
+/*
+ * The first pass: every band of rows is integrated on its own, as if it was the top of the image,
+ * i.e. the first row of a band is accumulated onto the zero row 0 of the integral image.
+ */
+template <typename T, typename ST, typename QT>
+class Integral_Invoker: public ParallelLoopBody
+{
+public:
+    Integral_Invoker(const Mat& _src, Mat& _sum, Mat* _sqsum, int _nbands):
+        ParallelLoopBody(), src(_src), sum(_sum), sqsum(_sqsum), nbands(_nbands)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        int cn = src.channels(), width = src.cols;
+
+        for (int b = range.start; b < range.end; b++)
+        {
+            int y0 = integralBandStart(b, src.rows, nbands), y1 = integralBandStart(b + 1, src.rows, nbands);
+
+            for (int y = y0; y < y1; y++)
+            {
+                const T* S  = src.ptr<T>(y);
+                int      py = y == y0 ? 0 : y;
+
+                ST* D       = sum.ptr<ST>(y + 1);
+                for (int c = 0; c < cn; c++)
+                    D[c] = 0;
+                integralRow<T, ST, false>(S, sum.ptr<ST>(py) + cn, D + cn, width, cn);
+
+                if (sqsum)
+                {
+                    QT* Q = sqsum->ptr<QT>(y + 1);
+                    for (int c = 0; c < cn; c++)
+                        Q[c] = 0;
+                    integralRow<T, QT, true>(S, sqsum->ptr<QT>(py) + cn, Q + cn, width, cn);
+                }
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat&       sum;
+    Mat*       sqsum;
+    int        nbands;
+
+    Integral_Invoker(const Integral_Invoker&);                     // = delete;
+    const Integral_Invoker& operator=(const Integral_Invoker&);    // = delete;
+};
+
+/*
+ * The second pass: the band b is shifted by the last integral row of the band b - 1. The last rows
+ * of the bands have been fixed up serially beforehand, so the bands are independent.
+ */
+template <typename ST>
+class IntegralFixup_Invoker: public ParallelLoopBody
+{
+public:
+    IntegralFixup_Invoker(Mat& _sum, int _rows, int _nbands):
+        ParallelLoopBody(), sum(_sum), rows(_rows), nbands(_nbands)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        int n = sum.cols * sum.channels();
+
+        for (int b = range.start; b < range.end; b++)
+        {
+            int       y0    = integralBandStart(b, rows, nbands), y1 = integralBandStart(b + 1, rows, nbands);
+            const ST* carry = sum.ptr<ST>(y0);
+
+            for (int y = y0 + 1; y < y1; y++)
+            {
+                ST* D = sum.ptr<ST>(y);
+                for (int x = 0; x < n; x++)
+                    D[x] += carry[x];
+            }
+        }
+    }
+
+private:
+    Mat& sum;
+    int  rows;
+    int  nbands;
+
+    IntegralFixup_Invoker(const IntegralFixup_Invoker&);                     // = delete;
+    const IntegralFixup_Invoker& operator=(const IntegralFixup_Invoker&);    // = delete;
+};
+
+template <typename ST>
+static void integralFixup(Mat& sum, int rows, int nbands)
+{
+    int n = sum.cols * sum.channels();
+
+    for (int b = 1; b < nbands; b++)
+    {
+        const ST* carry = sum.ptr<ST>(integralBandStart(b, rows, nbands));
+        ST*       D     = sum.ptr<ST>(integralBandStart(b + 1, rows, nbands));
+        for (int x = 0; x < n; x++)
+            D[x] += carry[x];
+    }
+
+    IntegralFixup_Invoker<ST> body(sum, rows, nbands);
+    parallel_for_(Range(1, nbands), body, nbands - 1);
+}
+
+//! the integral images together with the tilted one, which depends on the two previous rows and is computed serially
+template <typename T, typename ST, typename QT>
+static void integralTilted_(const Mat& _src, Mat& _sum, Mat* _sqsum, Mat& _tilted)
+{
+    int  cn         = _src.channels();
+    Size size       = _src.size();
+    int  srcstep    = (int)(_src.step / sizeof(T));
+    int  sumstep    = (int)(_sum.step / sizeof(ST));
+    int  tiltedstep = (int)(_tilted.step / sizeof(ST));
+    int  sqsumstep  = _sqsum ? (int)(_sqsum->step / sizeof(QT)) : 0;
+
+    const T* src    = _src.ptr<T>();
+    ST*      sum    = _sum.ptr<ST>();
+    ST*      tilted = _tilted.ptr<ST>();
+    QT*      sqsum  = _sqsum ? _sqsum->ptr<QT>() : 0;
+
+    int x, y, k;
+
+    size.width *= cn;
+
+    memset(sum, 0, (size.width + cn) * sizeof(sum[0]));
+    sum += sumstep + cn;
+
+    if (sqsum)
+    {
+        memset(sqsum, 0, (size.width + cn) * sizeof(sqsum[0]));
+        sqsum += sqsumstep + cn;
+    }
+
+    memset(tilted, 0, (size.width + cn) * sizeof(tilted[0]));
+    tilted += tiltedstep + cn;
+
+    AutoBuffer<ST> _buf(size.width + cn);
+    ST*            buf = _buf.data();
+    ST             s;
+    QT             sq;
+
+    for (k = 0; k < cn; k++, src++, sum++, tilted++, buf++)
+    {
+        sum[-cn] = tilted[-cn] = 0;
+
+        for (x = 0, s = 0, sq = 0; x < size.width; x += cn)
+        {
+            T it   = src[x];
+            buf[x] = tilted[x] = it;
+            s     += it;
+            sq    += (QT)it * it;
+            sum[x] = s;
+            if (sqsum)
+                sqsum[x] = sq;
+        }
+
+        if (size.width == cn)
+            buf[cn] = 0;
+
+        if (sqsum)
+        {
+            sqsum[-cn] = 0;
+            sqsum++;
+        }
+    }
+
+    for (y = 1; y < size.height; y++)
+    {
+        src    += srcstep - cn;
+        sum    += sumstep - cn;
+        tilted += tiltedstep - cn;
+        buf    += -cn;
+
+        if (sqsum)
+            sqsum += sqsumstep - cn;
+
+        for (k = 0; k < cn; k++, src++, sum++, tilted++, buf++)
+        {
+            T  it  = src[0];
+            ST t0  = s = it;
+            QT tq0 = sq = (QT)it * it;
+
+            sum[-cn] = 0;
+            if (sqsum)
+                sqsum[-cn] = 0;
+            tilted[-cn] = tilted[-tiltedstep];
+
+            sum[0] = sum[-sumstep] + t0;
+            if (sqsum)
+                sqsum[0] = sqsum[-sqsumstep] + tq0;
+            tilted[0] = tilted[-tiltedstep] + t0 + buf[cn];
+
+            for (x = cn; x < size.width - cn; x += cn)
+            {
+                ST t1       = buf[x];
+                buf[x - cn] = t1 + t0;
+                t0 = it     = src[x];
+                tq0         = (QT)it * it;
+                s          += t0;
+                sq         += tq0;
+                sum[x]      = sum[x - sumstep] + s;
+                if (sqsum)
+                    sqsum[x] = sqsum[x - sqsumstep] + sq;
+                t1        += buf[x + cn] + t0 + tilted[x - tiltedstep - cn];
+                tilted[x]  = t1;
+            }
+
+            if (size.width > cn)
+            {
+                ST t1       = buf[x];
+                buf[x - cn] = t1 + t0;
+                t0 = it     = src[x];
+                tq0         = (QT)it * it;
+                s          += t0;
+                sq         += tq0;
+                sum[x]      = sum[x - sumstep] + s;
+                if (sqsum)
+                    sqsum[x] = sqsum[x - sqsumstep] + sq;
+                tilted[x] = t0 + t1 + tilted[x - tiltedstep - cn];
+                buf[x]    = t0;
+            }
+
+            if (sqsum)
+                sqsum++;
+        }
+    }
+}
+
+template <typename T, typename ST, typename QT>
+static void integral_(const Mat& src, Mat& sum, Mat* sqsum, Mat* tilted)
+{
+    if (tilted)
+    {
+        integralTilted_<T, ST, QT>(src, sum, sqsum, *tilted);
+        return;
+    }
+
+    memset(sum.ptr(), 0, sum.cols * sum.elemSize());
+    if (sqsum)
+        memset(sqsum->ptr(), 0, sqsum->cols * sqsum->elemSize());
+
+    // the bands are integrated in parallel, then all but the first are shifted by the sums above them.
+    // The shift costs another pass over the bands, so there is one band per thread and none without threads
+    int nbands = std::max(std::min(std::min(src.rows / 256, 16), getNumThreads()), 1);
+
+    Integral_Invoker<T, ST, QT> body(src, sum, sqsum, nbands);
+    parallel_for_(Range(0, nbands), body, nbands);
+
+    if (nbands > 1)
+    {
+        integralFixup<ST>(sum, src.rows, nbands);
+        if (sqsum)
+            integralFixup<QT>(*sqsum, src.rows, nbands);
+    }
+}
+
+template <typename T, typename ST>
+static void integralSq_(const Mat& src, Mat& sum, Mat* sqsum, Mat* tilted)
+{
+    if (!sqsum || sqsum->depth() == HL_64F)
+        integral_<T, ST, double>(src, sum, sqsum, tilted);
+    else if (sqsum->depth() == HL_32F)
+        integral_<T, ST, float>(src, sum, sqsum, tilted);
+    else
+        HL_Error(HL_StsUnsupportedFormat, "");
+}
+
+}    // namespace
+
+void integral(const Mat& src, Mat& sum, Mat* sqsum, Mat* tilted)
+{
+    int depth = src.depth(), sdepth = sum.depth();
+
+    if (depth == HL_8U && sdepth == HL_32S)
+        integralSq_<uchar, int>(src, sum, sqsum, tilted);
+    else if (depth == HL_8U && sdepth == HL_32F)
+        integralSq_<uchar, float>(src, sum, sqsum, tilted);
+    else if (depth == HL_8U && sdepth == HL_64F)
+        integralSq_<uchar, double>(src, sum, sqsum, tilted);
+    else if (depth == HL_16U && sdepth == HL_32S)
+        integralSq_<ushort, int>(src, sum, sqsum, tilted);
+    else if (depth == HL_16U && sdepth == HL_32F)
+        integralSq_<ushort, float>(src, sum, sqsum, tilted);
+    else if (depth == HL_16U && sdepth == HL_64F)
+        integralSq_<ushort, double>(src, sum, sqsum, tilted);
+    else if (depth == HL_32F && sdepth == HL_32F)
+        integralSq_<float, float>(src, sum, sqsum, tilted);
+    else if (depth == HL_32F && sdepth == HL_64F)
+        integralSq_<float, double>(src, sum, sqsum, tilted);
+    else
+        HL_Error(HL_StsUnsupportedFormat, "");
+}
+
+}    // namespace cpu_baseline
+}    // namespace hl
@@ -0,0 +1,118 @@
+#include "test_precomp.hxx"
+
+#include <cmath>
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+//! direct evaluation of the exact filter in double precision, the constant border is 0
+template <typename T>
+Mat bilateralReference(const Mat& src, int radius, double sigmaColor, double sigmaSpace, int borderType)
+{
+    int cn = src.channels();
+    Mat dst(src.size(), src.type());
+
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols; x++)
+        {
+            const T* p0     = src.ptr<T>(y) + x * cn;
+            double   sum[3] = {0, 0, 0}, wsum = 0;
+            for (int i = -radius; i <= radius; i++)
+                for (int j = -radius; j <= radius; j++)
+                {
+                    double r = std::sqrt((double)i * i + (double)j * j);
+                    if (r > radius)
+                        continue;
+                    int    yy = borderInterpolate(y + i, src.rows, borderType);
+                    int    xx = borderInterpolate(x + j, src.cols, borderType);
+                    double v[3] = {0, 0, 0}, dist = 0;
+                    for (int c = 0; c < cn; c++)
+                    {
+                        v[c]  = yy >= 0 && xx >= 0 ? (double)src.ptr<T>(yy)[xx * cn + c] : 0.;
+                        dist += std::abs(v[c] - p0[c]);
+                    }
+                    double w = std::exp(-0.5 * r * r / (sigmaSpace * sigmaSpace)) * std::exp(-0.5 * dist * dist / (sigmaColor * sigmaColor));
+                    for (int c = 0; c < cn; c++)
+                        sum[c] += w * v[c];
+                    wsum += w;
+                }
+            for (int c = 0; c < cn; c++)
+                dst.ptr<T>(y)[x * cn + c] = saturate_cast<T>(sum[c] / wsum);
+        }
+    return dst;
+}
+
+TEST(Imgproc_BilateralFilter, exactMatchesReference)
+{
+    for (int type : {HL_8UC1, HL_8UC3, HL_32FC1, HL_32FC3})
+        for (int borderType : {BORDER_REFLECT_101, BORDER_REPLICATE, BORDER_CONSTANT})
+            for (int width : {3, 5, 38})
+            {
+                Mat src = randomMat(Size(width, 17), type, type + borderType * 7 + width, 1. / 3);
+                Mat dst, ref;
+                bilateralFilter(src, dst, 7, 40, 3, borderType);
+                if (src.depth() == HL_8U)
+                    ref = bilateralReference<uchar>(src, 3, 40, 3, borderType);
+                else
+                    ref = bilateralReference<float>(src, 3, 40, 3, borderType);
+
+                // 8U rounds the float sums, 32F interpolates the color weights
+                double tol = src.depth() == HL_8U ? 1 : 0.05;
+                EXPECT_LE(norm(dst, ref, NORM_INF), tol) << "type " << type << " border " << borderType << " width " << width;
+            }
+}
+
+TEST(Imgproc_BilateralFilter, floatNaNStaysLocal)
+{
+    Mat src = randomMat(Size(40, 30), HL_32FC1, 5, 1. / 3);
+    src.ptr<float>(15)[20] = std::nanf("");
+
+    for (int mode : {BILATERAL_EXACT, BILATERAL_GRID})
+    {
+        Mat dst;
+        bilateralFilter(src, dst, 5, 20, 2, BORDER_CONSTANT, mode);
+        EXPECT_FALSE(std::isnan(dst.ptr<float>(0)[0])) << "mode " << mode;
+        EXPECT_FALSE(std::isnan(dst.ptr<float>(29)[39])) << "mode " << mode;
+    }
+}
+
+TEST(Imgproc_BilateralFilter, gridReadsRoiParent)
+{
+    for (int type : {HL_8UC1, HL_8UC3, HL_32FC1})
+    {
+        Mat whole = randomMat(Size(160, 120), type, type + 11, 1. / 3);
+        Mat roi   = whole(Rect(30, 20, 100, 80));
+        Mat copy  = roi.clone();
+
+        Mat isolated, cloned, withParent;
+        bilateralFilter(roi, isolated, -1, 30, 4, BORDER_REFLECT_101 | BORDER_ISOLATED, BILATERAL_GRID);
+        bilateralFilter(copy, cloned, -1, 30, 4, BORDER_REFLECT_101, BILATERAL_GRID);
+        bilateralFilter(roi, withParent, -1, 30, 4, BORDER_REFLECT_101, BILATERAL_GRID);
+
+        EXPECT_TRUE(equalMats(isolated, cloned)) << "type " << type;
+        EXPECT_FALSE(equalMats(withParent, cloned)) << "type " << type;
+    }
+}
+
+TEST(Imgproc_BilateralFilter, gridFloatRangeIgnoresZero)
+{
+    // the grid spans the values of the image, so an offset image keeps the same grid and the result
+    // is offset too; a range stretched to 0 would be too deep and leave the grid for the exact filter
+    Mat bytes = randomMat(Size(160, 120), HL_8UC3, 17), src, shifted;
+    bytes.convertTo(src, HL_32F);
+    bytes.convertTo(shifted, HL_32F, 1, 1024);
+
+    Mat dst, dstShifted;
+    bilateralFilter(src, dst, -1, 30, 8, BORDER_REFLECT_101, BILATERAL_GRID);
+    bilateralFilter(shifted, dstShifted, -1, 30, 8, BORDER_REFLECT_101, BILATERAL_GRID);
+    dstShifted.convertTo(dstShifted, HL_32F, 1, -1024);
+    EXPECT_LE(norm(dstShifted, dst, NORM_INF), 1e-2);
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
@@ -0,0 +1,112 @@
+#include "test_precomp.hxx"
+
+#include <cstring>
+#include <vector>
+#include "../filterengine.hxx"
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+//! the source index of the position p of a line of len elements, -1 for the constant border
+int borderIndex(int p, int len, int borderType)
+{
+    if (p >= 0 && p < len)
+        return p;
+
+    switch (borderType)
+    {
+        case BORDER_REPLICATE: return p < 0 ? 0 : len - 1;
+        case BORDER_WRAP: return ((p % len) + len) % len;
+        case BORDER_REFLECT:
+        {
+            int q = ((p % (2 * len)) + 2 * len) % (2 * len);
+            return q < len ? q : 2 * len - 1 - q;
+        }
+        case BORDER_REFLECT_101:
+        {
+            if (len == 1)
+                return 0;
+            int q = ((p % (2 * len - 2)) + 2 * len - 2) % (2 * len - 2);
+            return q < len ? q : 2 * len - 2 - q;
+        }
+        default: return -1;
+    }
+}
+
+//! the element (x, y) of roi extended by the border, read from its parent unless isolated
+const uchar* borderElem(const Mat& roi, int y, int x, int borderType, bool isolated, const uchar* constElem)
+{
+    Size  whole = roi.size();
+    Point ofs;
+    if (!isolated)
+        roi.locateROI(whole, ofs);
+
+    int sy = borderIndex(y + ofs.y, whole.height, borderType), sx = borderIndex(x + ofs.x, whole.width, borderType);
+    if (sy < 0 || sx < 0)
+        return constElem;
+    return roi.ptr() + (ptrdiff_t)(sy - ofs.y) * roi.step + (ptrdiff_t)(sx - ofs.x) * roi.elemSize();
+}
+
+TEST(Imgproc_BorderRowAccessor, matchesDirectBorder)
+{
+    const int    borders[] = {BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT, BORDER_WRAP, BORDER_REFLECT_101};
+    const Scalar value(7, -3, 100, 1);
+    const int    k = 5;
+
+    // images smaller than the border on every side, and ROIs at the corner and inside of their parent
+    const Rect rois[] = {Rect(0, 0, 1, 1), Rect(0, 0, 3, 2), Rect(0, 0, 1, 4), Rect(0, 0, 6, 1), Rect(0, 0, 13, 9),
+                         Rect(2, 3, 1, 1), Rect(4, 1, 3, 2), Rect(0, 5, 6, 4), Rect(3, 0, 9, 7), Rect(1, 2, 13, 9)};
+
+    for (int type : {HL_8UC1, HL_16SC3, HL_32FC4})
+        for (const Rect& r : rois)
+            for (int parentExtra : {0, 4})
+            {
+                Mat parent(r.y + r.height + parentExtra, r.x + r.width + parentExtra, type);
+                randomFill(parent, type * 31 + r.x * 7 + r.width);
+                Mat roi = parent(r);
+
+                Mat          constMat(1, 1, type, value);
+                const uchar* constElem = constMat.ptr();
+                size_t       esz       = roi.elemSize();
+
+                for (int border : borders)
+                    for (bool isolated : {false, true})
+                    {
+                        SCOPED_TRACE(testing::Message() << "type " << type << " roi " << r.x << "," << r.y << " " << r.width << "x" << r.height << " parent " << parent.cols << "x" << parent.rows << " border " << border << " isolated " << isolated);
+                        int               flags = border | (isolated ? BORDER_ISOLATED : 0);
+                        BorderRowAccessor acc(roi, flags, k, k, value);
+
+                        std::vector<uchar> ext((roi.cols + 2 * k) * esz);
+                        std::vector<int>   tab(roi.cols + 2 * k);
+                        if (border != BORDER_CONSTANT)
+                            acc.columnTab(&tab[0], -k, roi.cols + 2 * k);
+
+                        for (int y = -k; y < roi.rows + k; y++)
+                        {
+                            acc.extendRow(y, &ext[0]);
+                            for (int x = -k; x < roi.cols + k; x++)
+                            {
+                                const uchar* expected = borderElem(roi, y, x, border, isolated, constElem);
+                                ASSERT_EQ(0, memcmp(acc.ptr(y, x), expected, esz)) << "ptr " << x << ", " << y;
+                                ASSERT_EQ(0, memcmp(&ext[(x + k) * esz], expected, esz)) << "extendRow " << x << ", " << y;
+                                if (x >= 0 && x < roi.cols)
+                                {
+                                    ASSERT_EQ(0, memcmp(acc.row(y) + x * esz, expected, esz)) << "row " << x << ", " << y;
+                                }
+                                if (border != BORDER_CONSTANT)
+                                {
+                                    ASSERT_EQ(0, memcmp(acc.row(y) + tab[x + k] * (esz / roi.channels()), expected, esz)) << "columnTab " << x << ", " << y;
+                                }
+                            }
+                        }
+                    }
+            }
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
@@ -0,0 +1,138 @@
+#include "test_precomp.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "openHL/core/utility.hxx"
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+//! tile LUTs computed on a reflect-101 padded copy, then the bilinear blend of the 4 nearest LUTs per pixel.
+//! The tiles of the roi of parent that extend past it read the parent, which is reflected at its own edges.
+Mat claheReference(const Mat& parent, Rect roi, double clipLimit, Size grid)
+{
+    Mat src = parent(roi);
+    Size tile((src.cols + grid.width - 1) / grid.width, (src.rows + grid.height - 1) / grid.height);
+    int  area = tile.area();
+
+    std::vector<std::vector<uchar>> luts(grid.area(), std::vector<uchar>(256));
+    for (int ty = 0; ty < grid.height; ty++)
+        for (int tx = 0; tx < grid.width; tx++)
+        {
+            int hist[256] = {0};
+            for (int y = ty * tile.height; y < (ty + 1) * tile.height; y++)
+                for (int x = tx * tile.width; x < (tx + 1) * tile.width; x++)
+                    hist[parent.at<uchar>(borderInterpolate(roi.y + y, parent.rows, BORDER_REFLECT_101), borderInterpolate(roi.x + x, parent.cols, BORDER_REFLECT_101))]++;
+
+            if (clipLimit > 0)
+            {
+                int limit = std::max((int)(clipLimit * area / 256), 1), clipped = 0;
+                for (int i = 0; i < 256; i++)
+                    if (hist[i] > limit)
+                    {
+                        clipped += hist[i] - limit;
+                        hist[i]  = limit;
+                    }
+                for (int i = 0; i < 256; i++)
+                    hist[i] += clipped / 256;
+                int residual = clipped % 256;
+                if (residual)
+                    for (int i = 0, step = std::max(256 / residual, 1); i < 256 && residual > 0; i += step, residual--)
+                        hist[i]++;
+            }
+
+            float scale = 255.f / area;
+            for (int i = 0, sum = 0; i < 256; i++)
+            {
+                sum                          += hist[i];
+                luts[ty * grid.width + tx][i]  = saturate_cast<uchar>(sum * scale);
+            }
+        }
+
+    // the weights have 8 fractional bits, the product of two of them is rounded once
+    auto weight = [](int p, int tsize, int ntiles, int& t1, int& t2)
+    {
+        float f = p * (1.f / tsize) - 0.5f;
+        t1      = (int)std::floor(f);
+        int w   = (int)std::lrint((f - t1) * 256.f);
+        t2      = std::min(t1 + 1, ntiles - 1);
+        t1      = std::max(t1, 0);
+        return w;
+    };
+
+    Mat dst(src.size(), src.type());
+    for (int y = 0; y < src.rows; y++)
+    {
+        int ty1, ty2, ya = weight(y, tile.height, grid.height, ty1, ty2);
+        for (int x = 0; x < src.cols; x++)
+        {
+            int tx1, tx2, xa = weight(x, tile.width, grid.width, tx1, tx2), v = src.at<uchar>(y, x);
+            int top    = luts[ty1 * grid.width + tx1][v] * (256 - xa) + luts[ty1 * grid.width + tx2][v] * xa;
+            int bottom = luts[ty2 * grid.width + tx1][v] * (256 - xa) + luts[ty2 * grid.width + tx2][v] * xa;
+            dst.at<uchar>(y, x) = (uchar)((top * (256 - ya) + bottom * ya + (1 << 15)) >> 16);
+        }
+    }
+    return dst;
+}
+
+TEST(Imgproc_CLAHE, matchesReference)
+{
+    const Size sizes[] = {Size(64, 64), Size(97, 61), Size(13, 200), Size(300, 7)};
+    const Size grids[] = {Size(8, 8), Size(3, 5), Size(1, 1)};
+
+    for (Size size : sizes)
+    {
+        // a smooth ramp with noise, so that the clipping matters
+        Mat src(size, HL_8UC1), noise(size, HL_8UC1);
+        randomFill(noise, size.width);
+        for (int y = 0; y < size.height; y++)
+            for (int x = 0; x < size.width; x++)
+                src.at<uchar>(y, x) = (uchar)((x + y) * 96 / (size.width + size.height) + (noise.at<uchar>(y, x) & 31));
+
+        for (Size grid : grids)
+            for (double clipLimit : {0., 2., 40.})
+            {
+                if (grid.width > size.width || grid.height > size.height)
+                    continue;
+                Ptr<CLAHE> clahe = createCLAHE(clipLimit, grid);
+                Mat        dst;
+                clahe->apply(src, dst);
+                EXPECT_TRUE(equalMats(dst, claheReference(src, Rect(0, 0, size.width, size.height), clipLimit, grid))) << size.width << "x" << size.height << " grid " << grid.width << "x" << grid.height << " clip " << clipLimit;
+            }
+    }
+}
+
+TEST(Imgproc_CLAHE, roiInPlaceAndThreads)
+{
+    Mat  parent(420, 500, HL_8UC1);
+    randomFill(parent, 3);
+    Rect rect(17, 9, 431, 387);
+    Mat  roi = parent(rect), copy = roi.clone();
+
+    // the last tiles extend past the ROI and read the parent there, like a non-isolated border
+    Mat expected = claheReference(parent, rect, 3, Size(6, 7));
+
+    int        nthreads = getNumThreads();
+    Ptr<CLAHE> clahe    = createCLAHE(3, Size(6, 7));
+    for (int threads : {1, 4})
+    {
+        setNumThreads(threads);
+        Mat dst;
+        clahe->apply(roi, dst);
+        EXPECT_TRUE(equalMats(dst, expected)) << "threads " << threads;
+    }
+    setNumThreads(nthreads);
+
+    expected = claheReference(copy, Rect(0, 0, copy.cols, copy.rows), 3, Size(6, 7));
+    clahe->apply(copy, copy);
+    EXPECT_TRUE(equalMats(copy, expected));
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
@@ -0,0 +1,95 @@
+#include "test_precomp.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+enum
+{
+    EDGE_PREWITT,
+    EDGE_SOBEL,
+    EDGE_LOG
+};
+
+//! the operators evaluated pixel by pixel, with the coordinates clamped to the image
+Mat edgeReference(const Mat& src, int op)
+{
+    Mat  dst(src.size(), HL_8UC1);
+    auto p = [&](int y, int x) { return (int)src.at<uchar>(std::clamp(y, 0, src.rows - 1), std::clamp(x, 0, src.cols - 1)); };
+
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols; x++)
+        {
+            if (op == EDGE_LOG)
+            {
+                short v = (short)(16 * p(y, x) - p(y - 2, x) - p(y + 2, x) - p(y, x - 2) - p(y, x + 2) - p(y - 1, x - 1) - p(y - 1, x + 1) - p(y + 1, x - 1) - p(y + 1, x + 1)
+                                  - 2 * (p(y - 1, x) + p(y + 1, x) + p(y, x - 1) + p(y, x + 1)));
+                dst.at<uchar>(y, x) = (uchar)std::clamp((int)v, 0, 255);
+                continue;
+            }
+
+            int    w  = op == EDGE_SOBEL ? 2 : 1;
+            short  gx = (short)(p(y + 1, x - 1) + w * p(y + 1, x) + p(y + 1, x + 1) - p(y - 1, x - 1) - w * p(y - 1, x) - p(y - 1, x + 1));
+            short  gy = (short)(p(y - 1, x + 1) + w * p(y, x + 1) + p(y + 1, x + 1) - p(y - 1, x - 1) - w * p(y, x - 1) - p(y + 1, x - 1));
+            double g  = std::sqrt(gx * gx + gy * gy);
+            dst.at<uchar>(y, x) = (uchar)(g > 255 ? 255 : g);
+        }
+    return dst;
+}
+
+void applyEdge(const Mat& src, Mat& dst, int op)
+{
+    if (op == EDGE_PREWITT)
+        prewitt(src, dst);
+    else if (op == EDGE_SOBEL)
+        sobel(src, dst);
+    else
+        LOG(src, dst);
+}
+
+TEST(Imgproc_Edge, matchesReference)
+{
+    // the images narrower or shorter than the 3x3 and 5x5 kernels only take the border paths
+    const Size sizes[] = {Size(1, 1), Size(2, 1), Size(1, 3), Size(2, 2), Size(4, 3), Size(3, 5), Size(5, 5), Size(37, 23)};
+
+    for (Size size : sizes)
+        for (int op : {EDGE_PREWITT, EDGE_SOBEL, EDGE_LOG})
+        {
+            Mat src(size, HL_8UC1);
+            randomFill(src, size.width * 16 + size.height + op);
+
+            Mat dst;
+            applyEdge(src, dst, op);
+            EXPECT_TRUE(equalMats(dst, edgeReference(src, op))) << "op " << op << " size " << size.width << "x" << size.height;
+
+            Mat inplace = src.clone();
+            applyEdge(inplace, inplace, op);
+            EXPECT_TRUE(equalMats(inplace, dst)) << "in place op " << op << " size " << size.width << "x" << size.height;
+        }
+}
+
+TEST(Imgproc_Edge, roiIsIsolated)
+{
+    // the border of a ROI replicates its own edge pixels, never the parent around it
+    Mat parent(30, 40, HL_8UC1);
+    randomFill(parent, 9);
+
+    const Rect rois[] = {Rect(5, 4, 20, 17), Rect(0, 0, 3, 2), Rect(38, 10, 2, 1), Rect(11, 27, 1, 3)};
+    for (const Rect& r : rois)
+        for (int op : {EDGE_PREWITT, EDGE_SOBEL, EDGE_LOG})
+        {
+            Mat dst;
+            applyEdge(parent(r), dst, op);
+            EXPECT_TRUE(equalMats(dst, edgeReference(parent(r).clone(), op))) << "op " << op << " roi " << r.x << "," << r.y << " " << r.width << "x" << r.height;
+        }
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
@@ -0,0 +1,161 @@
+#include "test_precomp.hxx"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "openHL/core/utility.hxx"
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+//! uniform histogram of the given channels of src counted pixel by pixel, as a flat vector in row-major order
+template <typename T>
+std::vector<float> histReference(const Mat& src, const Mat& mask, const std::vector<int>& channels, const int* histSize, const float** ranges)
+{
+    int    dims  = (int)channels.size(), cn = src.channels();
+    size_t total = 1;
+    for (int i = 0; i < dims; i++)
+        total *= histSize[i];
+    std::vector<float> hist(total, 0.f);
+
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols; x++)
+        {
+            if (!mask.empty() && !mask.at<uchar>(y, x))
+                continue;
+            size_t ofs    = 0;
+            bool   inside = true;
+            for (int i = 0; i < dims && inside; i++)
+            {
+                double v = src.ptr<T>(y)[x * cn + channels[i]], lo = ranges[i][0], hi = ranges[i][1];
+                double a = histSize[i] / (hi - lo);
+                inside   = v >= lo && v < hi;
+                int idx  = std::min(std::max((int)std::floor(v * a - lo * a), 0), histSize[i] - 1);
+                ofs      = ofs * histSize[i] + idx;
+            }
+            if (inside)
+                hist[ofs]++;
+        }
+    return hist;
+}
+
+bool equalHist(const Mat& hist, const std::vector<float>& expected)
+{
+    if (hist.type() != HL_32FC1 || hist.total() != expected.size() || !hist.isContinuous())
+        return false;
+    return memcmp(hist.ptr<float>(), expected.data(), expected.size() * sizeof(float)) == 0;
+}
+
+TEST(Imgproc_CalcHist, oneDimension8u)
+{
+    Mat src(123, 97, HL_8UC3), mask(123, 97, HL_8UC1);
+    randomFill(src, 1);
+    randomFill(mask, 2);
+    Mat row = src.reshape(0, 1).clone();
+
+    const float range0[] = {0, 256}, range1[] = {10, 200};
+    for (const float* range : {range0, range1})
+        for (int histSize : {256, 32, 7})
+            for (int c = 0; c < 3; c++)
+            {
+                const float* ranges[] = {range};
+                Mat          hist;
+                calcHist(&src, 1, &c, Mat(), hist, 1, &histSize, ranges);
+                EXPECT_TRUE(equalHist(hist, histReference<uchar>(src, Mat(), {c}, &histSize, ranges))) << "size " << histSize << " channel " << c;
+
+                calcHist(&src, 1, &c, mask, hist, 1, &histSize, ranges);
+                EXPECT_TRUE(equalHist(hist, histReference<uchar>(src, mask, {c}, &histSize, ranges))) << "masked size " << histSize << " channel " << c;
+
+                // a single row is split by pixels instead of rows
+                calcHist(&row, 1, &c, Mat(), hist, 1, &histSize, ranges);
+                EXPECT_TRUE(equalHist(hist, histReference<uchar>(row, Mat(), {c}, &histSize, ranges))) << "row size " << histSize << " channel " << c;
+            }
+}
+
+TEST(Imgproc_CalcHist, accumulate)
+{
+    Mat a(40, 50, HL_8UC1), b(40, 50, HL_8UC1);
+    randomFill(a, 3);
+    randomFill(b, 4);
+
+    int          histSize = 64, channel = 0;
+    float        range[]  = {0, 256};
+    const float* ranges[] = {range};
+
+    Mat hist;
+    calcHist(&a, 1, &channel, Mat(), hist, 1, &histSize, ranges);
+    calcHist(&b, 1, &channel, Mat(), hist, 1, &histSize, ranges, true, true);
+
+    std::vector<float> expected = histReference<uchar>(a, Mat(), {0}, &histSize, ranges), hb = histReference<uchar>(b, Mat(), {0}, &histSize, ranges);
+    for (int i = 0; i < histSize; i++)
+        expected[i] += hb[i];
+    EXPECT_TRUE(equalHist(hist, expected));
+}
+
+TEST(Imgproc_CalcHist, multiDimensional)
+{
+    Mat src(90, 70, HL_8UC3), mask(90, 70, HL_8UC1);
+    randomFill(src, 5);
+    randomFill(mask, 6);
+
+    float        r0[] = {0, 256}, r1[] = {20, 240}, r2[] = {0, 128};
+    const float* ranges[] = {r0, r1, r2};
+
+    int channels2[] = {2, 0}, size2[] = {16, 9};
+    Mat hist;
+    calcHist(&src, 1, channels2, mask, hist, 2, size2, ranges);
+    EXPECT_TRUE(equalHist(hist, histReference<uchar>(src, mask, {2, 0}, size2, ranges)));
+
+    int channels3[] = {0, 1, 2}, size3[] = {8, 5, 6};
+    calcHist(&src, 1, channels3, Mat(), hist, 3, size3, ranges);
+    EXPECT_TRUE(equalHist(hist, histReference<uchar>(src, Mat(), {0, 1, 2}, size3, ranges)));
+}
+
+TEST(Imgproc_CalcHist, float32f)
+{
+    Mat bytes(64, 80, HL_8UC2), src;
+    randomFill(bytes, 7);
+    bytes.convertTo(src, HL_32FC2, 1. / 32, -2);
+
+    float        range[]  = {-1.5f, 5.25f};
+    const float* ranges[] = {range, range};
+    int          histSize[] = {27, 11}, channels[] = {1, 0};
+
+    Mat hist;
+    calcHist(&src, 1, channels, Mat(), hist, 1, histSize, ranges);
+    EXPECT_TRUE(equalHist(hist, histReference<float>(src, Mat(), {1}, histSize, ranges)));
+
+    calcHist(&src, 1, channels, Mat(), hist, 2, histSize, ranges);
+    EXPECT_TRUE(equalHist(hist, histReference<float>(src, Mat(), {1, 0}, histSize, ranges)));
+}
+
+TEST(Imgproc_CalcHist, independentOfThreads)
+{
+    // a large, smooth image, the case of the interleaved tables
+    Mat src(600, 800, HL_8UC1);
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols; x++)
+            src.at<uchar>(y, x) = (uchar)((x / 37 + y / 23) & 255);
+
+    int          histSize = 256, channel = 0;
+    float        range[]  = {0, 256};
+    const float* ranges[] = {range};
+    int          nthreads = getNumThreads();
+
+    for (int threads : {1, 4})
+    {
+        setNumThreads(threads);
+        Mat hist;
+        calcHist(&src, 1, &channel, Mat(), hist, 1, &histSize, ranges);
+        EXPECT_TRUE(equalHist(hist, histReference<uchar>(src, Mat(), {0}, &histSize, ranges))) << "threads " << threads;
+    }
+    setNumThreads(nthreads);
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
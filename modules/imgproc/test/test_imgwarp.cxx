@@ -0,0 +1,380 @@
+#include "test_precomp.hxx"
+
+#include <climits>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include "openHL/core/utility.hxx"
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+Mat rotationMatrix(double angle, double scale, Point2d center)
+{
+    double a = std::cos(angle) * scale, b = std::sin(angle) * scale;
+    Mat    M(2, 3, HL_64FC1);
+    double m[] = {a, b, (1 - a) * center.x - b * center.y, -b, a, b * center.x + (1 - a) * center.y};
+    memcpy(M.ptr(), m, sizeof(m));
+    return M;
+}
+
+TEST(Imgproc_Warp, concurrentFirstCalls)
+{
+    // the first calls of the process build the interpolation tables while the others read them
+    Mat src(64, 80, HL_8UC3);
+    randomFill(src, 1);
+    Mat M = rotationMatrix(0.3, 0.9, Point2d(40, 32));
+
+    const int        methods[] = {INTER_LINEAR, INTER_CUBIC, INTER_LANCZOS4};
+    std::vector<Mat> results(12);
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < (int)results.size(); t++)
+            threads.emplace_back([&, t] { warpAffine(src, results[t], M, src.size(), methods[t % 3]); });
+        for (std::thread& t : threads)
+            t.join();
+    }
+
+    for (int t = 0; t < (int)results.size(); t++)
+    {
+        Mat ref;
+        warpAffine(src, ref, M, src.size(), methods[t % 3]);
+        EXPECT_TRUE(equalMats(ref, results[t])) << "thread " << t;
+    }
+}
+
+//! the fixed-point maps of warpAffine with WARP_INVERSE_MAP: the rows start from the rounded offset, the columns
+//! add their own rounded step, both with 10 fractional bits
+void warpAffineMaps(const Mat& M, Size dsize, int interpolation, Mat& xy, Mat& fxy)
+{
+    const double* m          = M.ptr<double>();
+    const bool    nn         = interpolation == INTER_NEAREST;
+    const int     roundDelta = nn ? 512 : 1024 / (int)INTER_TAB_SIZE / 2, shift = nn ? 10 : 10 - INTER_BITS;
+    xy.create(dsize, HL_16SC2);
+    if (nn)
+        fxy.release();
+    else
+        fxy.create(dsize, HL_16UC1);
+
+    for (int y = 0; y < dsize.height; y++)
+    {
+        int X0 = saturate_cast<int>((m[1] * y + m[2]) * 1024) + roundDelta;
+        int Y0 = saturate_cast<int>((m[4] * y + m[5]) * 1024) + roundDelta;
+        for (int x = 0; x < dsize.width; x++)
+        {
+            int X = (X0 + saturate_cast<int>(m[0] * x * 1024)) >> shift;
+            int Y = (Y0 + saturate_cast<int>(m[3] * x * 1024)) >> shift;
+            if (nn)
+            {
+                xy.ptr<short>(y)[x * 2]     = saturate_cast<short>(X);
+                xy.ptr<short>(y)[x * 2 + 1] = saturate_cast<short>(Y);
+            }
+            else
+            {
+                xy.ptr<short>(y)[x * 2]     = saturate_cast<short>(X >> INTER_BITS);
+                xy.ptr<short>(y)[x * 2 + 1] = saturate_cast<short>(Y >> INTER_BITS);
+                fxy.ptr<ushort>(y)[x]       = (ushort)((Y & (INTER_TAB_SIZE - 1)) * INTER_TAB_SIZE + (X & (INTER_TAB_SIZE - 1)));
+            }
+        }
+    }
+}
+
+TEST(Imgproc_Warp, affineMatchesRemapOfFixedPointMaps)
+{
+    // a rotation reaching past the borders, and a zoom whose coordinates overflow 16 bits
+    Mat zoom(2, 3, HL_64FC1);
+    double z[] = {300, 0.5, -100, 0.25, 250, -50};
+    memcpy(zoom.ptr(), z, sizeof(z));
+    const Mat    matrices[] = {rotationMatrix(0.3, 0.9, Point2d(40, 32)), zoom};
+    const int    borders[]  = {BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101, BORDER_WRAP};
+    const Scalar border(17, 200, 90, 255);
+    int          nthreads = getNumThreads();
+
+    for (int depth : {HL_8U, HL_16U, HL_32F})
+        for (int cn : {1, 3, 4})
+        {
+            Mat src(83, 97, HL_MAKETYPE(depth, cn));
+            randomFill(src, depth * 8 + cn);
+
+            // dst spans two tile columns and ends with a partial vector
+            for (const Mat& M : matrices)
+                for (int interpolation : {INTER_NEAREST, INTER_LINEAR, INTER_CUBIC, INTER_LANCZOS4})
+                {
+                    Mat xy, fxy;
+                    warpAffineMaps(M, Size(150, 70), interpolation, xy, fxy);
+                    for (int borderType : borders)
+                    {
+                        Mat expected;
+                        remap(src, expected, xy, fxy, interpolation, borderType, border);
+                        for (int threads : {1, 4})
+                        {
+                            setNumThreads(threads);
+                            Mat dst;
+                            warpAffine(src, dst, M, Size(150, 70), interpolation | WARP_INVERSE_MAP, borderType, border);
+                            EXPECT_TRUE(equalMats(dst, expected)) << "depth " << depth << " cn " << cn << " interpolation " << interpolation << " border " << borderType << " threads " << threads;
+                        }
+                    }
+                }
+        }
+    setNumThreads(nthreads);
+}
+
+//! the fixed-point maps of warpPerspective with WARP_INVERSE_MAP, every point divided by its W, W = 0 mapping to 0
+void warpPerspectiveMaps(const Mat& M, Size dsize, int interpolation, Mat& xy, Mat& fxy)
+{
+    const double* m     = M.ptr<double>();
+    const bool    nn    = interpolation == INTER_NEAREST;
+    const double  scale = nn ? 1. : (double)INTER_TAB_SIZE;
+    xy.create(dsize, HL_16SC2);
+    if (nn)
+        fxy.release();
+    else
+        fxy.create(dsize, HL_16UC1);
+
+    for (int y = 0; y < dsize.height; y++)
+        for (int x = 0; x < dsize.width; x++)
+        {
+            double W = m[6] * x + m[7] * y + m[8];
+            W        = W ? scale / W : 0;
+            int X    = saturate_cast<int>(std::max((double)INT_MIN, std::min((double)INT_MAX, (m[0] * x + m[1] * y + m[2]) * W)));
+            int Y    = saturate_cast<int>(std::max((double)INT_MIN, std::min((double)INT_MAX, (m[3] * x + m[4] * y + m[5]) * W)));
+            if (nn)
+            {
+                xy.ptr<short>(y)[x * 2]     = saturate_cast<short>(X);
+                xy.ptr<short>(y)[x * 2 + 1] = saturate_cast<short>(Y);
+            }
+            else
+            {
+                xy.ptr<short>(y)[x * 2]     = saturate_cast<short>(X >> INTER_BITS);
+                xy.ptr<short>(y)[x * 2 + 1] = saturate_cast<short>(Y >> INTER_BITS);
+                fxy.ptr<ushort>(y)[x]       = (ushort)((Y & (INTER_TAB_SIZE - 1)) * INTER_TAB_SIZE + (X & (INTER_TAB_SIZE - 1)));
+            }
+        }
+}
+
+TEST(Imgproc_Warp, perspectiveMatchesRemapOfFixedPointMaps)
+{
+    // the coefficients are dyadic, so the numerators and W are exact whatever the tile origin they are summed from;
+    // the second matrix has W = 0 at x = 64, the third one coordinates past the int range
+    const double m[][9] = {
+        {0.875,  0.125, 3.5,           -0.0625, 1.0625, -2.25, 0.0009765625, -0.00048828125, 1 },
+        {1,      0.25,  -8,            0.125,   1,      -4,    0.015625,     0,              -1},
+        {0.5,    0,     1073741824.,   0,       0.5,    1,     0.0078125,    0,              1 },
+    };
+    const int    borders[] = {BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101, BORDER_WRAP};
+    const Scalar border(17, 200, 90, 255);
+    int          nthreads = getNumThreads();
+
+    for (int depth : {HL_8U, HL_16U, HL_32F})
+        for (int cn : {1, 3, 4})
+        {
+            Mat src(83, 97, HL_MAKETYPE(depth, cn));
+            randomFill(src, depth * 8 + cn);
+
+            for (const auto& coeffs : m)
+            {
+                Mat M(3, 3, HL_64FC1);
+                memcpy(M.ptr(), coeffs, sizeof(coeffs));
+                for (int interpolation : {INTER_NEAREST, INTER_LINEAR, INTER_CUBIC, INTER_LANCZOS4})
+                {
+                    Mat xy, fxy;
+                    warpPerspectiveMaps(M, Size(150, 70), interpolation, xy, fxy);
+                    for (int borderType : borders)
+                    {
+                        Mat expected;
+                        remap(src, expected, xy, fxy, interpolation, borderType, border);
+                        for (int threads : {1, 4})
+                        {
+                            setNumThreads(threads);
+                            Mat dst;
+                            warpPerspective(src, dst, M, Size(150, 70), interpolation | WARP_INVERSE_MAP, borderType, border);
+                            EXPECT_TRUE(equalMats(dst, expected)) << "depth " << depth << " cn " << cn << " interpolation " << interpolation << " border " << borderType << " threads " << threads;
+                        }
+                    }
+                }
+            }
+        }
+    setNumThreads(nthreads);
+}
+
+//! fixed-point maps of a slight rotation and zoom, with 5 fractional bits, reaching a few pixels out of src
+void fixedPointMaps(Size ssize, Size dsize, Mat& xy, Mat& fxy)
+{
+    xy.create(dsize, HL_16SC2);
+    fxy.create(dsize, HL_16UC1);
+    double a = std::cos(0.1) * 1.07, b = std::sin(0.1) * 1.07;
+    for (int y = 0; y < dsize.height; y++)
+        for (int x = 0; x < dsize.width; x++)
+        {
+            double sx = a * x - b * y + ssize.width * 0.08 - 4, sy = b * x + a * y - ssize.height * 0.05 - 3;
+            int    ix = (int)std::lrint(sx * (int)INTER_TAB_SIZE), iy = (int)std::lrint(sy * (int)INTER_TAB_SIZE);
+
+            xy.ptr<short>(y)[x * 2]     = (short)(ix >> INTER_BITS);
+            xy.ptr<short>(y)[x * 2 + 1] = (short)(iy >> INTER_BITS);
+            fxy.ptr<ushort>(y)[x]       = (ushort)((iy & (INTER_TAB_SIZE - 1)) * INTER_TAB_SIZE + (ix & (INTER_TAB_SIZE - 1)));
+        }
+}
+
+//! 8-bit bilinear remap with the 15-bit fixed-point weights of the integer tables
+Mat remapBilinearReference(const Mat& src, const Mat& xy, const Mat& fxy, int borderType, const Scalar& borderValue)
+{
+    int cn = src.channels();
+    Mat dst(xy.size(), src.type());
+    for (int y = 0; y < xy.rows; y++)
+        for (int x = 0; x < xy.cols; x++)
+        {
+            int sx = xy.ptr<short>(y)[x * 2], sy = xy.ptr<short>(y)[x * 2 + 1];
+            int fx = fxy.ptr<ushort>(y)[x] % INTER_TAB_SIZE, fy = fxy.ptr<ushort>(y)[x] / INTER_TAB_SIZE;
+
+            // the weights of a cell sum to 1 << 15; the one of the top left tap is saturated to
+            // 32767 when it is the only one, and the missing unit goes to the bottom right one
+            int w[4] = {(INTER_TAB_SIZE - fy) * (INTER_TAB_SIZE - fx) * 32, (INTER_TAB_SIZE - fy) * fx * 32, fy * (INTER_TAB_SIZE - fx) * 32, fy * fx * 32};
+            if (w[0] == 1 << 15)
+                w[0] = (1 << 15) - 1, w[3] = 1;
+
+            uchar* D = dst.ptr<uchar>(y) + x * cn;
+            if (borderType == BORDER_CONSTANT && (sx >= src.cols || sx + 1 < 0 || sy >= src.rows || sy + 1 < 0))
+            {
+                for (int c = 0; c < cn; c++)
+                    D[c] = saturate_cast<uchar>(borderValue[c & 3]);
+                continue;
+            }
+
+            int xs[2] = {borderInterpolate(sx, src.cols, borderType), borderInterpolate(sx + 1, src.cols, borderType)};
+            int ys[2] = {borderInterpolate(sy, src.rows, borderType), borderInterpolate(sy + 1, src.rows, borderType)};
+            for (int c = 0; c < cn; c++)
+            {
+                int sum = 0;
+                for (int k = 0; k < 4; k++)
+                {
+                    int px  = xs[k & 1], py = ys[k >> 1];
+                    int v   = px >= 0 && py >= 0 ? src.ptr<uchar>(py)[px * cn + c] : saturate_cast<uchar>(borderValue[c & 3]);
+                    sum    += v * w[k];
+                }
+                D[c] = saturate_cast<uchar>((sum + (1 << 14)) >> 15);
+            }
+        }
+    return dst;
+}
+
+TEST(Imgproc_Remap, bilinear8uMatchesFixedPointReference)
+{
+    const int    borders[] = {BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101, BORDER_WRAP};
+    const Scalar border(17, 200, 90, 255);
+
+    for (int cn = 1; cn <= 4; cn++)
+    {
+        Mat src(97, 131, HL_MAKETYPE(HL_8U, cn));
+        randomFill(src, cn);
+        Mat xy, fxy;
+        fixedPointMaps(src.size(), Size(123, 89), xy, fxy);
+
+        // the same sampling through relative maps
+        Mat rxy = xy.clone();
+        for (int y = 0; y < rxy.rows; y++)
+            for (int x = 0; x < rxy.cols; x++)
+            {
+                rxy.ptr<short>(y)[x * 2]     -= (short)x;
+                rxy.ptr<short>(y)[x * 2 + 1] -= (short)y;
+            }
+
+        for (int borderType : borders)
+        {
+            Mat expected = remapBilinearReference(src, xy, fxy, borderType, border), dst;
+            remap(src, dst, xy, fxy, INTER_LINEAR, borderType, border);
+            EXPECT_TRUE(equalMats(dst, expected)) << "cn " << cn << " border " << borderType;
+
+            remap(src, dst, rxy, fxy, INTER_LINEAR | WARP_RELATIVE_MAP, borderType, border);
+            EXPECT_TRUE(equalMats(dst, expected)) << "relative cn " << cn << " border " << borderType;
+        }
+    }
+}
+
+//! planar float maps of the same rotation and zoom as the fixed-point ones
+void floatMaps(Size ssize, Size dsize, Mat& mapx, Mat& mapy)
+{
+    mapx.create(dsize, HL_32FC1);
+    mapy.create(dsize, HL_32FC1);
+    double a = std::cos(0.1) * 1.07, b = std::sin(0.1) * 1.07;
+    for (int y = 0; y < dsize.height; y++)
+        for (int x = 0; x < dsize.width; x++)
+        {
+            mapx.ptr<float>(y)[x] = (float)(a * x - b * y + ssize.width * 0.08 - 4);
+            mapy.ptr<float>(y)[x] = (float)(b * x + a * y - ssize.height * 0.05 - 3);
+        }
+}
+
+TEST(Imgproc_ConvertMaps, remapMatchesFloatMaps)
+{
+    Mat src(97, 131, HL_8UC3);
+    randomFill(src, 4);
+    Mat mapx, mapy;
+    floatMaps(src.size(), Size(123, 89), mapx, mapy);
+
+    // interleaved copy of the planar maps
+    Mat mapxy(mapx.size(), HL_32FC2);
+    for (int y = 0; y < mapx.rows; y++)
+        for (int x = 0; x < mapx.cols; x++)
+        {
+            mapxy.ptr<float>(y)[x * 2]     = mapx.ptr<float>(y)[x];
+            mapxy.ptr<float>(y)[x * 2 + 1] = mapy.ptr<float>(y)[x];
+        }
+
+    for (int interpolation : {INTER_NEAREST, INTER_LINEAR, INTER_CUBIC, INTER_LANCZOS4})
+    {
+        bool nn = interpolation == INTER_NEAREST;
+        Mat  expected, dst, xy, fxy;
+        remap(src, expected, mapx, mapy, interpolation, BORDER_REFLECT_101);
+
+        convertMaps(mapx, mapy, xy, fxy, HL_16SC2, nn);
+        remap(src, dst, xy, fxy, interpolation, BORDER_REFLECT_101);
+        EXPECT_TRUE(equalMats(dst, expected)) << "planar interpolation " << interpolation;
+
+        convertMaps(mapxy, Mat(), xy, fxy, HL_16SC2, nn);
+        remap(src, dst, xy, fxy, interpolation, BORDER_REFLECT_101);
+        EXPECT_TRUE(equalMats(dst, expected)) << "interleaved interpolation " << interpolation;
+
+        remap(src, dst, mapxy, Mat(), interpolation, BORDER_REFLECT_101);
+        EXPECT_TRUE(equalMats(dst, expected)) << "32FC2 interpolation " << interpolation;
+    }
+}
+
+TEST(Imgproc_ConvertMaps, roundTrips)
+{
+    Mat xy, fxy;
+    fixedPointMaps(Size(131, 97), Size(123, 89), xy, fxy);
+
+    // the fixed-point coordinates are exact in float, so every path back gives the same maps
+    Mat mapx, mapy, mapxy, xy2, fxy2;
+    convertMaps(xy, fxy, mapx, mapy, HL_32FC1);
+    convertMaps(mapx, mapy, xy2, fxy2, HL_16SC2);
+    EXPECT_TRUE(equalMats(xy2, xy));
+    EXPECT_TRUE(equalMats(fxy2, fxy));
+
+    Mat none;
+    convertMaps(xy, fxy, mapxy, none, HL_32FC2);
+    EXPECT_TRUE(none.empty());
+    for (int y = 0; y < mapxy.rows; y++)
+        for (int x = 0; x < mapxy.cols; x++)
+        {
+            ASSERT_EQ(mapxy.ptr<float>(y)[x * 2], mapx.ptr<float>(y)[x]);
+            ASSERT_EQ(mapxy.ptr<float>(y)[x * 2 + 1], mapy.ptr<float>(y)[x]);
+        }
+    convertMaps(mapxy, Mat(), xy2, fxy2, HL_16SC2);
+    EXPECT_TRUE(equalMats(xy2, xy));
+    EXPECT_TRUE(equalMats(fxy2, fxy));
+
+    // the fraction table may come first
+    convertMaps(fxy, xy, mapx, mapy, HL_32FC1);
+    convertMaps(mapx, mapy, xy2, fxy2, HL_16SC2);
+    EXPECT_TRUE(equalMats(xy2, xy));
+    EXPECT_TRUE(equalMats(fxy2, fxy));
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
@@ -0,0 +1,115 @@
+#include "test_precomp.hxx"
+
+#include <cmath>
+#include <vector>
+#include "openHL/core/utility.hxx"
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+//! the sums, squared sums and tilted sums of the pixels above and left of each point, in double
+template <typename T>
+void integralReference(const Mat& src, Mat& sum, Mat& sqsum, Mat& tilted)
+{
+    int cn = src.channels(), rows = src.rows + 1, cols = (src.cols + 1) * cn;
+    sum    = Mat(rows, src.cols + 1, HL_MAKETYPE(HL_64F, cn), Scalar::all(0));
+    sqsum  = Mat(rows, src.cols + 1, HL_MAKETYPE(HL_64F, cn), Scalar::all(0));
+    tilted = Mat(rows, src.cols + 1, HL_MAKETYPE(HL_64F, cn), Scalar::all(0));
+
+    for (int y = 1; y < rows; y++)
+        for (int x = cn; x < cols; x++)
+        {
+            double v                = src.ptr<T>(y - 1)[x - cn];
+            sum.ptr<double>(y)[x]   = v + sum.ptr<double>(y - 1)[x] + sum.ptr<double>(y)[x - cn] - sum.ptr<double>(y - 1)[x - cn];
+            sqsum.ptr<double>(y)[x] = v * v + sqsum.ptr<double>(y - 1)[x] + sqsum.ptr<double>(y)[x - cn] - sqsum.ptr<double>(y - 1)[x - cn];
+        }
+
+    // tilted(Y, X) sums the pixels (x, y) with y < Y and |x - X + 1| <= Y - y - 1; it is computed
+    // directly, which is slow, so only for the small images
+    if (src.total() > 10000)
+        return;
+    for (int Y = 1; Y < rows; Y++)
+        for (int X = 0; X <= src.cols; X++)
+            for (int c = 0; c < cn; c++)
+            {
+                double s = 0;
+                for (int y = 0; y < Y; y++)
+                    for (int x = std::max(X - 1 - (Y - y - 1), 0); x <= std::min(X - 1 + (Y - y - 1), src.cols - 1); x++)
+                        s += src.ptr<T>(y)[x * cn + c];
+                tilted.ptr<double>(Y)[X * cn + c] = s;
+            }
+}
+
+template <typename T>
+void checkIntegral(int depth, int sdepth, int sqdepth, double tol)
+{
+    // enough rows for several bands, which are shifted by the sums above them afterwards
+    const Size sizes[] = {Size(1, 1), Size(13, 1), Size(1, 9), Size(37, 29), Size(90, 70), Size(61, 700)};
+    int        nthreads = getNumThreads();
+    setNumThreads(4);
+
+    for (int cn = 1; cn <= 4; cn++)
+        for (Size size : sizes)
+        {
+            Mat src = randomMat(size, HL_MAKETYPE(depth, cn), cn + size.height, 1. / 16, -8);
+
+            Mat sumRef, sqsumRef, tiltedRef;
+            integralReference<T>(src, sumRef, sqsumRef, tiltedRef);
+
+            Mat sum, sqsum, tilted;
+            integral(src, sum, sqsum, tilted, sdepth, sqdepth);
+            EXPECT_EQ(sum.depth(), sdepth);
+            EXPECT_EQ(sqsum.depth(), sqdepth);
+            EXPECT_TRUE(nearMats(sum, sumRef, tol)) << "sum depth " << depth << " cn " << cn << " " << size.width << "x" << size.height;
+            EXPECT_TRUE(nearMats(sqsum, sqsumRef, tol)) << "sqsum depth " << depth << " cn " << cn << " " << size.width << "x" << size.height;
+            if (size.area() <= 10000)
+            {
+                EXPECT_TRUE(nearMats(tilted, tiltedRef, tol)) << "tilted depth " << depth << " cn " << cn << " " << size.width << "x" << size.height;
+            }
+
+            // the sum alone is the same as the one computed with the squares
+            Mat sumOnly;
+            integral(src, sumOnly, sdepth);
+            EXPECT_TRUE(equalMats(sumOnly, sum));
+        }
+    setNumThreads(nthreads);
+}
+
+TEST(Imgproc_Integral, exact8u)
+{
+    checkIntegral<uchar>(HL_8U, HL_32S, HL_64F, 0);
+}
+
+TEST(Imgproc_Integral, exact16u)
+{
+    checkIntegral<ushort>(HL_16U, HL_64F, HL_64F, 0);
+}
+
+TEST(Imgproc_Integral, float32f)
+{
+    checkIntegral<float>(HL_32F, HL_64F, HL_64F, 1e-12);
+    checkIntegral<float>(HL_32F, HL_32F, HL_32F, 1e-5);
+}
+
+TEST(Imgproc_Integral, defaultDepths)
+{
+    Mat src(5, 6, HL_8UC2), sum, sqsum;
+    randomFill(src, 2);
+    integral(src, sum, sqsum);
+    EXPECT_EQ(sum.type(), HL_32SC2);
+    EXPECT_EQ(sqsum.type(), HL_64FC2);
+    EXPECT_EQ(sum.size(), Size(7, 6));
+
+    Mat src16(5, 6, HL_16UC1);
+    randomFill(src16, 3);
+    integral(src16, sum);
+    EXPECT_EQ(sum.type(), HL_64FC1);
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
@@ -0,0 +1,146 @@
+#include "test_precomp.hxx"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <vector>
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+//! total order of the elements, NaNs included, the same as the order of the IEEE bit patterns
+template <typename T>
+int orderKey(T v)
+{
+    return v;
+}
+
+template <>
+int orderKey(float v)
+{
+    int i = std::bit_cast<int>(v);
+    return i ^ ((i >> 31) & 0x7fffffff);
+}
+
+//! naive median with the replicated border of medianBlur
+template <typename T>
+Mat medianReference(const Mat& src, int ksize)
+{
+    int            cn = src.channels(), r = ksize / 2;
+    Mat            dst(src.size(), src.type());
+    std::vector<T> vals(ksize * ksize);
+
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols; x++)
+            for (int c = 0; c < cn; c++)
+            {
+                int n = 0;
+                for (int dy = -r; dy <= r; dy++)
+                    for (int dx = -r; dx <= r; dx++)
+                    {
+                        int yy    = std::clamp(y + dy, 0, src.rows - 1);
+                        int xx    = std::clamp(x + dx, 0, src.cols - 1);
+                        vals[n++] = src.ptr<T>(yy)[xx * cn + c];
+                    }
+                std::nth_element(vals.begin(), vals.begin() + n / 2, vals.end(), [](T a, T b) { return orderKey(a) < orderKey(b); });
+                dst.ptr<T>(y)[x * cn + c] = vals[n / 2];
+            }
+    return dst;
+}
+
+Mat medianReference(const Mat& src, int ksize)
+{
+    switch (src.depth())
+    {
+        case HL_8U: return medianReference<uchar>(src, ksize);
+        case HL_16U: return medianReference<ushort>(src, ksize);
+        case HL_16S: return medianReference<short>(src, ksize);
+        default: return medianReference<float>(src, ksize);
+    }
+}
+
+TEST(Imgproc_MedianBlur, matchesReference)
+{
+    for (int type : {HL_8UC1, HL_8UC3, HL_8UC4, HL_16UC1, HL_16SC3, HL_32FC1})
+        for (int ksize : {3, 5, 7, 9})
+        {
+            Mat src = randomMat(Size(41, 23), type, type * 16 + ksize);
+            Mat dst;
+            medianBlur(src, dst, ksize);
+            EXPECT_TRUE(equalMats(medianReference(src, ksize), dst)) << "type " << type << " ksize " << ksize;
+        }
+}
+
+TEST(Imgproc_MedianBlur, inplaceMatchesOutOfPlace)
+{
+    for (int type : {HL_8UC1, HL_8UC3, HL_16UC4, HL_32FC1})
+        for (int ksize : {3, 5, 7})
+        {
+            Mat src = randomMat(Size(33, 19), type, type + ksize);
+            Mat dst;
+            medianBlur(src, dst, ksize);
+
+            Mat inplace = src.clone();
+            medianBlur(inplace, inplace, ksize);
+            EXPECT_TRUE(equalMats(dst, inplace)) << "type " << type << " ksize " << ksize;
+        }
+}
+
+TEST(Imgproc_MedianBlur, floatNaN)
+{
+    Mat src = randomMat(Size(29, 17), HL_32FC1, 7);
+    for (int i = 0; i < 40; i++)
+        src.ptr<float>((i * 7) % src.rows)[(i * 13) % src.cols] = i % 2 ? std::numeric_limits<float>::quiet_NaN() : -std::numeric_limits<float>::quiet_NaN();
+
+    // the 3x3 and 5x5 min/max networks do not order the NaNs, only the histogram kernels do
+    for (int ksize : {7, 11})
+    {
+        Mat dst;
+        medianBlur(src, dst, ksize);
+        EXPECT_TRUE(equalMats(medianReference(src, ksize), dst)) << "ksize " << ksize;
+    }
+}
+
+TEST(Imgproc_MedianBlur, floatNetworksIndependentOfColumn)
+{
+    const float values[] = {std::numeric_limits<float>::quiet_NaN(), 0.f, -0.f, 1.f, -1.f};
+
+    // shifting the image by a column moves pixels between the vector loops and the scalar tails,
+    // which must order NaN, 0 and -0 the same way
+    for (int width : {29, 36, 43})
+        for (int ksize : {3, 5})
+        {
+            Mat src(17, width, HL_32FC1);
+            for (int y = 0; y < src.rows; y++)
+                for (int x = 0; x < src.cols; x++)
+                    src.ptr<float>(y)[x] = values[(y * 7 + x * 3 + x * x) % 5];
+
+            int r = ksize / 2;
+            Mat dst, shifted;
+            medianBlur(src, dst, ksize);
+            medianBlur(src(Rect(1, 0, width - 1, src.rows)), shifted, ksize);
+            EXPECT_TRUE(equalMats(dst(Rect(r + 1, 0, width - 2 * r - 1, src.rows)), shifted(Rect(r, 0, width - 2 * r - 1, src.rows))))
+                << "width " << width << " ksize " << ksize;
+        }
+}
+
+TEST(Imgproc_MedianBlur, kernelLargerThanTile)
+{
+    for (int type : {HL_16UC1, HL_16SC2, HL_32FC1})
+        for (int ksize : {241, 243, 301})
+        {
+            // past 241 the 16-bit images keep the histogram with 64 pixel tiles, the 67 columns take two of them
+            Mat src = randomMat(ksize > 243 ? Size(67, 5) : Size(9, 6), type, type + ksize);
+            Mat dst;
+            medianBlur(src, dst, ksize);
+            EXPECT_TRUE(equalMats(medianReference(src, ksize), dst)) << "type " << type << " ksize " << ksize;
+        }
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
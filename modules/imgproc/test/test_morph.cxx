@@ -0,0 +1,236 @@
+#include "test_precomp.hxx"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+//! the minimum or maximum over the nonzero kernel taps, the taps outside src read the border
+template <typename T>
+Mat morphReference(const Mat& src, int op, const Mat& kernel, Point anchor, int borderType, const Scalar& borderValue)
+{
+    // the default border value is neutral, the largest value for erode and the smallest for dilate
+    bool neutral = borderValue == morphologyDefaultBorderValue();
+    T    extreme = op == MORPH_ERODE ? (std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max())
+                                     : (std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest());
+
+    int cn = src.channels();
+    Mat dst(src.size(), src.type());
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols; x++)
+            for (int c = 0; c < cn; c++)
+            {
+                T    v     = extreme;
+                bool first = true;
+                for (int i = 0; i < kernel.rows; i++)
+                    for (int j = 0; j < kernel.cols; j++)
+                    {
+                        if (!kernel.at<uchar>(i, j))
+                            continue;
+                        int sy = borderInterpolate(y + i - anchor.y, src.rows, borderType);
+                        int sx = borderInterpolate(x + j - anchor.x, src.cols, borderType);
+                        T   s  = sy >= 0 && sx >= 0 ? src.ptr<T>(sy)[sx * cn + c] : neutral ? extreme : saturate_cast<T>(borderValue[c & 3]);
+                        v      = first ? s : op == MORPH_ERODE ? std::min(v, s) : std::max(v, s);
+                        first  = false;
+                    }
+                dst.ptr<T>(y)[x * cn + c] = v;
+            }
+    return dst;
+}
+
+template <typename T>
+Mat morphReference(const Mat& src, int op, const Mat& kernel, int iterations)
+{
+    Point anchor(kernel.cols / 2, kernel.rows / 2);
+    Mat   dst = src;
+    for (int i = 0; i < iterations; i++)
+        dst = morphReference<T>(dst, op, kernel, anchor, BORDER_CONSTANT, morphologyDefaultBorderValue());
+    return dst;
+}
+
+//! saturating a - b
+template <typename T>
+Mat subtractReference(const Mat& a, const Mat& b)
+{
+    Mat dst(a.size(), a.type());
+    for (int y = 0; y < a.rows; y++)
+        for (int x = 0; x < a.cols * a.channels(); x++)
+            dst.ptr<T>(y)[x] = saturate_cast<T>((double)a.ptr<T>(y)[x] - b.ptr<T>(y)[x]);
+    return dst;
+}
+
+std::vector<Mat> testKernels()
+{
+    Mat random(4, 6, HL_8U);
+    randomFill(random, 3);
+    for (int i = 0; i < (int)random.total(); i++)
+        random.ptr<uchar>()[i] = random.ptr<uchar>()[i] > 100;
+
+    return {getStructuringElement(MORPH_RECT, Size(3, 3)), getStructuringElement(MORPH_RECT, Size(7, 2)), getStructuringElement(MORPH_CROSS, Size(5, 5)),
+            getStructuringElement(MORPH_ELLIPSE, Size(9, 7)), random};
+}
+
+template <typename T>
+void checkErodeDilate(int depth)
+{
+    const int borders[] = {BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT, BORDER_REFLECT_101};
+
+    for (int cn : {1, 3, 4})
+    {
+        Mat src = randomMat(Size(67, 45), HL_MAKETYPE(depth, cn), depth * 4 + cn, 1. / 8, -10);
+        for (const Mat& kernel : testKernels())
+        {
+            Point anchors[] = {Point(-1, -1), Point(0, kernel.rows - 1)};
+            for (Point anchor : anchors)
+                for (int border : borders)
+                    for (int op : {MORPH_ERODE, MORPH_DILATE})
+                    {
+                        Scalar bv  = border == BORDER_CONSTANT && anchor.x == 0 ? Scalar(100, 30, 7, 1) : morphologyDefaultBorderValue();
+                        Point  a   = anchor.x < 0 ? Point(kernel.cols / 2, kernel.rows / 2) : anchor;
+                        Mat    ref = morphReference<T>(src, op, kernel, a, border, bv), dst;
+                        if (op == MORPH_ERODE)
+                            erode(src, dst, kernel, anchor, 1, border, bv);
+                        else
+                            dilate(src, dst, kernel, anchor, 1, border, bv);
+                        EXPECT_TRUE(equalMats(dst, ref)) << "depth " << depth << " cn " << cn << " kernel " << kernel.cols << "x" << kernel.rows << " border " << border << " op " << op;
+                    }
+        }
+    }
+}
+
+TEST(Imgproc_Morph, erodeDilate8u)
+{
+    checkErodeDilate<uchar>(HL_8U);
+}
+
+TEST(Imgproc_Morph, erodeDilate16u)
+{
+    checkErodeDilate<ushort>(HL_16U);
+}
+
+TEST(Imgproc_Morph, erodeDilate16s)
+{
+    checkErodeDilate<short>(HL_16S);
+}
+
+TEST(Imgproc_Morph, erodeDilate32f)
+{
+    checkErodeDilate<float>(HL_32F);
+}
+
+TEST(Imgproc_Morph, iterations)
+{
+    // the rectangles are merged into one larger rectangle, the other kernels are applied repeatedly
+    Mat src = randomMat(Size(80, 70), HL_8UC1, 5);
+    for (const Mat& kernel : testKernels())
+        for (int iterations : {2, 3})
+        {
+            Mat dst;
+            erode(src, dst, kernel, Point(-1, -1), iterations);
+            EXPECT_TRUE(equalMats(dst, morphReference<uchar>(src, MORPH_ERODE, kernel, iterations))) << "kernel " << kernel.cols << "x" << kernel.rows << " iterations " << iterations;
+            dilate(src, dst, kernel, Point(-1, -1), iterations);
+            EXPECT_TRUE(equalMats(dst, morphReference<uchar>(src, MORPH_DILATE, kernel, iterations))) << "kernel " << kernel.cols << "x" << kernel.rows << " iterations " << iterations;
+        }
+}
+
+TEST(Imgproc_Morph, roiReadsParent)
+{
+    Mat parent = randomMat(Size(60, 50), HL_8UC3, 8);
+    Mat kernel = getStructuringElement(MORPH_ELLIPSE, Size(5, 5));
+    Mat roi    = parent(Rect(0, 7, 41, 30));
+
+    // the ROI pixels next to it are read from the parent, the borders only apply at its edges
+    Mat expected = morphReference<uchar>(parent, MORPH_DILATE, kernel, Point(2, 2), BORDER_REPLICATE, Scalar())(Rect(0, 7, 41, 30)), dst;
+    dilate(roi, dst, kernel, Point(-1, -1), 1, BORDER_REPLICATE);
+    EXPECT_TRUE(equalMats(dst, expected.clone()));
+
+    expected = morphReference<uchar>(roi.clone(), MORPH_DILATE, kernel, Point(2, 2), BORDER_REPLICATE, Scalar());
+    dilate(roi, dst, kernel, Point(-1, -1), 1, BORDER_REPLICATE | BORDER_ISOLATED);
+    EXPECT_TRUE(equalMats(dst, expected));
+}
+
+TEST(Imgproc_Morph, morphologyEx)
+{
+    Mat src    = randomMat(Size(53, 41), HL_8UC1, 6);
+    Mat kernel = getStructuringElement(MORPH_CROSS, Size(5, 3));
+
+    Mat eroded  = morphReference<uchar>(src, MORPH_ERODE, kernel, 2);
+    Mat dilated = morphReference<uchar>(src, MORPH_DILATE, kernel, 2);
+
+    struct
+    {
+        int op;
+        Mat expected;
+    } cases[] = {
+        {MORPH_ERODE,    eroded},
+        {MORPH_DILATE,   dilated},
+        {MORPH_OPEN,     morphReference<uchar>(eroded, MORPH_DILATE, kernel, 2)},
+        {MORPH_CLOSE,    morphReference<uchar>(dilated, MORPH_ERODE, kernel, 2)},
+        {MORPH_GRADIENT, subtractReference<uchar>(dilated, eroded)},
+        {MORPH_TOPHAT,   subtractReference<uchar>(src, morphReference<uchar>(eroded, MORPH_DILATE, kernel, 2))},
+        {MORPH_BLACKHAT, subtractReference<uchar>(morphReference<uchar>(dilated, MORPH_ERODE, kernel, 2), src)},
+    };
+
+    for (const auto& c : cases)
+    {
+        Mat dst;
+        morphologyEx(src, dst, c.op, kernel, Point(-1, -1), 2);
+        EXPECT_TRUE(equalMats(dst, c.expected)) << "op " << c.op;
+
+        // in place
+        dst = src.clone();
+        morphologyEx(dst, dst, c.op, kernel, Point(-1, -1), 2);
+        EXPECT_TRUE(equalMats(dst, c.expected)) << "in place op " << c.op;
+    }
+}
+
+//! the baseline contour rule: a foreground point is inner if none of its 8 neighbours inside the image is 0
+Mat contoursReference(const Mat& src)
+{
+    Mat dst(src.size(), HL_8UC3);
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols; x++)
+        {
+            uchar v = src.at<uchar>(y, x);
+            if (v != 255)
+            {
+                dst.at<Vec3b>(y, x) = Vec3b(v, v, v);
+                continue;
+            }
+            bool inner = true;
+            for (int i = -1; i <= 1; i++)
+                for (int j = -1; j <= 1; j++)
+                    if (y + i >= 0 && y + i < src.rows && x + j >= 0 && x + j < src.cols && src.at<uchar>(y + i, x + j) == 0)
+                        inner = false;
+            dst.at<Vec3b>(y, x) = inner ? Vec3b(0, 0, 0) : Vec3b(0, 0, 255);
+        }
+    return dst;
+}
+
+TEST(Imgproc_Morph, contoursOfRoi)
+{
+    // a foreground ROI with a few holes in a background parent: the parent pixels around the ROI must not
+    // turn its edge points into contour points
+    Mat parent(40, 50, HL_8UC1, Scalar(0));
+    Mat roi = parent(Rect(5, 4, 37, 29));
+    roi = Scalar(255);
+    for (int i = 0; i < 12; i++)
+        roi.at<uchar>((i * 7) % roi.rows, (i * 11 + 3) % roi.cols) = 0;
+
+    Mat expected = contoursReference(roi.clone()), dst;
+    extractContours(roi, dst);
+    EXPECT_TRUE(equalMats(dst, expected));
+
+    extractContours(parent, dst);
+    EXPECT_TRUE(equalMats(dst, contoursReference(parent)));
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../../core/test/test_precomp.hxx"
+#include "openHL/imgproc.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+namespace hl
+{
+namespace test
+{
+
+//! random bytes for the integer types; the floating point images are random bytes scaled and shifted,
+//! since random bit patterns would give NaNs and infinities
+inline Mat randomMat(Size size, int type, unsigned seed, double scale = 1. / 16, double shift = 0)
+{
+    if (HL_MAT_DEPTH(type) != HL_32F && HL_MAT_DEPTH(type) != HL_64F)
+    {
+        Mat m(size, type);
+        randomFill(m, seed);
+        return m;
+    }
+
+    Mat bytes(size, HL_MAKETYPE(HL_8U, HL_MAT_CN(type))), m;
+    randomFill(bytes, seed);
+    bytes.convertTo(m, type, scale, shift);
+    return m;
+}
+
+//! a random image blurred a little, for the filters that approximate and are not meant for white noise
+inline Mat smoothImage(Size size, int type, unsigned seed)
+{
+    Mat m = randomMat(size, HL_MAKETYPE(HL_8U, HL_MAT_CN(type)), seed), t;
+    blur(m, t, Size(3, 3));
+    t.convertTo(m, HL_MAT_DEPTH(type));
+    return m;
+}
+
+//! true if a and b have the same size and channels and differ by at most tol times the largest value of b
+//! (at least 1); a tol of 0 asks for the same values
+inline bool nearMats(const Mat& a, const Mat& b, double tol)
+{
+    if (a.size() != b.size() || a.channels() != b.channels())
+        return false;
+
+    Mat da, db;
+    a.convertTo(da, HL_64F);
+    b.convertTo(db, HL_64F);
+    double scale = 1;
+    for (int y = 0; y < db.rows; y++)
+        for (int x = 0; x < db.cols * db.channels(); x++)
+            scale = std::max(scale, std::abs(db.ptr<double>(y)[x]));
+    for (int y = 0; y < db.rows; y++)
+        for (int x = 0; x < db.cols * db.channels(); x++)
+            if (std::abs(da.ptr<double>(y)[x] - db.ptr<double>(y)[x]) > tol * scale)
+                return false;
+    return true;
+}
+
+}    // namespace test
+}    // namespace hl
@@ -0,0 +1,168 @@
+#include "test_precomp.hxx"
+
+#include <cmath>
+#include <type_traits>
+#include <vector>
+#include "openHL/core/utility.hxx"
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+//! rounds the weighted sum like the fixed-point paths, or scales it for the float depths
+template <typename T>
+T castSum(double sum, int shift)
+{
+    if (std::is_floating_point<T>::value)
+        return (T)(sum * (1. / (1 << shift)));
+    return (T)std::floor((sum + (1 << (shift - 1))) / (1 << shift));
+}
+
+//! the 5x5 binomial kernel applied at the even pixels of src
+template <typename T>
+Mat pyrDownReference(const Mat& src, Size dsize, int borderType)
+{
+    const int k[] = {1, 4, 6, 4, 1};
+    int       cn  = src.channels();
+    Mat       dst(dsize, src.type());
+    for (int y = 0; y < dsize.height; y++)
+        for (int x = 0; x < dsize.width; x++)
+            for (int c = 0; c < cn; c++)
+            {
+                double sum = 0;
+                for (int i = 0; i < 5; i++)
+                    for (int j = 0; j < 5; j++)
+                    {
+                        int sy  = borderInterpolate(y * 2 + i - 2, src.rows, borderType);
+                        int sx  = borderInterpolate(x * 2 + j - 2, src.cols, borderType);
+                        sum    += (double)k[i] * k[j] * src.ptr<T>(sy)[sx * cn + c];
+                    }
+                dst.ptr<T>(y)[x * cn + c] = castSum<T>(sum, 8);
+            }
+    return dst;
+}
+
+//! the even pixels weight their neighbours by 1 6 1, the odd ones the two pixels around them by 4 4
+template <typename T>
+Mat pyrUpReference(const Mat& src, Size dsize, int borderType)
+{
+    int cn = src.channels();
+    Mat dst(dsize, src.type());
+
+    auto taps = [&](int d, int len, int* ofs, int* w)
+    {
+        int s = d >> 1;
+        if (d & 1)
+        {
+            ofs[0] = s, ofs[1] = s + 1, ofs[2] = s;
+            w[0] = 4, w[1] = 4, w[2] = 0;
+        }
+        else
+        {
+            ofs[0] = s - 1, ofs[1] = s, ofs[2] = s + 1;
+            w[0] = 1, w[1] = 6, w[2] = 1;
+        }
+        for (int i = 0; i < 3; i++)
+            ofs[i] = borderInterpolate(ofs[i], len, borderType);
+    };
+
+    for (int y = 0; y < dsize.height; y++)
+        for (int x = 0; x < dsize.width; x++)
+        {
+            int yofs[3], yw[3], xofs[3], xw[3];
+            taps(y, src.rows, yofs, yw);
+            taps(x, src.cols, xofs, xw);
+            for (int c = 0; c < cn; c++)
+            {
+                double sum = 0;
+                for (int i = 0; i < 3; i++)
+                    for (int j = 0; j < 3; j++)
+                        sum += (double)yw[i] * xw[j] * src.ptr<T>(yofs[i])[xofs[j] * cn + c];
+                dst.ptr<T>(y)[x * cn + c] = castSum<T>(sum, 6);
+            }
+        }
+    return dst;
+}
+
+template <typename T>
+void checkPyramids(int depth)
+{
+    const Size sizes[]   = {Size(1, 1), Size(2, 3), Size(7, 5), Size(33, 18), Size(64, 41)};
+    const int  borders[] = {BORDER_REFLECT_101, BORDER_REFLECT, BORDER_REPLICATE};
+
+    // the integer pyramids are exact, the float ones may round the sums in another order
+    double tol = depth == HL_32F ? 1e-5 : 0;
+
+    for (int cn : {1, 2, 3, 4})
+        for (Size size : sizes)
+            for (int border : borders)
+            {
+                Mat src = randomMat(size, HL_MAKETYPE(depth, cn), size.width * 16 + cn);
+
+                Mat down;
+                pyrDown(src, down, Size(), border);
+                EXPECT_TRUE(nearMats(down, pyrDownReference<T>(src, down.size(), border), tol)) << "pyrDown depth " << depth << " cn " << cn << " " << size.width << "x" << size.height << " border " << border;
+
+                Mat up;
+                pyrUp(src, up, Size(), border);
+                EXPECT_TRUE(nearMats(up, pyrUpReference<T>(src, up.size(), border), tol)) << "pyrUp depth " << depth << " cn " << cn << " " << size.width << "x" << size.height << " border " << border;
+
+                Size oddSize(size.width * 2 + 1, size.height * 2 + 1);
+                pyrUp(src, up, oddSize, border);
+                EXPECT_TRUE(nearMats(up, pyrUpReference<T>(src, oddSize, border), tol)) << "odd pyrUp depth " << depth << " cn " << cn << " " << size.width << "x" << size.height;
+            }
+}
+
+TEST(Imgproc_Pyramids, matchReference8u)
+{
+    checkPyramids<uchar>(HL_8U);
+}
+
+TEST(Imgproc_Pyramids, matchReference16u)
+{
+    checkPyramids<ushort>(HL_16U);
+}
+
+TEST(Imgproc_Pyramids, matchReference16s)
+{
+    checkPyramids<short>(HL_16S);
+}
+
+TEST(Imgproc_Pyramids, matchReference32f)
+{
+    checkPyramids<float>(HL_32F);
+}
+
+TEST(Imgproc_Pyramids, buildPyramidMatchesPyrDown)
+{
+    // enough rows for several stripes, whose shared rows are computed again by each of them
+    Mat src(613, 397, HL_8UC3);
+    randomFill(src, 9);
+    int nthreads = getNumThreads();
+
+    for (int threads : {1, 4})
+    {
+        setNumThreads(threads);
+        std::vector<Mat> levels;
+        buildPyramid(src, levels, 5);
+        ASSERT_EQ(levels.size(), 6u);
+        EXPECT_TRUE(equalMats(levels[0], src));
+
+        Mat prev = src;
+        for (int k = 1; k <= 5; k++)
+        {
+            Mat down;
+            pyrDown(prev, down);
+            EXPECT_TRUE(equalMats(levels[k], down)) << "level " << k << " threads " << threads;
+            prev = down;
+        }
+    }
+    setNumThreads(nthreads);
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
@@ -0,0 +1,349 @@
+#include "test_precomp.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "openHL/core/utility.hxx"
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+TEST(Imgproc_Resize, planCacheAcrossSteps)
+{
+    // the plans are shared between sources of the same size, whatever their step, except for the fast
+    // area one whose offsets are in units of the step; resizing a ROI and its compact copy in turn
+    // exercises both the cache hits and the misses
+    Mat wide(48, 200, HL_8UC3), narrow(48, 180, HL_8UC3);
+    randomFill(wide, 1);
+    randomFill(narrow, 2);
+    Mat rois[] = {wide.colRange(10, 70), narrow.colRange(0, 60)};
+
+    struct
+    {
+        Size dsize;
+        int  interpolation;
+    } cases[] = {
+        {Size(30, 24), INTER_AREA  },
+        {Size(20, 16), INTER_AREA  },
+        {Size(25, 19), INTER_AREA  },
+        {Size(30, 24), INTER_LINEAR},
+        {Size(90, 70), INTER_LINEAR},
+        {Size(90, 70), INTER_CUBIC },
+    };
+
+    for (const auto& c : cases)
+        for (int pass = 0; pass < 2; pass++)
+            for (const Mat& roi : rois)
+            {
+                Mat dst, expected;
+                resize(roi, dst, c.dsize, 0, 0, c.interpolation);
+                resize(roi.clone(), expected, c.dsize, 0, 0, c.interpolation);
+                EXPECT_TRUE(equalMats(dst, expected)) << "interpolation " << c.interpolation << " size " << c.dsize.width << "x" << c.dsize.height;
+            }
+}
+
+double maxAbsDiff(const Mat& a, const Mat& b)
+{
+    Mat da, db;
+    a.convertTo(da, HL_64F);
+    b.convertTo(db, HL_64F);
+    double    diff = 0;
+    const int n    = (int)(da.total() * da.channels());
+    for (int i = 0; i < n; i++)
+        diff = std::max(diff, std::abs(da.ptr<double>()[i] - db.ptr<double>()[i]));
+    return diff;
+}
+
+//! source offsets and 8-bit weights of INTER_LINEAR_EXACT along one axis, clamped at the borders
+void linearExactTab(int ssize, int dsize, std::vector<int>& ofs, std::vector<int>& w)
+{
+    double scale = 1. / ((double)dsize / ssize);
+    ofs.resize(dsize);
+    w.resize(dsize);
+    for (int d = 0; d < dsize; d++)
+    {
+        double f = scale * (d + 0.5) - 0.5;
+        int    i = (int)std::floor(f);
+        if (i < 0 || ssize == 1)
+        {
+            ofs[d] = 0;
+            w[d]   = 0;
+        }
+        else if (i >= ssize - 1)
+        {
+            ofs[d] = ssize - 2;
+            w[d]   = 256;
+        }
+        else
+        {
+            ofs[d] = i;
+            w[d]   = (int)std::nearbyint((f - i) * 256);
+        }
+    }
+}
+
+//! INTER_LINEAR_EXACT of an 8-bit image: the rows are interpolated with 8-bit weights, then the columns, and rounded once
+Mat linearExactReference(const Mat& src, Size dsize)
+{
+    int              cn = src.channels();
+    std::vector<int> xofs, xw, yofs, yw;
+    linearExactTab(src.cols, dsize.width, xofs, xw);
+    linearExactTab(src.rows, dsize.height, yofs, yw);
+
+    auto pixel = [&](int y, int x, int c) { return (int)src.ptr<uchar>(std::min(y, src.rows - 1))[std::min(x, src.cols - 1) * cn + c]; };
+    auto hline = [&](int y, int dx, int c) { return pixel(y, xofs[dx], c) * (256 - xw[dx]) + pixel(y, xofs[dx] + 1, c) * xw[dx]; };
+
+    Mat dst(dsize, src.type());
+    for (int dy = 0; dy < dsize.height; dy++)
+        for (int dx = 0; dx < dsize.width; dx++)
+            for (int c = 0; c < cn; c++)
+            {
+                int v = hline(yofs[dy], dx, c) * (256 - yw[dy]) + hline(yofs[dy] + 1, dx, c) * yw[dy];
+                dst.ptr<uchar>(dy)[dx * cn + c] = (uchar)((v + (1 << 15)) >> 16);
+            }
+    return dst;
+}
+
+TEST(Imgproc_Resize, linearExactMatchesFixedPointReference)
+{
+    const Size sizes[][2] = {
+        {Size(37, 29), Size(81, 65)},
+        {Size(81, 65), Size(37, 29)},
+        {Size(64, 48), Size(100, 30)},
+        {Size(1, 9),   Size(5, 20)  },
+        {Size(40, 40), Size(13, 77)},
+    };
+
+    for (int cn = 1; cn <= 4; cn++)
+        for (const auto& sz : sizes)
+        {
+            Mat src(sz[0], HL_MAKETYPE(HL_8U, cn));
+            randomFill(src, cn);
+            Mat dst;
+            resize(src, dst, sz[1], 0, 0, INTER_LINEAR_EXACT);
+            EXPECT_TRUE(equalMats(dst, linearExactReference(src, sz[1]))) << "cn " << cn << " " << sz[0].width << "x" << sz[0].height << " -> " << sz[1].width << "x" << sz[1].height;
+        }
+}
+
+//! the tap weights of INTER_LINEAR, INTER_CUBIC and INTER_LANCZOS4 for the fractional offset f
+void resizeCoeffs(int interpolation, float f, float* w)
+{
+    if (interpolation == INTER_LINEAR)
+    {
+        w[0] = 1.f - f;
+        w[1] = f;
+    }
+    else if (interpolation == INTER_CUBIC)
+    {
+        const float A = -0.75f;
+        w[0]          = ((A * (f + 1) - 5 * A) * (f + 1) + 8 * A) * (f + 1) - 4 * A;
+        w[1]          = ((A + 2) * f - (A + 3)) * f * f + 1;
+        w[2]          = ((A + 2) * (1 - f) - (A + 3)) * (1 - f) * (1 - f) + 1;
+        w[3]          = 1.f - w[0] - w[1] - w[2];
+    }
+    else
+    {
+        const double s45     = 0.70710678118654752440084436210485;
+        const double cs[][2] = {{1, 0}, {-s45, -s45}, {0, 1}, {s45, -s45}, {-1, 0}, {s45, s45}, {0, -1}, {-s45, s45}};
+        float        sum     = 0;
+        double       y0 = -(f + 3) * HL_PI * 0.25, s0 = std::sin(y0), c0 = std::cos(y0);
+        for (int i = 0; i < 8; i++)
+        {
+            float y = f + 3 - i;
+            w[i]    = std::fabs(y) >= 1e-6f ? (float)((cs[i][0] * s0 + cs[i][1] * c0) / ((y * HL_PI * 0.25) * (y * HL_PI * 0.25))) : 1e30f;
+            sum    += w[i];
+        }
+        sum = 1.f / sum;
+        for (int i = 0; i < 8; i++)
+            w[i] *= sum;
+    }
+}
+
+//! resize of a single pixel at a time: the rows are filtered horizontally into WT, then blended vertically, with the
+//! 11-bit fixed-point weights of the 8-bit tables and the order of the float sums of the scalar kernels
+template <typename T, typename WT>
+Mat resizeReference(const Mat& src, Size dsize, int interpolation)
+{
+    const bool fixpt  = src.depth() == HL_8U;
+    const int  ksize  = interpolation == INTER_LINEAR ? 2 : interpolation == INTER_CUBIC ? 4 : 8;
+    const int  cn     = src.channels();
+    double     scalex = 1. / ((double)dsize.width / src.cols), scaley = 1. / ((double)dsize.height / src.rows);
+
+    auto weights = [&](float f, WT* w) {
+        float c[8];
+        resizeCoeffs(interpolation, f, c);
+        for (int k = 0; k < ksize; k++)
+            w[k] = fixpt ? (WT)saturate_cast<short>(c[k] * 2048) : (WT)c[k];
+    };
+
+    std::vector<int> xofs(dsize.width);
+    std::vector<WT>  alpha(dsize.width * ksize);
+    for (int dx = 0; dx < dsize.width; dx++)
+    {
+        float fx = (float)((dx + 0.5) * scalex - 0.5);
+        int   sx = (int)std::floor(fx);
+        fx      -= sx;
+        // only the linear taps are pinned to the edge pixels, the wider kernels replicate them
+        if (interpolation == INTER_LINEAR && sx < 0)
+            fx = 0, sx = 0;
+        if (interpolation == INTER_LINEAR && sx >= src.cols - 1)
+            fx = 0, sx = src.cols - 1;
+        xofs[dx] = sx;
+        weights(fx, &alpha[dx * ksize]);
+    }
+
+    auto hline = [&](int y, int dx, int c) {
+        const T* S = src.ptr<T>(std::min(std::max(y, 0), src.rows - 1));
+        WT       v = 0;
+        for (int k = 0; k < ksize; k++)
+        {
+            int x  = std::min(std::max(xofs[dx] + k - ksize / 2 + 1, 0), src.cols - 1);
+            v     += S[x * cn + c] * alpha[dx * ksize + k];
+        }
+        return v;
+    };
+
+    Mat dst(dsize, src.type());
+    for (int dy = 0; dy < dsize.height; dy++)
+    {
+        float fy = (float)((dy + 0.5) * scaley - 0.5);
+        int   sy = (int)std::floor(fy);
+        WT    beta[8];
+        weights(fy - sy, beta);
+
+        for (int dx = 0; dx < dsize.width; dx++)
+            for (int c = 0; c < cn; c++)
+            {
+                WT rows[8], v = 0;
+                for (int k = 0; k < ksize; k++)
+                    rows[k] = hline(sy + k - ksize / 2 + 1, dx, c);
+                T& d = dst.ptr<T>(dy)[dx * cn + c];
+                if (fixpt && interpolation == INTER_LINEAR)
+                    d = (T)((((int)beta[0] * ((int)rows[0] >> 4) >> 16) + ((int)beta[1] * ((int)rows[1] >> 4) >> 16) + 2) >> 2);
+                else
+                {
+                    for (int k = 0; k < ksize; k++)
+                        v += rows[k] * beta[k];
+                    d = fixpt ? saturate_cast<T>(((int)v + (1 << 21)) >> 22) : saturate_cast<T>(v);
+                }
+            }
+    }
+    return dst;
+}
+
+TEST(Imgproc_Resize, kernelsMatchScalarReference)
+{
+    // no scale is an exact factor of two, which INTER_LINEAR hands over to the fast area path
+    const Size sizes[][2] = {
+        {Size(37, 29),  Size(81, 65) },
+        {Size(81, 65),  Size(37, 29) },
+        {Size(64, 48),  Size(100, 30)},
+        {Size(40, 40),  Size(13, 77) },
+        {Size(3, 5),    Size(17, 11) },
+        {Size(200, 20), Size(333, 15)},
+    };
+    const int interpolations[] = {INTER_LINEAR, INTER_CUBIC, INTER_LANCZOS4};
+
+    for (int depth : {HL_8U, HL_16U, HL_16S, HL_32F})
+        for (int cn = 1; cn <= 4; cn++)
+            for (const auto& sz : sizes)
+            {
+                Mat src(sz[0], HL_MAKETYPE(depth, cn));
+                if (depth == HL_32F)
+                {
+                    Mat src8u(sz[0], HL_MAKETYPE(HL_8U, cn));
+                    randomFill(src8u, cn);
+                    src8u.convertTo(src, HL_32F, 1. / 255);
+                }
+                else
+                    randomFill(src, depth * 8 + cn);
+
+                for (int interpolation : interpolations)
+                {
+                    Mat dst, expected;
+                    resize(src, dst, sz[1], 0, 0, interpolation);
+                    switch (depth)
+                    {
+                        case HL_8U: expected = resizeReference<uchar, int>(src, sz[1], interpolation); break;
+                        case HL_16U: expected = resizeReference<ushort, float>(src, sz[1], interpolation); break;
+                        case HL_16S: expected = resizeReference<short, float>(src, sz[1], interpolation); break;
+                        default: expected = resizeReference<float, float>(src, sz[1], interpolation); break;
+                    }
+                    EXPECT_TRUE(equalMats(dst, expected)) << "interpolation " << interpolation << " depth " << depth << " cn " << cn << " " << sz[0].width << "x" << sz[0].height << " -> " << sz[1].width << "x" << sz[1].height;
+                }
+            }
+}
+
+TEST(Imgproc_Resize, exactModesNearFloat)
+{
+    const int  depths[] = {HL_8U, HL_16U, HL_16S};
+    const Size sizes[][2] = {
+        {Size(37, 29), Size(81, 65)},
+        {Size(81, 65), Size(37, 29)},
+        {Size(90, 60), Size(30, 20)},
+    };
+
+    for (int depth : depths)
+        for (int cn = 1; cn <= 4; cn++)
+            for (const auto& sz : sizes)
+            {
+                Mat src(sz[0], HL_MAKETYPE(depth, cn));
+                randomFill(src, depth * 8 + cn);
+
+                Mat exact, ref;
+                resize(src, exact, sz[1], 0, 0, INTER_CUBIC_EXACT);
+                resize(src, ref, sz[1], 0, 0, INTER_CUBIC);
+                EXPECT_LE(maxAbsDiff(exact, ref), 1) << "cubic depth " << depth << " cn " << cn;
+
+                resize(src, exact, sz[1], 0, 0, INTER_AREA_EXACT);
+                resize(src, ref, sz[1], 0, 0, INTER_AREA);
+                EXPECT_LE(maxAbsDiff(exact, ref), 1) << "area depth " << depth << " cn " << cn;
+            }
+}
+
+TEST(Imgproc_Resize, exactModesIndependentOfThreads)
+{
+    // large enough destinations to be split into several stripes
+    Mat src(200, 260, HL_8UC3);
+    randomFill(src, 5);
+    int nthreads = getNumThreads();
+
+    for (int interpolation : {INTER_LINEAR_EXACT, INTER_CUBIC_EXACT, INTER_AREA_EXACT})
+        for (Size dsize : {Size(520, 400), Size(97, 61)})
+        {
+            Mat serial, threaded;
+            setNumThreads(1);
+            resize(src, serial, dsize, 0, 0, interpolation);
+            setNumThreads(4);
+            resize(src, threaded, dsize, 0, 0, interpolation);
+            EXPECT_TRUE(equalMats(serial, threaded)) << "interpolation " << interpolation;
+        }
+    setNumThreads(nthreads);
+}
+
+TEST(Imgproc_Resize, warpRejectsExactResizeModes)
+{
+    Mat src(16, 16, HL_8UC1), dst;
+    randomFill(src, 1);
+    Mat affine(2, 3, HL_64FC1, Scalar(0)), perspective(3, 3, HL_64FC1, Scalar(0));
+    affine.at<double>(0, 0) = affine.at<double>(1, 1) = 1;
+    perspective.at<double>(0, 0) = perspective.at<double>(1, 1) = perspective.at<double>(2, 2) = 1;
+
+    for (int flags : {(int)INTER_CUBIC_EXACT, (int)INTER_AREA_EXACT, INTER_CUBIC_EXACT | WARP_INVERSE_MAP})
+    {
+        EXPECT_THROW(warpAffine(src, dst, affine, src.size(), flags), Exception);
+        EXPECT_THROW(warpPerspective(src, dst, perspective, src.size(), flags), Exception);
+    }
+
+    // the warp flags keep their values
+    warpAffine(src, dst, affine, src.size(), INTER_LINEAR | WARP_FILL_OUTLIERS | WARP_INVERSE_MAP);
+    EXPECT_TRUE(equalMats(dst, src));
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
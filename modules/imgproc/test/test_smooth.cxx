@@ -0,0 +1,220 @@
+#include "test_precomp.hxx"
+
+#include <cmath>
+#include <vector>
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+//! separable convolution in double precision with the 1D kernels kx and ky, the constant border is 0
+Mat separableReference(const Mat& src, const std::vector<double>& kx, const std::vector<double>& ky, int borderType)
+{
+    int cn = src.channels(), rx = (int)kx.size() / 2, ry = (int)ky.size() / 2;
+    Mat src64, dst64(src.size(), HL_MAKETYPE(HL_64F, cn)), dst;
+    src.convertTo(src64, HL_64F);
+
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols * cn; x++)
+        {
+            double s = 0;
+            for (int i = -ry; i <= ry; i++)
+                for (int j = -rx; j <= rx; j++)
+                {
+                    int yy = borderInterpolate(y + i, src.rows, borderType);
+                    int xx = borderInterpolate(x / cn + j, src.cols, borderType);
+                    if (yy >= 0 && xx >= 0)
+                        s += ky[i + ry] * kx[j + rx] * src64.ptr<double>(yy)[xx * cn + x % cn];
+                }
+            dst64.ptr<double>(y)[x] = s;
+        }
+    dst64.convertTo(dst, src.depth());
+    return dst;
+}
+
+std::vector<double> tentKernel(int ksize)
+{
+    int                 r = ksize / 2;
+    std::vector<double> k(ksize);
+    for (int i = -r; i <= r; i++)
+        k[i + r] = (double)(r + 1 - std::abs(i)) / ((r + 1) * (r + 1));
+    return k;
+}
+
+std::vector<double> gaussianKernel(double sigma)
+{
+    int                 r = hlCeil(sigma * 6);
+    std::vector<double> k(r * 2 + 1);
+    double              s = 0;
+    for (int i = -r; i <= r; i++)
+        s += k[i + r] = std::exp(-0.5 * i * i / (sigma * sigma));
+    for (double& v : k)
+        v /= s;
+    return k;
+}
+
+//! the integer window sums of a box filter, the constant border is 0
+template <typename T>
+Mat boxSums(const Mat& src, Size ksize, int borderType)
+{
+    int cn = src.channels(), rx = ksize.width / 2, ry = ksize.height / 2;
+    Mat sums(src.size(), HL_MAKETYPE(HL_32S, cn));
+
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols * cn; x++)
+        {
+            int s = 0;
+            for (int i = -ry; i < ksize.height - ry; i++)
+                for (int j = -rx; j < ksize.width - rx; j++)
+                {
+                    int yy = borderInterpolate(y + i, src.rows, borderType);
+                    int xx = borderInterpolate(x / cn + j, src.cols, borderType);
+                    if (yy >= 0 && xx >= 0)
+                        s += src.ptr<T>(yy)[xx * cn + x % cn];
+                }
+            sums.ptr<int>(y)[x] = s;
+        }
+    return sums;
+}
+
+//! the normalized box filter: the window sums times the double reciprocal of the area; the 16-bit sums of the
+//! 8-bit kernels up to 256 pixels are divided in 23-bit fixed point instead
+template <typename T>
+Mat boxReference(const Mat& src, Size ksize, int borderType)
+{
+    Mat    sums  = boxSums<T>(src, ksize, borderType), dst(src.size(), src.type());
+    int    area  = ksize.area();
+    double scale = 1. / area;
+
+    bool   fixpt = src.depth() == HL_8U && area <= 256;
+    double fds   = (double)(1 << 23) / area;
+    int    ds = (int)std::floor(fds), dd = area / 2;
+    if (fds - ds < 0.5)
+        dd++;
+    else
+        ds++;
+
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols * src.channels(); x++)
+        {
+            int s            = sums.ptr<int>(y)[x];
+            dst.ptr<T>(y)[x] = fixpt ? (T)((s + dd) * ds >> 23) : saturate_cast<T>(s * scale);
+        }
+    return dst;
+}
+
+TEST(Imgproc_BoxFilter, matchesReference)
+{
+    // the even areas have exact halves, which must round like the double product
+    const Size ksizes[] = {Size(3, 3), Size(4, 4), Size(7, 5), Size(9, 9), Size(1, 6), Size(12, 2), Size(17, 16), Size(19, 15)};
+    const int  borders[] = {BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101};
+
+    for (int depth : {HL_8U, HL_16U, HL_16S})
+        for (int cn : {1, 3, 4})
+        {
+            Mat src(41, 57, HL_MAKETYPE(depth, cn));
+            randomFill(src, depth * 8 + cn);
+            for (Size ksize : ksizes)
+                for (int borderType : borders)
+                {
+                    Mat dst, expected;
+                    switch (depth)
+                    {
+                        case HL_8U: expected = boxReference<uchar>(src, ksize, borderType); break;
+                        case HL_16U: expected = boxReference<ushort>(src, ksize, borderType); break;
+                        default: expected = boxReference<short>(src, ksize, borderType); break;
+                    }
+                    blur(src, dst, ksize, Point(-1, -1), borderType);
+                    EXPECT_TRUE(equalMats(dst, expected)) << "depth " << depth << " cn " << cn << " ksize " << ksize.width << "x" << ksize.height << " border " << borderType;
+                }
+        }
+}
+
+TEST(Imgproc_BoxFilter, unnormalizedSums)
+{
+    const Size ksizes[] = {Size(3, 3), Size(4, 4), Size(7, 5), Size(1, 6), Size(12, 2)};
+
+    for (int cn : {1, 2, 3, 4, 5})
+    {
+        Mat src(41, 57, HL_MAKETYPE(HL_8U, cn));
+        randomFill(src, cn);
+        for (Size ksize : ksizes)
+            for (int borderType : {BORDER_CONSTANT, BORDER_REFLECT_101})
+            {
+                Mat dst;
+                boxFilter(src, dst, HL_32S, ksize, Point(-1, -1), false, borderType);
+                EXPECT_TRUE(equalMats(dst, boxSums<uchar>(src, ksize, borderType))) << "cn " << cn << " ksize " << ksize.width << "x" << ksize.height << " border " << borderType;
+            }
+    }
+}
+
+TEST(Imgproc_StackBlur, matchesTentKernel)
+{
+    for (int type : {HL_8UC1, HL_8UC3, HL_16UC1, HL_32FC4})
+        for (int borderType : {BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT, BORDER_WRAP, BORDER_REFLECT_101})
+            for (Size ksize : {Size(1, 5), Size(5, 1), Size(7, 3), Size(15, 9)})
+            {
+                Mat src = smoothImage(Size(31, 19), type, type + borderType);
+                Mat dst;
+                stackBlur(src, dst, ksize, borderType);
+                Mat ref = separableReference(src, tentKernel(ksize.width), tentKernel(ksize.height), borderType);
+                EXPECT_LE(norm(dst, ref, NORM_INF), src.depth() == HL_32F ? 1e-3 : 1) << "type " << type << " border " << borderType << " ksize " << ksize.width << "x" << ksize.height;
+            }
+}
+
+TEST(Imgproc_GaussianBlurIIR, matchesGaussian)
+{
+    // the recursive filter only approximates the Gaussian, and the worse the smaller sigma is
+    for (int type : {HL_8UC1, HL_8UC3, HL_32FC1})
+        for (double sigma : {2.5, 4.0})
+        {
+            Mat src = smoothImage(Size(40, 33), type, type);
+            Mat dst;
+            GaussianBlurIIR(src, dst, sigma, sigma, BORDER_REFLECT_101);
+            Mat ref = separableReference(src, gaussianKernel(sigma), gaussianKernel(sigma), BORDER_REFLECT_101);
+            EXPECT_LE(norm(dst, ref, NORM_INF), 3) << "type " << type << " sigma " << sigma;
+        }
+}
+
+TEST(Imgproc_GaussianBlurIIR, borderMatchesPaddedImage)
+{
+    const int pad = 64;
+    for (int type : {HL_8UC1, HL_8UC3, HL_32FC1})
+        for (int borderType : {BORDER_CONSTANT, BORDER_REFLECT, BORDER_WRAP, BORDER_REFLECT_101})
+            for (double sigma : {1.0, 3.0})
+            {
+                Mat src = smoothImage(Size(40, 33), type, type + borderType);
+                Mat padded, paddedDst, dst;
+                copyMakeBorder(src, padded, pad, pad, pad, pad, borderType);
+                GaussianBlurIIR(padded, paddedDst, sigma, sigma, BORDER_REPLICATE);
+                GaussianBlurIIR(src, dst, sigma, sigma, borderType);
+                EXPECT_LE(norm(dst, paddedDst(Rect(pad, pad, src.cols, src.rows)).clone(), NORM_INF), src.depth() == HL_32F ? 0.05 : 1) << "type " << type << " border " << borderType << " sigma " << sigma;
+            }
+}
+
+TEST(Imgproc_Smooth, borderReadsRoiParent)
+{
+    Mat whole = smoothImage(Size(80, 60), HL_8UC3, 3);
+    Rect r(20, 15, 40, 30);
+
+    Mat wholeDst, roiDst;
+    stackBlur(whole, wholeDst, Size(9, 7), BORDER_REFLECT_101);
+    stackBlur(whole(r), roiDst, Size(9, 7), BORDER_REFLECT_101);
+    EXPECT_TRUE(equalMats(wholeDst(r).clone(), roiDst));
+
+    GaussianBlurIIR(whole, wholeDst, 2, 2, BORDER_REPLICATE);
+    GaussianBlurIIR(whole(r), roiDst, 2, 2, BORDER_REPLICATE);
+    EXPECT_LE(norm(wholeDst(r).clone(), roiDst, NORM_INF), 1);
+
+    Mat isolated;
+    stackBlur(whole(r), roiDst, Size(9, 7), BORDER_REFLECT_101 | BORDER_ISOLATED);
+    stackBlur(whole(r).clone(), isolated, Size(9, 7), BORDER_REFLECT_101);
+    EXPECT_TRUE(equalMats(isolated, roiDst));
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
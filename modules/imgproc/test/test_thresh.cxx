@@ -0,0 +1,392 @@
+#include "test_precomp.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "openHL/core/utility.hxx"
+
+namespace hl
+{
+namespace test
+{
+namespace
+{
+
+//! threshold of every element, the integer thresholds floored and maxval rounded; NaN fails every comparison, so
+//! the inverted modes map it to 0
+template <typename T>
+Mat thresholdReference(const Mat& src, double thresh, double maxval, int type)
+{
+    bool isInt = std::numeric_limits<T>::is_integer;
+    T    t     = isInt ? saturate_cast<T>(std::floor(thresh)) : (T)thresh;
+    T    m     = isInt ? saturate_cast<T>(std::lrint(maxval)) : (T)maxval;
+    Mat  dst(src.size(), src.type());
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols * src.channels(); x++)
+        {
+            T v = src.ptr<T>(y)[x];
+            T d = v;
+            switch (type)
+            {
+                case THRESH_BINARY: d = v > t ? m : 0; break;
+                case THRESH_BINARY_INV: d = v <= t ? m : 0; break;
+                case THRESH_TRUNC: d = v > t ? t : v; break;
+                case THRESH_TOZERO: d = v > t ? v : 0; break;
+                case THRESH_TOZERO_INV: d = v <= t ? v : 0; break;
+            }
+            dst.ptr<T>(y)[x] = d;
+        }
+    return dst;
+}
+
+TEST(Imgproc_Threshold, matchesReference)
+{
+    const int types[] = {THRESH_BINARY, THRESH_BINARY_INV, THRESH_TRUNC, THRESH_TOZERO, THRESH_TOZERO_INV};
+
+    for (int depth : {HL_8U, HL_16U, HL_16S, HL_32F, HL_64F})
+    {
+        // an odd width and a column range, so that rows end with partial vectors
+        Mat whole(23, 70, HL_MAKETYPE(depth, 3));
+        if (depth == HL_32F || depth == HL_64F)
+        {
+            Mat bytes(whole.size(), HL_8UC3);
+            randomFill(bytes, 1);
+            bytes.convertTo(whole, depth, 1. / 255);
+            for (int i = 0; i < 40; i++)
+            {
+                uchar* p = whole.ptr(i % whole.rows) + (i * 37 % (whole.cols * 3)) * whole.elemSize1();
+                if (depth == HL_32F)
+                    *(float*)p = std::numeric_limits<float>::quiet_NaN();
+                else
+                    *(double*)p = std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+        else
+            randomFill(whole, depth + 1);
+
+        double thresh = depth == HL_8U ? 100.7 : depth == HL_16U ? 30000.2 : depth == HL_16S ? -1234.5 : 0.37;
+        double maxval = depth == HL_8U ? 200.4 : depth == HL_16U ? 61234.6 : depth == HL_16S ? 12345.5 : 0.83;
+
+        for (const Mat& src : {whole, whole.colRange(3, 60)})
+            for (int type : types)
+            {
+                Mat dst, expected;
+                threshold(src, dst, thresh, maxval, type);
+                switch (depth)
+                {
+                    case HL_8U: expected = thresholdReference<uchar>(src, thresh, maxval, type); break;
+                    case HL_16U: expected = thresholdReference<ushort>(src, thresh, maxval, type); break;
+                    case HL_16S: expected = thresholdReference<short>(src, thresh, maxval, type); break;
+                    case HL_32F: expected = thresholdReference<float>(src, thresh, maxval, type); break;
+                    default: expected = thresholdReference<double>(src, thresh, maxval, type); break;
+                }
+                EXPECT_TRUE(equalMats(dst, expected)) << "depth " << depth << " type " << type << " continuous " << src.isContinuous();
+            }
+    }
+}
+
+//! adaptiveThreshold of each pixel against the local mean m, with delta rounded like the implementation
+uchar adaptivePixel(int v, int m, int type, double delta, uchar maxval)
+{
+    int idelta = type == THRESH_BINARY ? (int)std::ceil(delta) : (int)std::floor(delta);
+    return (v - m > -idelta) == (type == THRESH_BINARY) ? maxval : 0;
+}
+
+TEST(Imgproc_AdaptiveThreshold, meanMatchesBoxFilter)
+{
+    Mat src(67, 83, HL_8UC1);
+    randomFill(src, 11);
+
+    for (int blockSize : {3, 5, 11, 17, 31})
+        for (int type : {THRESH_BINARY, THRESH_BINARY_INV})
+            for (double delta : {-3.5, 0., 4.2})
+            {
+                Mat mean, dst, expected(src.size(), HL_8UC1);
+                blur(src, mean, Size(blockSize, blockSize), Point(-1, -1), BORDER_REPLICATE);
+                for (int y = 0; y < src.rows; y++)
+                    for (int x = 0; x < src.cols; x++)
+                        expected.at<uchar>(y, x) = adaptivePixel(src.at<uchar>(y, x), mean.at<uchar>(y, x), type, delta, 200);
+
+                adaptiveThreshold(src, dst, 200, ADAPTIVE_THRESH_MEAN_C, type, blockSize, delta);
+                EXPECT_TRUE(equalMats(dst, expected)) << "blockSize " << blockSize << " type " << type << " delta " << delta;
+            }
+}
+
+TEST(Imgproc_AdaptiveThreshold, gaussianMatchesDoubleReference)
+{
+    Mat src(67, 83, HL_8UC1);
+    randomFill(src, 12);
+
+    for (int blockSize : {3, 7, 9, 21})
+    {
+        // the kernel of getGaussianKernel(blockSize, 0), tabulated up to 7 taps
+        std::vector<double> k(blockSize);
+        if (blockSize == 3)
+            k = {0.25, 0.5, 0.25};
+        else if (blockSize == 7)
+            k = {0.03125, 0.109375, 0.21875, 0.28125, 0.21875, 0.109375, 0.03125};
+        else
+        {
+            double sigma = 0.3 * ((blockSize - 1) * 0.5 - 1) + 0.8, sum = 0;
+            for (int i = 0; i < blockSize; i++)
+                sum += k[i] = std::exp(-0.5 * (i - blockSize / 2) * (i - blockSize / 2) / (sigma * sigma));
+            for (double& w : k)
+                w /= sum;
+        }
+
+        int r = blockSize / 2, checked = 0;
+        Mat dst;
+        adaptiveThreshold(src, dst, 255, ADAPTIVE_THRESH_GAUSSIAN_C, THRESH_BINARY, blockSize, 2);
+        for (int y = 0; y < src.rows; y++)
+            for (int x = 0; x < src.cols; x++)
+            {
+                double m = 0;
+                for (int i = -r; i <= r; i++)
+                    for (int j = -r; j <= r; j++)
+                        m += k[i + r] * k[j + r] * src.at<uchar>(std::min(std::max(y + i, 0), src.rows - 1), std::min(std::max(x + j, 0), src.cols - 1));
+
+                // the float sums may round the other way right at the halves
+                if (std::abs(m - std::floor(m) - 0.5) < 1e-3)
+                    continue;
+                checked++;
+                ASSERT_EQ(dst.at<uchar>(y, x), adaptivePixel(src.at<uchar>(y, x), (int)std::lrint(m), THRESH_BINARY, 2, 255)) << "blockSize " << blockSize << " at " << x << "," << y;
+            }
+        EXPECT_GT(checked, (int)src.total() * 9 / 10);
+    }
+}
+
+TEST(Imgproc_AdaptiveThreshold, roiInPlaceAndThreads)
+{
+    Mat whole(300, 90, HL_8UC1);
+    randomFill(whole, 13);
+    Mat roi      = whole(Rect(7, 20, 70, 250));
+    int nthreads = getNumThreads();
+
+    for (int method : {ADAPTIVE_THRESH_MEAN_C, ADAPTIVE_THRESH_GAUSSIAN_C})
+    {
+        // the border is replicated from the ROI itself, not read from its parent
+        Mat ref;
+        setNumThreads(1);
+        adaptiveThreshold(roi.clone(), ref, 255, method, THRESH_BINARY, 9, 1);
+
+        for (int threads : {1, 4})
+        {
+            setNumThreads(threads);
+            Mat dst;
+            adaptiveThreshold(roi, dst, 255, method, THRESH_BINARY, 9, 1);
+            EXPECT_TRUE(equalMats(dst, ref)) << "method " << method << " threads " << threads;
+
+            Mat inplace = roi.clone();
+            adaptiveThreshold(inplace, inplace, 255, method, THRESH_BINARY, 9, 1);
+            EXPECT_TRUE(equalMats(inplace, ref)) << "in place, method " << method << " threads " << threads;
+        }
+    }
+    setNumThreads(nthreads);
+}
+
+//! isodata threshold computed by scanning the image, with the initial value and the empty class rule of threshold_Iter
+double iterReference(const Mat& src, double epsilon)
+{
+    std::vector<int> levels;
+    std::vector<int> count(256, 0);
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols; x++)
+            count[src.at<uchar>(y, x)]++;
+    for (int i = 0; i < 256; i++)
+        if (count[i] > 0)
+            levels.push_back(i);
+
+    double T = levels[levels.size() / 2], T_new;
+    for (;;)
+    {
+        double sum1 = 0, sum2 = 0, count1 = 0, count2 = 0;
+        for (int y = 0; y < src.rows; y++)
+            for (int x = 0; x < src.cols; x++)
+            {
+                int v = src.at<uchar>(y, x);
+                if (v > std::floor(T))
+                {
+                    sum1 += v;
+                    count1++;
+                }
+                else
+                {
+                    sum2 += v;
+                    count2++;
+                }
+            }
+        double mean1 = count1 > 0 ? sum1 / count1 : sum2 / count2;
+        double mean2 = count2 > 0 ? sum2 / count2 : mean1;
+        T_new        = (mean1 + mean2) / 2;
+        if (std::abs(T_new - T) < epsilon)
+            break;
+        T = T_new;
+    }
+    return T_new;
+}
+
+Mat histogram8u(const Mat& src)
+{
+    Mat          hist;
+    int          channels[] = {0};
+    int          histSize[] = {256};
+    float        range[]    = {0, 256};
+    const float* ranges[]   = {range};
+    calcHist(&src, 1, channels, Mat(), hist, 1, histSize, ranges);
+    return hist;
+}
+
+TEST(Imgproc_ThresholdIter, matchesReference)
+{
+    for (unsigned seed = 1; seed <= 4; seed++)
+    {
+        Mat src(37, 53, HL_8UC1);
+        randomFill(src, seed);
+        Mat hist = histogram8u(src);
+
+        Mat    dst, expected;
+        double T = threshold_Iter(src, dst, hist, 0.01);
+        // the returned threshold is the one applied to the 8-bit image, i.e. the integer part of T
+        EXPECT_EQ(T, std::floor(iterReference(src, 0.01))) << "seed " << seed;
+
+        threshold(src, expected, T, 255, THRESH_BINARY);
+        EXPECT_TRUE(equalMats(dst, expected)) << "seed " << seed;
+    }
+}
+
+TEST(Imgproc_ThresholdIter, histogramShapes)
+{
+    Mat src(31, 29, HL_8UC1);
+    randomFill(src, 7);
+    Mat hist = histogram8u(src);
+
+    Mat    dst;
+    double T = threshold_Iter(src, dst, hist, 0.01);
+
+    // row vector
+    Mat row(1, (int)hist.total(), HL_32FC1);
+    for (int i = 0; i < row.cols; i++)
+        row.at<float>(0, i) = hist.ptr<float>()[i];
+    EXPECT_EQ(threshold_Iter(src, dst, row, 0.01), T);
+
+    // non-continuous column
+    Mat wide(row.cols, 3, HL_32FC1, Scalar(0));
+    for (int i = 0; i < row.cols; i++)
+        wide.at<float>(i, 1) = row.at<float>(0, i);
+    Mat col = wide.col(1);
+    ASSERT_FALSE(col.isContinuous());
+    EXPECT_EQ(threshold_Iter(src, dst, col, 0.01), T);
+
+    // fewer bins than gray levels, the missing levels are empty
+    Mat dark(8, 8, HL_8UC1);
+    for (int i = 0; i < (int)dark.total(); i++)
+        dark.ptr<uchar>()[i] = (uchar)(i % 16);
+    Mat short_hist(16, 1, HL_32FC1, Scalar(4));
+    EXPECT_EQ(threshold_Iter(dark, dst, short_hist, 0.01), threshold_Iter(dark, dst, histogram8u(dark), 0.01));
+}
+
+TEST(Imgproc_ThresholdIter, rejectsNonPositiveEpsilon)
+{
+    Mat src(8, 8, HL_8UC1);
+    randomFill(src, 3);
+    Mat hist = histogram8u(src), dst;
+
+    EXPECT_THROW(threshold_Iter(src, dst, hist, 0), Exception);
+    EXPECT_THROW(threshold_Iter(src, dst, hist, -1), Exception);
+}
+
+//! between-class variance, up to constant terms, of the classes split by the thresholds
+double otsuObjective(const std::vector<int>& count, const std::vector<int>& thresholds)
+{
+    double obj = 0;
+    for (size_t k = 0, i = 0; k <= thresholds.size(); k++)
+    {
+        int    last = k < thresholds.size() ? thresholds[k] : 255;
+        double w = 0, m = 0;
+        for (; (int)i <= last; i++)
+        {
+            w += count[i];
+            m += (double)i * count[i];
+        }
+        if (w > 0)
+            obj += m * m / w;
+    }
+    return obj;
+}
+
+std::vector<int> levelCounts(const Mat& src)
+{
+    std::vector<int> count(256, 0);
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols; x++)
+            count[src.at<uchar>(y, x)]++;
+    return count;
+}
+
+//! the class of a pixel is the number of thresholds below its level
+Mat multiReference(const Mat& src, const std::vector<int>& thresholds, double maxval)
+{
+    int nthresh = (int)thresholds.size();
+    Mat dst(src.size(), src.type());
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols; x++)
+        {
+            int k = 0;
+            while (k < nthresh && src.at<uchar>(y, x) > thresholds[k])
+                k++;
+            dst.at<uchar>(y, x) = saturate_cast<uchar>(k * maxval / nthresh);
+        }
+    return dst;
+}
+
+TEST(Imgproc_ThresholdMulti, matchesExhaustiveSearch)
+{
+    Mat src(41, 37, HL_8UC1);
+    randomFill(src, 11);
+    // fewer levels keep the exhaustive search over two thresholds cheap and the optimum unique enough
+    for (int i = 0; i < (int)src.total(); i++)
+        src.ptr<uchar>()[i] = (uchar)((src.ptr<uchar>()[i] * src.ptr<uchar>()[i]) >> 8);
+    std::vector<int> count = levelCounts(src);
+
+    Mat              dst;
+    std::vector<int> t1 = thresholdMulti(src, dst, 1);
+    ASSERT_EQ(t1.size(), 1u);
+    double best1 = 0;
+    for (int a = 0; a < 255; a++)
+        best1 = std::max(best1, otsuObjective(count, {a}));
+    EXPECT_NEAR(otsuObjective(count, t1), best1, best1 * 1e-12);
+    EXPECT_TRUE(equalMats(dst, multiReference(src, t1, 255)));
+
+    std::vector<int> t2 = thresholdMulti(src, dst, 2, 200);
+    ASSERT_EQ(t2.size(), 2u);
+    EXPECT_LT(t2[0], t2[1]);
+    double best2 = 0;
+    for (int a = 0; a < 255; a++)
+        for (int b = a + 1; b < 255; b++)
+            best2 = std::max(best2, otsuObjective(count, {a, b}));
+    EXPECT_NEAR(otsuObjective(count, t2), best2, best2 * 1e-12);
+    EXPECT_TRUE(equalMats(dst, multiReference(src, t2, 200)));
+}
+
+TEST(Imgproc_ThresholdMulti, fewerLevelsThanClasses)
+{
+    Mat dst;
+
+    Mat constant(9, 13, HL_8UC1, Scalar(77));
+    EXPECT_EQ(thresholdMulti(constant, dst, 3), std::vector<int>({255, 255, 255}));
+    EXPECT_TRUE(equalMats(dst, Mat(constant.size(), HL_8UC1, Scalar(0))));
+
+    Mat two(9, 13, HL_8UC1, Scalar(40));
+    Mat top = two.rowRange(0, 4);
+    top     = Scalar(180);
+    std::vector<int> t = thresholdMulti(two, dst, 3);
+    EXPECT_EQ(t, std::vector<int>({40, 255, 255}));
+    EXPECT_TRUE(equalMats(dst, multiReference(two, t, 255)));
+    EXPECT_EQ(dst.at<uchar>(0, 0), 85);
+    EXPECT_EQ(dst.at<uchar>(8, 0), 0);
+}
+
+}    // namespace
+}    // namespace test
+}    // namespace hl
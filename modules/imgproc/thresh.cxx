@@ -1,4 +1,5 @@
 #include "precomp.hxx"
+#include "openHL/core/hal/intrin.hxx"
 
 namespace hl
 {
@@ -33,40 +34,100 @@ inline static T threshToZeroInv(const T& src, const T& thresh)
     return src <= thresh ? src : 0;
 }
 
+/*
+ * The comparisons are done on whole vectors and the results are picked with v_select, so all the
+ * depths share the same LUT-free kernels. The selects follow the scalar expressions above lane by
+ * lane, NaNs of the floating point images included; the remaining elements of a row are done by
+ * the scalar loop.
+ */
 template <typename T>
 static void threshGeneric(Size roi, const T* src, size_t src_step, T* dst, size_t dst_step, T thresh, T maxval, int type)
 {
     int i = 0, j;
+
+#if HL_SIMD128
+    typedef v_reg<T, HL_SIMD_WIDTH / sizeof(T)> VT;
+
+    const int nlanes  = VT::nlanes;
+    VT        vthresh = v_setall(thresh);
+    VT        vmaxval = v_setall(maxval);
+    VT        vzero   = v_setall((T)0);
+#endif
+
     switch (type)
     {
         case THRESH_BINARY :
             for (; i < roi.height; i++, src += src_step, dst += dst_step)
-                for (j = 0; j < roi.width; j++)
+            {
+                j = 0;
+#if HL_SIMD128
+                for (; j <= roi.width - nlanes; j += nlanes)
+                    v_store(dst + j, v_select(v_load(src + j) > vthresh, vmaxval, vzero));
+#endif
+                for (; j < roi.width; j++)
                     dst[j] = threshBinary<T>(src[j], thresh, maxval);
+            }
             return;
 
         case THRESH_BINARY_INV :
             for (; i < roi.height; i++, src += src_step, dst += dst_step)
-                for (j = 0; j < roi.width; j++)
+            {
+                j = 0;
+#if HL_SIMD128
+                for (; j <= roi.width - nlanes; j += nlanes)
+                    v_store(dst + j, v_select(v_load(src + j) <= vthresh, vmaxval, vzero));
+#endif
+                for (; j < roi.width; j++)
                     dst[j] = threshBinaryInv<T>(src[j], thresh, maxval);
+            }
             return;
 
         case THRESH_TRUNC :
             for (; i < roi.height; i++, src += src_step, dst += dst_step)
-                for (j = 0; j < roi.width; j++)
+            {
+                j = 0;
+#if HL_SIMD128
+                for (; j <= roi.width - nlanes; j += nlanes)
+                {
+                    VT v = v_load(src + j);
+                    v_store(dst + j, v_select(v > vthresh, vthresh, v));
+                }
+#endif
+                for (; j < roi.width; j++)
                     dst[j] = threshTrunc<T>(src[j], thresh);
+            }
             return;
 
         case THRESH_TOZERO :
             for (; i < roi.height; i++, src += src_step, dst += dst_step)
-                for (j = 0; j < roi.width; j++)
+            {
+                j = 0;
+#if HL_SIMD128
+                for (; j <= roi.width - nlanes; j += nlanes)
+                {
+                    VT v = v_load(src + j);
+                    v_store(dst + j, v_select(v > vthresh, v, vzero));
+                }
+#endif
+                for (; j < roi.width; j++)
                     dst[j] = threshToZero<T>(src[j], thresh);
+            }
             return;
 
         case THRESH_TOZERO_INV :
             for (; i < roi.height; i++, src += src_step, dst += dst_step)
-                for (j = 0; j < roi.width; j++)
+            {
+                j = 0;
+#if HL_SIMD128
+                for (; j <= roi.width - nlanes; j += nlanes)
+                {
+                    VT v = v_load(src + j);
+                    v_store(dst + j, v_select(v <= vthresh, v, vzero));
+                }
+#endif
+                for (; j < roi.width; j++)
                     dst[j] = threshToZeroInv<T>(src[j], thresh);
+            }
             return;
 
         default :
@@ -89,76 +150,9 @@ static void thresh_8u(const Mat& _src, Mat& _dst, uchar thresh, uchar maxval, in
         src_step = dst_step = roi.width;
     }
 
-    int          j   = 0;
     const uchar* src = _src.ptr();
     uchar*       dst = _dst.ptr();
-
-    int j_scalar     = j;
-    if (j_scalar < roi.width)
-    {
-        const int thresh_pivot = thresh + 1;
-        uchar     tab[256]     = {0};
-        switch (type)
-        {
-            case THRESH_BINARY :
-                memset(tab, 0, thresh_pivot);
-                if (thresh_pivot < 256)
-                {
-                    memset(tab + thresh_pivot, maxval, 256 - thresh_pivot);
-                }
-                break;
-            case THRESH_BINARY_INV :
-                memset(tab, maxval, thresh_pivot);
-                if (thresh_pivot < 256)
-                {
-                    memset(tab + thresh_pivot, 0, 256 - thresh_pivot);
-                }
-                break;
-            case THRESH_TRUNC :
-                for (int i = 0; i <= thresh; i++)
-                    tab[i] = (uchar)i;
-                if (thresh_pivot < 256)
-                {
-                    memset(tab + thresh_pivot, thresh, 256 - thresh_pivot);
-                }
-                break;
-            case THRESH_TOZERO :
-                memset(tab, 0, thresh_pivot);
-                for (int i = thresh_pivot; i < 256; i++)
-                    tab[i] = (uchar)i;
-                break;
-            case THRESH_TOZERO_INV :
-                for (int i = 0; i <= thresh; i++)
-                    tab[i] = (uchar)i;
-                if (thresh_pivot < 256)
-                {
-                    memset(tab + thresh_pivot, 0, 256 - thresh_pivot);
-                }
-                break;
-        }
-
-        src = _src.ptr();
-        dst = _dst.ptr();
-        for (int i = 0; i < roi.height; i++, src += src_step, dst += dst_step)
-        {
-            for (j = j_scalar; j <= roi.width - 4; j += 4)
-            {
-                uchar t0   = tab[src[j]];
-                uchar t1   = tab[src[j + 1]];
-
-                dst[j]     = t0;
-                dst[j + 1] = t1;
-
-                t0         = tab[src[j + 2]];
-                t1         = tab[src[j + 3]];
-
-                dst[j + 2] = t0;
-                dst[j + 3] = t1;
-            }
-            for (; j < roi.width; j++)
-                dst[j] = tab[src[j]];
-        }
-    }
+    threshGeneric<uchar>(roi, src, src_step, dst, dst_step, thresh, maxval, type);
 }
 
 static void thresh_16u(const Mat& _src, Mat& _dst, ushort thresh, ushort maxval, int type)
@@ -235,40 +229,102 @@ static void thresh_64f(const Mat& _src, Mat& _dst, double thresh, double maxval,
     threshGeneric<double>(roi, src, src_step, dst, dst_step, thresh, maxval, type);
 }
 
-template <typename T, size_t BinsOnStack = 0u>
-static double getThreshVal_Otsu(const Mat& _src, const Size& size)
+/*
+ * Every stripe counts its rows into its own histogram (split into 4 interleaved sub-histograms to
+ * break the dependency between consecutive increments of the same bin), which is added to the
+ * shared one at the end under the lock.
+ */
+template <typename T>
+class ThreshHist_Invoker: public ParallelLoopBody
 {
-    const int N = std::numeric_limits<T>::max() + 1;
-    int       i, j;
+public:
+    enum
+    {
+        HIST_SZ = std::numeric_limits<T>::max() + 1
+    };
 
-    AutoBuffer<int, 4 * BinsOnStack> hBuf(4 * N);
+    ThreshHist_Invoker(const Mat& _src, int* _hist, Mutex* _histLock):
+        ParallelLoopBody(), src(_src), hist(_hist), histLock(_histLock)
+    {
+    }
 
-    memset(hBuf.data(), 0, hBuf.size() * sizeof(int));
-    int* h             = hBuf.data();
-    int* h_unrolled[3] = {h + N, h + 2 * N, h + 3 * N};
-    for (i = 0; i < size.height; i++)
+    void operator()(const Range& range) const override
     {
-        const T* src = _src.ptr<T>(i, 0);
-        for (j = 0; j <= size.width - 4; j += 4)
+        AutoBuffer<int, 4 * 256> hBuf(4 * HIST_SZ);
+
+        memset(hBuf.data(), 0, hBuf.size() * sizeof(int));
+        int* h             = hBuf.data();
+        int* h_unrolled[3] = {h + HIST_SZ, h + 2 * HIST_SZ, h + 3 * HIST_SZ};
+
+        int width  = src.cols * src.channels();
+        int height = range.end - range.start;
+        if (src.isContinuous())
+        {
+            width  *= height;
+            height  = 1;
+        }
+
+        for (int i = 0; i < height; i++)
         {
-            int v0 = src[j], v1 = src[j + 1];
-            h[v0]++;
-            h_unrolled[0][v1]++;
-            v0 = src[j + 2];
-            v1 = src[j + 3];
-            h_unrolled[1][v0]++;
-            h_unrolled[2][v1]++;
+            const T* ptr = src.ptr<T>(range.start + i);
+            int      j   = 0;
+            for (; j <= width - 4; j += 4)
+            {
+                int v0 = ptr[j], v1 = ptr[j + 1];
+                h[v0]++;
+                h_unrolled[0][v1]++;
+                v0 = ptr[j + 2];
+                v1 = ptr[j + 3];
+                h_unrolled[1][v0]++;
+                h_unrolled[2][v1]++;
+            }
+            for (; j < width; j++)
+                h[ptr[j]]++;
         }
-        for (; j < size.width; j++)
-            h[src[j]]++;
+
+        AutoLock lock(*histLock);
+
+        for (int i = 0; i < HIST_SZ; i++)
+            hist[i] += h[i] + h_unrolled[0][i] + h_unrolled[1][i] + h_unrolled[2][i];
     }
 
-    double mu = 0, scale = 1. / (size.width * size.height);
+private:
+    const Mat& src;
+    int*       hist;
+    Mutex*     histLock;
+
+    ThreshHist_Invoker(const ThreshHist_Invoker&);                     // = delete;
+    const ThreshHist_Invoker& operator=(const ThreshHist_Invoker&);    // = delete;
+};
+
+//! the histogram of all the values of src, hist has numeric_limits<T>::max() + 1 bins
+template <typename T>
+static void calcThreshHist(const Mat& src, int* hist)
+{
+    const int N = ThreshHist_Invoker<T>::HIST_SZ;
+    memset(hist, 0, N * sizeof(hist[0]));
+
+    Mutex                 histLock;
+    ThreshHist_Invoker<T> body(src, hist, &histLock);
+
+    // clearing and merging the sub-histograms is not free, so there are no more stripes than threads
+    double nstripes = std::min((double)getNumThreads(), src.total() / (double)(1 << 16));
+    parallel_for_(Range(0, src.rows), body, nstripes);
+}
+
+template <typename T, size_t BinsOnStack = 0u>
+static double getThreshVal_Otsu(const Mat& _src)
+{
+    const int N = std::numeric_limits<T>::max() + 1;
+    int       i;
+
+    AutoBuffer<int, BinsOnStack> hBuf(N);
+    int*                         h = hBuf.data();
+    calcThreshHist<T>(_src, h);
+
+    double mu = 0, scale = 1. / _src.total();
     for (i = 0; i < N; i++)
-    {
-        h[i] += h_unrolled[0][i] + h_unrolled[1][i] + h_unrolled[2][i];
-        mu   += i * (double)h[i];
-    }
+        mu += i * (double)h[i];
 
     mu         *= scale;
     double mu1 = 0, q1 = 0;
@@ -300,71 +356,24 @@ static double getThreshVal_Otsu(const Mat& _src, const Size& size)
 
 static double getThreshVal_Otsu_8u(const Mat& _src)
 {
-    Size size = _src.size();
-    int  step = (int)_src.step;
-    if (_src.isContinuous())
-    {
-        size.width  *= size.height;
-        size.height  = 1;
-        step         = size.width;
-    }
-
-    HL_UNUSED(step);
-    return getThreshVal_Otsu<uchar, 256u>(_src, size);
+    return getThreshVal_Otsu<uchar, 256u>(_src);
 }
 
 static double getThreshVal_Otsu_16u(const Mat& _src)
 {
-    Size size = _src.size();
-    if (_src.isContinuous())
-    {
-        size.width  *= size.height;
-        size.height  = 1;
-    }
-
-    return getThreshVal_Otsu<ushort>(_src, size);
+    return getThreshVal_Otsu<ushort>(_src);
 }
 
 static double getThreshVal_Triangle_8u(const Mat& _src)
 {
-    Size size = _src.size();
-    int  step = (int)_src.step;
-    if (_src.isContinuous())
-    {
-        size.width  *= size.height;
-        size.height  = 1;
-        step         = size.width;
-    }
-
     const int N = 256;
-    int       i, j, h[N] = {0};
-    int       h_unrolled[3][N] = {};
-    for (i = 0; i < size.height; i++)
-    {
-        const uchar* src = _src.ptr() + step * i;
-        for (j = 0; j <= size.width - 4; j += 4)
-        {
-            int v0 = src[j], v1 = src[j + 1];
-            h[v0]++;
-            h_unrolled[0][v1]++;
-            v0 = src[j + 2];
-            v1 = src[j + 3];
-            h_unrolled[1][v0]++;
-            h_unrolled[2][v1]++;
-        }
-        for (; j < size.width; j++)
-            h[src[j]]++;
-    }
+    int       i, j, h[N];
+    calcThreshHist<uchar>(_src, h);
 
     int  left_bound = 0, right_bound = 0, max_ind = 0, max = 0;
     int  temp;
     bool isflipped = false;
 
-    for (i = 0; i < N; i++)
-    {
-        h[i] += h_unrolled[0][i] + h_unrolled[1][i] + h_unrolled[2][i];
-    }
-
     for (i = 0; i < N; i++)
     {
         if (h[i] > 0)
@@ -438,6 +447,172 @@ static double getThreshVal_Triangle_8u(const Mat& _src)
     return thresh;
 }
 
+/*
+ * 迭代法(isodata)求阈值：阈值T把像素分成两类，新的阈值取两类灰度均值的平均，直到阈值的变化小于epsilon。
+ * 两类的像素个数和灰度和都由直方图的累积和得到，每次迭代只需O(1)，不需要重新扫描图像。
+ * T可能在两个值之间来回振荡，所以迭代次数有上限，达到上限时返回最后一次的T。
+ */
+static double getThreshVal_Iter(const float* h, int N, double epsilon)
+{
+    enum
+    {
+        MAX_ITER = 1000
+    };
+
+    // cnt[i]、mom[i]为灰度值不大于i的像素个数与灰度和
+    AutoBuffer<double> _buf(N * 2);
+    double*            cnt = _buf.data();
+    double*            mom = cnt + N;
+
+    double c = 0, m = 0;
+    int    nonzero = 0;
+    for (int i = 0; i < N; i++)
+    {
+        c      += h[i];
+        m      += (double)i * h[i];
+        cnt[i]  = c;
+        mom[i]  = m;
+        if (h[i] > 0)
+            nonzero++;
+    }
+
+    if (nonzero == 0)
+        return 0;
+
+    // 初始阈值取非空灰度级的中值
+    int    k = nonzero / 2, i = 0;
+    for (;; i++)
+        if (h[i] > 0 && k-- == 0)
+            break;
+    double T = i, T_new = T;
+
+    // 迭代
+    for (int iter = 0; iter < MAX_ITER; iter++)
+    {
+        // 灰度值不大于T的像素属于第二类
+        int    t      = std::min(hlFloor(T), N - 1);
+        double count2 = t >= 0 ? cnt[t] : 0, sum2 = t >= 0 ? mom[t] : 0;
+        double count1 = c - count2, sum1 = m - sum2;
+
+        // 其中一类为空时两类的均值都取另一类的均值
+        double mean1  = count1 > 0 ? sum1 / count1 : sum2 / count2;
+        double mean2  = count2 > 0 ? sum2 / count2 : mean1;
+        T_new         = (mean1 + mean2) / 2;
+
+        if (std::abs(T_new - T) < epsilon)
+            break;
+        T = T_new;
+    }
+
+    return T_new;
+}
+
+/*
+ * Multi-level Otsu: the nthresh thresholds split the N levels into nthresh + 1 classes maximizing
+ * the between-class variance, i.e. the sum of S^2 / W over the classes, where W and S are the pixel
+ * count and the sum of the levels of a class. Both are differences of prefix sums, so a class costs
+ * O(1), and the best splits are found by dynamic programming over the class boundaries in
+ * O(nthresh * N^2). thresh[k] is the last level of the class k.
+ */
+static void getThreshVals_OtsuMulti(const int* h, int N, int nthresh, int* thresh)
+{
+    const int K = nthresh + 1;
+
+    AutoBuffer<double> _buf((N + 1) * (K + 2));
+    AutoBuffer<int>    _arg((N + 1) * K);
+    double*            P = _buf.data();
+    double*            S = P + N + 1;
+    // F[k][b] is the best sum of the first k + 1 classes covering the levels [0, b)
+    double*            F = S + N + 1;
+    int*               A = _arg.data();
+
+    P[0] = S[0] = 0;
+    for (int i = 0; i < N; i++)
+    {
+        P[i + 1] = P[i] + h[i];
+        S[i + 1] = S[i] + (double)i * h[i];
+    }
+
+    auto cost = [&](int a, int b)
+    {
+        double w = P[b] - P[a], m = S[b] - S[a];
+        return w > 0 ? m * m / w : 0.;
+    };
+
+    for (int b = 1; b <= N; b++)
+        F[b] = cost(0, b);
+
+    for (int k = 1; k < K; k++)
+    {
+        const double* Fp = F + (k - 1) * (N + 1);
+        double*       Fk = F + k * (N + 1);
+        int*          Ak = A + k * (N + 1);
+
+        // every class has at least one level
+        for (int b = k + 1; b <= N; b++)
+        {
+            double best = -1;
+            int    arg  = k;
+            for (int a = k; a < b; a++)
+            {
+                double v = Fp[a] + cost(a, b);
+                if (v > best)
+                {
+                    best = v;
+                    arg  = a;
+                }
+            }
+            Fk[b] = best;
+            Ak[b] = arg;
+        }
+    }
+
+    for (int k = K - 1, b = N; k > 0; k--)
+    {
+        b             = A[k * (N + 1) + b];
+        thresh[k - 1] = b - 1;
+    }
+}
+
+/*
+ * dst = lut[src], the table maps every level to its class.
+ */
+class ThreshLut_Invoker: public ParallelLoopBody
+{
+public:
+    ThreshLut_Invoker(const Mat& _src, Mat& _dst, const uchar* _lut):
+        ParallelLoopBody(), src(_src), dst(_dst), lut(_lut)
+    {
+    }
+
+    void operator()(const Range& range) const override
+    {
+        int width  = src.cols;
+        int height = range.end - range.start;
+        if (src.isContinuous() && dst.isContinuous())
+        {
+            width  *= height;
+            height  = 1;
+        }
+
+        for (int i = 0; i < height; i++)
+        {
+            const uchar* S = src.ptr(range.start + i);
+            uchar*       D = dst.ptr(range.start + i);
+            for (int j = 0; j < width; j++)
+                D[j] = lut[S[j]];
+        }
+    }
+
+private:
+    const Mat&   src;
+    Mat&         dst;
+    const uchar* lut;
+
+    ThreshLut_Invoker(const ThreshLut_Invoker&);                     // = delete;
+    const ThreshLut_Invoker& operator=(const ThreshLut_Invoker&);    // = delete;
+};
+
 class ThresholdRunner: public ParallelLoopBody
 {
 public:
@@ -490,58 +665,190 @@ private:
     int    thresholdType;
 };
 
-}    // namespace hl
+//! the kernel of getGaussianKernel(n, 0), i.e. sigma = 0.3 * ((n - 1) * 0.5 - 1) + 0.8
+static void getGaussianKernel_(int n, std::vector<float>& kernel)
+{
+    const int SMALL_GAUSSIAN_SIZE = 7;
 
-double hl::threshold_Iter(const Mat& src, Mat& dst, const Mat& hist, double epsilon)
+    static const float small_gaussian_tab[][SMALL_GAUSSIAN_SIZE] = {
+        {1.f},
+        {0.25f, 0.5f, 0.25f},
+        {0.0625f, 0.25f, 0.375f, 0.25f, 0.0625f},
+        {0.03125f, 0.109375f, 0.21875f, 0.28125f, 0.21875f, 0.109375f, 0.03125f}
+    };
+
+    kernel.resize(n);
+    if (n % 2 == 1 && n <= SMALL_GAUSSIAN_SIZE)
+    {
+        for (int i = 0; i < n; i++)
+            kernel[i] = small_gaussian_tab[n >> 1][i];
+        return;
+    }
+
+    double              sigmaX  = 0.3 * ((n - 1) * 0.5 - 1) + 0.8;
+    double              scale2X = -0.5 / (sigmaX * sigmaX);
+    double              sum     = 0;
+    std::vector<double> w(n);
+
+    for (int i = 0; i < n; i++)
+    {
+        double x  = i - (n - 1) * 0.5;
+        w[i]      = std::exp(scale2X * x * x);
+        sum      += w[i];
+    }
+    for (int i = 0; i < n; i++)
+        kernel[i] = (float)(w[i] / sum);
+}
+
+/*
+ * The local mean of every row is computed right before the row is thresholded, so the blurred image
+ * is never materialized. For the mean method the column box sums slide down the stripe, updated by
+ * the horizontal sums of the rows entering and leaving the block; for the Gaussian method each row
+ * is filtered vertically and then horizontally. The border is replicated virtually.
+ */
+class AdaptiveThresholdRunner: public ParallelLoopBody
 {
-    // 迭代法求阈值
-    // 初始化阈值
-    // 通过直方图获得图像灰度的中值
-    std::vector<double> hist_data;
-    for (int i = 0; i < hist.rows; ++i)
+public:
+    AdaptiveThresholdRunner(const Mat& _src, Mat& _dst, int _method, int _blockSize, const uchar* _tab):
+        ParallelLoopBody(), src(_src), dst(_dst), method(_method), blockSize(_blockSize), tab(_tab), border(_src, BORDER_REPLICATE | BORDER_ISOLATED, _blockSize / 2, _blockSize / 2)
     {
-        if (hist.at<float>(i) > 0)
-            hist_data.push_back(static_cast<double>(i));
+        if (method == ADAPTIVE_THRESH_GAUSSIAN_C)
+            getGaussianKernel_(blockSize, kernel);
     }
-    double T = hist_data[hist_data.size() / 2];
-    double T_new;
 
-    // 迭代
-    while (true)
+    void operator()(const Range& range) const override
+    {
+        if (method == ADAPTIVE_THRESH_MEAN_C)
+            meanRows(range);
+        else
+            gaussianRows(range);
+    }
+
+private:
+    void meanRows(const Range& range) const
     {
-        double sum1 = 0, sum2 = 0;
-        int    count1 = 0, count2 = 0;
-        for (int y = 0; y < src.rows; y++)
+        int    width = src.cols, r = blockSize / 2;
+        // the same rounding as boxFilter, so the means are those of the normalized box filter
+        double scale = 1. / ((double)blockSize * blockSize);
+
+        AutoBuffer<int> _sum(width + r * 2);
+        int*            SUM = _sum.data() + r;
+
+        // the column sums of the block above the first row of the stripe
+        memset(SUM, 0, width * sizeof(SUM[0]));
+        for (int i = range.start - r - 1; i < range.start + r; i++)
         {
-            for (int x = 0; x < src.cols; x++)
-            {
-                // 分别计算两个区域的灰度和像素个数
-                if (src.at<uchar>(y, x) > T)
-                {
-                    sum1 += src.at<uchar>(y, x);
-                    count1++;
-                }
-                else
-                {
-                    sum2 += src.at<uchar>(y, x);
-                    count2++;
-                }
-            }
+            const uchar* sp = border.row(i);
+            for (int x = 0; x < width; x++)
+                SUM[x] += sp[x];
         }
-        T_new = (sum1 / count1 + sum2 / count2) / 2;
 
-        if (std::abs(T_new - T) < epsilon)
+        for (int y = range.start; y < range.end; y++)
         {
-            break;
+            const uchar* S  = src.ptr(y);
+            const uchar* Sp = border.row(y + r);
+            const uchar* Sm = border.row(y - r - 1);
+            uchar*       D  = dst.ptr(y);
+
+            for (int x = 0; x < width; x++)
+                SUM[x] += Sp[x] - Sm[x];
+            // the replicated border columns have the sums of the first and the last ones
+            for (int i = 1; i <= r; i++)
+            {
+                SUM[-i]            = SUM[0];
+                SUM[width - 1 + i] = SUM[width - 1];
+            }
+
+            int s = 0;
+            for (int i = -r; i < r; i++)
+                s += SUM[i];
+            for (int x = 0; x < width; x++)
+            {
+                s    += SUM[x + r];
+                // s * scale is never a half-integer as the block area is odd
+                D[x]  = tab[S[x] - (int)(s * scale + 0.5) + 255];
+                s    -= SUM[x - r];
+            }
         }
-        else
+    }
+
+    void gaussianRows(const Range& range) const
+    {
+        int          width = src.cols, k = blockSize, r = k / 2;
+        const float* kx    = &kernel[r];
+
+        AutoBuffer<float> _buf(width * 2 + r * 2);
+        float*            col  = _buf.data() + r;
+        float*            mean = col + width + r;
+
+        for (int y = range.start; y < range.end; y++)
         {
-            T = T_new;
+            const uchar* S = src.ptr(y);
+            uchar*       D = dst.ptr(y);
+
+            // the vertical pass, the kernel is symmetric so the rows are added in pairs
+            const uchar* sp = border.row(y);
+            for (int x = 0; x < width; x++)
+                col[x] = kx[0] * sp[x];
+            for (int i = 1; i <= r; i++)
+            {
+                const uchar* sp0 = border.row(y - i);
+                const uchar* sp1 = border.row(y + i);
+                float        w   = kx[i];
+                for (int x = 0; x < width; x++)
+                    col[x] += w * (float)(sp0[x] + sp1[x]);
+            }
+            // the replicated border columns are equal to the first and the last ones
+            for (int i = 1; i <= r; i++)
+            {
+                col[-i]            = col[0];
+                col[width - 1 + i] = col[width - 1];
+            }
+
+            // the horizontal pass
+            for (int x = 0; x < width; x++)
+                mean[x] = kx[0] * col[x];
+            for (int i = 1; i <= r; i++)
+            {
+                float w = kx[i];
+                for (int x = 0; x < width; x++)
+                    mean[x] += w * (col[x - i] + col[x + i]);
+            }
+
+            for (int x = 0; x < width; x++)
+                D[x] = tab[S[x] - saturate_cast<uchar>(mean[x]) + 255];
         }
     }
 
+    const Mat&         src;
+    Mat&               dst;
+    int                method;
+    int                blockSize;
+    const uchar*       tab;
+    BorderRowAccessor  border;
+    std::vector<float> kernel;
+
+    AdaptiveThresholdRunner(const AdaptiveThresholdRunner&);                     // = delete;
+    const AdaptiveThresholdRunner& operator=(const AdaptiveThresholdRunner&);    // = delete;
+};
+
+}    // namespace hl
+
+double hl::threshold_Iter(const Mat& src, Mat& dst, const Mat& hist, double epsilon)
+{
+    HL_Assert(src.type() == HL_8UC1 || src.type() == HL_16UC1);
+
+    HL_Assert(epsilon > 0);
+
+    // 直方图的第i个bin对应灰度值i，可以是行向量或列向量，bin数少于灰度级数时其余灰度级的个数视为0
+    const int N = src.depth() == HL_8U ? 256 : 65536;
+    HL_Assert(hist.type() == HL_32FC1 && (hist.rows == 1 || hist.cols == 1) && (int)hist.total() <= N);
+
+    Mat    h      = hist.isContinuous() ? hist : hist.clone();
+    double thresh = getThreshVal_Iter(h.ptr<float>(), (int)h.total(), epsilon);
+
     // 根据阈值分割图像
-    return threshold(src, dst, T_new, 255, THRESH_BINARY);
+    return threshold(src, dst, thresh, N - 1, THRESH_BINARY);
 }
 
 double hl::threshold(const Mat& _src, Mat& _dst, double thresh, double maxval, int type)
@@ -657,3 +964,95 @@ double hl::threshold(const Mat& _src, Mat& _dst, double thresh, double maxval, i
                   dst.total() / (double)(1 << 16));
     return thresh;
 }
+
+void hl::adaptiveThreshold(const Mat& _src, Mat& _dst, double maxValue, int method, int type, int blockSize, double delta)
+{
+    HL_Assert(_src.type() == HL_8UC1);
+    HL_Assert(blockSize % 2 == 1 && blockSize > 1);
+    HL_Assert(method == ADAPTIVE_THRESH_MEAN_C || method == ADAPTIVE_THRESH_GAUSSIAN_C);
+    HL_Assert(type == THRESH_BINARY || type == THRESH_BINARY_INV);
+
+    // the rows around the current one are read after it has been written
+    Mat src = _src;
+    if (src.data == _dst.data)
+    {
+        src = Mat(_src.size(), _src.type());
+        _src.copyTo(src);
+    }
+    _dst.create(src.size(), src.type());
+    Mat dst = _dst;
+
+    if (maxValue < 0)
+    {
+        dst.setTo(0);
+        return;
+    }
+
+    uchar imaxval = saturate_cast<uchar>(maxValue);
+    int   idelta  = type == THRESH_BINARY ? hlCeil(delta) : hlFloor(delta);
+    uchar tab[768];
+
+    // tab[src - mean + 255] is the thresholded value
+    if (type == THRESH_BINARY)
+        for (int i = 0; i < 768; i++)
+            tab[i] = (uchar)(i - 255 > -idelta ? imaxval : 0);
+    else
+        for (int i = 0; i < 768; i++)
+            tab[i] = (uchar)(i - 255 <= -idelta ? imaxval : 0);
+
+    int nStripes = std::max(std::min(src.rows / std::max(blockSize * 4, 64), 64), 1);
+
+    AdaptiveThresholdRunner body(src, dst, method, blockSize, tab);
+    parallel_for_(Range(0, src.rows), body, nStripes);
+}
+
+/*
+ * When the image has fewer distinct levels than classes, every partition separating the levels is
+ * optimal. The thresholds are then defined as the distinct levels but the last, so that each level
+ * gets its own class from the bottom up, followed by N - 1 for the empty classes on top. A constant
+ * image thus gets the thresholds N - 1 and maps to 0.
+ */
+std::vector<int> hl::thresholdMulti(const Mat& _src, Mat& _dst, int nthresh, double maxval)
+{
+    HL_CheckType(_src.type() == HL_8UC1, "thresholdMulti");
+    HL_Assert(nthresh >= 1 && nthresh <= 4);
+
+    Mat src = _src;
+    _dst.create(src.size(), src.type());
+    Mat dst = _dst;
+
+    const int N = 256;
+    int       h[N];
+    calcThreshHist<uchar>(src, h);
+
+    std::vector<int> thresholds;
+    for (int i = 0; i < N && (int)thresholds.size() <= nthresh; i++)
+        if (h[i] > 0)
+            thresholds.push_back(i);
+
+    if ((int)thresholds.size() <= nthresh)
+    {
+        if (!thresholds.empty())
+            thresholds.pop_back();
+        thresholds.resize(nthresh, N - 1);
+    }
+    else
+    {
+        thresholds.resize(nthresh);
+        getThreshVals_OtsuMulti(h, N, nthresh, thresholds.data());
+    }
+
+    // the class k is mapped to k * maxval / nthresh
+    uchar lut[N];
+    for (int i = 0, k = 0; i < N; i++)
+    {
+        while (k < nthresh && i > thresholds[k])
+            k++;
+        lut[i] = saturate_cast<uchar>(k * maxval / nthresh);
+    }
+
+    ThreshLut_Invoker body(src, dst, lut);
+    parallel_for_(Range(0, src.rows), body, src.total() / (double)(1 << 16));
+
+    return thresholds;
+}